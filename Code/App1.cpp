@@ -8,13 +8,17 @@ App1::App1()
 {
 
 	lightShader = nullptr;
-	marchingCubesShader = nullptr;
-	gradientNoiseShader = nullptr;
-	voxelComputeShader = nullptr;
+	gpuBackend = nullptr;
+	cpuBackend = nullptr;
+	cpuScheduler = nullptr;
+	volumeBackend = nullptr;
 
-	voxelMesh = nullptr;
 	outputMesh = nullptr;
+	backMesh = nullptr;
+	regenerator = nullptr;
+	gpuProfiler = nullptr;
 	mainLight = nullptr;
+	bakedExtent = 0.0f;
 	triTableTexture = nullptr;
 
 	srand(time(NULL));
@@ -29,9 +33,6 @@ void App1::init(HINSTANCE hinstance, HWND hwnd, int screenWidth, int screenHeigh
 
 	// Initialise the shaders
 	lightShader = new LightShader(renderer->getDevice(), hwnd, POS4X32_NORM3X32);
-	marchingCubesShader = new MCShader(renderer->getDevice(), renderer->getDeviceContext(), hwnd);
-	gradientNoiseShader = new GradientNoise(renderer->getDevice(), hwnd);
-	voxelComputeShader = new VoxelComputeShader(renderer->getDevice(), hwnd);
 
 	// Initialise the textures from file
 	textureMgr->loadTexture("grass", L"../res/grass.png");
@@ -39,14 +40,21 @@ void App1::init(HINSTANCE hinstance, HWND hwnd, int screenWidth, int screenHeigh
 	textureMgr->loadTexture("rocks", L"../res/rocks.png");
 	textureMgr->loadTexture("sand", L"../res/sand.png");
 
-	// Create triangulation table texture from array data & set it in the marching cubes shader
+	// Create triangulation table texture from array data for the marching cubes shaders
 	triTableTexture = new TriTableTexture(renderer->getDevice());
-	marchingCubesShader->setTriTableTexture(triTableTexture->getTriTable());
 
-	// Initialise the voxel mesh using the meshSize parameter
-	voxelMesh = new EmptyMesh(renderer->getDevice(), true, true);
-	voxelMesh->setTopology(D3D11_PRIMITIVE_TOPOLOGY_POINTLIST);
+	// Initialise the compute backends
+	gpuBackend = new D3D11ComputeBackend(renderer->getDevice(), renderer->getDeviceContext(), hwnd, triTableTexture->getTriTable(), triTableTexture->getPackedTriTableBuffer());
+	cpuScheduler = new JobScheduler();
+	cpuBackend = new CPUComputeBackend(cpuScheduler);
+
 	outputMesh = new EmptyMesh(renderer->getDevice(), false, false);
+	backMesh = new EmptyMesh(renderer->getDevice(), false, false);
+
+	// Start the background regeneration thread, using every hardware thread for its jobs
+	regenerator = new AsyncRegenerator();
+
+	gpuProfiler = new GPUProfiler(new D3D11QueryBackend(renderer->getDevice(), renderer->getDeviceContext()));
 
 	lightDirection = -1.0f;
 
@@ -58,9 +66,11 @@ void App1::init(HINSTANCE hinstance, HWND hwnd, int screenWidth, int screenHeigh
 	mainLight->setSpecularColour(1.0f, 1.0f, 1.0f, 1.0f);
 	mainLight->setDirection(0.0f, lightDirection, 1.0f + lightDirection);
 
-	// Initial mesh size will be 64 - this value MUST be a multiple of 8
-	meshSize = 64;
-	meshScaleFactor = 64.0f / meshSize;
+	// Initial mesh size will be 64 in each dimension
+	meshSize[0] = 64;
+	meshSize[1] = 64;
+	meshSize[2] = 64;
+	meshScaleFactor = 64.0f / meshSize[0];
 	noiseScaleFactors = XMFLOAT3(1.0f, 2.7f, 1.0f);
 
 	// Set an initial isovalue
@@ -75,15 +85,26 @@ void App1::init(HINSTANCE hinstance, HWND hwnd, int screenWidth, int screenHeigh
 	offsets = XMFLOAT3(0.0f, 0.0f, 0.0f);
 	isSimplex = false;
 	isRidged = false;
+	isHashed = false;
+	seed = 0;
 	heightBase = -0.7f;
 	heightMultiplier = 3.0f;
 
 	isWireframe = false;
+	isBackgroundRegeneration = true;
+	isExtractionPending = false;
+	isComputeExtraction = false;
+	isPackedTriTable = false;
+	isCPUBackend = false;
+	extractionMethod = EXTRACTION_MARCHING_CUBES;
 	// We want a surface for the first frame, so set this to be true initially
 	recalculateSurface = true;
 
 #if TESTING_
 
+	// Timed runs bind their mesh as soon as it is extracted
+	isBackgroundRegeneration = false;
+
 	for (int i = 0; i < 100; i++)
 	{
 
@@ -95,6 +116,10 @@ void App1::init(HINSTANCE hinstance, HWND hwnd, int screenWidth, int screenHeigh
 
 	fileStream << "voxel gen" << "," << "noise gen" << "," << "marching cubes" << "," << "buffers" << "," << "total" << endl;
 
+	gpuFileStream = ofstream("gpu_timings.csv", std::ofstream::app);
+
+	gpuFileStream << "gpu noise gen" << "," << "gpu marching cubes" << "," << "gs invocations" << "," << "primitives written" << "," << "so overflow" << endl;
+
 	elapsedTime = 0.0f;
 	testCase = 0;
 	timeInterval = 0.1f;
@@ -110,6 +135,7 @@ App1::~App1()
 #if TESTING_
 
 	fileStream.close();
+	gpuFileStream.close();
 
 #endif
 
@@ -121,27 +147,27 @@ App1::~App1()
 
 	}
 
-	if (marchingCubesShader)
+	if (gpuBackend)
 	{
 
-		delete marchingCubesShader;
-		marchingCubesShader = 0;
+		delete gpuBackend;
+		gpuBackend = 0;
 
 	}
 
-	if (gradientNoiseShader)
+	if (cpuBackend)
 	{
 
-		delete gradientNoiseShader;
-		gradientNoiseShader = 0;
+		delete cpuBackend;
+		cpuBackend = 0;
 
 	}
 
-	if (voxelComputeShader)
+	if (cpuScheduler)
 	{
 
-		delete voxelComputeShader;
-		voxelComputeShader = 0;
+		delete cpuScheduler;
+		cpuScheduler = 0;
 
 	}
 
@@ -153,14 +179,17 @@ App1::~App1()
 
 	}
 
-	if (voxelMesh)
+	// Stop the regenerator first, as it may still be running a job
+	if (regenerator)
 	{
 
-		delete voxelMesh;
-		voxelMesh = 0;
+		delete regenerator;
+		regenerator = 0;
 
 	}
 
+	ReleaseBakedTerrain();
+
 	if (outputMesh)
 	{
 
@@ -169,6 +198,22 @@ App1::~App1()
 
 	}
 
+	if (backMesh)
+	{
+
+		delete backMesh;
+		backMesh = 0;
+
+	}
+
+	if (gpuProfiler)
+	{
+
+		delete gpuProfiler;
+		gpuProfiler = 0;
+
+	}
+
 	if (triTableTexture)
 	{
 
@@ -183,42 +228,195 @@ App1::~App1()
 }
 
 // The run function executes every stem required to get a new mesh representation of the surface
-// 1: Calculate a new voxel point list
-// 2: Calculate a new 3D texture using the noise shader
-// 3: Run the marching cubes algorithm using the voxel point list and 3D texture
-// 4: Put the geometry data streamed out into a mesh for rendering
+// 1: Allocate the volume
+// 2: Fill the volume using the noise shader
+// 3: Run the marching cubes algorithm over the volume
+// 4: Put the extracted geometry into a mesh for rendering
+// Each step goes through the selected compute backend, so the same steps run on the GPU or the CPU
+// The volume is kept between runs, so when only the isovalue, the scale or the extraction settings have changed, steps 1 and 2 are skipped
+// With background regeneration, step 4 waits for the D3D11 backend's extraction to complete, see frame
 void App1::Run()
 {
 
-	// Recalculate the number of voxels to send to the GPU
-	voxelComputeShader->UpdateMeshValues(meshSize, meshSize, meshSize);
-	voxelComputeShader->Run(renderer->getDeviceContext());
+	ComputeBackend* backend = getComputeBackend();
+	GenerationParameters parameters = getGenerationParameters();
+
+	// Only one backend's volume is ever extracted from, so free the other's when switching
+	if (volumeBackend && volumeBackend != backend)
+	{
+
+		volumeBackend->ReleaseVolume();
+		volumeBackend = nullptr;
+
+	}
+
+	// GPU timestamps measure nothing of the CPU backend's work, so only the D3D11 backend's runs are profiled
+	if (backend == gpuBackend)
+	{
+
+		gpuProfiler->BeginFrame();
+
+	}
+
+	if (!volumeBackend || !AsyncRegenerator::IsSameVolume(parameters, volumeParameters))
+	{
+
+		backend->AllocateVolume(parameters.dimsX, parameters.dimsY, parameters.dimsZ);
+
+		gpuProfiler->BeginStage(PROFILER_STAGE_NOISE);
+		backend->DispatchNoise(parameters.noise);
+		gpuProfiler->EndStage(PROFILER_STAGE_NOISE);
+
+		volumeBackend = backend;
+		volumeParameters = parameters;
+
+	}
+
+	// The CPU backend re-extracts an unchanged volume through its brick tree, visiting only the bricks the surface passes through
+	gpuProfiler->BeginStage(PROFILER_STAGE_MARCHING_CUBES);
+	backend->ExtractSurface(parameters.isoValue, parameters.meshScaleFactor);
+	gpuProfiler->EndStage(PROFILER_STAGE_MARCHING_CUBES);
+
+	// Then put the backend's output into the empty mesh, or leave the current one drawn until a deferred extraction completes
+	isExtractionPending = backend == gpuBackend && isBackgroundRegeneration;
+
+	if (!isExtractionPending)
+	{
+
+		backend->BindMesh(*outputMesh);
+
+	}
+
+	gpuProfiler->EndFrame();
+
+}
+
+void App1::SwapMeshes()
+{
+
+	EmptyMesh* previousMesh = outputMesh;
+	outputMesh = backMesh;
+	backMesh = previousMesh;
+
+}
+
+ComputeBackend* App1::getComputeBackend()
+{
+
+	gpuBackend->setComputeExtraction(isComputeExtraction);
+	gpuBackend->setPackedTriTable(isPackedTriTable);
+	gpuBackend->setDeferred(isBackgroundRegeneration);
+	cpuBackend->setExtractionMethod((ExtractionMethod)extractionMethod);
 
-	voxelMesh->initBuffers(renderer->getDeviceContext(), voxelComputeShader->getVertexBuffer(), voxelComputeShader->getIndexBuffer());
-	voxelMesh->setIndexCount(voxelComputeShader->getIndexCount());
+	if (isCPUBackend)
+	{
+
+		return cpuBackend;
+
+	}
+
+	return gpuBackend;
+
+}
+
+bool App1::LoadBakedTerrain(const char* path)
+{
+
+	ChunkMeshFile chunkFile;
+
+	if (!chunkFile.Open(path))
+	{
+
+		return false;
+
+	}
+
+	ReleaseBakedTerrain();
+	bakedExtent = chunkFile.getChunkExtent();
+
+	// The buffers are created from the mapped blobs, so nothing is parsed or copied on the CPU
+	for (int i = 0; i < chunkFile.getChunkCount(); i++)
+	{
+
+		const ChunkMeshFile::ChunkEntry& chunk = chunkFile.getChunk(i);
+
+		if (chunk.indexCount == 0)
+		{
+
+			continue;
+
+		}
+
+		EmptyMesh* mesh = new EmptyMesh(renderer->getDevice(), true, false);
 
-	// Update the noise shader's parameters
-	gradientNoiseShader->UpdateMeshValues(meshSize, meshSize, meshSize);
-	gradientNoiseShader->UpdateNoiseValues(amplitude, frequency, persistence, octaves, meshScaleFactor, noiseScaleFactors, offsets, isRidged, isSimplex, heightBase, heightMultiplier);
+		if (chunkFile.getVertexFormat() == CHUNK_VERTEX_PACKED)
+		{
+
+			mesh->uploadIndexedVertices(chunkFile.getPackedVertices(i), chunk.vertexCount, chunkFile.getIndices(i), chunk.indexCount);
+
+		}
+		else
+		{
+
+			mesh->uploadIndexedVertices(chunkFile.getVertices(i), chunk.vertexCount, chunkFile.getIndices(i), chunk.indexCount);
+
+		}
+
+		VertexPacker packer;
+		chunkFile.getPacker(i, packer);
+		bakedMeshes.push_back(mesh);
+		bakedOrigins.push_back(XMFLOAT3(packer.getOrigin()));
+
+	}
+
+	return true;
 
-	// Run the noise shader
-	gradientNoiseShader->Run(renderer->getDeviceContext());
+}
 
-	// Then initialise the output buffer before running the marching cubes shader
-	marchingCubesShader->reInitOutputBuffer(meshSize, meshSize, meshSize);
+void App1::ReleaseBakedTerrain()
+{
 
-	// Then take compute shader texture and input into marching cubes shader
-	voxelMesh->sendData(renderer->getDeviceContext());
-	marchingCubesShader->setShaderParameters(renderer->getDeviceContext(), gradientNoiseShader->getTexture(), textureMgr->getTexture("rocks"), isovalue, meshSize, meshScaleFactor);
-	// Then run the marching cubes shader
-	marchingCubesShader->render(renderer->getDeviceContext(), voxelMesh->getIndexCount());
+	for (size_t i = 0; i < bakedMeshes.size(); i++)
+	{
 
-	voxelComputeShader->releaseBuffers();
-	gradientNoiseShader->releaseConstantBuffer();
-	gradientNoiseShader->releaseTexture();
+		delete bakedMeshes[i];
 
-	// Then take GS output buffer and input into empty mesh
-	outputMesh->initBuffers(renderer->getDeviceContext(), marchingCubesShader->getOutputBuffer());
+	}
+
+	bakedMeshes.clear();
+	bakedOrigins.clear();
+
+}
+
+GenerationParameters App1::getGenerationParameters()
+{
+
+	GenerationParameters parameters;
+	parameters.dimsX = meshSize[0];
+	parameters.dimsY = meshSize[1];
+	parameters.dimsZ = meshSize[2];
+	parameters.noise.amplitude = amplitude;
+	parameters.noise.frequency = frequency;
+	parameters.noise.persistence = persistence;
+	parameters.noise.octaves = octaves;
+	parameters.noise.meshScaleFactor = meshScaleFactor;
+	parameters.noise.noiseOffsets[0] = offsets.x;
+	parameters.noise.noiseOffsets[1] = offsets.y;
+	parameters.noise.noiseOffsets[2] = offsets.z;
+	parameters.noise.noiseScaleFactors[0] = noiseScaleFactors.x;
+	parameters.noise.noiseScaleFactors[1] = noiseScaleFactors.y;
+	parameters.noise.noiseScaleFactors[2] = noiseScaleFactors.z;
+	parameters.noise.isRidged = isRidged;
+	parameters.noise.isSimplex = isSimplex;
+	parameters.noise.isHashed = isHashed;
+	parameters.noise.seed = (unsigned int)seed;
+	parameters.noise.heightBase = heightBase;
+	parameters.noise.heightMultiplier = heightMultiplier;
+	parameters.isoValue = isovalue;
+	parameters.meshScaleFactor = meshScaleFactor;
+	parameters.extractionMethod = (ExtractionMethod)extractionMethod;
+
+	return parameters;
 
 }
 
@@ -227,44 +425,39 @@ void App1::TestRun()
 
 #if TESTING_
 
+	ComputeBackend* backend = getComputeBackend();
+	GenerationParameters parameters = getGenerationParameters();
+
 	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
-	// Recalculate the number of voxels to send to the GPU
-	voxelComputeShader->UpdateMeshValues(meshSize, meshSize, meshSize);
-	
-	voxelComputeShader->Run(renderer->getDeviceContext());
+	if (backend == gpuBackend)
+	{
 
-	voxelMesh->initBuffers(renderer->getDeviceContext(), voxelComputeShader->getVertexBuffer(), voxelComputeShader->getIndexBuffer());
-	voxelMesh->setIndexCount(voxelComputeShader->getIndexCount());
+		gpuProfiler->BeginFrame();
 
-	std::chrono::steady_clock::time_point noiseStart = std::chrono::steady_clock::now();
+	}
+
+	backend->AllocateVolume(parameters.dimsX, parameters.dimsY, parameters.dimsZ);
 
-	// Update the noise shader's parameters
-	gradientNoiseShader->UpdateMeshValues(meshSize, meshSize, meshSize);
-	gradientNoiseShader->UpdateNoiseValues(amplitude, frequency, persistence, octaves, meshScaleFactor, noiseScaleFactors, offsets, isRidged, isSimplex, heightBase, heightMultiplier);
+	std::chrono::steady_clock::time_point noiseStart = std::chrono::steady_clock::now();
 
-	// Run the noise shader
-	gradientNoiseShader->Run(renderer->getDeviceContext());
+	gpuProfiler->BeginStage(PROFILER_STAGE_NOISE);
+	backend->DispatchNoise(parameters.noise);
+	gpuProfiler->EndStage(PROFILER_STAGE_NOISE);
 
 	std::chrono::steady_clock::time_point noiseEnd = std::chrono::steady_clock::now();
 
-	// Then initialise the output buffer before running the marching cubes shader
-	marchingCubesShader->reInitOutputBuffer(meshSize, meshSize, meshSize);
-
-	// Then take compute shader texture and input into marching cubes shader
-	voxelMesh->sendData(renderer->getDeviceContext());
-	marchingCubesShader->setShaderParameters(renderer->getDeviceContext(), gradientNoiseShader->getTexture(), textureMgr->getTexture("rocks"), isovalue, meshSize, meshScaleFactor);
-	// Then run the marching cubes shader
-	marchingCubesShader->render(renderer->getDeviceContext(), voxelMesh->getIndexCount());
+	gpuProfiler->BeginStage(PROFILER_STAGE_MARCHING_CUBES);
+	backend->ExtractSurface(parameters.isoValue, parameters.meshScaleFactor);
+	gpuProfiler->EndStage(PROFILER_STAGE_MARCHING_CUBES);
 
 	std::chrono::steady_clock::time_point marchingCubesEnd = std::chrono::steady_clock::now();
 
-	voxelComputeShader->releaseBuffers();
-	gradientNoiseShader->releaseConstantBuffer();
-	gradientNoiseShader->releaseTexture();
+	backend->ReleaseVolume();
+	backend->BindMesh(*outputMesh);
+	volumeBackend = nullptr;
 
-	// Then take GS output buffer and input into empty mesh
-	outputMesh->initBuffers(renderer->getDeviceContext(), marchingCubesShader->getOutputBuffer());
+	gpuProfiler->EndFrame();
 
 	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
 
@@ -294,6 +487,34 @@ bool App1::frame()
 
 	}
 
+	// Pick up any GPU timings that have finished since last frame
+#if TESTING_
+
+	if (gpuProfiler->Update() > 0)
+	{
+
+		const StageStatistics& marchingCubes = gpuProfiler->getStageStatistics(PROFILER_STAGE_MARCHING_CUBES);
+
+		gpuFileStream << gpuProfiler->getStageStatistics(PROFILER_STAGE_NOISE).lastMilliseconds << ","
+			<< marchingCubes.lastMilliseconds << "," << marchingCubes.gsInvocations << ","
+			<< marchingCubes.soPrimitivesWritten << "," << marchingCubes.hasOverflowed << endl;
+
+	}
+
+#else
+
+	gpuProfiler->Update();
+
+#endif
+
+	// An extraction whose mesh buffer turned out too small is missing triangles; the buffer now knows the size, so regenerate
+	if (!isBackgroundRegeneration && getComputeBackend()->PollOverflow())
+	{
+
+		recalculateSurface = true;
+
+	}
+
 #if TESTING_
 
 	elapsedTime += timer->getTime();
@@ -314,13 +535,13 @@ bool App1::frame()
 
 			fileStream << endl << endl << endl;
 
-			if (meshSize == 256)
+			if (meshSize[0] == 256)
 			{
 
 				exit(0);
 
 			}
-			else if (meshSize == 128)
+			else if (meshSize[0] == 128)
 			{
 
 				timeInterval = 1.0f;
@@ -328,8 +549,10 @@ bool App1::frame()
 			}
 
 			testCase = 1;
-			meshSize *= 2;
-			meshScaleFactor = 64.0f / meshSize;
+			meshSize[0] *= 2;
+			meshSize[1] *= 2;
+			meshSize[2] *= 2;
+			meshScaleFactor = 64.0f / meshSize[0];
 			isSimplex = false;
 			isRidged = false;
 
@@ -369,11 +592,45 @@ bool App1::frame()
 	if (recalculateSurface)
 	{
 
-		Run();
+		if (isBackgroundRegeneration && isCPUBackend)
+		{
+
+			// Supersedes (and cancels) any regeneration still in flight, including one the D3D11 backend was deferring
+			regenerator->Request(getGenerationParameters());
+			isExtractionPending = false;
+
+		}
+		else
+		{
+
+			// The D3D11 backend only queues its work here, and with background regeneration the result is picked up below
+			Run();
+
+		}
 
 		recalculateSurface = false;
 
-}
+	}
+
+	// Swap in a finished background mesh; until one arrives, the current outputMesh keeps being drawn
+	std::unique_ptr<GeneratedMesh> generatedMesh = regenerator->TakeCompleted();
+
+	if (generatedMesh && isBackgroundRegeneration && isCPUBackend)
+	{
+
+		backMesh->uploadVertices(generatedMesh->vertices.data(), (int)generatedMesh->vertices.size());
+		SwapMeshes();
+
+	}
+
+	if (isExtractionPending && gpuBackend->PollExtraction())
+	{
+
+		gpuBackend->BindMesh(*backMesh);
+		SwapMeshes();
+		isExtractionPending = false;
+
+	}
 
 #endif
 
@@ -412,13 +669,39 @@ bool App1::render()
 	viewMatrix = camera->getViewMatrix();
 	projectionMatrix = renderer->getProjectionMatrix();
 
-	// Send geometry data (from mesh)
-	outputMesh->sendData(renderer->getDeviceContext());
 	// Set shader parameters
 	lightShader->setShaderParameters(renderer->getDeviceContext(), worldMatrix, viewMatrix, projectionMatrix, textureMgr->getTexture("rocks"), 
 		textureMgr->getTexture("grass"), textureMgr->getTexture("mossyrocks"), textureMgr->getTexture("sand"), mainLight, camera, meshScaleFactor);
-	// Render object (combination of mesh geometry and shader process)
-	lightShader->render(renderer->getDeviceContext(), outputMesh->getIndexCount());
+
+	if (!bakedMeshes.empty())
+	{
+
+		// Baked terrain replaces the generated mesh while it is loaded
+		for (size_t i = 0; i < bakedMeshes.size(); i++)
+		{
+
+			if (bakedMeshes[i]->isPacked())
+			{
+
+				lightShader->setChunkBox(renderer->getDeviceContext(), &bakedOrigins[i].x, bakedExtent);
+
+			}
+
+			bakedMeshes[i]->sendData(renderer->getDeviceContext());
+			lightShader->render(renderer->getDeviceContext(), bakedMeshes[i]->getIndexCount(), true, bakedMeshes[i]->isPacked());
+
+		}
+
+	}
+	else
+	{
+
+		// Send geometry data (from mesh)
+		outputMesh->sendData(renderer->getDeviceContext());
+		// Render object (combination of mesh geometry and shader process)
+		lightShader->render(renderer->getDeviceContext(), outputMesh->getIndexCount());
+
+	}
 
 	renderer->setWireframeMode(false);
 
@@ -442,26 +725,60 @@ void App1::gui()
 	ImGui::Text("FPS: %.2f", timer->getFPS());
 	ImGui::SliderFloat("Light Direction", &lightDirection, -1.0f, 0.0f);
 	ImGui::Checkbox("Wireframe", &isWireframe);
+	if (ImGui::Checkbox("Background Regeneration", &isBackgroundRegeneration))
+	{
+
+		recalculateSurface = true;
+
+	}
+	if (ImGui::Checkbox("Compute Shader Extraction", &isComputeExtraction) ||
+		ImGui::Checkbox("Packed Triangle Table", &isPackedTriTable) ||
+		ImGui::Checkbox("CPU Backend", &isCPUBackend))
+	{
+
+		recalculateSurface = true;
+
+	}
+	if (isCPUBackend && ImGui::Combo("Extraction", &extractionMethod, "Marching Cubes\0Surface Nets\0Dual Contouring\0"))
+	{
+
+		recalculateSurface = true;
+
+	}
+	if (regenerator->isBusy() || isExtractionPending)
+	{
+
+		ImGui::Text("Regenerating...");
+
+	}
 	if (ImGui::SliderFloat("Isovalue", &isovalue, -1.0f, 2.0f) ||
 		ImGui::Checkbox("Ridged Turbulence", &isRidged) ||
-		ImGui::Checkbox("Simplex Noise", &isSimplex))
+		ImGui::Checkbox("Simplex Noise", &isSimplex) ||
+		ImGui::Checkbox("Hashed Gradients", &isHashed) ||
+		(isHashed && ImGui::InputInt("Seed", &seed)))
 	{
 
 		recalculateSurface = true;
 
 	}
-	if (ImGui::InputInt("Mesh Size", &meshSize))
+	if (ImGui::InputInt3("Mesh Size", meshSize))
 	{
 
-		// Make sure that the noise shader doesn't encounter an error
-		if (meshSize % 8 != 0)
+		// Any size works, but there has to be at least one cell in each dimension
+		for (int i = 0; i < 3; i++)
 		{
 
-			meshSize = 64;
+			if (meshSize[i] < 2)
+			{
+
+				meshSize[i] = 2;
+
+			}
 
 		}
 
-		meshScaleFactor = 64.0f / meshSize;
+		// Voxels stay cubes, so the width alone sets the scale of the noise
+		meshScaleFactor = 64.0f / meshSize[0];
 		recalculateSurface = true;
 
 	}
@@ -489,6 +806,39 @@ void App1::gui()
 
 	}
 
+	// Chunk mesh files are baked with: headless --bench chunks --chunk-file terrain.mccm
+	if (bakedMeshes.empty() && ImGui::Button("Load Baked Terrain"))
+	{
+
+		LoadBakedTerrain("terrain.mccm");
+
+	}
+	else if (!bakedMeshes.empty() && ImGui::Button("Unload Baked Terrain"))
+	{
+
+		ReleaseBakedTerrain();
+
+	}
+
+	// GPU stage timings from the last profiled run of the GPU pipeline
+	if (ImGui::CollapsingHeader("GPU Timings"))
+	{
+
+		for (int i = 0; i < PROFILER_STAGE_COUNT; i++)
+		{
+
+			const StageStatistics& stage = gpuProfiler->getStageStatistics((ProfilerStage)i);
+			ImGui::Text("%s: %.3f ms (avg %.3f ms)", GPUProfiler::getStageName((ProfilerStage)i), stage.lastMilliseconds, stage.averageMilliseconds);
+
+		}
+
+		const StageStatistics& marchingCubes = gpuProfiler->getStageStatistics(PROFILER_STAGE_MARCHING_CUBES);
+		ImGui::Text("GS invocations: %llu", marchingCubes.gsInvocations);
+		ImGui::Text("Primitives written: %llu", marchingCubes.soPrimitivesWritten);
+		ImGui::Text("SO overflow: %s", marchingCubes.hasOverflowed ? "yes" : "no");
+
+	}
+
 	// Render UI
 	ImGui::Render();
 
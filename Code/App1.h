@@ -9,11 +9,15 @@
 #include "../DXFramework/DXF.h"
 #include "../DXFramework/PointMesh.h"
 #include "LightShader.h"
-#include "MCShader.h"
 #include "EmptyMesh.h"
-#include "GradientNoise.h"
-#include "VoxelComputeShader.h"
+#include "D3D11ComputeBackend.h"
+#include "CPUComputeBackend.h"
 #include "TriTableTexture.h"
+#include "AsyncRegenerator.h"
+#include "GPUProfiler.h"
+#include "D3D11QueryBackend.h"
+#include "ChunkMeshFile.h"
+#include <vector>
 
 class App1 : public BaseApplication
 {
@@ -32,21 +36,43 @@ protected:
 	// Run function encapsulating all of the steps necessary to generate a new mesh
 	void Run();
 	void TestRun();
+	// Collects the current GUI values into a request for the background regenerator
+	GenerationParameters getGenerationParameters();
+	// The backend selected in the GUI, used by Run
+	ComputeBackend* getComputeBackend();
+	// Draw the back mesh from now on, after a background regeneration has filled it
+	void SwapMeshes();
+	// Maps a chunk mesh file baked by the headless generator and creates a mesh for each chunk straight from the mapping
+	bool LoadBakedTerrain(const char* path);
+	void ReleaseBakedTerrain();
 
 private:
 
+	// Compute backends, which generate the volume and extract the mesh for Run
+	D3D11ComputeBackend* gpuBackend;				// Voxel, noise and marching cubes shaders
+	CPUComputeBackend* cpuBackend;					// The same stages on worker threads
+	JobScheduler* cpuScheduler;						// Runs the CPU backend's jobs
+	ComputeBackend* volumeBackend;					// Backend holding the volume generated for volumeParameters, nullptr if none does
+	GenerationParameters volumeParameters;
+
 	// Shaders
-	VoxelComputeShader* voxelComputeShader;			// This shader generates the initial voxel point list
-	GradientNoise* gradientNoiseShader;				// This shader generates the 3D noise volume which marching cubes will sample
-	MCShader* marchingCubesShader;					// This shader generates the final output mesh
 	LightShader* lightShader;						// Final rendering shader
 
 	// The scene's directional light
 	Light* mainLight;
 
 	// Meshes
-	EmptyMesh* voxelMesh;
 	EmptyMesh* outputMesh;
+	EmptyMesh* backMesh;							// Receives background regenerations, then swaps with outputMesh
+	std::vector<EmptyMesh*> bakedMeshes;			// One per chunk of a loaded chunk mesh file, drawn instead of outputMesh
+	std::vector<XMFLOAT3> bakedOrigins;				// Box origin of each baked mesh, for decoding packed vertices
+	float bakedExtent;								// Box extent shared by every baked chunk
+
+	// Generates meshes on worker threads while the current outputMesh keeps rendering
+	AsyncRegenerator* regenerator;
+
+	// Times each GPU stage of Run with timestamp queries, read back a few frames later
+	GPUProfiler* gpuProfiler;
 
 	// Textures
 	TriTableTexture* triTableTexture;
@@ -56,11 +82,25 @@ private:
 
 	bool isWireframe;
 	bool recalculateSurface;
+	// Never wait for a regeneration: the CPU backend generates on the regenerator's threads, and the D3D11 backend's
+	// extraction is copied into backMesh once its queries show the GPU has finished it; either way outputMesh is drawn until then
+	bool isBackgroundRegeneration;
+	// Set while a deferred D3D11 extraction is waiting to be swapped in
+	bool isExtractionPending;
+	// Extract the surface with the compute shader passes instead of the geometry shader
+	bool isComputeExtraction;
+	// Have the geometry shader read the packed triangle table from a constant buffer instead of the texture
+	bool isPackedTriTable;
+	// Generate with the CPU backend, or the background regenerator's CPU pipeline, instead of the D3D11 backend
+	bool isCPUBackend;
+	// Surface extraction used by the CPU backend and the background regenerator, an ExtractionMethod
+	// The D3D11 backend always uses marching cubes
+	int extractionMethod;
 
 	// Values for calculating the isosurface in the geometry shader
 	float isovalue;
-	// Mesh size also used for setting number of voxels and size of compute shader's output texture and number of threads to dispatch
-	int meshSize;
+	// Mesh size in X, Y and Z, also used for setting number of voxels and size of compute shader's output texture and number of threads to dispatch
+	int meshSize[3];
 
 	float meshScaleFactor;
 	XMFLOAT3 noiseScaleFactors;
@@ -75,6 +115,9 @@ private:
 	// Checks for the type of noise we'll be using in the gradient noise shader
 	bool isRidged;
 	bool isSimplex;
+	// Hash the noise gradients instead of using the permutation table, and the seed that varies them
+	bool isHashed;
+	int seed;
 
 	// Values for the height increment method in the gradient noise shader
 	float heightBase;
@@ -85,6 +128,8 @@ private:
 	XMFLOAT3 testCases[100];
 
 	ofstream fileStream;
+	// GPU stage timings arrive frames after TestRun, so they're written separately as they resolve
+	ofstream gpuFileStream;
 
 	float elapsedTime;
 	float timeInterval;
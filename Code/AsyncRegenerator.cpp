@@ -0,0 +1,170 @@
+#include "AsyncRegenerator.h"
+
+AsyncRegenerator::AsyncRegenerator(int threadCount) : scheduler(threadCount), pipeline(&scheduler)
+{
+
+	hasPendingRequest = false;
+	isShuttingDown = false;
+	isVolumeValid = false;
+	latestGeneration = 0;
+	completedGeneration = 0;
+
+	worker = std::thread(&AsyncRegenerator::WorkerLoop, this);
+
+}
+
+AsyncRegenerator::~AsyncRegenerator()
+{
+
+	{
+
+		std::lock_guard<std::mutex> lock(requestMutex);
+		isShuttingDown = true;
+
+	}
+
+	// Bumping the generation cancels anything still running
+	latestGeneration++;
+	requestAvailable.notify_all();
+
+	worker.join();
+
+}
+
+void AsyncRegenerator::Request(const GenerationParameters& parameters)
+{
+
+	{
+
+		std::lock_guard<std::mutex> lock(requestMutex);
+		pendingParameters = parameters;
+		hasPendingRequest = true;
+		latestGeneration++;
+
+	}
+
+	requestAvailable.notify_one();
+
+}
+
+std::unique_ptr<GeneratedMesh> AsyncRegenerator::TakeCompleted()
+{
+
+	std::lock_guard<std::mutex> lock(completedMutex);
+
+	return std::move(completedMesh);
+
+}
+
+bool AsyncRegenerator::isBusy() const
+{
+
+	return completedGeneration.load() != latestGeneration.load();
+
+}
+
+void AsyncRegenerator::WorkerLoop()
+{
+
+	while (true)
+	{
+
+		GenerationParameters parameters;
+		unsigned int generation;
+
+		{
+
+			std::unique_lock<std::mutex> lock(requestMutex);
+			requestAvailable.wait(lock, [this] { return isShuttingDown || hasPendingRequest; });
+
+			if (isShuttingDown)
+			{
+
+				return;
+
+			}
+
+			parameters = pendingParameters;
+			generation = latestGeneration;
+			hasPendingRequest = false;
+
+		}
+
+		pipeline.UpdateExtractionValues(parameters.isoValue, parameters.meshScaleFactor);
+		pipeline.setExtractionMethod(parameters.extractionMethod);
+
+		// Abandon this generation as soon as a newer request comes in
+		std::function<bool()> isCancelled = [this, generation] { return latestGeneration.load() != generation; };
+		bool isComplete;
+
+		if (isVolumeValid && IsSameVolume(parameters, volumeParameters))
+		{
+
+			// A cancelled re-extraction leaves the volume intact
+			isComplete = pipeline.RunExtraction(isCancelled);
+
+		}
+		else
+		{
+
+			pipeline.UpdateMeshValues(parameters.dimsX, parameters.dimsY, parameters.dimsZ);
+			pipeline.UpdateNoiseValues(parameters.noise);
+
+			isComplete = pipeline.Run(isCancelled);
+			isVolumeValid = isComplete;
+			volumeParameters = parameters;
+
+		}
+
+		if (!isComplete || latestGeneration.load() != generation)
+		{
+
+			continue;
+
+		}
+
+		std::unique_ptr<GeneratedMesh> mesh(new GeneratedMesh());
+		pipeline.swapVertices(mesh->vertices);
+		mesh->parameters = parameters;
+		mesh->generation = generation;
+
+		// Publish the finished mesh, replacing any that the render loop hasn't picked up yet
+		{
+
+			std::lock_guard<std::mutex> lock(completedMutex);
+			completedMesh = std::move(mesh);
+
+		}
+
+		completedGeneration = generation;
+
+	}
+
+}
+
+bool AsyncRegenerator::IsSameVolume(const GenerationParameters& a, const GenerationParameters& b)
+{
+
+	const NoiseParameters& noiseA = a.noise;
+	const NoiseParameters& noiseB = b.noise;
+
+	for (int i = 0; i < 3; i++)
+	{
+
+		if (noiseA.noiseOffsets[i] != noiseB.noiseOffsets[i] || noiseA.noiseScaleFactors[i] != noiseB.noiseScaleFactors[i])
+		{
+
+			return false;
+
+		}
+
+	}
+
+	return a.dimsX == b.dimsX && a.dimsY == b.dimsY && a.dimsZ == b.dimsZ &&
+		noiseA.amplitude == noiseB.amplitude && noiseA.frequency == noiseB.frequency && noiseA.persistence == noiseB.persistence &&
+		noiseA.octaves == noiseB.octaves && noiseA.meshScaleFactor == noiseB.meshScaleFactor &&
+		noiseA.isRidged == noiseB.isRidged && noiseA.isSimplex == noiseB.isSimplex &&
+		noiseA.heightBase == noiseB.heightBase && noiseA.heightMultiplier == noiseB.heightMultiplier &&
+		noiseA.isHashed == noiseB.isHashed && noiseA.seed == noiseB.seed;
+
+}
@@ -0,0 +1,78 @@
+// Async regenerator
+// Regenerates the terrain on a background thread so that the render loop never waits for it
+// The caller requests a new mesh whenever the parameters change and polls for finished meshes once per frame;
+// a newer request cancels whatever generation is still in flight, so only the latest parameters are ever completed
+// Requests that only change the isovalue or scale reuse the last density volume and just re-extract it
+#ifndef _ASYNC_REGENERATOR_H_
+#define _ASYNC_REGENERATOR_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CPUPipeline.h"
+
+// A finished mesh and the request it was generated for
+struct GeneratedMesh
+{
+
+	std::vector<MeshVertex> vertices;
+	GenerationParameters parameters;
+	unsigned int generation;
+
+};
+
+class AsyncRegenerator
+{
+
+public:
+
+	// threadCount is passed to the regenerator's own JobScheduler (0 uses every hardware thread)
+	AsyncRegenerator(int threadCount = 0);
+	~AsyncRegenerator();
+
+	// Queue a regeneration with new parameters, superseding any earlier request; never blocks
+	void Request(const GenerationParameters& parameters);
+
+	// Returns the most recently completed mesh, or nullptr if none has finished since the last call
+	// Ownership passes to the caller, which swaps it in as its front buffer
+	std::unique_ptr<GeneratedMesh> TakeCompleted();
+
+	// True while a requested mesh has not been completed yet
+	bool isBusy() const;
+
+	// True if two requests produce the same density volume, so only extraction needs to run again
+	static bool IsSameVolume(const GenerationParameters& a, const GenerationParameters& b);
+
+private:
+
+	void WorkerLoop();
+
+	JobScheduler scheduler;
+	CPUPipeline pipeline;
+	// Parameters of the volume currently held by the pipeline, only touched by the worker thread
+	GenerationParameters volumeParameters;
+	bool isVolumeValid;
+
+	// Latest request, guarded by requestMutex
+	std::mutex requestMutex;
+	std::condition_variable requestAvailable;
+	GenerationParameters pendingParameters;
+	bool hasPendingRequest;
+	bool isShuttingDown;
+
+	// Incremented by every request; a running generation is stale as soon as this moves past it
+	std::atomic<unsigned int> latestGeneration;
+	std::atomic<unsigned int> completedGeneration;
+
+	// Back buffer handed over to the render loop, swapped atomically under completedMutex
+	std::mutex completedMutex;
+	std::unique_ptr<GeneratedMesh> completedMesh;
+
+	std::thread worker;
+
+};
+
+#endif // !_ASYNC_REGENERATOR_H_
@@ -25,6 +25,13 @@ BaseComputeShader::~BaseComputeShader()
 }
 
 void BaseComputeShader::loadComputeShader(WCHAR* filename)
+{
+
+	loadComputeShader(filename, &computeShader);
+
+}
+
+void BaseComputeShader::loadComputeShader(WCHAR* filename, ID3D11ComputeShader** shader)
 {
 
 	ID3DBlob* computeShaderBuffer;
@@ -70,7 +77,7 @@ void BaseComputeShader::loadComputeShader(WCHAR* filename)
 
 	}
 	// Create the compute shader from the buffer
-	result = renderer->CreateComputeShader(computeShaderBuffer->GetBufferPointer(), computeShaderBuffer->GetBufferSize(), NULL, &computeShader);
+	result = renderer->CreateComputeShader(computeShaderBuffer->GetBufferPointer(), computeShaderBuffer->GetBufferSize(), NULL, shader);
 	if (result != S_OK)
 	{
 
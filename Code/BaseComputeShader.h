@@ -36,6 +36,8 @@ protected:
 
 	// Loads the compute shader object from file
 	void loadComputeShader(WCHAR* filename);
+	// Loads a compute shader object into the given pointer, for classes that run more than one pass
+	void loadComputeShader(WCHAR* filename, ID3D11ComputeShader** shader);
 
 	// Creates a structured buffer for read access on the GPU
 	HRESULT CreateStructuredBuffer(UINT elementSize, UINT count, void* pInitData, ID3D11Buffer** buffer);
@@ -0,0 +1,290 @@
+#include "BrickTree.h"
+#include "CPUMarchingCubes.h"
+#include <algorithm>
+
+BrickTree::BrickTree()
+{
+
+	brickSize = 8;
+	cellsX = 0;
+	cellsY = 0;
+	cellsZ = 0;
+
+}
+
+void BrickTree::Build(const DensityVolume& volume, int lbrickSize)
+{
+
+	brickSize = lbrickSize > 0 ? lbrickSize : 1;
+	cellsX = CPUMarchingCubes::getCellCount(volume.getDimsX());
+	cellsY = CPUMarchingCubes::getCellCount(volume.getDimsY());
+	cellsZ = CPUMarchingCubes::getCellCount(volume.getDimsZ());
+
+	levels.clear();
+
+	if (cellsX == 0 || cellsY == 0 || cellsZ == 0)
+	{
+
+		return;
+
+	}
+
+	// Leaf bricks take the range of every corner their cells read, so they include the voxels one past their last cell
+	Level leaves;
+	leaves.countX = (cellsX + brickSize - 1) / brickSize;
+	leaves.countY = (cellsY + brickSize - 1) / brickSize;
+	leaves.countZ = (cellsZ + brickSize - 1) / brickSize;
+	leaves.minimums.resize((size_t)leaves.countX * leaves.countY * leaves.countZ);
+	leaves.maximums.resize(leaves.minimums.size());
+
+	for (int bz = 0; bz < leaves.countZ; bz++)
+	{
+
+		for (int by = 0; by < leaves.countY; by++)
+		{
+
+			for (int bx = 0; bx < leaves.countX; bx++)
+			{
+
+				int x1 = std::min((bx + 1) * brickSize, cellsX);
+				int y1 = std::min((by + 1) * brickSize, cellsY);
+				int z1 = std::min((bz + 1) * brickSize, cellsZ);
+
+				float minimum = volume.get(bx * brickSize, by * brickSize, bz * brickSize);
+				float maximum = minimum;
+
+				for (int z = bz * brickSize; z <= z1; z++)
+				{
+
+					for (int y = by * brickSize; y <= y1; y++)
+					{
+
+						for (int x = bx * brickSize; x <= x1; x++)
+						{
+
+							float value = volume.get(x, y, z);
+							minimum = std::min(minimum, value);
+							maximum = std::max(maximum, value);
+
+						}
+
+					}
+
+				}
+
+				size_t index = ((size_t)bz * leaves.countY + by) * leaves.countX + bx;
+				leaves.minimums[index] = minimum;
+				leaves.maximums[index] = maximum;
+
+			}
+
+		}
+
+	}
+
+	levels.push_back(std::move(leaves));
+
+	// Reduce 2x2x2 nodes at a time until a single root remains
+	while (levels.back().minimums.size() > 1)
+	{
+
+		const Level& child = levels.back();
+
+		Level parent;
+		parent.countX = (child.countX + 1) / 2;
+		parent.countY = (child.countY + 1) / 2;
+		parent.countZ = (child.countZ + 1) / 2;
+		parent.minimums.resize((size_t)parent.countX * parent.countY * parent.countZ);
+		parent.maximums.resize(parent.minimums.size());
+
+		for (int z = 0; z < parent.countZ; z++)
+		{
+
+			for (int y = 0; y < parent.countY; y++)
+			{
+
+				for (int x = 0; x < parent.countX; x++)
+				{
+
+					size_t first = ((size_t)(z * 2) * child.countY + y * 2) * child.countX + x * 2;
+					float minimum = child.minimums[first];
+					float maximum = child.maximums[first];
+
+					for (int cz = z * 2; cz < std::min(z * 2 + 2, child.countZ); cz++)
+					{
+
+						for (int cy = y * 2; cy < std::min(y * 2 + 2, child.countY); cy++)
+						{
+
+							for (int cx = x * 2; cx < std::min(x * 2 + 2, child.countX); cx++)
+							{
+
+								size_t index = ((size_t)cz * child.countY + cy) * child.countX + cx;
+								minimum = std::min(minimum, child.minimums[index]);
+								maximum = std::max(maximum, child.maximums[index]);
+
+							}
+
+						}
+
+					}
+
+					size_t index = ((size_t)z * parent.countY + y) * parent.countX + x;
+					parent.minimums[index] = minimum;
+					parent.maximums[index] = maximum;
+
+				}
+
+			}
+
+		}
+
+		levels.push_back(std::move(parent));
+
+	}
+
+}
+
+void BrickTree::Clear()
+{
+
+	levels.clear();
+
+}
+
+bool BrickTree::isBuilt() const
+{
+
+	return !levels.empty();
+
+}
+
+int BrickTree::FindActiveBricks(float isoValue, std::vector<Brick>& output) const
+{
+
+	return FindActiveBricks(&isoValue, 1, output);
+
+}
+
+int BrickTree::FindActiveBricks(const std::vector<float>& isoValues, std::vector<Brick>& output) const
+{
+
+	return FindActiveBricks(isoValues.data(), (int)isoValues.size(), output);
+
+}
+
+int BrickTree::FindActiveBricks(const float* isoValues, int isoValueCount, std::vector<Brick>& output) const
+{
+
+	output.clear();
+
+	if (levels.empty())
+	{
+
+		return 0;
+
+	}
+
+	std::vector<int> leaves;
+	int nodesVisited = 0;
+	Visit((int)levels.size() - 1, 0, 0, 0, isoValues, isoValueCount, leaves, nodesVisited);
+
+	// The descent visits leaves in octree order; sorting the linear indices gives volume order
+	std::sort(leaves.begin(), leaves.end());
+
+	const Level& leafLevel = levels[0];
+	output.reserve(leaves.size());
+
+	for (size_t i = 0; i < leaves.size(); i++)
+	{
+
+		int bx = leaves[i] % leafLevel.countX;
+		int by = (leaves[i] / leafLevel.countX) % leafLevel.countY;
+		int bz = leaves[i] / (leafLevel.countX * leafLevel.countY);
+
+		Brick brick;
+		brick.x0 = bx * brickSize;
+		brick.x1 = std::min(brick.x0 + brickSize, cellsX);
+		brick.y0 = by * brickSize;
+		brick.y1 = std::min(brick.y0 + brickSize, cellsY);
+		brick.z0 = bz * brickSize;
+		brick.z1 = std::min(brick.z0 + brickSize, cellsZ);
+		brick.minimum = leafLevel.minimums[leaves[i]];
+		brick.maximum = leafLevel.maximums[leaves[i]];
+		output.push_back(brick);
+
+	}
+
+	return nodesVisited;
+
+}
+
+void BrickTree::Visit(int level, int x, int y, int z, const float* isoValues, int isoValueCount, std::vector<int>& leaves, int& nodesVisited) const
+{
+
+	const Level& node = levels[level];
+
+	// Children of a node on an odd sized level may fall outside the level below
+	if (x >= node.countX || y >= node.countY || z >= node.countZ)
+	{
+
+		return;
+
+	}
+
+	int index = (z * node.countY + y) * node.countX + x;
+	nodesVisited++;
+
+	bool isActive = false;
+
+	for (int i = 0; i < isoValueCount && !isActive; i++)
+	{
+
+		isActive = Contains(node.minimums[index], node.maximums[index], isoValues[i]);
+
+	}
+
+	if (!isActive)
+	{
+
+		return;
+
+	}
+
+	if (level == 0)
+	{
+
+		leaves.push_back(index);
+		return;
+
+	}
+
+	for (int i = 0; i < 8; i++)
+	{
+
+		Visit(level - 1, x * 2 + (i & 1), y * 2 + ((i >> 1) & 1), z * 2 + (i >> 2), isoValues, isoValueCount, leaves, nodesVisited);
+
+	}
+
+}
+
+int BrickTree::getBrickSize() const
+{
+
+	return brickSize;
+
+}
+
+int BrickTree::getBrickCount() const
+{
+
+	return levels.empty() ? 0 : (int)levels[0].minimums.size();
+
+}
+
+int BrickTree::getLevelCount() const
+{
+
+	return (int)levels.size();
+
+}
@@ -0,0 +1,88 @@
+// Brick tree
+// Min/max hierarchy over a density volume for skipping empty space during extraction
+// The cells are split into bricks of brickSize^3 with the range of every voxel they read; each coarser level holds the
+// range of 2x2x2 bricks of the level below, up to a single root. Built once per noise volume, it lets a new isovalue
+// be extracted by visiting only the bricks whose [min, max] range contains it
+#ifndef _BRICK_TREE_H_
+#define _BRICK_TREE_H_
+
+#include <vector>
+#include "DensityVolume.h"
+
+class BrickTree
+{
+
+public:
+
+	// A box of cells, [x0, x1) x [y0, y1) x [z0, z1), and the range of the voxels they read
+	struct Brick
+	{
+
+		int x0;
+		int x1;
+		int y0;
+		int y1;
+		int z0;
+		int z1;
+		float minimum;
+		float maximum;
+
+	};
+
+private:
+
+	struct Level
+	{
+
+		int countX;
+		int countY;
+		int countZ;
+		std::vector<float> minimums;
+		std::vector<float> maximums;
+
+	};
+
+public:
+
+	BrickTree();
+
+	// Build the tree over the cells of a volume; bricks at the far edges are clipped to the cell count
+	void Build(const DensityVolume& volume, int brickSize);
+	// Free the tree, e.g. when the volume it was built from changes
+	void Clear();
+	bool isBuilt() const;
+
+	// Replace output with the leaf bricks that can contain the isosurface, ordered with X varying fastest, then Y, then Z
+	// Returns the number of nodes tested, across every level
+	int FindActiveBricks(float isoValue, std::vector<Brick>& output) const;
+	// As above, for the bricks that can contain the surface at any of the isovalues
+	int FindActiveBricks(const std::vector<float>& isoValues, std::vector<Brick>& output) const;
+
+	int getBrickSize() const;
+	int getBrickCount() const;
+	int getLevelCount() const;
+
+private:
+
+	// Tests a node against the isovalues, descending into its children if it may contain any of their surfaces
+	void Visit(int level, int x, int y, int z, const float* isoValues, int isoValueCount, std::vector<int>& leaves, int& nodesVisited) const;
+	// Shared by both public overloads
+	int FindActiveBricks(const float* isoValues, int isoValueCount, std::vector<Brick>& output) const;
+
+	// A cell has a surface when at least one corner is below the isovalue and one is not, as in ClassifyCell
+	static inline bool Contains(float minimum, float maximum, float isoValue)
+	{
+		return minimum < isoValue && maximum >= isoValue;
+	}
+
+	// Level 0 holds the leaf bricks, the last level the root
+	std::vector<Level> levels;
+
+	int brickSize;
+	int cellsX;
+	int cellsY;
+	int cellsZ;
+
+};
+
+#endif // !_BRICK_TREE_H_
@@ -0,0 +1,126 @@
+#include "CPUComputeBackend.h"
+
+CPUComputeBackend::CPUComputeBackend(JobScheduler* scheduler) : pipeline(scheduler)
+{
+
+	isNoisePending = false;
+	isVolumeValid = false;
+
+	dimsX = 0;
+	dimsY = 0;
+	dimsZ = 0;
+
+}
+
+void CPUComputeBackend::AllocateVolume(int x, int y, int z)
+{
+
+	if (isVolumeValid && x == dimsX && y == dimsY && z == dimsZ)
+	{
+
+		return;
+
+	}
+
+	dimsX = x;
+	dimsY = y;
+	dimsZ = z;
+
+	pipeline.UpdateMeshValues(dimsX, dimsY, dimsZ);
+	isVolumeValid = false;
+
+}
+
+void CPUComputeBackend::DispatchNoise(const NoiseParameters& parameters)
+{
+
+	pipeline.UpdateNoiseValues(parameters);
+	isNoisePending = true;
+
+}
+
+void CPUComputeBackend::ExtractSurface(float isoValue, float meshScaleFactor)
+{
+
+	pipeline.UpdateExtractionValues(isoValue, meshScaleFactor);
+
+	// Only the extraction needs to run again if the volume is unchanged since the last extraction
+	if (isNoisePending || !isVolumeValid)
+	{
+
+		pipeline.Run();
+
+	}
+	else
+	{
+
+		pipeline.RunExtraction();
+
+	}
+
+	isNoisePending = false;
+	isVolumeValid = true;
+
+}
+
+void CPUComputeBackend::BindMesh(MeshTarget& target)
+{
+
+	target.setVertices(pipeline.getVertices().data(), (int)pipeline.getVertices().size());
+
+}
+
+void CPUComputeBackend::ReleaseVolume()
+{
+
+	pipeline.releaseVolume();
+
+	isVolumeValid = false;
+	dimsX = 0;
+	dimsY = 0;
+	dimsZ = 0;
+
+}
+
+bool CPUComputeBackend::PollOverflow()
+{
+
+	// The vertices go into a vector that grows as needed, so nothing is ever dropped
+	return false;
+
+}
+
+int CPUComputeBackend::getVertexCount() const
+{
+
+	return (int)pipeline.getVertices().size();
+
+}
+
+const char* CPUComputeBackend::getName() const
+{
+
+	return "CPU";
+
+}
+
+const std::vector<MeshVertex>& CPUComputeBackend::getVertices() const
+{
+
+	return pipeline.getVertices();
+
+}
+
+void CPUComputeBackend::setSlabDepth(int depth)
+{
+
+	pipeline.setSlabDepth(depth);
+
+}
+
+void CPUComputeBackend::setExtractionMethod(ExtractionMethod method)
+{
+
+	pipeline.setExtractionMethod(method);
+
+}
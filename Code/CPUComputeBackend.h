@@ -0,0 +1,48 @@
+// CPU compute backend
+// Runs the generation stages with CPUPipeline on a JobScheduler, for machines without a D3D11 device
+// Noise is deferred until extraction so that both run as one job graph and early slabs are extracted while later ones are still generating
+#ifndef _CPU_COMPUTE_BACKEND_H_
+#define _CPU_COMPUTE_BACKEND_H_
+
+#include "ComputeBackend.h"
+#include "CPUPipeline.h"
+
+class CPUComputeBackend : public ComputeBackend
+{
+
+public:
+
+	CPUComputeBackend(JobScheduler* scheduler);
+
+	void AllocateVolume(int x, int y, int z);
+	void DispatchNoise(const NoiseParameters& parameters);
+	void ExtractSurface(float isoValue, float meshScaleFactor);
+	void BindMesh(MeshTarget& target);
+	void ReleaseVolume();
+	bool PollOverflow();
+
+	int getVertexCount() const;
+	const char* getName() const;
+
+	// Direct access for callers that want the vertices without going through a MeshTarget
+	const std::vector<MeshVertex>& getVertices() const;
+	void setSlabDepth(int depth);
+	// See CPUPipeline::setExtractionMethod
+	void setExtractionMethod(ExtractionMethod method);
+
+private:
+
+	CPUPipeline pipeline;
+
+	// Set by DispatchNoise, cleared once the noise has run with the next extraction
+	bool isNoisePending;
+	// Whether the volume holds noise that can be re-extracted without regenerating it
+	bool isVolumeValid;
+
+	int dimsX;
+	int dimsY;
+	int dimsZ;
+
+};
+
+#endif // !_CPU_COMPUTE_BACKEND_H_
@@ -0,0 +1,733 @@
+#include "CPUMarchingCubes.h"
+#include "CellIndex.h"
+#include "MarchingCubesTables.h"
+#include "MaterialWeights.h"
+#include <cmath>
+#include <utility>
+
+// Corner offsets of a cell, in the same order as the geometry shader's cornerPositions
+static const int cornerOffsets[8][3] = {
+
+	{ 0, 0, 1 }, { 1, 0, 1 }, { 1, 0, 0 }, { 0, 0, 0 },
+	{ 0, 1, 1 }, { 1, 1, 1 }, { 1, 1, 0 }, { 0, 1, 0 }
+
+};
+
+// The pair of corners joined by each of the 12 cell edges
+static const int edgeCorners[12][2] = {
+
+	{ 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 },
+	{ 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 },
+	{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+
+};
+
+CPUMarchingCubes::CPUMarchingCubes()
+{
+
+	isoValue = 0.0f;
+	meshScaleFactor = 1.0f;
+	originX = 0;
+	originY = 0;
+	originZ = 0;
+
+}
+
+void CPUMarchingCubes::UpdateValues(float liso, float lscale)
+{
+
+	isoValue = liso;
+	meshScaleFactor = lscale;
+
+}
+
+void CPUMarchingCubes::setVolumeOrigin(int x, int y, int z)
+{
+
+	originX = x;
+	originY = y;
+	originZ = z;
+
+}
+
+int CPUMarchingCubes::getCellCount(int voxels)
+{
+
+	return voxels > 1 ? voxels - 1 : 0;
+
+}
+
+void CPUMarchingCubes::getSliceRange(int zBegin, int zEnd, int dimsZ, int& sliceBegin, int& sliceEnd)
+{
+
+	// Cells span [zBegin, zEnd], and the central difference normals reach one voxel further either way
+	sliceBegin = zBegin - 1 < 0 ? 0 : zBegin - 1;
+	sliceEnd = zEnd + 2 > dimsZ ? dimsZ : zEnd + 2;
+
+}
+
+void CPUMarchingCubes::Run(const DensityVolume& volume, int zBegin, int zEnd, std::vector<MeshVertex>& output) const
+{
+
+	int cellsX = getCellCount(volume.getDimsX());
+	int cellsY = getCellCount(volume.getDimsY());
+	int cellsZ = getCellCount(volume.getDimsZ());
+
+	if (zEnd > cellsZ)
+	{
+
+		zEnd = cellsZ;
+
+	}
+
+	for (int z = zBegin; z < zEnd; z++)
+	{
+
+		for (int y = 0; y < cellsY; y++)
+		{
+
+			for (int x = 0; x < cellsX; x++)
+			{
+
+				float cornerValues[8];
+				int cubeIndex = ClassifyCell(volume, x, y, z, cornerValues);
+
+				// Check that the cell is not empty
+				if (edgeTable[cubeIndex] == 0)
+				{
+
+					continue;
+
+				}
+
+				MeshVertex triangles[15];
+				int vertexCount = PolygoniseCell(volume, x, y, z, cubeIndex, cornerValues, isoValue, triangles);
+				output.insert(output.end(), triangles, triangles + vertexCount);
+
+			}
+
+		}
+
+	}
+
+}
+
+void CPUMarchingCubes::Run(const DensityVolume& volume, int xBegin, int xEnd, int yBegin, int yEnd, int zBegin, int zEnd, std::vector<MeshVertex>& output) const
+{
+
+	SignVolume block;
+
+	if (!PackRegion(volume, xBegin, xEnd, yBegin, yEnd, zBegin, zEnd, &isoValue, 1, &block))
+	{
+
+		return;
+
+	}
+
+	EmitActiveCells(volume, block, 0, block.getDimsZ() - 1, xBegin, yBegin, zBegin, [&output](const MeshVertex* vertices, int count)
+	{
+
+		output.insert(output.end(), vertices, vertices + count);
+
+	});
+
+}
+
+void CPUMarchingCubes::Run(const DensityVolume& volume, int xBegin, int xEnd, int yBegin, int yEnd, int zBegin, int zEnd, const VertexPacker& packer, std::vector<PackedVertex>& output) const
+{
+
+	SignVolume block;
+
+	if (!PackRegion(volume, xBegin, xEnd, yBegin, yEnd, zBegin, zEnd, &isoValue, 1, &block))
+	{
+
+		return;
+
+	}
+
+	// Each cell's triangles are packed as they are emitted, so the full size vertices never leave the stack
+	EmitActiveCells(volume, block, 0, block.getDimsZ() - 1, xBegin, yBegin, zBegin, [&output, &packer](const MeshVertex* vertices, int count)
+	{
+
+		size_t first = output.size();
+		output.resize(first + count);
+
+		for (int i = 0; i < count; i++)
+		{
+
+			packer.Pack(vertices[i], output[first + i]);
+
+		}
+
+	});
+
+}
+
+bool CPUMarchingCubes::PackRegion(const DensityVolume& volume, int xBegin, int xEnd, int yBegin, int yEnd, int zBegin, int zEnd, const float* thresholds, int count, SignVolume* blocks) const
+{
+
+	int cellsX = getCellCount(volume.getDimsX());
+	int cellsY = getCellCount(volume.getDimsY());
+	int cellsZ = getCellCount(volume.getDimsZ());
+
+	if (xEnd > cellsX)
+	{
+
+		xEnd = cellsX;
+
+	}
+
+	if (yEnd > cellsY)
+	{
+
+		yEnd = cellsY;
+
+	}
+
+	if (zEnd > cellsZ)
+	{
+
+		zEnd = cellsZ;
+
+	}
+
+	if (xBegin >= xEnd || yBegin >= yEnd || zBegin >= zEnd)
+	{
+
+		return false;
+
+	}
+
+	// Pack the signs of just the voxels the region reads, so its cells can be classified 64 at a time
+	for (int i = 0; i < count; i++)
+	{
+
+		blocks[i].Allocate(xEnd - xBegin + 1, yEnd - yBegin + 1, zEnd - zBegin + 1);
+		blocks[i].setIsoValue(thresholds[i]);
+
+	}
+
+	for (int z = 0; z < blocks[0].getDimsZ(); z++)
+	{
+
+		for (int y = 0; y < blocks[0].getDimsY(); y++)
+		{
+
+			SignVolume::PackRow(volume.getData() + volume.index(xBegin, yBegin + y, zBegin + z), y, z, blocks, count);
+
+		}
+
+	}
+
+	return true;
+
+}
+
+void CPUMarchingCubes::Run(const DensityVolume& volume, const SignVolume& signs, int zBegin, int zEnd, std::vector<MeshVertex>& output) const
+{
+
+	int cellsZ = getCellCount(volume.getDimsZ());
+
+	if (zEnd > cellsZ)
+	{
+
+		zEnd = cellsZ;
+
+	}
+
+	EmitActiveCells(volume, signs, zBegin, zEnd, 0, 0, 0, [&output](const MeshVertex* vertices, int count)
+	{
+
+		output.insert(output.end(), vertices, vertices + count);
+
+	});
+
+}
+
+template <typename Append>
+void CPUMarchingCubes::EmitActiveCells(const DensityVolume& volume, const SignVolume& signs, int zBegin, int zEnd, int xOffset, int yOffset, int zOffset, Append append) const
+{
+
+	int cellsY = getCellCount(signs.getDimsY());
+	float threshold = signs.getIsoValue();
+
+	for (int z = zBegin; z < zEnd; z++)
+	{
+
+		for (int y = 0; y < cellsY; y++)
+		{
+
+			for (int w = 0; w < signs.getWordsPerRow(); w++)
+			{
+
+				uint64_t cornerWords[8];
+				uint64_t activeCells = ClassifyWord(signs, w, y, z, cornerWords);
+
+				// Visit the active cells in increasing X, as Run does
+				while (activeCells != 0)
+				{
+
+					int b = SignVolume::CountTrailingZeros(activeCells);
+					activeCells &= activeCells - 1;
+
+					int cubeIndex = getCubeIndex(cornerWords, b);
+					int x = xOffset + w * 64 + b;
+					float cornerValues[8];
+					LoadCorners(volume, x, yOffset + y, zOffset + z, cornerValues);
+
+					MeshVertex triangles[15];
+					int vertexCount = PolygoniseCell(volume, x, yOffset + y, zOffset + z, cubeIndex, cornerValues, threshold, triangles);
+					append(triangles, vertexCount);
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+size_t CPUMarchingCubes::CountActiveCells(const SignVolume& signs, int zBegin, int zEnd)
+{
+
+	int cellsY = getCellCount(signs.getDimsY());
+	int cellsZ = getCellCount(signs.getDimsZ());
+	size_t activeCount = 0;
+
+	if (zEnd > cellsZ)
+	{
+
+		zEnd = cellsZ;
+
+	}
+
+	for (int z = zBegin; z < zEnd; z++)
+	{
+
+		for (int y = 0; y < cellsY; y++)
+		{
+
+			for (int w = 0; w < signs.getWordsPerRow(); w++)
+			{
+
+				uint64_t cornerWords[8];
+				activeCount += SignVolume::PopCount(ClassifyWord(signs, w, y, z, cornerWords));
+
+			}
+
+		}
+
+	}
+
+	return activeCount;
+
+}
+
+uint64_t CPUMarchingCubes::ClassifyWord(const SignVolume& signs, int w, int y, int z, uint64_t* cornerWords)
+{
+
+	int wordsPerRow = signs.getWordsPerRow();
+	uint64_t anyBelow = 0;
+	uint64_t allBelow = ~(uint64_t)0;
+
+	for (int i = 0; i < 8; i++)
+	{
+
+		const uint64_t* row = signs.getRow(y + cornerOffsets[i][1], z + cornerOffsets[i][2]);
+
+		// Corners at x + 1 take the next bit along, carrying the lowest bit of the following word into the top
+		if (cornerOffsets[i][0] == 0)
+		{
+
+			cornerWords[i] = row[w];
+
+		}
+		else
+		{
+
+			cornerWords[i] = (row[w] >> 1) | (w + 1 < wordsPerRow ? row[w + 1] << 63 : 0);
+
+		}
+
+		anyBelow |= cornerWords[i];
+		allBelow &= cornerWords[i];
+
+	}
+
+	// The last voxel of a row has no cell, and bits past the end of the row aren't cells either
+	int cellsX = getCellCount(signs.getDimsX());
+	int cellsInWord = cellsX - w * 64;
+	uint64_t cellMask = cellsInWord >= 64 ? ~(uint64_t)0 : cellsInWord > 0 ? ((uint64_t)1 << cellsInWord) - 1 : 0;
+
+	return anyBelow & ~allBelow & cellMask;
+
+}
+
+void CPUMarchingCubes::RunMultiple(const DensityVolume& volume, int xBegin, int xEnd, int yBegin, int yEnd, int zBegin, int zEnd, float minimum, float maximum, const std::vector<float>& isoValues, std::vector<std::vector<MeshVertex>>& outputs) const
+{
+
+	outputs.resize(isoValues.size());
+
+	// As in ClassifyCell, a surface needs a corner below the isovalue and one that isn't
+	std::vector<int> surfaces;
+	std::vector<float> thresholds;
+
+	for (size_t i = 0; i < isoValues.size(); i++)
+	{
+
+		if (minimum < isoValues[i] && maximum >= isoValues[i])
+		{
+
+			surfaces.push_back((int)i);
+			thresholds.push_back(isoValues[i]);
+
+		}
+
+	}
+
+	int count = (int)surfaces.size();
+	std::vector<SignVolume> blocks(count);
+
+	if (count == 0 || !PackRegion(volume, xBegin, xEnd, yBegin, yEnd, zBegin, zEnd, thresholds.data(), count, blocks.data()))
+	{
+
+		return;
+
+	}
+
+	int cellsY = getCellCount(blocks[0].getDimsY());
+	int cellsZ = getCellCount(blocks[0].getDimsZ());
+	std::vector<uint64_t> cornerWords((size_t)count * 8);
+	std::vector<uint64_t> activeCells(count);
+
+	for (int z = 0; z < cellsZ; z++)
+	{
+
+		for (int y = 0; y < cellsY; y++)
+		{
+
+			for (int w = 0; w < blocks[0].getWordsPerRow(); w++)
+			{
+
+				uint64_t anyActive = 0;
+
+				for (int k = 0; k < count; k++)
+				{
+
+					activeCells[k] = ClassifyWord(blocks[k], w, y, z, &cornerWords[(size_t)k * 8]);
+					anyActive |= activeCells[k];
+
+				}
+
+				// Visit the cells active at any isovalue in increasing X, so each surface comes out in the order Run gives it
+				while (anyActive != 0)
+				{
+
+					int b = SignVolume::CountTrailingZeros(anyActive);
+					anyActive &= anyActive - 1;
+
+					// The corners are loaded once and shared by every surface passing through the cell
+					int x = xBegin + w * 64 + b;
+					float cornerValues[8];
+					LoadCorners(volume, x, yBegin + y, zBegin + z, cornerValues);
+
+					for (int k = 0; k < count; k++)
+					{
+
+						if (((activeCells[k] >> b) & 1) == 0)
+						{
+
+							continue;
+
+						}
+
+						MeshVertex triangles[15];
+						int vertexCount = PolygoniseCell(volume, x, yBegin + y, zBegin + z, getCubeIndex(&cornerWords[(size_t)k * 8], b), cornerValues, thresholds[k], triangles);
+
+						std::vector<MeshVertex>& output = outputs[surfaces[k]];
+						output.insert(output.end(), triangles, triangles + vertexCount);
+
+					}
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+void CPUMarchingCubes::Classify(const DensityVolume& volume, std::vector<unsigned int>& cubeIndices, std::vector<unsigned int>& triangleCounts) const
+{
+
+	int cellsX = getCellCount(volume.getDimsX());
+	int cellsY = getCellCount(volume.getDimsY());
+	int cellsZ = getCellCount(volume.getDimsZ());
+	const int* caseTriangleCounts = getCaseTriangleCounts();
+
+	cubeIndices.resize((size_t)cellsX * cellsY * cellsZ);
+	triangleCounts.resize(cubeIndices.size());
+
+	for (int z = 0; z < cellsZ; z++)
+	{
+
+		for (int y = 0; y < cellsY; y++)
+		{
+
+			for (int x = 0; x < cellsX; x++)
+			{
+
+				float cornerValues[8];
+				int cubeIndex = ClassifyCell(volume, x, y, z, cornerValues);
+
+				unsigned int cell = CellIndex(x, y, z, cellsX, cellsY);
+				cubeIndices[cell] = cubeIndex;
+				triangleCounts[cell] = caseTriangleCounts[cubeIndex];
+
+			}
+
+		}
+
+	}
+
+}
+
+unsigned int CPUMarchingCubes::ExclusiveScan(std::vector<unsigned int>& values)
+{
+
+	unsigned int total = 0;
+
+	for (size_t i = 0; i < values.size(); i++)
+	{
+
+		unsigned int value = values[i];
+		values[i] = total;
+		total += value;
+
+	}
+
+	return total;
+
+}
+
+void CPUMarchingCubes::Emit(const DensityVolume& volume, const std::vector<unsigned int>& cubeIndices, const std::vector<unsigned int>& triangleOffsets, std::vector<MeshVertex>& output) const
+{
+
+	int cellsX = getCellCount(volume.getDimsX());
+	int cellsY = getCellCount(volume.getDimsY());
+	const int* caseTriangleCounts = getCaseTriangleCounts();
+
+	// The final cell's offset plus its own count is the scan total
+	size_t cellCount = cubeIndices.size();
+	unsigned int triangleCount = cellCount > 0 ? triangleOffsets[cellCount - 1] + caseTriangleCounts[cubeIndices[cellCount - 1]] : 0;
+	output.resize((size_t)triangleCount * 3);
+
+	// One pass over the linear cell indices, deriving each active cell's coordinates as the shaders do from their thread ids
+	for (size_t cell = 0; cell < cellCount; cell++)
+	{
+
+		int cubeIndex = cubeIndices[cell];
+
+		if (edgeTable[cubeIndex] == 0)
+		{
+
+			continue;
+
+		}
+
+		// Each cell owns its own range of the output, so cells could be emitted in any order
+		CellCoordinates coordinates = GetCellCoordinates((unsigned int)cell, cellsX, cellsY);
+		int x = coordinates.x;
+		int y = coordinates.y;
+		int z = coordinates.z;
+
+		float cornerValues[8];
+		ClassifyCell(volume, x, y, z, cornerValues);
+		PolygoniseCell(volume, x, y, z, cubeIndex, cornerValues, isoValue, &output[(size_t)triangleOffsets[cell] * 3]);
+
+	}
+
+}
+
+int CPUMarchingCubes::ClassifyCell(const DensityVolume& volume, int x, int y, int z, float* cornerValues) const
+{
+
+	// Set the corner values by loading the corner voxels
+	LoadCorners(volume, x, y, z, cornerValues);
+
+	return getCubeIndex(cornerValues, isoValue);
+
+}
+
+void CPUMarchingCubes::LoadCorners(const DensityVolume& volume, int x, int y, int z, float* cornerValues) const
+{
+
+	for (int i = 0; i < 8; i++)
+	{
+
+		cornerValues[i] = volume.get(x + cornerOffsets[i][0], y + cornerOffsets[i][1], z + cornerOffsets[i][2]);
+
+	}
+
+}
+
+int CPUMarchingCubes::getCubeIndex(const float* cornerValues, float threshold)
+{
+
+	// Determine the cube configuration of the cell/voxel
+	int cubeIndex = 0;
+
+	for (int i = 0; i < 8; i++)
+	{
+
+		if (cornerValues[i] < threshold)
+		{
+
+			cubeIndex |= 1 << i;
+
+		}
+
+	}
+
+	return cubeIndex;
+
+}
+
+int CPUMarchingCubes::getCubeIndex(const uint64_t* cornerWords, int b)
+{
+
+	int cubeIndex = 0;
+
+	for (int i = 0; i < 8; i++)
+	{
+
+		cubeIndex |= (int)((cornerWords[i] >> b) & 1) << i;
+
+	}
+
+	return cubeIndex;
+
+}
+
+int CPUMarchingCubes::PolygoniseCell(const DensityVolume& volume, int x, int y, int z, int cubeIndex, const float* cornerValues, float threshold, MeshVertex* output) const
+{
+
+	// Find the vertices where the surface intersects the cube from the edges using trilinear interpolation, in terrain space
+	float vertlist[12][3];
+
+	for (int e = 0; e < 12; e++)
+	{
+
+		if (edgeTable[cubeIndex] & (1 << e))
+		{
+
+			// Interpolate from the lower corner of the edge to the upper one, so the cells sharing an edge, which list
+			// its corners in opposite orders, give its vertex bit for bit the same position
+			int first = edgeCorners[e][0];
+			int second = edgeCorners[e][1];
+
+			if (cornerOffsets[first][0] + cornerOffsets[first][1] + cornerOffsets[first][2] > cornerOffsets[second][0] + cornerOffsets[second][1] + cornerOffsets[second][2])
+			{
+
+				std::swap(first, second);
+
+			}
+
+			const int* c1 = cornerOffsets[first];
+			const int* c2 = cornerOffsets[second];
+			float p1[3] = { (float)(originX + x + c1[0]), (float)(originY + y + c1[1]), (float)(originZ + z + c1[2]) };
+			float p2[3] = { (float)(originX + x + c2[0]), (float)(originY + y + c2[1]), (float)(originZ + z + c2[2]) };
+			VertexInterp(p1, p2, cornerValues[first], cornerValues[second], threshold, vertlist[e]);
+
+		}
+
+	}
+
+	// Calculate polygons from the detected vertices, reading a triangle's three edges at a time from the packed table
+	uint64_t edges = getPackedTriTable()[cubeIndex];
+	int vertexCount = (int)(edges >> 60) * 3;
+
+	for (int i = 0; i < vertexCount; i += 3, edges >>= 12)
+	{
+
+		for (int k = 0; k < 3; k++)
+		{
+
+			const float* p = vertlist[(edges >> (4 * k)) & 0xF];
+			float local[3] = { p[0] - originX, p[1] - originY, p[2] - originZ };
+
+			MeshVertex& vertex = output[i + k];
+			vertex.position[0] = p[0] * meshScaleFactor;
+			vertex.position[1] = p[1] * meshScaleFactor;
+			vertex.position[2] = p[2] * meshScaleFactor;
+			vertex.position[3] = 1.0f;
+			CalculateNormal(volume, local, vertex.normal);
+			MaterialWeights::Apply(vertex);
+
+		}
+
+	}
+
+	return vertexCount;
+
+}
+
+void CPUMarchingCubes::VertexInterp(const float* p1, const float* p2, float valp1, float valp2, float threshold, float* p) const
+{
+
+	float mu = 0.0f;
+
+	if (fabsf(threshold - valp1) < 0.00001f)
+	{
+
+		mu = 0.0f;
+
+	}
+	else if (fabsf(threshold - valp2) < 0.00001f)
+	{
+
+		mu = 1.0f;
+
+	}
+	else if (fabsf(valp1 - valp2) < 0.00001f)
+	{
+
+		mu = 0.0f;
+
+	}
+	else
+	{
+
+		mu = (threshold - valp1) / (valp2 - valp1);
+
+	}
+
+	p[0] = p1[0] + mu * (p2[0] - p1[0]);
+	p[1] = p1[1] + mu * (p2[1] - p1[1]);
+	p[2] = p1[2] + mu * (p2[2] - p1[2]);
+
+}
+
+void CPUMarchingCubes::CalculateNormal(const DensityVolume& volume, const float* position, float* normal) const
+{
+
+	normal[0] = volume.Sample(position[0] + 1.0f, position[1], position[2]) - volume.Sample(position[0] - 1.0f, position[1], position[2]);
+	normal[1] = volume.Sample(position[0], position[1] + 1.0f, position[2]) - volume.Sample(position[0], position[1] - 1.0f, position[2]);
+	normal[2] = volume.Sample(position[0], position[1], position[2] + 1.0f) - volume.Sample(position[0], position[1], position[2] - 1.0f);
+
+	float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+	if (length > 0.0f)
+	{
+
+		normal[0] /= length;
+		normal[1] /= length;
+		normal[2] /= length;
+
+	}
+
+}
@@ -0,0 +1,98 @@
+// CPU marching cubes
+// Native port of the marching cubes geometry shader (marching_cubes_gs.hlsl)
+// Emits the same vertex layout as the stream output stage so its output can be uploaded straight into a vertex buffer
+#ifndef _CPU_MARCHING_CUBES_H_
+#define _CPU_MARCHING_CUBES_H_
+
+#include <vector>
+#include "TerrainTypes.h"
+#include "DensityVolume.h"
+#include "SignVolume.h"
+#include "VertexPacker.h"
+
+class CPUMarchingCubes
+{
+
+public:
+
+	CPUMarchingCubes();
+
+	// Update the values used for calculating the isosurface
+	void UpdateValues(float isoValue, float meshScaleFactor);
+	// Treat voxel (0, 0, 0) of the volumes extracted as voxel (x, y, z) of the terrain (default (0, 0, 0))
+	// Positions are computed from terrain coordinates, so a chunk extracted from its own volume gets exactly the
+	// positions it would get from the whole volume
+	void setVolumeOrigin(int x, int y, int z);
+
+	// Polygonise every cell with its lowest Z corner in [zBegin, zEnd), appending triangles to output
+	// Cells read the Z slices [zBegin, zEnd] and normals read one further slice either side, see getSliceRange
+	void Run(const DensityVolume& volume, int zBegin, int zEnd, std::vector<MeshVertex>& output) const;
+	// Polygonise only the cells in [xBegin, xEnd) x [yBegin, yEnd) x [zBegin, zEnd), for extracting part of a volume
+	// The region's signs are packed into a small sign volume first, and its cells classified as in the sign volume Run below
+	void Run(const DensityVolume& volume, int xBegin, int xEnd, int yBegin, int yEnd, int zBegin, int zEnd, std::vector<MeshVertex>& output) const;
+	// As above, but emitting PackedVertex relative to the packer's box, which must hold the region's vertices
+	void Run(const DensityVolume& volume, int xBegin, int xEnd, int yBegin, int yEnd, int zBegin, int zEnd, const VertexPacker& packer, std::vector<PackedVertex>& output) const;
+
+	// As Run, but classifying 64 cells at a time from a sign volume packed at the current isovalue
+	// Only the active cells load their float corners, and the output is identical to Run's
+	void Run(const DensityVolume& volume, const SignVolume& signs, int zBegin, int zEnd, std::vector<MeshVertex>& output) const;
+	// Number of cells with their lowest Z corner in [zBegin, zEnd) that the surface passes through
+	static size_t CountActiveCells(const SignVolume& signs, int zBegin, int zEnd);
+
+	// Extract one surface per isovalue from the cells in [xBegin, xEnd) x [yBegin, yEnd) x [zBegin, zEnd), appending the surface
+	// at isoValues[i] to outputs[i] in the same order the region Run above would; the isovalue set by UpdateValues is ignored
+	// minimum and maximum bound the densities the region reads, e.g. from its brick, and isovalues outside them are skipped
+	// The rest are handled in one traversal: each row of densities is read once to pack a sign block per isovalue, each word of
+	// cells is classified against every block, and a cell active at any isovalue loads its corners once for all of its surfaces
+	void RunMultiple(const DensityVolume& volume, int xBegin, int xEnd, int yBegin, int yEnd, int zBegin, int zEnd, float minimum, float maximum, const std::vector<float>& isoValues, std::vector<std::vector<MeshVertex>>& outputs) const;
+
+	// Reference implementation of the compute shader path (MCComputeShader), split into the same three passes
+	// Classify stores each cell's cube configuration and triangle count, indexed by CellIndex (X fastest)
+	void Classify(const DensityVolume& volume, std::vector<unsigned int>& cubeIndices, std::vector<unsigned int>& triangleCounts) const;
+	// Replace each count with the sum of all counts before it, returning the total
+	static unsigned int ExclusiveScan(std::vector<unsigned int>& values);
+	// Write each cell's triangles at its scanned offset, giving the same ordering as Run over the whole volume
+	void Emit(const DensityVolume& volume, const std::vector<unsigned int>& cubeIndices, const std::vector<unsigned int>& triangleOffsets, std::vector<MeshVertex>& output) const;
+
+	// Number of cells along each axis for a volume of the given dimensions
+	// There is one fewer cell than voxels, as each cell needs both of its corners inside the volume
+	static int getCellCount(int voxels);
+	// The Z slices of the volume read when extracting the cells [zBegin, zEnd), including the normal stencil
+	static void getSliceRange(int zBegin, int zEnd, int dimsZ, int& sliceBegin, int& sliceEnd);
+
+private:
+
+	// Load the corners of a cell and return its cube configuration
+	int ClassifyCell(const DensityVolume& volume, int x, int y, int z, float* cornerValues) const;
+	void LoadCorners(const DensityVolume& volume, int x, int y, int z, float* cornerValues) const;
+	// Cube configuration of a cell's corners against a threshold
+	static int getCubeIndex(const float* cornerValues, float threshold);
+	// Cube configuration of cell b of a word of cells, from the corner words ClassifyWord gave
+	static int getCubeIndex(const uint64_t* cornerWords, int b);
+	// Clamp a region to the volume's cells and pack the signs of the voxels it reads into blocks[i] at thresholds[i], reading
+	// the region's densities once for all of them; returns false if the region is empty
+	bool PackRegion(const DensityVolume& volume, int xBegin, int xEnd, int yBegin, int yEnd, int zBegin, int zEnd, const float* thresholds, int count, SignVolume* blocks) const;
+	// Polygonise the active cells of the sign volume's cell slices [zBegin, zEnd), where sign voxel (0, 0, 0) is volume voxel (xOffset, yOffset, zOffset)
+	// The surface is placed at the isovalue the signs were packed at
+	// Each cell's triangles are handed to append(const MeshVertex* vertices, int count) in cell order
+	template <typename Append>
+	void EmitActiveCells(const DensityVolume& volume, const SignVolume& signs, int zBegin, int zEnd, int xOffset, int yOffset, int zOffset, Append append) const;
+	// Cube configurations of the 64 cells in word w of a row of cells, one word per corner with bit b belonging to cell w * 64 + b
+	// Returns the mask of cells that are neither entirely below nor entirely above the isovalue
+	static uint64_t ClassifyWord(const SignVolume& signs, int w, int y, int z, uint64_t* cornerWords);
+	// Write the triangles of a non-empty cell's surface at the given threshold, returning the number of vertices written
+	int PolygoniseCell(const DensityVolume& volume, int x, int y, int z, int cubeIndex, const float* cornerValues, float threshold, MeshVertex* output) const;
+	// Trilinear vertex interpolation, from Paul Bourke's reference implementation
+	void VertexInterp(const float* p1, const float* p2, float valp1, float valp2, float threshold, float* p) const;
+	// Calculate a normal by sampling either side of the vertex in each dimension
+	void CalculateNormal(const DensityVolume& volume, const float* position, float* normal) const;
+
+	float isoValue;
+	float meshScaleFactor;
+	int originX;
+	int originY;
+	int originZ;
+
+};
+
+#endif // !_CPU_MARCHING_CUBES_H_
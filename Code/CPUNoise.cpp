@@ -0,0 +1,842 @@
+#include "CPUNoise.h"
+#include "PermutationTable.h"
+#include <cmath>
+
+// Interpolation function from improved Perlin noise (6t^5 - 15t^4 + 10t^3)
+static inline float fade(float t)
+{
+
+	return (t * t * t * (t * (t * 6 - 15) + 10));
+
+}
+
+static inline float lerp(float a, float b, float t)
+{
+
+	return a + (b - a) * t;
+
+}
+
+// Convert low 4 bits of hash code into 12 simple gradient directions, and compute dot product
+static inline float grad3(int hash, float x, float y, float z)
+{
+
+	int h = hash & 15;
+	float u = h < 8 ? x : y;
+	float v = h < 4 ? y : h == 12 || h == 14 ? x : z;	// Fix repeats at h = 12 to 15
+	return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+
+}
+
+// Hash of a lattice point's coordinates and a seed, as hashLattice in noise_fx.hlsl
+// Each coordinate is scaled by its own odd constant, then xxHash32's avalanche mixes every input bit into every output bit
+// seedLattice gives a point's sum and mixHash its avalanche; mixHashes avalanches a whole cell's corners in a loop of
+// independent lanes, which the compiler turns into vector multiplies and shifts
+static const unsigned int latticeX = 0x9E3779B1u;
+static const unsigned int latticeY = 0x85EBCA77u;
+static const unsigned int latticeZ = 0xC2B2AE3Du;
+
+static inline unsigned int seedLattice(int x, int y, int z, unsigned int seed)
+{
+
+	return seed * 0x27D4EB2Fu + 0x165667B1u + (unsigned int)x * latticeX + (unsigned int)y * latticeY + (unsigned int)z * latticeZ;
+
+}
+
+static inline unsigned int mixHash(unsigned int hash)
+{
+
+	hash ^= hash >> 15;
+	hash *= 0x85EBCA77u;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE3Du;
+	hash ^= hash >> 16;
+	return hash;
+
+}
+
+static inline unsigned int hashLattice(int x, int y, int z, unsigned int seed)
+{
+
+	return mixHash(seedLattice(x, y, z, seed));
+
+}
+
+static inline void mixHashes(unsigned int* hashes, int count)
+{
+
+	for (int i = 0; i < count; i++)
+	{
+
+		hashes[i] = mixHash(hashes[i]);
+
+	}
+
+}
+
+// Hashes of the 8 corners of the lattice cell whose lowest corner is (x, y, z), numbered with X in bit 2, Y in bit 1 and
+// Z in bit 0; stepping a coordinate by one only adds its constant to the sum, so the scaling is done once per cell
+static inline void hashLatticeCell(int x, int y, int z, unsigned int seed, unsigned int* hashes)
+{
+
+	static const unsigned int cornerSteps[8] = {
+
+		0, latticeZ, latticeY, latticeY + latticeZ,
+		latticeX, latticeX + latticeZ, latticeX + latticeY, latticeX + latticeY + latticeZ
+
+	};
+
+	unsigned int sum = seedLattice(x, y, z, seed);
+
+	for (int c = 0; c < 8; c++)
+	{
+
+		hashes[c] = sum + cornerSteps[c];
+
+	}
+
+	mixHashes(hashes, 8);
+
+}
+
+CPUNoise::CPUNoise()
+{
+
+	parameters.amplitude = 0.0f;
+	parameters.frequency = 0.0f;
+	parameters.persistence = 0.0f;
+	parameters.octaves = 0;
+	parameters.meshScaleFactor = 1.0f;
+	parameters.noiseOffsets[0] = parameters.noiseOffsets[1] = parameters.noiseOffsets[2] = 0.0f;
+	parameters.noiseScaleFactors[0] = parameters.noiseScaleFactors[1] = parameters.noiseScaleFactors[2] = 1.0f;
+	parameters.isRidged = false;
+	parameters.isSimplex = false;
+	parameters.heightBase = -0.7f;
+	parameters.heightMultiplier = 3.0f;
+	parameters.isHashed = false;
+	parameters.seed = 0;
+
+}
+
+void CPUNoise::UpdateNoiseValues(const NoiseParameters& lparameters)
+{
+
+	parameters = lparameters;
+
+}
+
+void CPUNoise::Run(DensityVolume& volume, int zBegin, int zEnd) const
+{
+
+	Fill(volume, nullptr, zBegin, zEnd, 0, 0, 0, volume.getDimsY());
+
+}
+
+void CPUNoise::Run(DensityVolume& volume, SignVolume& signs, int zBegin, int zEnd) const
+{
+
+	Fill(volume, &signs, zBegin, zEnd, 0, 0, 0, volume.getDimsY());
+
+}
+
+void CPUNoise::RunSlice(DensityVolume& window, int slice, int z, int dimsY) const
+{
+
+	Fill(window, nullptr, slice, slice + 1, 0, 0, z - slice, dimsY);
+
+}
+
+void CPUNoise::RunRegion(DensityVolume& region, int xOrigin, int yOrigin, int zOrigin, int dimsY) const
+{
+
+	Fill(region, nullptr, 0, region.getDimsZ(), xOrigin, yOrigin, zOrigin, dimsY);
+
+}
+
+void CPUNoise::Fill(DensityVolume& volume, SignVolume* signs, int zBegin, int zEnd, int xOrigin, int yOrigin, int zOrigin, int dimsY) const
+{
+
+	int countX = volume.getDimsX();
+	int countY = volume.getDimsY();
+
+	// Simplex noise's lattice is skewed, so its cells don't line up with the voxel axes; it's evaluated a voxel at a time
+	if (parameters.isSimplex)
+	{
+
+		for (int z = zBegin; z < zEnd; z++)
+		{
+
+			for (int y = 0; y < countY; y++)
+			{
+
+				float* row = volume.getData() + volume.index(0, y, z);
+
+				for (int x = 0; x < countX; x++)
+				{
+
+					row[x] = Density(xOrigin + x, yOrigin + y, zOrigin + z, dimsY);
+
+				}
+
+				if (signs)
+				{
+
+					signs->PackRow(row, y, z);
+
+				}
+
+			}
+
+		}
+
+		return;
+
+	}
+
+	// X and Y lattice coordinates of every octave, plus Y shifted by 150 for the ridged copy, are the same for every slice
+	int octaves = parameters.octaves;
+	std::vector<LatticeAxis> xAxes(octaves);
+	std::vector<LatticeAxis> yAxes(parameters.isRidged ? octaves * 2 : octaves);
+	float frequency = parameters.frequency;
+
+	for (int k = 0; k < octaves; k++)
+	{
+
+		BuildLatticeAxis(xAxes[k], xOrigin, countX, parameters.noiseScaleFactors[0], parameters.noiseOffsets[0], 0.0f, frequency);
+		BuildLatticeAxis(yAxes[k], yOrigin, countY, parameters.noiseScaleFactors[1], parameters.noiseOffsets[1], 0.0f, frequency);
+
+		if (parameters.isRidged)
+		{
+
+			BuildLatticeAxis(yAxes[octaves + k], yOrigin, countY, parameters.noiseScaleFactors[1], parameters.noiseOffsets[1], 150.0f, frequency);
+
+		}
+
+		frequency *= 2.0f;
+
+	}
+
+	std::vector<float> octaveValues((size_t)countX * countY);
+	std::vector<float> ridgedValues(parameters.isRidged ? (size_t)countX * countY : 0);
+
+	for (int z = zBegin; z < zEnd; z++)
+	{
+
+		// The slice itself accumulates the octaves, in the same order fBm adds them
+		for (int y = 0; y < countY; y++)
+		{
+
+			float* row = volume.getData() + volume.index(0, y, z);
+
+			for (int x = 0; x < countX; x++)
+			{
+
+				row[x] = 0.0f;
+
+			}
+
+		}
+
+		float pz = ((float)(zOrigin + z) * parameters.meshScaleFactor * parameters.noiseScaleFactors[2]) + parameters.noiseOffsets[2];
+		float localAmplitude = parameters.amplitude;
+		float localFrequency = parameters.frequency;
+
+		for (int k = 0; k < octaves; k++)
+		{
+
+			float lz = pz * localFrequency;
+			int zCell = (int)floorf(lz);
+			float zOffset = lz - zCell;
+
+			PerlinOctave(xAxes[k], yAxes[k], zCell, zOffset, fade(zOffset), localAmplitude, countX, countY, octaveValues.data());
+
+			if (parameters.isRidged)
+			{
+
+				PerlinOctave(xAxes[k], yAxes[octaves + k], zCell, zOffset, fade(zOffset), localAmplitude, countX, countY, ridgedValues.data());
+
+			}
+
+			for (int y = 0; y < countY; y++)
+			{
+
+				float* row = volume.getData() + volume.index(0, y, z);
+				const float* values = octaveValues.data() + (size_t)y * countX;
+
+				if (parameters.isRidged)
+				{
+
+					const float* ridged = ridgedValues.data() + (size_t)y * countX;
+
+					for (int x = 0; x < countX; x++)
+					{
+
+						float noiseValue = values[x];
+
+						if (ridged[x] > noiseValue)
+						{
+
+							noiseValue = ridged[x];
+
+						}
+
+						row[x] += fabsf(noiseValue);
+
+					}
+
+				}
+				else
+				{
+
+					for (int x = 0; x < countX; x++)
+					{
+
+						row[x] += values[x];
+
+					}
+
+				}
+
+			}
+
+			localAmplitude *= parameters.persistence;
+			localFrequency *= 2.0f;
+
+		}
+
+		// Height increment, as Density adds it
+		for (int y = 0; y < countY; y++)
+		{
+
+			float* row = volume.getData() + volume.index(0, y, z);
+			float increment = (yOrigin + y) / (float)dimsY;
+			float heightValue = parameters.heightBase + (increment * parameters.heightMultiplier);
+
+			for (int x = 0; x < countX; x++)
+			{
+
+				row[x] = row[x] + heightValue;
+
+			}
+
+			if (signs)
+			{
+
+				signs->PackRow(row, y, z);
+
+			}
+
+		}
+
+	}
+
+}
+
+void CPUNoise::BuildLatticeAxis(LatticeAxis& axis, int origin, int count, float scaleFactor, float offset, float shift, float frequency) const
+{
+
+	axis.cells.resize(count);
+	axis.offsets.resize(count);
+	axis.fades.resize(count);
+
+	for (int i = 0; i < count; i++)
+	{
+
+		// The same arithmetic as fBm, which only adds a shift for the ridged copy
+		float p = ((float)(origin + i) * parameters.meshScaleFactor * scaleFactor) + offset;
+		float lattice = shift != 0.0f ? (p + shift) * frequency : p * frequency;
+		int cell = (int)floorf(lattice);
+
+		axis.cells[i] = cell;
+		axis.offsets[i] = lattice - cell;
+		axis.fades[i] = fade(axis.offsets[i]);
+
+	}
+
+}
+
+void CPUNoise::PerlinOctave(const LatticeAxis& xAxis, const LatticeAxis& yAxis, int zCell, float zOffset, float zFade, float amplitude, int countX, int countY, float* output) const
+{
+
+	float zOffsets[2] = { zOffset, zOffset - 1.0f };
+
+	// Walk the runs of rows, then of voxels in each row, that fall inside the same lattice cell
+	for (int yBegin = 0; yBegin < countY;)
+	{
+
+		int yCell = yAxis.cells[yBegin];
+		int yEnd = yBegin + 1;
+
+		while (yEnd < countY && yAxis.cells[yEnd] == yCell)
+		{
+
+			yEnd++;
+
+		}
+
+		for (int xBegin = 0; xBegin < countX;)
+		{
+
+			int xCell = xAxis.cells[xBegin];
+			int xEnd = xBegin + 1;
+
+			while (xEnd < countX && xAxis.cells[xEnd] == xCell)
+			{
+
+				xEnd++;
+
+			}
+
+			// Corners are numbered with X in bit 2, Y in bit 1 and Z in bit 0
+			int hashes[8];
+			float gradients[8][3];
+			CornerHashes(xCell, yCell, zCell, hashes);
+
+			for (int c = 0; c < 8; c++)
+			{
+
+				GetGradient(hashes[c], gradients[c]);
+
+			}
+
+			for (int y = yBegin; y < yEnd; y++)
+			{
+
+				float yOffsets[2] = { yAxis.offsets[y], yAxis.offsets[y] - 1.0f };
+				float t = yAxis.fades[y];
+
+				// Each gradient has exactly two non-zero components of +-1, so adding the X term to the Y and Z terms
+				// afterwards rounds the same as grad3's single addition
+				float partial[8];
+
+				for (int c = 0; c < 8; c++)
+				{
+
+					partial[c] = gradients[c][1] * yOffsets[(c >> 1) & 1] + gradients[c][2] * zOffsets[c & 1];
+
+				}
+
+				float* row = output + (size_t)y * countX;
+
+				for (int x = xBegin; x < xEnd; x++)
+				{
+
+					float fx0 = xAxis.offsets[x];
+					float fx1 = fx0 - 1.0f;
+					float s = xAxis.fades[x];
+
+					float nx0 = lerp(gradients[0][0] * fx0 + partial[0], gradients[1][0] * fx0 + partial[1], zFade);
+					float nx1 = lerp(gradients[2][0] * fx0 + partial[2], gradients[3][0] * fx0 + partial[3], zFade);
+					float n0 = lerp(nx0, nx1, t);
+
+					nx0 = lerp(gradients[4][0] * fx1 + partial[4], gradients[5][0] * fx1 + partial[5], zFade);
+					nx1 = lerp(gradients[6][0] * fx1 + partial[6], gradients[7][0] * fx1 + partial[7], zFade);
+					float n1 = lerp(nx0, nx1, t);
+
+					row[x] = 0.936f * (lerp(n0, n1, s)) * amplitude;
+
+				}
+
+			}
+
+			xBegin = xEnd;
+
+		}
+
+		yBegin = yEnd;
+
+	}
+
+}
+
+void CPUNoise::GetGradient(int hash, float* gradient)
+{
+
+	// grad3 returns +-u +-v, with u and v two different axes chosen by h
+	int h = hash & 15;
+	int u = h < 8 ? 0 : 1;
+	int v = h < 4 ? 1 : h == 12 || h == 14 ? 0 : 2;
+
+	gradient[0] = gradient[1] = gradient[2] = 0.0f;
+	gradient[u] = (h & 1) ? -1.0f : 1.0f;
+	gradient[v] = (h & 2) ? -1.0f : 1.0f;
+
+}
+
+void CPUNoise::CornerHashes(int x, int y, int z, int* hashes) const
+{
+
+	if (parameters.isHashed)
+	{
+
+		hashLatticeCell(x, y, z, parameters.seed, (unsigned int*)hashes);
+		return;
+
+	}
+
+	const int* perm = permutationTable;
+
+	for (int c = 0; c < 8; c++)
+	{
+
+		int cornerX = x + ((c >> 2) & 1);
+		int cornerY = y + ((c >> 1) & 1);
+		int cornerZ = z + (c & 1);
+		hashes[c] = perm[(cornerX & 0xff) + perm[(cornerY & 0xff) + perm[cornerZ & 0xff]]];
+
+	}
+
+}
+
+float CPUNoise::Density(int x, int y, int z, int dimsY) const
+{
+
+	// Get the noise value
+	float value = fBm((float)x, (float)y, (float)z);
+
+	// Calculate an increment value based on height
+	// Lower values of y will tend to negative, higher values will tend to positive
+	float increment = y / (float)dimsY;
+	float heightValue = parameters.heightBase + (increment * parameters.heightMultiplier);
+
+	return value + heightValue;
+
+}
+
+float CPUNoise::fBm(float x, float y, float z) const
+{
+
+	float noiseValue = 0.0f;
+	float noise2 = 0.0f;
+	float value = 0.0f;
+	float localAmplitude = parameters.amplitude;
+	float localFrequency = parameters.frequency;
+
+	// Position in noise space before frequency scaling; these don't change between octaves
+	float px = (x * parameters.meshScaleFactor * parameters.noiseScaleFactors[0]) + parameters.noiseOffsets[0];
+	float py = (y * parameters.meshScaleFactor * parameters.noiseScaleFactors[1]) + parameters.noiseOffsets[1];
+	float pz = (z * parameters.meshScaleFactor * parameters.noiseScaleFactors[2]) + parameters.noiseOffsets[2];
+
+	for (int k = 0; k < parameters.octaves; k++)
+	{
+
+		noiseValue = Basis(px * localFrequency, py * localFrequency, pz * localFrequency) * localAmplitude;
+
+		// Check if we're doing ridged turbulence implementation
+		if (parameters.isRidged)
+		{
+
+			noise2 = Basis(px * localFrequency, (py + 150.0f) * localFrequency, pz * localFrequency) * localAmplitude;
+
+		}
+
+		// Return the greater of the two noise values, then find absolute value
+		if (parameters.isRidged)
+		{
+
+			if (noise2 > noiseValue)
+			{
+
+				noiseValue = noise2;
+
+			}
+
+			value += fabsf(noiseValue);
+
+		}
+		else
+		{
+
+			value += noiseValue;
+
+		}
+
+		// Persistence/gain for amplitude, lacunarity of 2.0 for frequency
+		localAmplitude *= parameters.persistence;
+		localFrequency *= 2.0f;
+
+	}
+
+	return value;
+
+}
+
+float CPUNoise::Basis(float x, float y, float z) const
+{
+
+	// Check whether we should use Simplex noise or Perlin noise, and where their gradients come from
+	if (parameters.isHashed)
+	{
+
+		return parameters.isSimplex ? hsnoise3(x, y, z) : hnoise3(x, y, z);
+
+	}
+
+	return parameters.isSimplex ? snoise3(x, y, z) : noise3(x, y, z);
+
+}
+
+// Adapted from C implementation by Stefan Gustavson, as in noise_fx.hlsl
+float CPUNoise::noise3(float x, float y, float z) const
+{
+
+	const int* perm = permutationTable;
+
+	int ix0 = (int)floorf(x);
+	int iy0 = (int)floorf(y);
+	int iz0 = (int)floorf(z);
+	float fx0 = x - ix0;
+	float fy0 = y - iy0;
+	float fz0 = z - iz0;
+	float fx1 = fx0 - 1.0f;
+	float fy1 = fy0 - 1.0f;
+	float fz1 = fz0 - 1.0f;
+	int ix1 = (ix0 + 1) & 0xff;		// Wrap to 0..255
+	int iy1 = (iy0 + 1) & 0xff;
+	int iz1 = (iz0 + 1) & 0xff;
+	ix0 &= 0xff;
+	iy0 &= 0xff;
+	iz0 &= 0xff;
+
+	float r = fade(fz0);
+	float t = fade(fy0);
+	float s = fade(fx0);
+
+	float nxy0, nxy1, nx0, nx1, n0, n1;
+
+	nxy0 = grad3(perm[ix0 + perm[iy0 + perm[iz0]]], fx0, fy0, fz0);
+	nxy1 = grad3(perm[ix0 + perm[iy0 + perm[iz1]]], fx0, fy0, fz1);
+	nx0 = lerp(nxy0, nxy1, r);
+
+	nxy0 = grad3(perm[ix0 + perm[iy1 + perm[iz0]]], fx0, fy1, fz0);
+	nxy1 = grad3(perm[ix0 + perm[iy1 + perm[iz1]]], fx0, fy1, fz1);
+	nx1 = lerp(nxy0, nxy1, r);
+
+	n0 = lerp(nx0, nx1, t);
+
+	nxy0 = grad3(perm[ix1 + perm[iy0 + perm[iz0]]], fx1, fy0, fz0);
+	nxy1 = grad3(perm[ix1 + perm[iy0 + perm[iz1]]], fx1, fy0, fz1);
+	nx0 = lerp(nxy0, nxy1, r);
+
+	nxy0 = grad3(perm[ix1 + perm[iy1 + perm[iz0]]], fx1, fy1, fz0);
+	nxy1 = grad3(perm[ix1 + perm[iy1 + perm[iz1]]], fx1, fy1, fz1);
+	nx1 = lerp(nxy0, nxy1, r);
+
+	n1 = lerp(nx0, nx1, t);
+
+	// Requires rescaling of approximately 0.936 to match original Perlin noise output value range
+	return 0.936f * (lerp(n0, n1, s));
+
+}
+
+// Adapted from the C and GLSL implementations by Stefan Gustavson, as in noise_fx.hlsl
+float CPUNoise::snoise3(float x, float y, float z) const
+{
+
+	const int* perm = permutationTable;
+	const float F3 = 1.0f / 3.0f;
+	const float G3 = 1.0f / 6.0f;
+
+	// First corner
+	float skew = (x + y + z) * F3;
+	int i = (int)floorf(x + skew);
+	int j = (int)floorf(y + skew);
+	int k = (int)floorf(z + skew);
+	float unskew = (i + j + k) * G3;
+	float x0 = x - i + unskew;
+	float y0 = y - j + unskew;
+	float z0 = z - k + unskew;
+
+	// Other corners, ordered by the relative magnitudes of x0, y0, z0 (the step/min/max trick from the shader)
+	int gx = x0 >= y0 ? 1 : 0;
+	int gy = y0 >= z0 ? 1 : 0;
+	int gz = z0 >= x0 ? 1 : 0;
+	int i1 = gx < 1 - gz ? gx : 1 - gz;
+	int j1 = gy < 1 - gx ? gy : 1 - gx;
+	int k1 = gz < 1 - gy ? gz : 1 - gy;
+	int i2 = gx > 1 - gz ? gx : 1 - gz;
+	int j2 = gy > 1 - gx ? gy : 1 - gx;
+	int k2 = gz > 1 - gy ? gz : 1 - gy;
+
+	float x1 = x0 - i1 + G3;
+	float y1 = y0 - j1 + G3;
+	float z1 = z0 - k1 + G3;
+	float x2 = x0 - i2 + F3;
+	float y2 = y0 - j2 + F3;
+	float z2 = z0 - k2 + F3;
+	float x3 = x0 - 0.5f;
+	float y3 = y0 - 0.5f;
+	float z3 = z0 - 0.5f;
+
+	// Calculate the contribution from the four corners
+	float t0 = 0.5f - x0 * x0 - y0 * y0 - z0 * z0;
+	float t1 = 0.5f - x1 * x1 - y1 * y1 - z1 * z1;
+	float t2 = 0.5f - x2 * x2 - y2 * y2 - z2 * z2;
+	float t3 = 0.5f - x3 * x3 - y3 * y3 - z3 * z3;
+
+	// Wrap the integer indices at 256, to avoid indexing perm[] out of bounds
+	int ii = i & 0xff;
+	int jj = j & 0xff;
+	int kk = k & 0xff;
+
+	float n0, n1, n2, n3;
+
+	if (t0 < 0.0f)
+	{
+
+		n0 = 0.0f;
+
+	}
+	else
+	{
+
+		t0 *= t0;
+		n0 = t0 * t0 * grad3(perm[ii + perm[jj + perm[kk]]], x0, y0, z0);
+
+	}
+
+	if (t1 < 0.0f)
+	{
+
+		n1 = 0.0f;
+
+	}
+	else
+	{
+
+		t1 *= t1;
+		n1 = t1 * t1 * grad3(perm[ii + i1 + perm[jj + j1 + perm[kk + k1]]], x1, y1, z1);
+
+	}
+
+	if (t2 < 0.0f)
+	{
+
+		n2 = 0.0f;
+
+	}
+	else
+	{
+
+		t2 *= t2;
+		n2 = t2 * t2 * grad3(perm[ii + i2 + perm[jj + j2 + perm[kk + k2]]], x2, y2, z2);
+
+	}
+
+	if (t3 < 0.0f)
+	{
+
+		n3 = 0.0f;
+
+	}
+	else
+	{
+
+		t3 *= t3;
+		n3 = t3 * t3 * grad3(perm[ii + 1 + perm[jj + 1 + perm[kk + 1]]], x3, y3, z3);
+
+	}
+
+	// Add contributions from each corner to get the final noise value
+	// The result is scaled to stay just inside [-1,1]
+	return 72.0f * (n0 + n1 + n2 + n3);
+
+}
+
+// noise3 with hashed gradients, as hnoise3 in noise_fx.hlsl
+float CPUNoise::hnoise3(float x, float y, float z) const
+{
+
+	unsigned int seed = parameters.seed;
+
+	int ix0 = (int)floorf(x);
+	int iy0 = (int)floorf(y);
+	int iz0 = (int)floorf(z);
+	float fx0 = x - ix0;
+	float fy0 = y - iy0;
+	float fz0 = z - iz0;
+	float fx1 = fx0 - 1.0f;
+	float fy1 = fy0 - 1.0f;
+	float fz1 = fz0 - 1.0f;
+
+	float r = fade(fz0);
+	float t = fade(fy0);
+	float s = fade(fx0);
+
+	// The same 12 gradient directions as the table-driven noise, chosen by the low bits of each corner's hash
+	unsigned int hashes[8];
+	hashLatticeCell(ix0, iy0, iz0, seed, hashes);
+
+	float n000 = grad3(hashes[0], fx0, fy0, fz0);
+	float n001 = grad3(hashes[1], fx0, fy0, fz1);
+	float n010 = grad3(hashes[2], fx0, fy1, fz0);
+	float n011 = grad3(hashes[3], fx0, fy1, fz1);
+	float n100 = grad3(hashes[4], fx1, fy0, fz0);
+	float n101 = grad3(hashes[5], fx1, fy0, fz1);
+	float n110 = grad3(hashes[6], fx1, fy1, fz0);
+	float n111 = grad3(hashes[7], fx1, fy1, fz1);
+
+	float n0 = lerp(lerp(n000, n001, r), lerp(n010, n011, r), t);
+	float n1 = lerp(lerp(n100, n101, r), lerp(n110, n111, r), t);
+
+	return 0.936f * (lerp(n0, n1, s));
+
+}
+
+// snoise3 with hashed gradients, as hsnoise3 in noise_fx.hlsl
+float CPUNoise::hsnoise3(float x, float y, float z) const
+{
+
+	unsigned int seed = parameters.seed;
+	const float F3 = 1.0f / 3.0f;
+	const float G3 = 1.0f / 6.0f;
+
+	float skew = (x + y + z) * F3;
+	int i = (int)floorf(x + skew);
+	int j = (int)floorf(y + skew);
+	int k = (int)floorf(z + skew);
+	float unskew = (i + j + k) * G3;
+	float x0 = x - i + unskew;
+	float y0 = y - j + unskew;
+	float z0 = z - k + unskew;
+
+	int gx = x0 >= y0 ? 1 : 0;
+	int gy = y0 >= z0 ? 1 : 0;
+	int gz = z0 >= x0 ? 1 : 0;
+	int i1 = gx < 1 - gz ? gx : 1 - gz;
+	int j1 = gy < 1 - gx ? gy : 1 - gx;
+	int k1 = gz < 1 - gy ? gz : 1 - gy;
+	int i2 = gx > 1 - gz ? gx : 1 - gz;
+	int j2 = gy > 1 - gx ? gy : 1 - gx;
+	int k2 = gz > 1 - gy ? gz : 1 - gy;
+
+	float x1 = x0 - i1 + G3;
+	float y1 = y0 - j1 + G3;
+	float z1 = z0 - k1 + G3;
+	float x2 = x0 - i2 + F3;
+	float y2 = y0 - j2 + F3;
+	float z2 = z0 - k2 + F3;
+	float x3 = x0 - 0.5f;
+	float y3 = y0 - 0.5f;
+	float z3 = z0 - 0.5f;
+
+	// Corners out of range are clamped to no contribution rather than skipped, so every sample takes the same path
+	float t0 = fmaxf(0.5f - x0 * x0 - y0 * y0 - z0 * z0, 0.0f);
+	float t1 = fmaxf(0.5f - x1 * x1 - y1 * y1 - z1 * z1, 0.0f);
+	float t2 = fmaxf(0.5f - x2 * x2 - y2 * y2 - z2 * z2, 0.0f);
+	float t3 = fmaxf(0.5f - x3 * x3 - y3 * y3 - z3 * z3, 0.0f);
+	t0 *= t0;
+	t1 *= t1;
+	t2 *= t2;
+	t3 *= t3;
+
+	// Four corners a sample, each feeding one scalar grad3, run fastest as independent scalar hashes; gathering them
+	// into a vector and back out costs more than the vector multiplies save
+	float n0 = t0 * t0 * grad3(hashLattice(i, j, k, seed), x0, y0, z0);
+	float n1 = t1 * t1 * grad3(hashLattice(i + i1, j + j1, k + k1, seed), x1, y1, z1);
+	float n2 = t2 * t2 * grad3(hashLattice(i + i2, j + j2, k + k2, seed), x2, y2, z2);
+	float n3 = t3 * t3 * grad3(hashLattice(i + 1, j + 1, k + 1, seed), x3, y3, z3);
+
+	return 72.0f * (n0 + n1 + n2 + n3);
+
+}
@@ -0,0 +1,82 @@
+// CPU noise
+// Native port of the gradient noise compute shader (gradient_noise_cs.hlsl and noise_fx.hlsl)
+// Produces the same density values as the GPU, so that volumes can be generated without a D3D11 device
+#ifndef _CPU_NOISE_H_
+#define _CPU_NOISE_H_
+
+#include "TerrainTypes.h"
+#include "DensityVolume.h"
+#include "SignVolume.h"
+#include <vector>
+
+class CPUNoise
+{
+
+public:
+
+	CPUNoise();
+
+	// Update the noise values when they're changed by user input
+	void UpdateNoiseValues(const NoiseParameters& parameters);
+
+	// Fill the Z slices [zBegin, zEnd) of the volume with fBm noise plus the height increment
+	// Slices are independent of each other, so separate ranges can safely be filled on separate threads
+	// Perlin noise is evaluated a lattice cell at a time, giving exactly the values Density would
+	void Run(DensityVolume& volume, int zBegin, int zEnd) const;
+	// As above, also packing each row's signs against the sign volume's isovalue as soon as the row is written
+	void Run(DensityVolume& volume, SignVolume& signs, int zBegin, int zEnd) const;
+	// Fill slice of a window volume with the noise of Z slice z of a volume dimsY voxels high, for volumes generated a few slices at a time
+	void RunSlice(DensityVolume& window, int slice, int z, int dimsY) const;
+	// Fill a region volume with the noise of the voxels from (xOrigin, yOrigin, zOrigin) on, in a volume dimsY voxels high
+	// The noise is defined everywhere, so the region may reach past the volume on any side, e.g. for a chunk's apron
+	void RunRegion(DensityVolume& region, int xOrigin, int yOrigin, int zOrigin, int dimsY) const;
+
+	// Density value for a single voxel, exactly as the noise shader's main function computes it
+	float Density(int x, int y, int z, int dimsY) const;
+
+	// Fractional Brownian motion function, expanded to implement both Perlin and Simplex noise, plus ridged turbulence
+	float fBm(float x, float y, float z) const;
+
+	// 3D Perlin noise function
+	float noise3(float x, float y, float z) const;
+	// 3D Simplex noise function
+	float snoise3(float x, float y, float z) const;
+	// As noise3 and snoise3, with each lattice point's gradient hashed from its coordinates and the seed
+	// Only integer arithmetic and no table, so the noise doesn't repeat every 256 units and can be reseeded; it isn't
+	// faster than the table on the CPU, see the README
+	float hnoise3(float x, float y, float z) const;
+	float hsnoise3(float x, float y, float z) const;
+
+private:
+
+	// Lattice cell, offset into the cell and fade of each voxel along one axis, for one octave
+	struct LatticeAxis
+	{
+
+		std::vector<int> cells;
+		std::vector<float> offsets;
+		std::vector<float> fades;
+
+	};
+
+	// The noise function the parameters select
+	float Basis(float x, float y, float z) const;
+
+	// Fill the Z slices [zBegin, zEnd) of a volume whose voxel (0, 0, 0) is noise voxel (xOrigin, yOrigin, zOrigin), packing
+	// each slice's signs afterwards if signs isn't null
+	void Fill(DensityVolume& volume, SignVolume* signs, int zBegin, int zEnd, int xOrigin, int yOrigin, int zOrigin, int dimsY) const;
+	// Lattice coordinates of count voxels from origin along an axis, at the given frequency
+	void BuildLatticeAxis(LatticeAxis& axis, int origin, int count, float scaleFactor, float offset, float shift, float frequency) const;
+	// One octave of Perlin noise, times amplitude, over a slice of countX by countY voxels
+	// Each lattice cell's corner gradients are found once, leaving the voxels inside it only the dot products and lerps
+	void PerlinOctave(const LatticeAxis& xAxis, const LatticeAxis& yAxis, int zCell, float zOffset, float zFade, float amplitude, int countX, int countY, float* output) const;
+	// The gradient the low 4 bits of a corner's hash select, as grad3 chooses it
+	static void GetGradient(int hash, float* gradient);
+	// Hashes of the 8 corners of a lattice cell, from the permutation table or hashed, as noise3 and hnoise3 find them
+	void CornerHashes(int x, int y, int z, int* hashes) const;
+
+	NoiseParameters parameters;
+
+};
+
+#endif // !_CPU_NOISE_H_
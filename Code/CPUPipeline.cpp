@@ -0,0 +1,859 @@
+#include "CPUPipeline.h"
+#include <algorithm>
+#include <cfloat>
+
+CPUPipeline::CPUPipeline(JobScheduler* lscheduler)
+{
+
+	scheduler = lscheduler;
+
+	dimsX = 0;
+	dimsY = 0;
+	dimsZ = 0;
+	slabDepth = 8;
+	brickSize = 8;
+	isoValue = 0.0f;
+	isSignClassification = true;
+	isMeshOptimized = false;
+	simplifyRatio = 1.0f;
+	simplifyError = FLT_MAX;
+	extractionMethod = EXTRACTION_MARCHING_CUBES;
+	areSignsValid = false;
+	volumeCache = nullptr;
+	noiseParameters = NoiseParameters();
+
+	wasCancelled = false;
+
+}
+
+void CPUPipeline::UpdateMeshValues(int x, int y, int z)
+{
+
+	dimsX = x;
+	dimsY = y;
+	dimsZ = z;
+
+	volume.Allocate(dimsX, dimsY, dimsZ);
+	volumeFile.Close();
+	brickTree.Clear();
+	areSignsValid = false;
+
+}
+
+void CPUPipeline::UpdateNoiseValues(const NoiseParameters& parameters)
+{
+
+	noise.UpdateNoiseValues(parameters);
+	noiseParameters = parameters;
+
+}
+
+void CPUPipeline::UpdateExtractionValues(float liso, float meshScaleFactor)
+{
+
+	isoValue = liso;
+	marchingCubes.UpdateValues(isoValue, meshScaleFactor);
+	surfaceNets.UpdateValues(isoValue, meshScaleFactor);
+
+}
+
+void CPUPipeline::setSlabDepth(int depth)
+{
+
+	slabDepth = depth > 0 ? depth : 1;
+
+}
+
+void CPUPipeline::setBrickSize(int size)
+{
+
+	brickSize = size > 0 ? size : 0;
+
+	if (brickTree.isBuilt() && brickTree.getBrickSize() != brickSize)
+	{
+
+		brickTree.Clear();
+
+	}
+
+}
+
+void CPUPipeline::setSignClassification(bool isEnabled)
+{
+
+	// Signs aren't packed while disabled, so any that were packed before may no longer match the volume
+	if (isEnabled != isSignClassification)
+	{
+
+		areSignsValid = false;
+
+	}
+
+	isSignClassification = isEnabled;
+
+}
+
+void CPUPipeline::setVolumeCache(VolumeCache* cache)
+{
+
+	volumeCache = cache;
+
+}
+
+void CPUPipeline::setMeshOptimization(bool isEnabled)
+{
+
+	isMeshOptimized = isEnabled;
+
+}
+
+void CPUPipeline::setSimplification(float targetRatio, float maxError)
+{
+
+	simplifyRatio = targetRatio;
+	simplifyError = maxError;
+
+}
+
+void CPUPipeline::setExtractionMethod(ExtractionMethod method)
+{
+
+	extractionMethod = method;
+	surfaceNets.setMethod(method);
+
+}
+
+void CPUPipeline::BuildGraph(bool isNoiseIncluded)
+{
+
+	graph.Clear();
+
+	// Signs are packed by the noise jobs, or repacked from the volume when only the isovalue changed
+	bool isRepackingSigns = false;
+
+	if (isSignClassification)
+	{
+
+		if (signs.getDimsX() != dimsX || signs.getDimsY() != dimsY || signs.getDimsZ() != dimsZ)
+		{
+
+			signs.Allocate(dimsX, dimsY, dimsZ);
+			areSignsValid = false;
+
+		}
+
+		isRepackingSigns = !isNoiseIncluded && (!areSignsValid || signs.getIsoValue() != isoValue);
+		areSignsValid = false;
+		signs.setIsoValue(isoValue);
+
+	}
+
+	int noiseSlabs = (dimsZ + slabDepth - 1) / slabDepth;
+	int cellsZ = CPUMarchingCubes::getCellCount(dimsZ);
+	int extractionSlabs = (cellsZ + slabDepth - 1) / slabDepth;
+
+	slabVertices.assign(extractionSlabs, std::vector<MeshVertex>());
+
+	// Noise bricks: one job per slab of voxels
+	std::vector<int> noiseJobs(isNoiseIncluded || isRepackingSigns ? noiseSlabs : 0);
+
+	for (int k = 0; k < (int)noiseJobs.size(); k++)
+	{
+
+		int zBegin = k * slabDepth;
+		int zEnd = zBegin + slabDepth < dimsZ ? zBegin + slabDepth : dimsZ;
+
+		noiseJobs[k] = graph.AddJob([this, zBegin, zEnd, isNoiseIncluded]
+		{
+
+			if (IsCancelled())
+			{
+
+				return;
+
+			}
+
+			if (!isNoiseIncluded)
+			{
+
+				signs.Build(volume, zBegin, zEnd);
+
+			}
+			else if (isSignClassification)
+			{
+
+				noise.Run(volume, signs, zBegin, zEnd);
+
+			}
+			else
+			{
+
+				noise.Run(volume, zBegin, zEnd);
+
+			}
+
+		});
+
+	}
+
+	// Extraction slabs: one job per slab of cells, depending only on the noise slabs holding the slices it reads
+	for (int k = 0; k < extractionSlabs; k++)
+	{
+
+		int zBegin = k * slabDepth;
+		int zEnd = zBegin + slabDepth < cellsZ ? zBegin + slabDepth : cellsZ;
+
+		int extractionJob = graph.AddJob([this, k, zBegin, zEnd]
+		{
+
+			if (IsCancelled())
+			{
+
+				return;
+
+			}
+
+			if (extractionMethod != EXTRACTION_MARCHING_CUBES)
+			{
+
+				surfaceNets.Run(volume, zBegin, zEnd, slabVertices[k]);
+
+			}
+			else if (isSignClassification)
+			{
+
+				marchingCubes.Run(volume, signs, zBegin, zEnd, slabVertices[k]);
+
+			}
+			else
+			{
+
+				marchingCubes.Run(volume, zBegin, zEnd, slabVertices[k]);
+
+			}
+
+		});
+
+		if (noiseJobs.empty())
+		{
+
+			continue;
+
+		}
+
+		int sliceBegin, sliceEnd;
+
+		if (extractionMethod != EXTRACTION_MARCHING_CUBES)
+		{
+
+			CPUSurfaceNets::getSliceRange(zBegin, zEnd, dimsZ, sliceBegin, sliceEnd);
+
+		}
+		else
+		{
+
+			CPUMarchingCubes::getSliceRange(zBegin, zEnd, dimsZ, sliceBegin, sliceEnd);
+
+		}
+
+		for (int n = sliceBegin / slabDepth; n <= (sliceEnd - 1) / slabDepth; n++)
+		{
+
+			graph.AddDependency(extractionJob, noiseJobs[n]);
+
+		}
+
+	}
+
+}
+
+void CPUPipeline::BuildBrickGraph()
+{
+
+	graph.Clear();
+
+	BuildBrickTree();
+	brickTree.FindActiveBricks(isoValue, activeBricks);
+
+	std::vector<size_t> rowStarts;
+	FindBrickRows(rowStarts);
+	slabVertices.assign(rowStarts.size() - 1, std::vector<MeshVertex>());
+
+	for (int k = 0; k < (int)slabVertices.size(); k++)
+	{
+
+		size_t first = rowStarts[k];
+		size_t last = rowStarts[k + 1];
+
+		graph.AddJob([this, k, first, last]
+		{
+
+			for (size_t i = first; i < last && !IsCancelled(); i++)
+			{
+
+				const BrickTree::Brick& brick = activeBricks[i];
+				marchingCubes.Run(volume, brick.x0, brick.x1, brick.y0, brick.y1, brick.z0, brick.z1, slabVertices[k]);
+
+			}
+
+		});
+
+	}
+
+}
+
+void CPUPipeline::BuildBrickTree()
+{
+
+	// The tree only depends on the volume, so it is built on the first re-extraction and kept for the ones after
+	if (!brickTree.isBuilt())
+	{
+
+		brickTree.Build(volume, brickSize > 0 ? brickSize : 8);
+
+	}
+
+}
+
+void CPUPipeline::FindBrickRows(std::vector<size_t>& rowStarts) const
+{
+
+	// Active bricks come out in volume order, so each Z row of bricks is a contiguous run of the list
+	rowStarts.clear();
+
+	for (size_t i = 0; i < activeBricks.size(); i++)
+	{
+
+		if (i == 0 || activeBricks[i].z0 != activeBricks[i - 1].z0)
+		{
+
+			rowStarts.push_back(i);
+
+		}
+
+	}
+
+	rowStarts.push_back(activeBricks.size());
+
+}
+
+bool CPUPipeline::IsCancelled()
+{
+
+	// Once cancelled, stay cancelled so the rest of the graph drains without calling back into the owner
+	if (wasCancelled)
+	{
+
+		return true;
+
+	}
+
+	if (cancelCheck && cancelCheck())
+	{
+
+		wasCancelled = true;
+		return true;
+
+	}
+
+	return false;
+
+}
+
+bool CPUPipeline::Run(const std::function<bool()>& isCancelled)
+{
+
+	if (!volumeCache || !volumeCache->isOpen())
+	{
+
+		return RunGraph(true, false, isCancelled);
+
+	}
+
+	unsigned long long key = VolumeCache::HashKey(noiseParameters, dimsX, dimsY, dimsZ);
+
+	// On a hit the volume points straight into the mapped file, so only the extraction is left to run
+	// It runs over slabs like a generated volume would, so the mesh comes out the same and no brick tree is built yet
+	if (volumeCache->Load(key, dimsX, dimsY, dimsZ, volumeFile, volume))
+	{
+
+		brickTree.Clear();
+		areSignsValid = false;
+
+		return RunGraph(false, false, isCancelled);
+
+	}
+
+	// Noise is written into the volume, so it needs its own memory again if it was mapped by an earlier hit
+	if (volume.isMapped())
+	{
+
+		volume.Allocate(dimsX, dimsY, dimsZ);
+		volumeFile.Close();
+
+	}
+
+	if (!RunGraph(true, false, isCancelled))
+	{
+
+		return false;
+
+	}
+
+	volumeCache->Store(key, volume);
+
+	return true;
+
+}
+
+bool CPUPipeline::RunExtraction(const std::function<bool()>& isCancelled)
+{
+
+	return RunGraph(false, true, isCancelled);
+
+}
+
+bool CPUPipeline::RunGraph(bool isNoiseIncluded, bool isBrickGraph, const std::function<bool()>& isCancelled)
+{
+
+	cancelCheck = isCancelled;
+	wasCancelled = false;
+
+	bool isSlabGraph = isNoiseIncluded || !isBrickGraph || brickSize == 0 || extractionMethod != EXTRACTION_MARCHING_CUBES;
+
+	if (isSlabGraph)
+	{
+
+		BuildGraph(isNoiseIncluded);
+
+	}
+	else
+	{
+
+		BuildBrickGraph();
+
+	}
+
+	// A new volume invalidates the tree, even if the run is cancelled part way through
+	if (isNoiseIncluded)
+	{
+
+		brickTree.Clear();
+
+	}
+
+	scheduler->Run(graph);
+
+	cancelCheck = nullptr;
+
+	if (wasCancelled)
+	{
+
+		return false;
+
+	}
+
+	// The slab graph leaves every sign packed at the current isovalue; the brick graph doesn't touch them
+	if (isSignClassification && isSlabGraph)
+	{
+
+		areSignsValid = true;
+
+	}
+
+	// Gather the slab outputs in order so the mesh is identical regardless of thread count
+	size_t vertexCount = 0;
+
+	for (size_t i = 0; i < slabVertices.size(); i++)
+	{
+
+		vertexCount += slabVertices[i].size();
+
+	}
+
+	vertices.clear();
+	vertices.reserve(vertexCount);
+
+	for (size_t i = 0; i < slabVertices.size(); i++)
+	{
+
+		vertices.insert(vertices.end(), slabVertices[i].begin(), slabVertices[i].end());
+
+	}
+
+	return true;
+
+}
+
+bool CPUPipeline::RunMultipleExtraction(const std::vector<float>& isoValues, std::vector<std::vector<MeshVertex>>& meshes, const std::function<bool()>& isCancelled)
+{
+
+	cancelCheck = isCancelled;
+	wasCancelled = false;
+
+	graph.Clear();
+
+	// Bricks whose range holds none of the isovalues are skipped, and the rest give the same rows RunExtraction would
+	BuildBrickTree();
+	brickTree.FindActiveBricks(isoValues, activeBricks);
+
+	std::vector<size_t> rowStarts;
+	FindBrickRows(rowStarts);
+
+	// The lists are kept from one call to the next, so repeated extraction reuses their memory rather than faulting in more
+	slabMeshes.resize(rowStarts.size() - 1);
+
+	for (size_t k = 0; k < slabMeshes.size(); k++)
+	{
+
+		slabMeshes[k].resize(isoValues.size());
+
+		for (size_t i = 0; i < isoValues.size(); i++)
+		{
+
+			slabMeshes[k][i].clear();
+
+		}
+
+	}
+
+	for (int k = 0; k < (int)slabMeshes.size(); k++)
+	{
+
+		size_t first = rowStarts[k];
+		size_t last = rowStarts[k + 1];
+
+		graph.AddJob([this, k, first, last, &isoValues]
+		{
+
+			for (size_t i = first; i < last && !IsCancelled(); i++)
+			{
+
+				const BrickTree::Brick& brick = activeBricks[i];
+				marchingCubes.RunMultiple(volume, brick.x0, brick.x1, brick.y0, brick.y1, brick.z0, brick.z1, brick.minimum, brick.maximum, isoValues, slabMeshes[k]);
+
+			}
+
+		});
+
+	}
+
+	scheduler->Run(graph);
+
+	cancelCheck = nullptr;
+
+	if (wasCancelled)
+	{
+
+		return false;
+
+	}
+
+	// Gather each isovalue's row outputs in order, as RunGraph does for a single mesh
+	// These are cleared rather than replaced for the same reason
+	meshes.resize(isoValues.size());
+
+	for (size_t i = 0; i < isoValues.size(); i++)
+	{
+
+		size_t vertexCount = 0;
+
+		for (size_t k = 0; k < slabMeshes.size(); k++)
+		{
+
+			vertexCount += slabMeshes[k][i].size();
+
+		}
+
+		meshes[i].clear();
+		meshes[i].reserve(vertexCount);
+
+		for (size_t k = 0; k < slabMeshes.size(); k++)
+		{
+
+			meshes[i].insert(meshes[i].end(), slabMeshes[k][i].begin(), slabMeshes[k][i].end());
+
+		}
+
+	}
+
+	return true;
+
+}
+
+bool CPUPipeline::WriteChunks(int chunkSize, ChunkMeshWriter& writer, const std::function<bool()>& isCancelled)
+{
+
+	cancelCheck = isCancelled;
+	wasCancelled = false;
+	graph.Clear();
+
+	int cellsX = CPUMarchingCubes::getCellCount(dimsX);
+	int cellsY = CPUMarchingCubes::getCellCount(dimsY);
+	int cellsZ = CPUMarchingCubes::getCellCount(dimsZ);
+	int chunksX = (cellsX + chunkSize - 1) / chunkSize;
+	int chunksY = (cellsY + chunkSize - 1) / chunkSize;
+	int chunksZ = (cellsZ + chunkSize - 1) / chunkSize;
+
+	// One job per Z row of chunks, so each job's scratch lists are reused across its chunks
+	for (int cz = 0; cz < chunksZ; cz++)
+	{
+
+		graph.AddJob([this, &writer, cz, chunkSize, chunksX, chunksY]
+		{
+
+			ChunkScratch scratch;
+
+			for (int cy = 0; cy < chunksY; cy++)
+			{
+
+				for (int cx = 0; cx < chunksX && !IsCancelled(); cx++)
+				{
+
+					int xBegin = cx * chunkSize;
+					int yBegin = cy * chunkSize;
+					int zBegin = cz * chunkSize;
+
+					WriteChunk(marchingCubes, surfaceNets, volume, xBegin, xBegin + chunkSize, yBegin, yBegin + chunkSize, zBegin, zBegin + chunkSize, cx, cy, cz, scratch, writer);
+
+				}
+
+			}
+
+		});
+
+	}
+
+	scheduler->Run(graph);
+
+	cancelCheck = nullptr;
+
+	return !wasCancelled;
+
+}
+
+bool CPUPipeline::GenerateChunks(int chunkSize, int apron, ChunkMeshWriter& writer, const std::function<bool()>& isCancelled)
+{
+
+	cancelCheck = isCancelled;
+	wasCancelled = false;
+	graph.Clear();
+
+	apron = std::max(apron, getMinimumApron());
+
+	int cellsX = CPUMarchingCubes::getCellCount(dimsX);
+	int cellsY = CPUMarchingCubes::getCellCount(dimsY);
+	int cellsZ = CPUMarchingCubes::getCellCount(dimsZ);
+	int chunksX = (cellsX + chunkSize - 1) / chunkSize;
+	int chunksY = (cellsY + chunkSize - 1) / chunkSize;
+	int chunksZ = (cellsZ + chunkSize - 1) / chunkSize;
+
+	// One job per X row of chunks; no job reads another's voxels, so the rows can run in any order
+	for (int cz = 0; cz < chunksZ; cz++)
+	{
+
+		for (int cy = 0; cy < chunksY; cy++)
+		{
+
+			graph.AddJob([this, &writer, cy, cz, chunkSize, apron, chunksX, cellsX, cellsY, cellsZ]
+			{
+
+				ChunkScratch scratch;
+				DensityVolume chunkVolume;
+				CPUMarchingCubes chunkMarchingCubes = marchingCubes;
+				CPUSurfaceNets chunkSurfaceNets = surfaceNets;
+
+				for (int cx = 0; cx < chunksX && !IsCancelled(); cx++)
+				{
+
+					int xBegin = cx * chunkSize;
+					int yBegin = cy * chunkSize;
+					int zBegin = cz * chunkSize;
+					int countX = std::min(chunkSize, cellsX - xBegin);
+					int countY = std::min(chunkSize, cellsY - yBegin);
+					int countZ = std::min(chunkSize, cellsZ - zBegin);
+
+					// The chunk's cells read one more voxel than there are cells, plus the apron on either side
+					chunkVolume.Allocate(countX + 1 + 2 * apron, countY + 1 + 2 * apron, countZ + 1 + 2 * apron);
+					noise.RunRegion(chunkVolume, xBegin - apron, yBegin - apron, zBegin - apron, dimsY);
+
+					chunkMarchingCubes.setVolumeOrigin(xBegin - apron, yBegin - apron, zBegin - apron);
+					chunkSurfaceNets.setVolumeOrigin(xBegin - apron, yBegin - apron, zBegin - apron);
+					WriteChunk(chunkMarchingCubes, chunkSurfaceNets, chunkVolume, apron, apron + countX, apron, apron + countY, apron, apron + countZ, cx, cy, cz, scratch, writer);
+
+				}
+
+			});
+
+		}
+
+	}
+
+	scheduler->Run(graph);
+
+	cancelCheck = nullptr;
+
+	return !wasCancelled;
+
+}
+
+int CPUPipeline::getMinimumApron() const
+{
+
+	// Marching cubes normals sample one voxel past a cell's corners; the dual methods place vertices in the cells one
+	// behind the chunk as well, whose gradients and normals reach one voxel further back
+	return extractionMethod == EXTRACTION_MARCHING_CUBES ? 1 : 2;
+
+}
+
+void CPUPipeline::WriteChunk(const CPUMarchingCubes& chunkMarchingCubes, const CPUSurfaceNets& chunkSurfaceNets, const DensityVolume& source, int xBegin, int xEnd, int yBegin, int yEnd, int zBegin, int zEnd, int cx, int cy, int cz, ChunkScratch& scratch, ChunkMeshWriter& writer)
+{
+
+	bool isSimplified = simplifyRatio < 1.0f || simplifyError < FLT_MAX;
+	bool isPacked = writer.getVertexFormat() == CHUNK_VERTEX_PACKED;
+	float origin[3] = { cx * writer.getChunkExtent(), cy * writer.getChunkExtent(), cz * writer.getChunkExtent() };
+	scratch.packer.setBox(origin, writer.getChunkExtent());
+
+	if (isPacked && !isSimplified && extractionMethod == EXTRACTION_MARCHING_CUBES)
+	{
+
+		// Packed chunks are emitted packed, relative to the chunk's box, then welded
+		scratch.packedSoup.clear();
+		chunkMarchingCubes.Run(source, xBegin, xEnd, yBegin, yEnd, zBegin, zEnd, scratch.packer, scratch.packedSoup);
+
+		if (scratch.packedSoup.empty())
+		{
+
+			return;
+
+		}
+
+		scratch.welder.Weld(scratch.packedSoup.data(), scratch.packedSoup.size(), scratch.packedVertices, scratch.indices);
+
+	}
+	else
+	{
+
+		scratch.soup.clear();
+
+		if (extractionMethod != EXTRACTION_MARCHING_CUBES)
+		{
+
+			chunkSurfaceNets.Run(source, xBegin, xEnd, yBegin, yEnd, zBegin, zEnd, scratch.soup);
+
+		}
+		else
+		{
+
+			chunkMarchingCubes.Run(source, xBegin, xEnd, yBegin, yEnd, zBegin, zEnd, scratch.soup);
+
+		}
+
+		if (scratch.soup.empty())
+		{
+
+			return;
+
+		}
+
+		scratch.welder.Weld(scratch.soup.data(), scratch.soup.size(), scratch.vertices, scratch.indices);
+
+		// Simplification needs full precision positions, and the dual extractors only emit them, so those chunks are packed last
+		if (isSimplified)
+		{
+
+			scratch.simplifier.Simplify(scratch.vertices, scratch.indices, simplifyRatio, simplifyError);
+
+		}
+
+		if (isPacked)
+		{
+
+			scratch.packedVertices.resize(scratch.vertices.size());
+
+			for (size_t v = 0; v < scratch.vertices.size(); v++)
+			{
+
+				scratch.packer.Pack(scratch.vertices[v], scratch.packedVertices[v]);
+
+			}
+
+		}
+
+	}
+
+	if (isMeshOptimized && isPacked)
+	{
+
+		scratch.optimizer.OptimizeVertexCache(scratch.indices.data(), scratch.indices.size(), scratch.packedVertices.size());
+		scratch.optimizer.OptimizeVertexFetch(scratch.packedVertices, scratch.indices);
+
+	}
+	else if (isMeshOptimized)
+	{
+
+		scratch.optimizer.OptimizeVertexCache(scratch.indices.data(), scratch.indices.size(), scratch.vertices.size());
+		scratch.optimizer.OptimizeVertexFetch(scratch.vertices, scratch.indices);
+
+	}
+
+	if (isPacked)
+	{
+
+		writer.Write(cx, cy, cz, scratch.packedVertices.data(), (unsigned int)scratch.packedVertices.size(), scratch.indices.data(), (unsigned int)scratch.indices.size());
+
+	}
+	else
+	{
+
+		writer.Write(cx, cy, cz, scratch.vertices.data(), (unsigned int)scratch.vertices.size(), scratch.indices.data(), (unsigned int)scratch.indices.size());
+
+	}
+
+}
+
+const std::vector<MeshVertex>& CPUPipeline::getVertices() const
+{
+
+	return vertices;
+
+}
+
+void CPUPipeline::swapVertices(std::vector<MeshVertex>& other)
+{
+
+	vertices.swap(other);
+
+}
+
+const DensityVolume& CPUPipeline::getVolume() const
+{
+
+	return volume;
+
+}
+
+void CPUPipeline::releaseVolume()
+{
+
+	volume.Release();
+	volumeFile.Close();
+	signs.Release();
+	brickTree.Clear();
+	areSignsValid = false;
+
+}
+
+int CPUPipeline::getActiveBrickCount() const
+{
+
+	return (int)activeBricks.size();
+
+}
+
+int CPUPipeline::getBrickCount() const
+{
+
+	return brickTree.getBrickCount();
+
+}
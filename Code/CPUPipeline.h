@@ -0,0 +1,167 @@
+// CPU pipeline
+// Chunked CPU equivalent of App1::Run: noise generation followed by marching cubes extraction
+// The volume is split into Z slabs; each noise slab and each extraction slab is a job in a graph run by the JobScheduler,
+// and an extraction slab only waits on the noise slabs it actually reads, so extraction of early slabs overlaps noise generation of later ones
+// Re-extraction from an unchanged volume goes through a min/max brick tree, so only bricks that can hold the surface are visited
+// With a volume cache set, a volume generated before is mapped from disk instead of being generated again
+#ifndef _CPU_PIPELINE_H_
+#define _CPU_PIPELINE_H_
+
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "BrickTree.h"
+#include "CPUNoise.h"
+#include "CPUMarchingCubes.h"
+#include "CPUSurfaceNets.h"
+#include "ChunkMeshWriter.h"
+#include "DensityVolume.h"
+#include "JobScheduler.h"
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "VertexWelder.h"
+#include "VolumeCache.h"
+
+class CPUPipeline
+{
+
+public:
+
+	CPUPipeline(JobScheduler* scheduler);
+
+	// Update the mesh values when the mesh size is changed
+	void UpdateMeshValues(int x, int y, int z);
+	// Update the noise values when they're changed by user input
+	void UpdateNoiseValues(const NoiseParameters& parameters);
+	// Update the values used for calculating the isosurface
+	void UpdateExtractionValues(float isoValue, float meshScaleFactor);
+	// Number of Z slices in each noise/extraction slab
+	void setSlabDepth(int depth);
+	// Width in cells of the brick tree's leaf bricks (default 8); 0 re-extracts every cell without the tree
+	void setBrickSize(int size);
+	// Classify cells from a 1-bit sign volume packed alongside the noise (default) instead of from the float corners
+	void setSignClassification(bool isEnabled);
+	// Look up each Run's volume in the cache before generating it, and store it there afterwards; nullptr disables caching
+	// The cache isn't owned by the pipeline and must outlive it
+	void setVolumeCache(VolumeCache* cache);
+	// Reorder each chunk written by WriteChunks for the vertex cache and vertex fetch (default off)
+	void setMeshOptimization(bool isEnabled);
+	// Simplify each chunk written by WriteChunks down to targetRatio of its triangles, collapsing no edge with more
+	// than maxError error (see MeshSimplifier); the default of 1.0 and FLT_MAX leaves chunks as extracted
+	void setSimplification(float targetRatio, float maxError);
+	// Extract with marching cubes (default), surface nets or dual contouring; this applies to Run, RunExtraction and
+	// WriteChunks, and the dual methods always extract every slab, as the brick tree only skips marching cubes cells
+	void setExtractionMethod(ExtractionMethod method);
+
+	// Generate the noise volume and extract the mesh, blocking until both are complete
+	// A volume found in the cache is mapped rather than generated, leaving only the extraction to run
+	// If isCancelled is given, it is polled before each job starts; once it returns true the remaining jobs are skipped
+	// Returns false if the run was cancelled, in which case the output is incomplete
+	bool Run(const std::function<bool()>& isCancelled = nullptr);
+	// Re-extract the mesh from the volume generated by the last Run, e.g. after only the isovalue changed
+	// The first call after a Run builds the brick tree, which later calls reuse until the volume changes again
+	bool RunExtraction(const std::function<bool()>& isCancelled = nullptr);
+	// Extract one mesh per isovalue from the volume generated by the last Run with marching cubes, visiting each brick of the tree
+	// that can hold any of the surfaces once and classifying its cells against every isovalue together (see CPUMarchingCubes::RunMultiple)
+	// The tree is built as for RunExtraction, with 8 cell bricks if they are disabled
+	// meshes[i] receives the surface at isoValues[i], identical to RunExtraction's; the pipeline's own output vertices are left untouched
+	bool RunMultipleExtraction(const std::vector<float>& isoValues, std::vector<std::vector<MeshVertex>>& meshes, const std::function<bool()>& isCancelled = nullptr);
+	// Extract the volume generated by the last Run as chunks of chunkSize cubed cells, welding each into an indexed mesh,
+	// simplifying and optimizing it if enabled, and writing it to the writer as soon as it is done; empty chunks are left out
+	// Vertices are written in the writer's format, and the writer's chunk extent should be chunkSize times the mesh scale
+	bool WriteChunks(int chunkSize, ChunkMeshWriter& writer, const std::function<bool()>& isCancelled = nullptr);
+	// Generate and write the same chunks without the shared volume: each chunk fills a volume of its own voxels plus an
+	// apron of extra voxels on every side with noise, and extracts from that alone, so no chunk reads its neighbours'
+	// voxels and every chunk can be generated in parallel; needs the mesh, noise and extraction values but no Run
+	// The apron is raised to getMinimumApron if smaller; with it, normals on the volume's faces come from the noise
+	// beyond them rather than from the clamped edge
+	bool GenerateChunks(int chunkSize, int apron, ChunkMeshWriter& writer, const std::function<bool()>& isCancelled = nullptr);
+	// Smallest apron the current extraction method can extract a chunk from, the voxels it reads past a chunk's cells
+	int getMinimumApron() const;
+
+	const std::vector<MeshVertex>& getVertices() const;
+	// Exchange the output vertices with another list, avoiding a copy when handing the mesh elsewhere
+	void swapVertices(std::vector<MeshVertex>& other);
+	const DensityVolume& getVolume() const;
+	// Free the volume's memory; UpdateMeshValues must be called again before the next Run
+	void releaseVolume();
+
+	// Bricks visited by the last RunExtraction or RunMultipleExtraction, out of the total in the tree
+	int getActiveBrickCount() const;
+	int getBrickCount() const;
+
+private:
+
+	// Scratch lists for extracting and writing chunks, kept by a job across its chunks
+	struct ChunkScratch
+	{
+
+		std::vector<MeshVertex> soup;
+		std::vector<MeshVertex> vertices;
+		std::vector<PackedVertex> packedSoup;
+		std::vector<PackedVertex> packedVertices;
+		std::vector<unsigned int> indices;
+		VertexWelder welder;
+		MeshSimplifier simplifier;
+		MeshOptimizer optimizer;
+		VertexPacker packer;
+
+	};
+
+	// Adds the extraction jobs for the current volume to the graph, and the noise jobs they depend on if requested
+	void BuildGraph(bool isNoiseIncluded);
+	// Adds one extraction job per Z row of active bricks, replacing the slab jobs when only extraction is run
+	void BuildBrickGraph();
+	// Build the brick tree if the volume has changed since it was last built
+	void BuildBrickTree();
+	// Index of the first active brick in each Z row of bricks, followed by the active brick count
+	void FindBrickRows(std::vector<size_t>& rowStarts) const;
+	// Builds and runs the graph, then gathers the slab outputs
+	// Extraction without noise goes through the brick tree if isBrickGraph is set and bricks are enabled
+	bool RunGraph(bool isNoiseIncluded, bool isBrickGraph, const std::function<bool()>& isCancelled);
+	bool IsCancelled();
+	// Extract the cells [xBegin, xEnd) x [yBegin, yEnd) x [zBegin, zEnd) of source as chunk (cx, cy, cz) with the given
+	// extractors, weld, simplify and optimize it as enabled, and write it; empty chunks are left out
+	void WriteChunk(const CPUMarchingCubes& chunkMarchingCubes, const CPUSurfaceNets& chunkSurfaceNets, const DensityVolume& source, int xBegin, int xEnd, int yBegin, int yEnd, int zBegin, int zEnd, int cx, int cy, int cz, ChunkScratch& scratch, ChunkMeshWriter& writer);
+
+	JobScheduler* scheduler;
+	JobGraph graph;
+	std::function<bool()> cancelCheck;
+	std::atomic<bool> wasCancelled;
+
+	CPUNoise noise;
+	CPUMarchingCubes marchingCubes;
+	CPUSurfaceNets surfaceNets;
+	ExtractionMethod extractionMethod;
+	DensityVolume volume;
+	BrickTree brickTree;
+	SignVolume signs;
+	bool isSignClassification;
+	bool isMeshOptimized;
+	float simplifyRatio;
+	float simplifyError;
+	bool areSignsValid;
+	std::vector<BrickTree::Brick> activeBricks;
+	float isoValue;
+
+	VolumeCache* volumeCache;
+	// Holds the mapping while the volume points into a cached file
+	MappedFile volumeFile;
+	NoiseParameters noiseParameters;
+
+	// One output list per extraction slab, concatenated in slab order once every slab is done
+	std::vector<std::vector<MeshVertex>> slabVertices;
+	// One output list per isovalue for each row of bricks of RunMultipleExtraction
+	std::vector<std::vector<std::vector<MeshVertex>>> slabMeshes;
+	std::vector<MeshVertex> vertices;
+
+	int dimsX;
+	int dimsY;
+	int dimsZ;
+	int slabDepth;
+	int brickSize;
+
+};
+
+#endif // !_CPU_PIPELINE_H_
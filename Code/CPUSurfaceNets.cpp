@@ -0,0 +1,465 @@
+#include "CPUSurfaceNets.h"
+#include "CPUMarchingCubes.h"
+#include "MaterialWeights.h"
+#include <algorithm>
+#include <cmath>
+
+const float CPUSurfaceNets::massPointWeight = 0.05f;
+
+// The pair of corners joined by each of the 12 cell edges, with corner i at offset (i & 1, (i >> 1) & 1, (i >> 2) & 1)
+static const int netEdgeCorners[12][2] = {
+
+	{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+	{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+	{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+
+};
+
+CPUSurfaceNets::CPUSurfaceNets()
+{
+
+	isoValue = 0.0f;
+	meshScaleFactor = 1.0f;
+	method = EXTRACTION_SURFACE_NETS;
+	originX = 0;
+	originY = 0;
+	originZ = 0;
+
+}
+
+void CPUSurfaceNets::UpdateValues(float liso, float lscale)
+{
+
+	isoValue = liso;
+	meshScaleFactor = lscale;
+
+}
+
+void CPUSurfaceNets::setMethod(ExtractionMethod lmethod)
+{
+
+	method = lmethod == EXTRACTION_DUAL_CONTOURING ? EXTRACTION_DUAL_CONTOURING : EXTRACTION_SURFACE_NETS;
+
+}
+
+void CPUSurfaceNets::setVolumeOrigin(int x, int y, int z)
+{
+
+	originX = x;
+	originY = y;
+	originZ = z;
+
+}
+
+void CPUSurfaceNets::getSliceRange(int zBegin, int zEnd, int dimsZ, int& sliceBegin, int& sliceEnd)
+{
+
+	// Cell vertices are placed for [zBegin - 1, zEnd), spanning slices [zBegin - 1, zEnd], and the normals and gradients
+	// reach one voxel further either way
+	sliceBegin = zBegin - 2 < 0 ? 0 : zBegin - 2;
+	sliceEnd = zEnd + 2 > dimsZ ? dimsZ : zEnd + 2;
+
+}
+
+void CPUSurfaceNets::Run(const DensityVolume& volume, int zBegin, int zEnd, std::vector<MeshVertex>& output) const
+{
+
+	Run(volume, 0, CPUMarchingCubes::getCellCount(volume.getDimsX()), 0, CPUMarchingCubes::getCellCount(volume.getDimsY()), zBegin, zEnd, output);
+
+}
+
+void CPUSurfaceNets::Run(const DensityVolume& volume, int xBegin, int xEnd, int yBegin, int yEnd, int zBegin, int zEnd, std::vector<MeshVertex>& output) const
+{
+
+	int cellsX = CPUMarchingCubes::getCellCount(volume.getDimsX());
+	int cellsY = CPUMarchingCubes::getCellCount(volume.getDimsY());
+	int cellsZ = CPUMarchingCubes::getCellCount(volume.getDimsZ());
+
+	xEnd = std::min(xEnd, cellsX);
+	yEnd = std::min(yEnd, cellsY);
+	zEnd = std::min(zEnd, cellsZ);
+
+	if (xBegin >= xEnd || yBegin >= yEnd || zBegin >= zEnd)
+	{
+
+		return;
+
+	}
+
+	// The quads of the region's edges reach one cell back along each axis, but not past the terrain's lower faces
+	int xFirst = std::max(xBegin - 1, std::max(-originX, 0));
+	int yFirst = std::max(yBegin - 1, std::max(-originY, 0));
+	int zFirst = std::max(zBegin - 1, std::max(-originZ, 0));
+	int rowLength = xEnd - xFirst;
+	int sliceLength = rowLength * (yEnd - yFirst);
+
+	const int noVertex = -1;
+	std::vector<int> cellVertices((size_t)sliceLength * (zEnd - zFirst), noVertex);
+	std::vector<MeshVertex> vertices;
+
+	for (int z = zFirst; z < zEnd; z++)
+	{
+
+		for (int y = yFirst; y < yEnd; y++)
+		{
+
+			for (int x = xFirst; x < xEnd; x++)
+			{
+
+				float cornerValues[8];
+				int belowCount = 0;
+
+				for (int i = 0; i < 8; i++)
+				{
+
+					cornerValues[i] = volume.get(x + (i & 1), y + ((i >> 1) & 1), z + ((i >> 2) & 1));
+					belowCount += cornerValues[i] < isoValue ? 1 : 0;
+
+				}
+
+				// Most cells are entirely on one side of the surface
+				if (belowCount == 0 || belowCount == 8)
+				{
+
+					continue;
+
+				}
+
+				float p[3];
+
+				if (!PlaceVertex(volume, x, y, z, cornerValues, p))
+				{
+
+					continue;
+
+				}
+
+				float local[3] = { p[0] - originX, p[1] - originY, p[2] - originZ };
+
+				MeshVertex vertex;
+				vertex.position[0] = p[0] * meshScaleFactor;
+				vertex.position[1] = p[1] * meshScaleFactor;
+				vertex.position[2] = p[2] * meshScaleFactor;
+				vertex.position[3] = 1.0f;
+				CalculateNormal(volume, local, vertex.normal);
+				MaterialWeights::Apply(vertex);
+
+				cellVertices[(size_t)(z - zFirst) * sliceLength + (y - yFirst) * rowLength + (x - xFirst)] = (int)vertices.size();
+				vertices.push_back(vertex);
+
+			}
+
+		}
+
+	}
+
+	// Each cell owns the X, Y and Z edges leaving its lowest corner; an edge on the boundary of the terrain has fewer
+	// than four cells around it and is left open, as marching cubes leaves the boundary open
+	for (int z = zBegin; z < zEnd; z++)
+	{
+
+		for (int y = yBegin; y < yEnd; y++)
+		{
+
+			for (int x = xBegin; x < xEnd; x++)
+			{
+
+				int cell[3] = { originX + x, originY + y, originZ + z };
+				bool isBelow = volume.get(x, y, z) < isoValue;
+
+				for (int axis = 0; axis < 3; axis++)
+				{
+
+					int u = (axis + 1) % 3;
+					int v = (axis + 2) % 3;
+
+					if (cell[u] == 0 || cell[v] == 0)
+					{
+
+						continue;
+
+					}
+
+					int end[3] = { x, y, z };
+					end[axis]++;
+
+					if ((volume.get(end[0], end[1], end[2]) < isoValue) == isBelow)
+					{
+
+						continue;
+
+					}
+
+					// The four cells around the edge, in order around it; each holds the edge, so each has a vertex
+					const MeshVertex* quad[4];
+
+					for (int q = 0; q < 4; q++)
+					{
+
+						int around[3] = { x, y, z };
+						around[u] -= (q == 1 || q == 2) ? 1 : 0;
+						around[v] -= (q == 2 || q == 3) ? 1 : 0;
+
+						quad[q] = &vertices[cellVertices[(size_t)(around[2] - zFirst) * sliceLength + (around[1] - yFirst) * rowLength + (around[0] - xFirst)]];
+
+					}
+
+					// Split along the shorter diagonal, which avoids most of the slivers the longer one would give
+					float diagonal02 = 0.0f;
+					float diagonal13 = 0.0f;
+
+					for (int a = 0; a < 3; a++)
+					{
+
+						float d02 = quad[0]->position[a] - quad[2]->position[a];
+						float d13 = quad[1]->position[a] - quad[3]->position[a];
+						diagonal02 += d02 * d02;
+						diagonal13 += d13 * d13;
+
+					}
+
+					int triangles[6] = { 0, 1, 2, 0, 2, 3 };
+
+					if (diagonal13 < diagonal02)
+					{
+
+						int other[6] = { 0, 1, 3, 1, 2, 3 };
+						std::copy(other, other + 6, triangles);
+
+					}
+
+					// Face towards the voxels below the isovalue, as marching cubes does
+					if (isBelow)
+					{
+
+						std::swap(triangles[1], triangles[2]);
+						std::swap(triangles[4], triangles[5]);
+
+					}
+
+					for (int i = 0; i < 6; i++)
+					{
+
+						output.push_back(*quad[triangles[i]]);
+
+					}
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+bool CPUSurfaceNets::PlaceVertex(const DensityVolume& volume, int x, int y, int z, const float* cornerValues, float* position) const
+{
+
+	float points[12][3];
+	float normals[12][3];
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	int count = 0;
+
+	for (int e = 0; e < 12; e++)
+	{
+
+		int c1 = netEdgeCorners[e][0];
+		int c2 = netEdgeCorners[e][1];
+		float value1 = cornerValues[c1];
+		float value2 = cornerValues[c2];
+
+		if ((value1 < isoValue) == (value2 < isoValue))
+		{
+
+			continue;
+
+		}
+
+		// The values differ in sign about the isovalue, so they can't be equal
+		float mu = (isoValue - value1) / (value2 - value1);
+		int corner1[3] = { x + (c1 & 1), y + ((c1 >> 1) & 1), z + ((c1 >> 2) & 1) };
+		int corner2[3] = { x + (c2 & 1), y + ((c2 >> 1) & 1), z + ((c2 >> 2) & 1) };
+		float p1[3] = { (float)(originX + corner1[0]), (float)(originY + corner1[1]), (float)(originZ + corner1[2]) };
+		float p2[3] = { (float)(originX + corner2[0]), (float)(originY + corner2[1]), (float)(originZ + corner2[2]) };
+
+		for (int a = 0; a < 3; a++)
+		{
+
+			points[count][a] = p1[a] + mu * (p2[a] - p1[a]);
+			mean[a] += points[count][a];
+
+		}
+
+		if (method == EXTRACTION_DUAL_CONTOURING)
+		{
+
+			// Interpolate the lattice gradients of the edge's corners to the crossing
+			float g1[3];
+			float g2[3];
+			LatticeGradient(volume, corner1[0], corner1[1], corner1[2], g1);
+			LatticeGradient(volume, corner2[0], corner2[1], corner2[2], g2);
+
+			float length = 0.0f;
+
+			for (int a = 0; a < 3; a++)
+			{
+
+				normals[count][a] = g1[a] + mu * (g2[a] - g1[a]);
+				length += normals[count][a] * normals[count][a];
+
+			}
+
+			length = sqrtf(length);
+
+			for (int a = 0; a < 3; a++)
+			{
+
+				normals[count][a] = length > 0.0f ? normals[count][a] / length : 0.0f;
+
+			}
+
+		}
+
+		count++;
+
+	}
+
+	if (count == 0)
+	{
+
+		return false;
+
+	}
+
+	for (int a = 0; a < 3; a++)
+	{
+
+		mean[a] /= count;
+
+	}
+
+	if (method == EXTRACTION_DUAL_CONTOURING)
+	{
+
+		float cellMin[3] = { (float)(originX + x), (float)(originY + y), (float)(originZ + z) };
+		SolveQEF(points, normals, count, mean, cellMin, position);
+
+	}
+	else
+	{
+
+		position[0] = mean[0];
+		position[1] = mean[1];
+		position[2] = mean[2];
+
+	}
+
+	return true;
+
+}
+
+void CPUSurfaceNets::LatticeGradient(const DensityVolume& volume, int x, int y, int z, float* gradient)
+{
+
+	int coords[3] = { x, y, z };
+	int dims[3] = { volume.getDimsX(), volume.getDimsY(), volume.getDimsZ() };
+
+	for (int a = 0; a < 3; a++)
+	{
+
+		int low[3] = { x, y, z };
+		int high[3] = { x, y, z };
+		low[a] = std::max(coords[a] - 1, 0);
+		high[a] = std::min(coords[a] + 1, dims[a] - 1);
+
+		float spacing = (float)(high[a] - low[a]);
+		gradient[a] = spacing > 0.0f ? (volume.get(high[0], high[1], high[2]) - volume.get(low[0], low[1], low[2])) / spacing : 0.0f;
+
+	}
+
+}
+
+void CPUSurfaceNets::SolveQEF(const float (*points)[3], const float (*normals)[3], int count, const float* mean, const float* cellMin, float* position)
+{
+
+	// Normal equations of the planes, relative to the mean so the pull towards it is a plain diagonal term
+	double ata[3][3] = { { massPointWeight, 0.0, 0.0 }, { 0.0, massPointWeight, 0.0 }, { 0.0, 0.0, massPointWeight } };
+	double atb[3] = { 0.0, 0.0, 0.0 };
+
+	for (int i = 0; i < count; i++)
+	{
+
+		const float* n = normals[i];
+		double distance = n[0] * (points[i][0] - mean[0]) + n[1] * (points[i][1] - mean[1]) + n[2] * (points[i][2] - mean[2]);
+
+		for (int r = 0; r < 3; r++)
+		{
+
+			for (int c = 0; c < 3; c++)
+			{
+
+				ata[r][c] += (double)n[r] * n[c];
+
+			}
+
+			atb[r] += n[r] * distance;
+
+		}
+
+	}
+
+	// The mass point term keeps the matrix positive definite, so the inverse always exists
+	double cofactors[3][3];
+
+	for (int r = 0; r < 3; r++)
+	{
+
+		for (int c = 0; c < 3; c++)
+		{
+
+			int r1 = (r + 1) % 3;
+			int r2 = (r + 2) % 3;
+			int c1 = (c + 1) % 3;
+			int c2 = (c + 2) % 3;
+			cofactors[r][c] = ata[r1][c1] * ata[r2][c2] - ata[r1][c2] * ata[r2][c1];
+
+		}
+
+	}
+
+	double determinant = ata[0][0] * cofactors[0][0] + ata[0][1] * cofactors[0][1] + ata[0][2] * cofactors[0][2];
+
+	for (int a = 0; a < 3; a++)
+	{
+
+		// The matrix is symmetric, so its inverse is the cofactor matrix over the determinant
+		double offset = (cofactors[a][0] * atb[0] + cofactors[a][1] * atb[1] + cofactors[a][2] * atb[2]) / determinant;
+
+		// A vertex outside its cell could fold the quads around it over
+		position[a] = std::min(std::max(mean[a] + (float)offset, cellMin[a]), cellMin[a] + 1.0f);
+
+	}
+
+}
+
+void CPUSurfaceNets::CalculateNormal(const DensityVolume& volume, const float* position, float* normal) const
+{
+
+	normal[0] = volume.Sample(position[0] + 1.0f, position[1], position[2]) - volume.Sample(position[0] - 1.0f, position[1], position[2]);
+	normal[1] = volume.Sample(position[0], position[1] + 1.0f, position[2]) - volume.Sample(position[0], position[1] - 1.0f, position[2]);
+	normal[2] = volume.Sample(position[0], position[1], position[2] + 1.0f) - volume.Sample(position[0], position[1], position[2] - 1.0f);
+
+	float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+	if (length > 0.0f)
+	{
+
+		normal[0] /= length;
+		normal[1] /= length;
+		normal[2] /= length;
+
+	}
+
+}
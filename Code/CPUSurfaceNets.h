@@ -0,0 +1,65 @@
+// CPU surface nets
+// Dual alternative to CPUMarchingCubes: one vertex per cell the surface passes through, and one quad per voxel edge that
+// crosses the isovalue, joining the vertices of the four cells around that edge
+// Naive surface nets puts each vertex at the mean of its cell's edge crossings; dual contouring (Ju et al. 2002) instead
+// solves a QEF built from the crossings and the density gradient at each, which keeps ridges and creases sharp
+// Output is a triangle soup in the same layout as CPUMarchingCubes, so it can be used anywhere marching cubes output is
+#ifndef _CPU_SURFACE_NETS_H_
+#define _CPU_SURFACE_NETS_H_
+
+#include <vector>
+#include "TerrainTypes.h"
+#include "DensityVolume.h"
+
+class CPUSurfaceNets
+{
+
+public:
+
+	CPUSurfaceNets();
+
+	// Update the values used for calculating the isosurface
+	void UpdateValues(float isoValue, float meshScaleFactor);
+	// EXTRACTION_SURFACE_NETS (default) or EXTRACTION_DUAL_CONTOURING; marching cubes is left to CPUMarchingCubes
+	void setMethod(ExtractionMethod method);
+	// Treat voxel (0, 0, 0) of the volumes extracted as voxel (x, y, z) of the terrain (default (0, 0, 0))
+	// Positions are computed from terrain coordinates, and only edges on the terrain's lower faces are left open, so a
+	// chunk extracted from its own volume with an apron gets exactly the vertices and quads the whole volume would give it
+	void setVolumeOrigin(int x, int y, int z);
+
+	// Emit the quads of the edges owned by the cells with their lowest Z corner in [zBegin, zEnd), appending triangles to output
+	// A cell owns the three edges leaving its lowest corner, so the quads of a slab use the cell vertices of one slab of
+	// cells below it as well; see getSliceRange for the slices read
+	void Run(const DensityVolume& volume, int zBegin, int zEnd, std::vector<MeshVertex>& output) const;
+	// As above for the cells in [xBegin, xEnd) x [yBegin, yEnd) x [zBegin, zEnd), for extracting part of a volume
+	// Cell vertices depend only on the cell, so regions that share a border emit bit-identical vertices along it
+	void Run(const DensityVolume& volume, int xBegin, int xEnd, int yBegin, int yEnd, int zBegin, int zEnd, std::vector<MeshVertex>& output) const;
+
+	// The Z slices of the volume read when extracting the cells [zBegin, zEnd), including the normal stencil
+	static void getSliceRange(int zBegin, int zEnd, int dimsZ, int& sliceBegin, int& sliceEnd);
+
+private:
+
+	// Place the vertex of a cell with the given corner values, in terrain voxel space; returns false if the surface misses the cell
+	bool PlaceVertex(const DensityVolume& volume, int x, int y, int z, const float* cornerValues, float* position) const;
+	// Central difference gradient at a voxel, one sided at the edges of the volume
+	static void LatticeGradient(const DensityVolume& volume, int x, int y, int z, float* gradient);
+	// Minimise the squared distances to the planes through each crossing, pulled slightly towards their mean so that
+	// flat and edge-like cells stay well conditioned, then clamp the result to the cell
+	static void SolveQEF(const float (*points)[3], const float (*normals)[3], int count, const float* mean, const float* cellMin, float* position);
+	// Calculate a normal by sampling either side of the vertex in each dimension, as CPUMarchingCubes does
+	void CalculateNormal(const DensityVolume& volume, const float* position, float* normal) const;
+
+	float isoValue;
+	float meshScaleFactor;
+	ExtractionMethod method;
+	int originX;
+	int originY;
+	int originZ;
+
+	// Weight of the pull towards the mean crossing, relative to one plane
+	static const float massPointWeight;
+
+};
+
+#endif // !_CPU_SURFACE_NETS_H_
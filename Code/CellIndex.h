@@ -0,0 +1,37 @@
+// Cell index
+// Conversion between a cell's coordinates and its linear index, X fastest, then Y, then Z, as DensityVolume and the noise
+// texture lay out their voxels
+// cell_index_fx.hlsl does the same arithmetic for the shaders, which derive their cells from SV_VertexID or SV_DispatchThreadID
+#ifndef _CELL_INDEX_H_
+#define _CELL_INDEX_H_
+
+struct CellCoordinates
+{
+
+	unsigned int x;
+	unsigned int y;
+	unsigned int z;
+
+};
+
+// Linear index of the cell (x, y, z) in a grid of countX by countY cells in X and Y
+constexpr unsigned int CellIndex(unsigned int x, unsigned int y, unsigned int z, unsigned int countX, unsigned int countY)
+{
+
+	return x + countX * (y + countY * z);
+
+}
+
+// Coordinates of the cell with the given linear index; the inverse of CellIndex
+constexpr CellCoordinates GetCellCoordinates(unsigned int index, unsigned int countX, unsigned int countY)
+{
+
+	return CellCoordinates{ index % countX, (index / countX) % countY, index / (countX * countY) };
+
+}
+
+// Both directions, and cell_index_fx.hlsl's copy, are checked over whole grids by headless --selftest
+// SV_VertexID is 32 bits, which covers volumes up to 1625^3 cells
+static_assert(GetCellCoordinates(CellIndex(1624, 1624, 1624, 1625, 1625), 1625, 1625).z == 1624, "Cell index overflows at 1625^3");
+
+#endif // !_CELL_INDEX_H_
@@ -0,0 +1,241 @@
+#include "ChunkMeshFile.h"
+#include <cstring>
+
+const unsigned int ChunkMeshFile::version = 3;
+const unsigned int ChunkMeshFile::pageSize;
+const unsigned int ChunkMeshFile::blobAlignment;
+
+ChunkMeshFile::ChunkMeshFile()
+{
+
+	chunks = nullptr;
+	chunkCount = 0;
+	chunkSize = 0;
+	chunkExtent = 0.0f;
+	vertexFormat = CHUNK_VERTEX_MESH;
+
+}
+
+bool ChunkMeshFile::Open(const char* path)
+{
+
+	Close();
+
+	if (!file.Open(path) || file.getSize() < pageSize)
+	{
+
+		Close();
+		return false;
+
+	}
+
+	const Header* header = reinterpret_cast<const Header*>(file.getData());
+	unsigned long long fileSize = file.getSize();
+	unsigned long long tableBytes = (unsigned long long)header->chunkCount * sizeof(ChunkEntry);
+
+	bool isValid = memcmp(header->magic, "MCCM", 4) == 0 && header->version == version && header->pageSize == pageSize &&
+		header->vertexFormat < CHUNK_VERTEX_FORMAT_COUNT && header->vertexSize == getVertexSize((ChunkVertexFormat)header->vertexFormat) &&
+		header->indexSize == sizeof(unsigned int) && header->fileSize == fileSize &&
+		header->chunkTableOffset % pageSize == 0 && header->chunkTableOffset >= pageSize && header->chunkTableOffset + tableBytes <= fileSize;
+
+	if (!isValid)
+	{
+
+		Close();
+		return false;
+
+	}
+
+	chunks = reinterpret_cast<const ChunkEntry*>(file.getData() + header->chunkTableOffset);
+	chunkCount = (int)header->chunkCount;
+	chunkSize = (int)header->chunkSize;
+	chunkExtent = header->chunkExtent;
+	vertexFormat = (ChunkVertexFormat)header->vertexFormat;
+
+	// Check every blob lies inside the file, so the pointers handed out never run off the mapping
+	for (int i = 0; i < chunkCount; i++)
+	{
+
+		const ChunkEntry& chunk = chunks[i];
+		unsigned long long vertexEnd = chunk.vertexOffset + (unsigned long long)chunk.vertexCount * header->vertexSize;
+		unsigned long long indexEnd = chunk.indexOffset + (unsigned long long)chunk.indexCount * sizeof(unsigned int);
+
+		if (chunk.vertexOffset % blobAlignment != 0 || chunk.indexOffset % blobAlignment != 0 ||
+			chunk.vertexOffset < pageSize || vertexEnd > header->chunkTableOffset ||
+			chunk.indexOffset < pageSize || indexEnd > header->chunkTableOffset)
+		{
+
+			Close();
+			return false;
+
+		}
+
+	}
+
+	return true;
+
+}
+
+void ChunkMeshFile::Close()
+{
+
+	file.Close();
+	chunks = nullptr;
+	chunkCount = 0;
+	chunkSize = 0;
+	chunkExtent = 0.0f;
+	vertexFormat = CHUNK_VERTEX_MESH;
+	chunkExtent = 0.0f;
+	vertexFormat = CHUNK_VERTEX_MESH;
+
+}
+
+bool ChunkMeshFile::isOpen() const
+{
+
+	return chunks != nullptr;
+
+}
+
+int ChunkMeshFile::getChunkCount() const
+{
+
+	return chunkCount;
+
+}
+
+int ChunkMeshFile::getChunkSize() const
+{
+
+	return chunkSize;
+
+}
+
+float ChunkMeshFile::getChunkExtent() const
+{
+
+	return chunkExtent;
+
+}
+
+ChunkVertexFormat ChunkMeshFile::getVertexFormat() const
+{
+
+	return vertexFormat;
+
+}
+
+const ChunkMeshFile::ChunkEntry& ChunkMeshFile::getChunk(int i) const
+{
+
+	return chunks[i];
+
+}
+
+const MeshVertex* ChunkMeshFile::getVertices(int i) const
+{
+
+	return reinterpret_cast<const MeshVertex*>(file.getData() + chunks[i].vertexOffset);
+
+}
+
+const PackedVertex* ChunkMeshFile::getPackedVertices(int i) const
+{
+
+	return reinterpret_cast<const PackedVertex*>(file.getData() + chunks[i].vertexOffset);
+
+}
+
+const unsigned int* ChunkMeshFile::getIndices(int i) const
+{
+
+	return reinterpret_cast<const unsigned int*>(file.getData() + chunks[i].indexOffset);
+
+}
+
+int ChunkMeshFile::FindChunk(int x, int y, int z) const
+{
+
+	ChunkEntry target;
+	target.coords[0] = x;
+	target.coords[1] = y;
+	target.coords[2] = z;
+
+	// The table is sorted, so a binary search finds the chunk without touching most of it
+	int low = 0;
+	int high = chunkCount;
+
+	while (low < high)
+	{
+
+		int middle = (low + high) / 2;
+
+		if (IsBefore(chunks[middle], target))
+		{
+
+			low = middle + 1;
+
+		}
+		else
+		{
+
+			high = middle;
+
+		}
+
+	}
+
+	if (low < chunkCount && !IsBefore(target, chunks[low]))
+	{
+
+		return low;
+
+	}
+
+	return -1;
+
+}
+
+void ChunkMeshFile::getPacker(int i, VertexPacker& packer) const
+{
+
+	float origin[3];
+
+	for (int a = 0; a < 3; a++)
+	{
+
+		origin[a] = chunks[i].coords[a] * chunkExtent;
+
+	}
+
+	packer.setBox(origin, chunkExtent);
+
+}
+
+unsigned int ChunkMeshFile::getVertexSize(ChunkVertexFormat format)
+{
+
+	return format == CHUNK_VERTEX_PACKED ? sizeof(PackedVertex) : sizeof(MeshVertex);
+
+}
+
+bool ChunkMeshFile::IsBefore(const ChunkEntry& a, const ChunkEntry& b)
+{
+
+	if (a.coords[2] != b.coords[2])
+	{
+
+		return a.coords[2] < b.coords[2];
+
+	}
+
+	if (a.coords[1] != b.coords[1])
+	{
+
+		return a.coords[1] < b.coords[1];
+
+	}
+
+	return a.coords[0] < b.coords[0];
+
+}
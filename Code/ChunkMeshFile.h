@@ -0,0 +1,108 @@
+// Chunk mesh file
+// Binary file of pre-generated terrain chunks, laid out so it can be memory mapped and used without parsing or copying
+// The header fills the first page, followed by each chunk's vertex and index blobs, then a page aligned table of chunk
+// entries sorted by chunk coordinate; vertices are stored as MeshVertex or PackedVertex, so a blob can be handed straight to a vertex buffer
+#ifndef _CHUNK_MESH_FILE_H_
+#define _CHUNK_MESH_FILE_H_
+
+#include "TerrainTypes.h"
+#include "MappedFile.h"
+#include "VertexPacker.h"
+
+// Layout of the vertices in a chunk mesh file
+enum ChunkVertexFormat
+{
+
+	CHUNK_VERTEX_MESH = 0,		// MeshVertex, in mesh space
+	CHUNK_VERTEX_PACKED,		// PackedVertex, relative to the chunk's box
+	CHUNK_VERTEX_FORMAT_COUNT
+
+};
+
+class ChunkMeshFile
+{
+
+public:
+
+	// Written at the start of the file, padded out to pageSize
+	struct Header
+	{
+
+		char magic[4];
+		unsigned int version;
+		unsigned int pageSize;
+		unsigned int vertexSize;
+		unsigned int indexSize;
+		// Width of a chunk in cells
+		unsigned int chunkSize;
+		unsigned int chunkCount;
+		unsigned int vertexFormat;
+		unsigned long long chunkTableOffset;
+		unsigned long long fileSize;
+		// Side of each chunk's box in mesh units; chunk (x, y, z) spans coords * chunkExtent to (coords + 1) * chunkExtent
+		float chunkExtent;
+		unsigned int padding;
+
+	};
+
+	// One entry of the chunk table; offsets are from the start of the file
+	struct ChunkEntry
+	{
+
+		int coords[3];
+		unsigned int vertexCount;
+		unsigned int indexCount;
+		unsigned int padding;
+		unsigned long long vertexOffset;
+		unsigned long long indexOffset;
+		float boundsMin[3];
+		float boundsMax[3];
+
+	};
+
+	ChunkMeshFile();
+
+	// Map the file and check its header and chunk table; returns false if it isn't a valid chunk mesh file
+	// The blobs themselves aren't read, so their pages are only loaded once they are used
+	bool Open(const char* path);
+	void Close();
+	bool isOpen() const;
+
+	int getChunkCount() const;
+	int getChunkSize() const;
+	float getChunkExtent() const;
+	ChunkVertexFormat getVertexFormat() const;
+	const ChunkEntry& getChunk(int i) const;
+	// Pointers into the mapped file, valid until it is closed
+	// getVertices is for CHUNK_VERTEX_MESH files and getPackedVertices for CHUNK_VERTEX_PACKED ones
+	const MeshVertex* getVertices(int i) const;
+	const PackedVertex* getPackedVertices(int i) const;
+	const unsigned int* getIndices(int i) const;
+	// Index of the chunk at the given chunk coordinate, or -1 if the file has none there
+	int FindChunk(int x, int y, int z) const;
+	// Set the packer to the chunk's box, for unpacking its vertices
+	void getPacker(int i, VertexPacker& packer) const;
+
+	// Size in bytes of one vertex in the given format
+	static unsigned int getVertexSize(ChunkVertexFormat format);
+
+	// Orders chunk entries by Z, then Y, then X, the order of the chunk table
+	static bool IsBefore(const ChunkEntry& a, const ChunkEntry& b);
+
+	static const unsigned int version;
+	static const unsigned int pageSize = 4096;
+	// Every vertex and index blob starts on a multiple of this
+	static const unsigned int blobAlignment = 64;
+
+private:
+
+	MappedFile file;
+	const ChunkEntry* chunks;
+	int chunkCount;
+	int chunkSize;
+	float chunkExtent;
+	ChunkVertexFormat vertexFormat;
+
+};
+
+#endif // !_CHUNK_MESH_FILE_H_
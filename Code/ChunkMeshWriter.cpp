@@ -0,0 +1,248 @@
+#include "ChunkMeshWriter.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+ChunkMeshWriter::ChunkMeshWriter()
+{
+
+	offset = 0;
+	vertexCount = 0;
+	indexCount = 0;
+	chunkSize = 0;
+	chunkExtent = 0.0f;
+	vertexFormat = CHUNK_VERTEX_MESH;
+
+}
+
+ChunkMeshWriter::~ChunkMeshWriter()
+{
+
+	if (file.is_open())
+	{
+
+		Close();
+
+	}
+
+}
+
+bool ChunkMeshWriter::Open(const char* path, int lchunkSize, float lchunkExtent, ChunkVertexFormat lvertexFormat)
+{
+
+	file.open(path, std::ofstream::binary | std::ofstream::trunc);
+
+	if (!file.is_open())
+	{
+
+		return false;
+
+	}
+
+	chunks.clear();
+	offset = 0;
+	vertexCount = 0;
+	indexCount = 0;
+	chunkSize = lchunkSize;
+	chunkExtent = lchunkExtent;
+	vertexFormat = lvertexFormat;
+
+	// The header page is written as zeros and filled in by Close
+	std::vector<char> headerPage(ChunkMeshFile::pageSize, 0);
+	file.write(headerPage.data(), headerPage.size());
+	offset = headerPage.size();
+
+	return file.good();
+
+}
+
+void ChunkMeshWriter::Write(int x, int y, int z, const MeshVertex* vertices, unsigned int lvertexCount, const unsigned int* indices, unsigned int lindexCount)
+{
+
+	ChunkMeshFile::ChunkEntry chunk;
+	memset(&chunk, 0, sizeof(chunk));
+	chunk.coords[0] = x;
+	chunk.coords[1] = y;
+	chunk.coords[2] = z;
+	chunk.vertexCount = lvertexCount;
+	chunk.indexCount = lindexCount;
+
+	// Bounds are worked out before taking the lock, as they only read the caller's vertices
+	for (int a = 0; a < 3; a++)
+	{
+
+		chunk.boundsMin[a] = lvertexCount > 0 ? FLT_MAX : 0.0f;
+		chunk.boundsMax[a] = lvertexCount > 0 ? -FLT_MAX : 0.0f;
+
+	}
+
+	for (unsigned int i = 0; i < lvertexCount; i++)
+	{
+
+		for (int a = 0; a < 3; a++)
+		{
+
+			chunk.boundsMin[a] = std::min(chunk.boundsMin[a], vertices[i].position[a]);
+			chunk.boundsMax[a] = std::max(chunk.boundsMax[a], vertices[i].position[a]);
+
+		}
+
+	}
+
+	WriteChunk(chunk, vertices, indices);
+
+}
+
+void ChunkMeshWriter::Write(int x, int y, int z, const PackedVertex* vertices, unsigned int lvertexCount, const unsigned int* indices, unsigned int lindexCount)
+{
+
+	ChunkMeshFile::ChunkEntry chunk;
+	memset(&chunk, 0, sizeof(chunk));
+	chunk.coords[0] = x;
+	chunk.coords[1] = y;
+	chunk.coords[2] = z;
+	chunk.vertexCount = lvertexCount;
+	chunk.indexCount = lindexCount;
+
+	// Bounds are kept in mesh space, so they mean the same in either format
+	unsigned short quantisedMin[3] = { 0xFFFF, 0xFFFF, 0xFFFF };
+	unsigned short quantisedMax[3] = { 0, 0, 0 };
+
+	for (unsigned int i = 0; i < lvertexCount; i++)
+	{
+
+		for (int a = 0; a < 3; a++)
+		{
+
+			quantisedMin[a] = std::min(quantisedMin[a], vertices[i].position[a]);
+			quantisedMax[a] = std::max(quantisedMax[a], vertices[i].position[a]);
+
+		}
+
+	}
+
+	for (int a = 0; a < 3; a++)
+	{
+
+		float origin = chunk.coords[a] * chunkExtent;
+		chunk.boundsMin[a] = lvertexCount > 0 ? origin + quantisedMin[a] / 65535.0f * chunkExtent : 0.0f;
+		chunk.boundsMax[a] = lvertexCount > 0 ? origin + quantisedMax[a] / 65535.0f * chunkExtent : 0.0f;
+
+	}
+
+	WriteChunk(chunk, vertices, indices);
+
+}
+
+void ChunkMeshWriter::WriteChunk(ChunkMeshFile::ChunkEntry& chunk, const void* vertices, const unsigned int* indices)
+{
+
+	unsigned long long vertexBytes = (unsigned long long)chunk.vertexCount * ChunkMeshFile::getVertexSize(vertexFormat);
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	Pad(ChunkMeshFile::blobAlignment);
+	chunk.vertexOffset = offset;
+	file.write(reinterpret_cast<const char*>(vertices), (std::streamsize)vertexBytes);
+	offset += vertexBytes;
+
+	Pad(ChunkMeshFile::blobAlignment);
+	chunk.indexOffset = offset;
+	file.write(reinterpret_cast<const char*>(indices), (std::streamsize)chunk.indexCount * sizeof(unsigned int));
+	offset += (unsigned long long)chunk.indexCount * sizeof(unsigned int);
+
+	chunks.push_back(chunk);
+	vertexCount += chunk.vertexCount;
+	indexCount += chunk.indexCount;
+
+}
+
+bool ChunkMeshWriter::Close()
+{
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// Chunks arrive in whatever order their jobs finish; the table is sorted so readers can binary search it
+	std::sort(chunks.begin(), chunks.end(), ChunkMeshFile::IsBefore);
+
+	Pad(ChunkMeshFile::pageSize);
+
+	ChunkMeshFile::Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "MCCM", 4);
+	header.version = ChunkMeshFile::version;
+	header.pageSize = ChunkMeshFile::pageSize;
+	header.vertexSize = ChunkMeshFile::getVertexSize(vertexFormat);
+	header.indexSize = sizeof(unsigned int);
+	header.chunkSize = (unsigned int)chunkSize;
+	header.chunkCount = (unsigned int)chunks.size();
+	header.vertexFormat = vertexFormat;
+	header.chunkExtent = chunkExtent;
+	header.chunkTableOffset = offset;
+	header.fileSize = offset + chunks.size() * sizeof(ChunkMeshFile::ChunkEntry);
+
+	file.write(reinterpret_cast<const char*>(chunks.data()), (std::streamsize)(chunks.size() * sizeof(ChunkMeshFile::ChunkEntry)));
+	offset = header.fileSize;
+
+	file.seekp(0);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	bool isGood = file.good();
+	file.close();
+
+	return isGood;
+
+}
+
+void ChunkMeshWriter::Pad(unsigned long long alignment)
+{
+
+	static const char zeros[ChunkMeshFile::pageSize] = {};
+	unsigned long long padding = (alignment - offset % alignment) % alignment;
+
+	file.write(zeros, (std::streamsize)padding);
+	offset += padding;
+
+}
+
+ChunkVertexFormat ChunkMeshWriter::getVertexFormat() const
+{
+
+	return vertexFormat;
+
+}
+
+float ChunkMeshWriter::getChunkExtent() const
+{
+
+	return chunkExtent;
+
+}
+
+int ChunkMeshWriter::getChunkCount() const
+{
+
+	return (int)chunks.size();
+
+}
+
+unsigned long long ChunkMeshWriter::getVertexCount() const
+{
+
+	return vertexCount;
+
+}
+
+unsigned long long ChunkMeshWriter::getIndexCount() const
+{
+
+	return indexCount;
+
+}
+
+unsigned long long ChunkMeshWriter::getFileSize() const
+{
+
+	return offset;
+
+}
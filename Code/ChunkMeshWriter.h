@@ -0,0 +1,56 @@
+// Chunk mesh writer
+// Streams chunks into a ChunkMeshFile as they are generated; only the chunk table is kept in memory,
+// and it is sorted and written after the blobs when the file is closed
+#ifndef _CHUNK_MESH_WRITER_H_
+#define _CHUNK_MESH_WRITER_H_
+
+#include <fstream>
+#include <mutex>
+#include <vector>
+#include "ChunkMeshFile.h"
+
+class ChunkMeshWriter
+{
+
+public:
+
+	ChunkMeshWriter();
+	~ChunkMeshWriter();
+
+	// Create the file for chunks chunkSize cells and chunkExtent mesh units wide; returns false if it can't be created
+	bool Open(const char* path, int chunkSize, float chunkExtent, ChunkVertexFormat vertexFormat);
+	// Append one chunk's vertices and triangle list indices; safe to call from several threads, in any order
+	// The vertices must be in the format the file was opened with, and packed vertices relative to the chunk's box
+	void Write(int x, int y, int z, const MeshVertex* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	void Write(int x, int y, int z, const PackedVertex* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	// Write the chunk table and the final header; returns false if any write failed
+	bool Close();
+
+	ChunkVertexFormat getVertexFormat() const;
+	float getChunkExtent() const;
+	int getChunkCount() const;
+	unsigned long long getVertexCount() const;
+	unsigned long long getIndexCount() const;
+	unsigned long long getFileSize() const;
+
+private:
+
+	// Write the blobs of a chunk whose entry has its coordinates, counts and bounds filled in
+	void WriteChunk(ChunkMeshFile::ChunkEntry& chunk, const void* vertices, const unsigned int* indices);
+	// Write zeros up to the next multiple of alignment; the caller holds the mutex
+	void Pad(unsigned long long alignment);
+
+	std::ofstream file;
+	std::mutex mutex;
+
+	std::vector<ChunkMeshFile::ChunkEntry> chunks;
+	unsigned long long offset;
+	unsigned long long vertexCount;
+	unsigned long long indexCount;
+	int chunkSize;
+	float chunkExtent;
+	ChunkVertexFormat vertexFormat;
+
+};
+
+#endif // !_CHUNK_MESH_WRITER_H_
@@ -0,0 +1,56 @@
+// Compute backend
+// Interface over the stages of generating a mesh: volume allocation, noise dispatch, surface extraction and mesh buffers
+// D3D11ComputeBackend runs them with the GPU shaders; CPUComputeBackend runs them on worker threads with no graphics API,
+// so the same driving code (App1::Run, the headless generator) works with either
+#ifndef _COMPUTE_BACKEND_H_
+#define _COMPUTE_BACKEND_H_
+
+#include "TerrainTypes.h"
+
+// Receives the mesh produced by a backend
+// EmptyMesh implements this for rendering; a backend calls whichever function matches where its mesh lives
+class MeshTarget
+{
+
+public:
+
+	virtual ~MeshTarget() {}
+
+	// Vertices in system memory, copied by the target
+	virtual void setVertices(const MeshVertex* vertices, int vertexCount) = 0;
+	// A vertex buffer already on the GPU (an ID3D11Buffer for the D3D11 backend), referenced rather than copied
+	// A vertex count of 0 means the count is only known to the GPU, so the buffer must be drawn with DrawAuto()
+	virtual void setVertexBuffer(void* nativeBuffer, int vertexCount) = 0;
+
+};
+
+class ComputeBackend
+{
+
+public:
+
+	virtual ~ComputeBackend() {}
+
+	// Allocate the density volume and any per size resources; does nothing if the size is unchanged
+	virtual void AllocateVolume(int x, int y, int z) = 0;
+	// Fill the volume with fBm noise
+	// Backends may defer the work until the volume is next read, as a GPU command would be
+	virtual void DispatchNoise(const NoiseParameters& parameters) = 0;
+	// Extract the isosurface of the volume into the backend's mesh buffer
+	// It can be called again with a new isovalue or scale to re-extract the same volume without dispatching the noise again
+	virtual void ExtractSurface(float isoValue, float meshScaleFactor) = 0;
+	// Hand the mesh buffer to a target; it stays valid until the next ExtractSurface
+	virtual void BindMesh(MeshTarget& target) = 0;
+	// Free the volume once no more extractions from it are needed; the mesh buffer is kept
+	virtual void ReleaseVolume() = 0;
+	// Check, without waiting, whether an earlier extraction turned out to overflow its mesh buffer
+	// If it did, the mesh is missing triangles and the caller should generate it again, into a buffer sized to fit
+	virtual bool PollOverflow() = 0;
+
+	// Number of vertices in the mesh buffer, or 0 if only the GPU knows
+	virtual int getVertexCount() const = 0;
+	virtual const char* getName() const = 0;
+
+};
+
+#endif // !_COMPUTE_BACKEND_H_
@@ -0,0 +1,418 @@
+#include "D3D11ComputeBackend.h"
+
+D3D11ComputeBackend::D3D11ComputeBackend(ID3D11Device* ldevice, ID3D11DeviceContext* ldeviceContext, HWND hwnd, ID3D11ShaderResourceView* triTableTexture, ID3D11Buffer* packedTriTable)
+{
+
+	device = ldevice;
+	deviceContext = ldeviceContext;
+
+	gradientNoiseShader = new GradientNoise(device, hwnd);
+	marchingCubesShader = new MCShader(device, deviceContext, hwnd);
+	marchingCubesComputeShader = new MCComputeShader(device, hwnd);
+
+	marchingCubesShader->setTriTableTexture(triTableTexture);
+	marchingCubesShader->setPackedTriTable(packedTriTable);
+	marchingCubesComputeShader->setTriTableTexture(triTableTexture);
+
+	isComputeExtraction = false;
+	isVolumeAllocated = false;
+
+	isDeferred = false;
+	isExtractionPending = false;
+	meshBuffers[0] = nullptr;
+	meshBuffers[1] = nullptr;
+	meshBufferSizes[0] = 0;
+	meshBufferSizes[1] = 0;
+	meshBufferIndex = 0;
+	meshVertexCount = 0;
+
+	isoValue = 0.0f;
+	meshScaleFactor = 1.0f;
+
+	dimsX = 0;
+	dimsY = 0;
+	dimsZ = 0;
+
+}
+
+D3D11ComputeBackend::~D3D11ComputeBackend()
+{
+
+	if (gradientNoiseShader)
+	{
+
+		delete gradientNoiseShader;
+		gradientNoiseShader = 0;
+
+	}
+
+	if (marchingCubesShader)
+	{
+
+		delete marchingCubesShader;
+		marchingCubesShader = 0;
+
+	}
+
+	if (marchingCubesComputeShader)
+	{
+
+		delete marchingCubesComputeShader;
+		marchingCubesComputeShader = 0;
+
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+
+		if (meshBuffers[i])
+		{
+
+			meshBuffers[i]->Release();
+			meshBuffers[i] = 0;
+
+		}
+
+	}
+
+}
+
+void D3D11ComputeBackend::AllocateVolume(int x, int y, int z)
+{
+
+	if (isVolumeAllocated && x == dimsX && y == dimsY && z == dimsZ)
+	{
+
+		return;
+
+	}
+
+	ReleaseVolume();
+
+	dimsX = x;
+	dimsY = y;
+	dimsZ = z;
+
+	// Create the noise texture
+	gradientNoiseShader->UpdateMeshValues(dimsX, dimsY, dimsZ);
+
+	isVolumeAllocated = true;
+
+}
+
+void D3D11ComputeBackend::DispatchNoise(const NoiseParameters& parameters)
+{
+
+	// Update the noise shader's parameters, then run it
+	gradientNoiseShader->UpdateNoiseValues(parameters.amplitude, parameters.frequency, parameters.persistence, parameters.octaves, parameters.meshScaleFactor,
+		XMFLOAT3(parameters.noiseScaleFactors[0], parameters.noiseScaleFactors[1], parameters.noiseScaleFactors[2]),
+		XMFLOAT3(parameters.noiseOffsets[0], parameters.noiseOffsets[1], parameters.noiseOffsets[2]),
+		parameters.isRidged, parameters.isSimplex, parameters.heightBase, parameters.heightMultiplier, parameters.isHashed, parameters.seed);
+
+	gradientNoiseShader->Run(deviceContext);
+
+}
+
+void D3D11ComputeBackend::ExtractSurface(float liso, float lscale)
+{
+
+	isoValue = liso;
+	meshScaleFactor = lscale;
+
+	DispatchExtraction();
+
+	if (isDeferred)
+	{
+
+		// The compute passes' vertex count is copied back alongside the extraction and read once it arrives
+		if (isComputeExtraction)
+		{
+
+			marchingCubesComputeShader->requestTriangleCount(deviceContext);
+
+		}
+
+		isExtractionPending = true;
+		return;
+
+	}
+
+	// The scanned total is exact, so one rerun into a regrown buffer is always enough
+	if (isComputeExtraction && marchingCubesComputeShader->checkOverflow(deviceContext))
+	{
+
+		marchingCubesComputeShader->reInitOutputBuffer(dimsX, dimsY, dimsZ);
+		marchingCubesComputeShader->Run(deviceContext);
+		marchingCubesComputeShader->checkOverflow(deviceContext);
+
+	}
+
+	// Whether the stream output buffer was big enough is only known once the GPU gets there; see PollOverflow
+
+}
+
+void D3D11ComputeBackend::DispatchExtraction()
+{
+
+	if (isComputeExtraction)
+	{
+
+		marchingCubesComputeShader->UpdateMeshValues(dimsX, dimsY, dimsZ);
+		marchingCubesComputeShader->UpdateValues(isoValue, meshScaleFactor);
+		marchingCubesComputeShader->reInitOutputBuffer(dimsX, dimsY, dimsZ);
+		marchingCubesComputeShader->setNoiseTexture(gradientNoiseShader->getTexture());
+
+		// Classify, scan and emit
+		marchingCubesComputeShader->Run(deviceContext);
+
+		return;
+
+	}
+
+	// Initialise the output buffer before running the marching cubes shader
+	marchingCubesShader->reInitOutputBuffer(dimsX, dimsY, dimsZ);
+
+	// Then take compute shader texture and input into marching cubes shader, drawing one point per voxel
+	marchingCubesShader->setShaderParameters(deviceContext, gradientNoiseShader->getTexture(), nullptr, isoValue, meshScaleFactor);
+	marchingCubesShader->render(deviceContext, dimsX * dimsY * dimsZ);
+
+}
+
+bool D3D11ComputeBackend::PollOverflow()
+{
+
+	// The compute passes already regrow and rerun within ExtractSurface, from their exact scanned total, and deferred
+	// extractions do the same within PollExtraction
+	if (isComputeExtraction || isDeferred)
+	{
+
+		return false;
+
+	}
+
+	return marchingCubesShader->pollOverflow(deviceContext);
+
+}
+
+bool D3D11ComputeBackend::PollExtraction()
+{
+
+	if (!isExtractionPending)
+	{
+
+		return false;
+
+	}
+
+	bool hasOverflowed = false;
+
+	if (isComputeExtraction)
+	{
+
+		if (!marchingCubesComputeShader->pollTriangleCount(deviceContext, hasOverflowed))
+		{
+
+			return false;
+
+		}
+
+	}
+	else
+	{
+
+		hasOverflowed = marchingCubesShader->pollOverflow(deviceContext);
+
+		if (marchingCubesShader->hasPendingQueries())
+		{
+
+			return false;
+
+		}
+
+	}
+
+	// The output buffer has regrown to fit, so extract again from the same volume and keep waiting
+	if (hasOverflowed && isVolumeAllocated)
+	{
+
+		DispatchExtraction();
+
+		if (isComputeExtraction)
+		{
+
+			marchingCubesComputeShader->requestTriangleCount(deviceContext);
+
+		}
+
+		return false;
+
+	}
+
+	if (isComputeExtraction)
+	{
+
+		CopyMesh(marchingCubesComputeShader->getOutputBuffer(), marchingCubesComputeShader->getVertexCount());
+
+	}
+	else
+	{
+
+		CopyMesh(marchingCubesShader->getOutputBuffer(), marchingCubesShader->getVertexCount());
+
+	}
+
+	isExtractionPending = false;
+
+	return true;
+
+}
+
+void D3D11ComputeBackend::CopyMesh(ID3D11Buffer* source, int vertexCount)
+{
+
+	// The other buffer may still be drawn from, so the copy goes into this one
+	meshBufferIndex = 1 - meshBufferIndex;
+	meshVertexCount = vertexCount;
+
+	UINT size = (UINT)vertexCount * sizeof(MeshVertex);
+
+	if (size == 0)
+	{
+
+		return;
+
+	}
+
+	if (!meshBuffers[meshBufferIndex] || meshBufferSizes[meshBufferIndex] < size)
+	{
+
+		if (meshBuffers[meshBufferIndex])
+		{
+
+			meshBuffers[meshBufferIndex]->Release();
+			meshBuffers[meshBufferIndex] = nullptr;
+
+		}
+
+		D3D11_BUFFER_DESC meshBufferDesc;
+		ZeroMemory(&meshBufferDesc, sizeof(meshBufferDesc));
+		meshBufferDesc.ByteWidth = size;
+		meshBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+		meshBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+		if (device->CreateBuffer(&meshBufferDesc, nullptr, &meshBuffers[meshBufferIndex]) != S_OK)
+		{
+
+			MessageBox(NULL, L"Failed to create mesh buffer", L"D3D11 Compute Backend", MB_OK);
+			exit(0);
+
+		}
+
+		meshBufferSizes[meshBufferIndex] = size;
+
+	}
+
+	// A copy on the GPU, queued behind the extraction, so nothing is read back
+	D3D11_BOX sourceBox = { 0, 0, 0, size, 1, 1 };
+	deviceContext->CopySubresourceRegion(meshBuffers[meshBufferIndex], 0, 0, 0, 0, source, 0, &sourceBox);
+
+}
+
+void D3D11ComputeBackend::BindMesh(MeshTarget& target)
+{
+
+	if (isDeferred)
+	{
+
+		// Copied meshes are drawn with their exact count; an empty one has no buffer to bind
+		if (meshVertexCount == 0)
+		{
+
+			target.setVertices(nullptr, 0);
+
+		}
+		else
+		{
+
+			target.setVertexBuffer(meshBuffers[meshBufferIndex], meshVertexCount);
+
+		}
+
+	}
+	else if (isComputeExtraction)
+	{
+
+		// The vertex count is known from the scan, so the mesh can be drawn with Draw()
+		target.setVertexBuffer(marchingCubesComputeShader->getOutputBuffer(), marchingCubesComputeShader->getVertexCount());
+
+	}
+	else
+	{
+
+		// Only the stream output stage knows how much it wrote, so the mesh is drawn with DrawAuto()
+		target.setVertexBuffer(marchingCubesShader->getOutputBuffer(), 0);
+
+	}
+
+}
+
+void D3D11ComputeBackend::ReleaseVolume()
+{
+
+	// Release redundant resources to reduce memory usage
+	gradientNoiseShader->releaseConstantBuffer();
+	gradientNoiseShader->releaseTexture();
+
+	isVolumeAllocated = false;
+
+}
+
+int D3D11ComputeBackend::getVertexCount() const
+{
+
+	if (isDeferred)
+	{
+
+		return meshVertexCount;
+
+	}
+
+	return isComputeExtraction ? marchingCubesComputeShader->getVertexCount() : 0;
+
+}
+
+const char* D3D11ComputeBackend::getName() const
+{
+
+	return "D3D11";
+
+}
+
+void D3D11ComputeBackend::setComputeExtraction(bool isCompute)
+{
+
+	isComputeExtraction = isCompute;
+
+}
+
+void D3D11ComputeBackend::setDeferred(bool lisDeferred)
+{
+
+	// Anything left pending was extracted under the other mode, and is superseded by the next extraction
+	if (lisDeferred != isDeferred)
+	{
+
+		isExtractionPending = false;
+
+	}
+
+	isDeferred = lisDeferred;
+
+}
+
+void D3D11ComputeBackend::setPackedTriTable(bool isPacked)
+{
+
+	marchingCubesShader->setPackedTriTableEnabled(isPacked);
+
+}
@@ -0,0 +1,78 @@
+// D3D11 compute backend
+// Runs the generation stages on the GPU with the existing shaders: the gradient noise compute shader, then either the
+// marching cubes geometry shader with stream output or the compute shader extraction passes
+// Neither extraction path needs a buffer of cell coordinates; each derives its cells from its vertex or thread IDs
+// Deferred, nothing waits on the GPU: each extraction is left running until PollExtraction finds it complete, then copied
+// into one of two mesh buffers of the backend's own, so the mesh being drawn is never the one being written
+#ifndef _D3D11_COMPUTE_BACKEND_H_
+#define _D3D11_COMPUTE_BACKEND_H_
+
+#include "ComputeBackend.h"
+#include "GradientNoise.h"
+#include "MCShader.h"
+#include "MCComputeShader.h"
+
+class D3D11ComputeBackend : public ComputeBackend
+{
+
+public:
+
+	D3D11ComputeBackend(ID3D11Device* device, ID3D11DeviceContext* deviceContext, HWND hwnd, ID3D11ShaderResourceView* triTableTexture, ID3D11Buffer* packedTriTable);
+	~D3D11ComputeBackend();
+
+	void AllocateVolume(int x, int y, int z);
+	void DispatchNoise(const NoiseParameters& parameters);
+	void ExtractSurface(float isoValue, float meshScaleFactor);
+	void BindMesh(MeshTarget& target);
+	void ReleaseVolume();
+	bool PollOverflow();
+
+	int getVertexCount() const;
+	const char* getName() const;
+
+	// Use the compute shader passes instead of the geometry shader for extraction
+	void setComputeExtraction(bool isCompute);
+	// Have the geometry shader read the packed triangle table instead of the triangle table texture
+	void setPackedTriTable(bool isPacked);
+	// Defer each extraction until PollExtraction finds it complete instead of binding the shaders' output straight away
+	void setDeferred(bool isDeferred);
+	// Check, without waiting, whether the last deferred extraction has finished; it regrows and reruns an overflowing
+	// extraction itself, and returns true once the complete mesh has been copied, after which BindMesh binds it
+	bool PollExtraction();
+
+private:
+
+	// Extract with the current isovalue and scale into the selected shader's output buffer
+	void DispatchExtraction();
+	// Copy a finished extraction into the mesh buffer that isn't being drawn, growing it if needed
+	void CopyMesh(ID3D11Buffer* source, int vertexCount);
+
+	ID3D11Device* device;
+	ID3D11DeviceContext* deviceContext;
+
+	// Shaders
+	GradientNoise* gradientNoiseShader;				// Generates the 3D noise volume which marching cubes will sample
+	MCShader* marchingCubesShader;					// Geometry shader extraction into a stream output buffer
+	MCComputeShader* marchingCubesComputeShader;	// Compute shader extraction into a raw vertex buffer
+
+	bool isComputeExtraction;
+	bool isVolumeAllocated;
+
+	// Deferred extraction state; meshBuffers[meshBufferIndex] holds the last completed mesh
+	bool isDeferred;
+	bool isExtractionPending;
+	ID3D11Buffer* meshBuffers[2];
+	UINT meshBufferSizes[2];
+	int meshBufferIndex;
+	int meshVertexCount;
+
+	float isoValue;
+	float meshScaleFactor;
+
+	int dimsX;
+	int dimsY;
+	int dimsZ;
+
+};
+
+#endif // !_D3D11_COMPUTE_BACKEND_H_
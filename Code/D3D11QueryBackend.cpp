@@ -0,0 +1,192 @@
+#include "D3D11QueryBackend.h"
+#include <cstdlib>
+
+D3D11QueryBackend::D3D11QueryBackend(ID3D11Device* ldevice, ID3D11DeviceContext* ldeviceContext)
+{
+
+	device = ldevice;
+	deviceContext = ldeviceContext;
+
+}
+
+D3D11QueryBackend::~D3D11QueryBackend()
+{
+
+	releaseQueries();
+
+}
+
+ID3D11Query* D3D11QueryBackend::CreateQuery(D3D11_QUERY type)
+{
+
+	ID3D11Query* query = nullptr;
+
+	D3D11_QUERY_DESC queryDesc;
+	ZeroMemory(&queryDesc, sizeof(queryDesc));
+	queryDesc.Query = type;
+	queryDesc.MiscFlags = 0;
+
+	HRESULT result = device->CreateQuery(&queryDesc, &query);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, L"Failed to create query", L"GPU Profiler", MB_OK);
+		exit(0);
+
+	}
+
+	return query;
+
+}
+
+void D3D11QueryBackend::Init(int slotCount)
+{
+
+	releaseQueries();
+
+	slots.resize(slotCount);
+
+	for (int i = 0; i < slotCount; i++)
+	{
+
+		slots[i].disjointQuery = CreateQuery(D3D11_QUERY_TIMESTAMP_DISJOINT);
+
+		for (int stage = 0; stage < PROFILER_STAGE_COUNT; stage++)
+		{
+
+			slots[i].beginQueries[stage] = CreateQuery(D3D11_QUERY_TIMESTAMP);
+			slots[i].endQueries[stage] = CreateQuery(D3D11_QUERY_TIMESTAMP);
+			slots[i].statisticsQueries[stage] = CreateQuery(D3D11_QUERY_PIPELINE_STATISTICS);
+			slots[i].streamOutputQueries[stage] = CreateQuery(D3D11_QUERY_SO_STATISTICS_STREAM0);
+
+		}
+
+	}
+
+}
+
+void D3D11QueryBackend::releaseQueries()
+{
+
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+
+		slots[i].disjointQuery->Release();
+
+		for (int stage = 0; stage < PROFILER_STAGE_COUNT; stage++)
+		{
+
+			slots[i].beginQueries[stage]->Release();
+			slots[i].endQueries[stage]->Release();
+			slots[i].statisticsQueries[stage]->Release();
+			slots[i].streamOutputQueries[stage]->Release();
+
+		}
+
+	}
+
+	slots.clear();
+
+}
+
+void D3D11QueryBackend::BeginFrame(int slot)
+{
+
+	for (int stage = 0; stage < PROFILER_STAGE_COUNT; stage++)
+	{
+
+		slots[slot].isStageRecorded[stage] = false;
+
+	}
+
+	deviceContext->Begin(slots[slot].disjointQuery);
+
+}
+
+void D3D11QueryBackend::EndFrame(int slot)
+{
+
+	deviceContext->End(slots[slot].disjointQuery);
+
+}
+
+void D3D11QueryBackend::BeginStage(int slot, int stage)
+{
+
+	slots[slot].isStageRecorded[stage] = true;
+
+	// Timestamp queries only have an End
+	deviceContext->End(slots[slot].beginQueries[stage]);
+	deviceContext->Begin(slots[slot].statisticsQueries[stage]);
+	deviceContext->Begin(slots[slot].streamOutputQueries[stage]);
+
+}
+
+void D3D11QueryBackend::EndStage(int slot, int stage)
+{
+
+	deviceContext->End(slots[slot].streamOutputQueries[stage]);
+	deviceContext->End(slots[slot].statisticsQueries[stage]);
+	deviceContext->End(slots[slot].endQueries[stage]);
+
+}
+
+bool D3D11QueryBackend::GetResults(int slot, FrameQueryResults& results)
+{
+
+	QuerySlot& querySlot = slots[slot];
+
+	// DONOTFLUSH keeps this a pure poll; S_FALSE means the GPU hasn't got there yet
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjointData;
+	if (deviceContext->GetData(querySlot.disjointQuery, &disjointData, sizeof(disjointData), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+	{
+
+		return false;
+
+	}
+
+	results.frequency = disjointData.Frequency;
+	results.isDisjoint = disjointData.Disjoint == TRUE;
+
+	for (int stage = 0; stage < PROFILER_STAGE_COUNT; stage++)
+	{
+
+		StageQueryResults& stageResults = results.stages[stage];
+		stageResults.isRecorded = querySlot.isStageRecorded[stage];
+
+		if (!stageResults.isRecorded)
+		{
+
+			continue;
+
+		}
+
+		UINT64 beginTimestamp = 0;
+		UINT64 endTimestamp = 0;
+		D3D11_QUERY_DATA_PIPELINE_STATISTICS statisticsData;
+		D3D11_QUERY_DATA_SO_STATISTICS streamOutputData;
+
+		// The disjoint query ended after every stage query, so these should all be ready; bail out if not
+		if (deviceContext->GetData(querySlot.beginQueries[stage], &beginTimestamp, sizeof(beginTimestamp), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+			deviceContext->GetData(querySlot.endQueries[stage], &endTimestamp, sizeof(endTimestamp), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+			deviceContext->GetData(querySlot.statisticsQueries[stage], &statisticsData, sizeof(statisticsData), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+			deviceContext->GetData(querySlot.streamOutputQueries[stage], &streamOutputData, sizeof(streamOutputData), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+		{
+
+			return false;
+
+		}
+
+		stageResults.beginTimestamp = beginTimestamp;
+		stageResults.endTimestamp = endTimestamp;
+		stageResults.csInvocations = statisticsData.CSInvocations;
+		stageResults.gsInvocations = statisticsData.GSInvocations;
+		stageResults.gsPrimitives = statisticsData.GSPrimitives;
+		stageResults.soPrimitivesWritten = streamOutputData.NumPrimitivesWritten;
+		stageResults.soPrimitivesNeeded = streamOutputData.PrimitivesStorageNeeded;
+
+	}
+
+	return true;
+
+}
@@ -0,0 +1,54 @@
+// D3D11 query backend
+// Implements the GPU profiler's queries with ID3D11Query objects:
+// TIMESTAMP_DISJOINT per frame, plus TIMESTAMP pairs, PIPELINE_STATISTICS and SO_STATISTICS per stage
+#ifndef _D3D11_QUERY_BACKEND_H_
+#define _D3D11_QUERY_BACKEND_H_
+
+#include <d3d11.h>
+#include <vector>
+#include "GPUProfiler.h"
+
+class D3D11QueryBackend : public ProfilerQueryBackend
+{
+
+private:
+
+	// All of the queries issued for one frame
+	struct QuerySlot
+	{
+
+		ID3D11Query* disjointQuery;
+		ID3D11Query* beginQueries[PROFILER_STAGE_COUNT];
+		ID3D11Query* endQueries[PROFILER_STAGE_COUNT];
+		ID3D11Query* statisticsQueries[PROFILER_STAGE_COUNT];
+		ID3D11Query* streamOutputQueries[PROFILER_STAGE_COUNT];
+		// Queries of stages the frame didn't bracket were never issued, so they are never read either
+		bool isStageRecorded[PROFILER_STAGE_COUNT];
+
+	};
+
+public:
+
+	D3D11QueryBackend(ID3D11Device* device, ID3D11DeviceContext* deviceContext);
+	~D3D11QueryBackend();
+
+	void Init(int slotCount);
+	void BeginFrame(int slot);
+	void EndFrame(int slot);
+	void BeginStage(int slot, int stage);
+	void EndStage(int slot, int stage);
+	bool GetResults(int slot, FrameQueryResults& results);
+
+private:
+
+	ID3D11Query* CreateQuery(D3D11_QUERY type);
+	void releaseQueries();
+
+	ID3D11Device* device;
+	ID3D11DeviceContext* deviceContext;
+
+	std::vector<QuerySlot> slots;
+
+};
+
+#endif // !_D3D11_QUERY_BACKEND_H_
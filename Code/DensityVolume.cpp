@@ -0,0 +1,150 @@
+#include "DensityVolume.h"
+#include <cmath>
+
+DensityVolume::DensityVolume()
+{
+
+	dimsX = 0;
+	dimsY = 0;
+	dimsZ = 0;
+
+	values = nullptr;
+
+}
+
+DensityVolume::DensityVolume(const DensityVolume& other)
+{
+
+	values = nullptr;
+	*this = other;
+
+}
+
+DensityVolume& DensityVolume::operator=(const DensityVolume& other)
+{
+
+	if (this != &other)
+	{
+
+		data = other.data;
+		values = other.isMapped() ? other.values : data.data();
+
+		dimsX = other.dimsX;
+		dimsY = other.dimsY;
+		dimsZ = other.dimsZ;
+
+	}
+
+	return *this;
+
+}
+
+void DensityVolume::Allocate(int x, int y, int z)
+{
+
+	dimsX = x;
+	dimsY = y;
+	dimsZ = z;
+
+	data.resize((size_t)x * y * z);
+	values = data.data();
+
+}
+
+void DensityVolume::Release()
+{
+
+	dimsX = 0;
+	dimsY = 0;
+	dimsZ = 0;
+
+	std::vector<float>().swap(data);
+	values = nullptr;
+
+}
+
+void DensityVolume::Map(float* lvalues, int x, int y, int z)
+{
+
+	Release();
+
+	dimsX = x;
+	dimsY = y;
+	dimsZ = z;
+	values = lvalues;
+
+}
+
+bool DensityVolume::isMapped() const
+{
+
+	return values != nullptr && values != data.data();
+
+}
+
+float DensityVolume::Sample(float x, float y, float z) const
+{
+
+	// Clamp the sample position to the volume, as the clamped texture sampler would
+	x = fminf(fmaxf(x, 0.0f), (float)(dimsX - 1));
+	y = fminf(fmaxf(y, 0.0f), (float)(dimsY - 1));
+	z = fminf(fmaxf(z, 0.0f), (float)(dimsZ - 1));
+
+	int x0 = (int)x;
+	int y0 = (int)y;
+	int z0 = (int)z;
+	int x1 = x0 + 1 < dimsX ? x0 + 1 : x0;
+	int y1 = y0 + 1 < dimsY ? y0 + 1 : y0;
+	int z1 = z0 + 1 < dimsZ ? z0 + 1 : z0;
+
+	float fx = x - x0;
+	float fy = y - y0;
+	float fz = z - z0;
+
+	// Interpolate along X, then Y, then Z
+	float c00 = get(x0, y0, z0) + (get(x1, y0, z0) - get(x0, y0, z0)) * fx;
+	float c10 = get(x0, y1, z0) + (get(x1, y1, z0) - get(x0, y1, z0)) * fx;
+	float c01 = get(x0, y0, z1) + (get(x1, y0, z1) - get(x0, y0, z1)) * fx;
+	float c11 = get(x0, y1, z1) + (get(x1, y1, z1) - get(x0, y1, z1)) * fx;
+
+	float c0 = c00 + (c10 - c00) * fy;
+	float c1 = c01 + (c11 - c01) * fy;
+
+	return c0 + (c1 - c0) * fz;
+
+}
+
+float* DensityVolume::getData()
+{
+
+	return values;
+
+}
+
+const float* DensityVolume::getData() const
+{
+
+	return values;
+
+}
+
+int DensityVolume::getDimsX() const
+{
+
+	return dimsX;
+
+}
+
+int DensityVolume::getDimsY() const
+{
+
+	return dimsY;
+
+}
+
+int DensityVolume::getDimsZ() const
+{
+
+	return dimsZ;
+
+}
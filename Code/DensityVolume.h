@@ -0,0 +1,67 @@
+// Density volume
+// CPU-side equivalent of the noise shader's R32_FLOAT 3D texture
+// Values are stored with X varying fastest, then Y, then Z, matching the texture's memory layout
+#ifndef _DENSITY_VOLUME_H_
+#define _DENSITY_VOLUME_H_
+
+#include <vector>
+#include <cstddef>
+
+class DensityVolume
+{
+
+public:
+
+	DensityVolume();
+	// Copies take their own copy of owned values, or share the mapping of mapped ones
+	DensityVolume(const DensityVolume& other);
+	DensityVolume& operator=(const DensityVolume& other);
+
+	// Resize the volume; contents are undefined until the noise stage has filled them
+	void Allocate(int x, int y, int z);
+	// Free the volume's memory, leaving it empty
+	void Release();
+	// Use memory owned elsewhere as the volume's values, e.g. a mapped cache file, freeing the volume's own
+	// The memory must stay valid until the volume is allocated, mapped or released again
+	void Map(float* values, int x, int y, int z);
+	bool isMapped() const;
+
+	inline size_t index(int x, int y, int z) const
+	{
+		return ((size_t)z * dimsY + y) * dimsX + x;
+	}
+
+	inline float get(int x, int y, int z) const
+	{
+		return values[index(x, y, z)];
+	}
+
+	inline void set(int x, int y, int z, float value)
+	{
+		values[index(x, y, z)] = value;
+	}
+
+	// Trilinearly filtered sample at a voxel-space position, clamped to the volume's edges
+	// This is the CPU equivalent of sampling the noise texture with the clamped linear sampler
+	float Sample(float x, float y, float z) const;
+
+	float* getData();
+	const float* getData() const;
+
+	int getDimsX() const;
+	int getDimsY() const;
+	int getDimsZ() const;
+
+private:
+
+	// Volumes hold their own storage unless mapped; values points at whichever is in use
+	std::vector<float> data;
+	float* values;
+
+	int dimsX;
+	int dimsY;
+	int dimsZ;
+
+};
+
+#endif // !_DENSITY_VOLUME_H_
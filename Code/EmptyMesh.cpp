@@ -1,11 +1,18 @@
 #include "EmptyMesh.h"
 
 
-EmptyMesh::EmptyMesh(ID3D11Device* device, bool isIndexed, bool isVoxel)
+EmptyMesh::EmptyMesh(ID3D11Device* ldevice, bool isIndexed, bool isVoxel)
 {
 
+	device = ldevice;
+	vertexBuffer = nullptr;
+	indexBuffer = nullptr;
+	ownedVertexBuffer = nullptr;
+	ownedIndexBuffer = nullptr;
+
 	isIndexedMesh = isIndexed;
 	isVoxelMesh = isVoxel;
+	isPackedMesh = false;
 	indexCount = 0;
 
 	topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
@@ -15,7 +22,28 @@ EmptyMesh::EmptyMesh(ID3D11Device* device, bool isIndexed, bool isVoxel)
 EmptyMesh::~EmptyMesh()
 {
 
+	releaseOwnedBuffer();
+
+}
+
+void EmptyMesh::releaseOwnedBuffer()
+{
+
+	if (ownedVertexBuffer)
+	{
+
+		ownedVertexBuffer->Release();
+		ownedVertexBuffer = nullptr;
+
+	}
+
+	if (ownedIndexBuffer)
+	{
+
+		ownedIndexBuffer->Release();
+		ownedIndexBuffer = nullptr;
 
+	}
 
 }
 
@@ -24,7 +52,17 @@ void EmptyMesh::initBuffers(ID3D11DeviceContext* deviceContext, ID3D11Buffer* vB
 
 	// Set the vertex buffer; we've already set up this buffer in another shader
 	// So we just use a pointer to it instead and will call DrawAuto() in the light shader
+	releaseOwnedBuffer();
 	vertexBuffer = vBuffer;
+	isPackedMesh = false;
+
+	// A zero count tells the light shader to use DrawAuto(), in case this mesh previously held CPU vertices
+	if (!isIndexedMesh)
+	{
+
+		indexCount = 0;
+
+	}
 
 	// Alternatively if the mesh was created by a compute shader, we can't call DrawAuto()
 	// Instead we can call DrawIndexed() provided an index buffer
@@ -37,6 +75,144 @@ void EmptyMesh::initBuffers(ID3D11DeviceContext* deviceContext, ID3D11Buffer* vB
 
 }
 
+void EmptyMesh::uploadVertices(const MeshVertex* vertices, int vertexCount)
+{
+
+	releaseOwnedBuffer();
+
+	vertexBuffer = nullptr;
+	isPackedMesh = false;
+	indexCount = vertexCount;
+
+	// An empty mesh has nothing to draw, and D3D11 won't create a zero sized buffer
+	if (vertexCount == 0)
+	{
+
+		return;
+
+	}
+
+	createVertexBuffer(vertices, sizeof(MeshVertex), vertexCount);
+
+}
+
+void EmptyMesh::uploadIndexedVertices(const MeshVertex* vertices, int vertexCount, const unsigned int* indices, int lindexCount)
+{
+
+	uploadVertices(vertices, vertexCount);
+
+	indexBuffer = nullptr;
+	indexCount = lindexCount;
+
+	if (vertexCount == 0 || lindexCount == 0)
+	{
+
+		indexCount = 0;
+		return;
+
+	}
+
+	createIndexBuffer(indices, lindexCount);
+
+}
+
+void EmptyMesh::uploadIndexedVertices(const PackedVertex* vertices, int vertexCount, const unsigned int* indices, int lindexCount)
+{
+
+	releaseOwnedBuffer();
+
+	vertexBuffer = nullptr;
+	indexBuffer = nullptr;
+	isPackedMesh = true;
+	indexCount = lindexCount;
+
+	if (vertexCount == 0 || lindexCount == 0)
+	{
+
+		indexCount = 0;
+		return;
+
+	}
+
+	createVertexBuffer(vertices, sizeof(PackedVertex), vertexCount);
+	createIndexBuffer(indices, lindexCount);
+
+}
+
+void EmptyMesh::createVertexBuffer(const void* vertices, unsigned int vertexSize, int vertexCount)
+{
+
+	D3D11_BUFFER_DESC vertexBufferDesc;
+	ZeroMemory(&vertexBufferDesc, sizeof(vertexBufferDesc));
+	vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	vertexBufferDesc.ByteWidth = vertexSize * vertexCount;
+	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	vertexBufferDesc.CPUAccessFlags = 0;
+	vertexBufferDesc.MiscFlags = 0;
+	vertexBufferDesc.StructureByteStride = 0;
+
+	D3D11_SUBRESOURCE_DATA vertexData;
+	ZeroMemory(&vertexData, sizeof(vertexData));
+	vertexData.pSysMem = vertices;
+
+	HRESULT result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &ownedVertexBuffer);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, L"Failed to create vertex buffer", L"Empty Mesh", MB_OK);
+		exit(0);
+
+	}
+
+	vertexBuffer = ownedVertexBuffer;
+
+}
+
+void EmptyMesh::createIndexBuffer(const unsigned int* indices, int lindexCount)
+{
+
+	D3D11_BUFFER_DESC indexBufferDesc;
+	ZeroMemory(&indexBufferDesc, sizeof(indexBufferDesc));
+	indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	indexBufferDesc.ByteWidth = sizeof(unsigned int) * lindexCount;
+	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	indexBufferDesc.CPUAccessFlags = 0;
+	indexBufferDesc.MiscFlags = 0;
+	indexBufferDesc.StructureByteStride = 0;
+
+	D3D11_SUBRESOURCE_DATA indexData;
+	ZeroMemory(&indexData, sizeof(indexData));
+	indexData.pSysMem = indices;
+
+	HRESULT result = device->CreateBuffer(&indexBufferDesc, &indexData, &ownedIndexBuffer);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, L"Failed to create index buffer", L"Empty Mesh", MB_OK);
+		exit(0);
+
+	}
+
+	indexBuffer = ownedIndexBuffer;
+
+}
+
+void EmptyMesh::setVertices(const MeshVertex* vertices, int vertexCount)
+{
+
+	uploadVertices(vertices, vertexCount);
+
+}
+
+void EmptyMesh::setVertexBuffer(void* nativeBuffer, int vertexCount)
+{
+
+	// The D3D11 backend's buffers are ID3D11Buffers owned by its shaders
+	initBuffers(nullptr, (ID3D11Buffer*)nativeBuffer);
+	indexCount = vertexCount;
+
+}
+
 void EmptyMesh::sendData(ID3D11DeviceContext* deviceContext)
 {
 
@@ -50,6 +226,13 @@ void EmptyMesh::sendData(ID3D11DeviceContext* deviceContext)
 		// The voxel mesh is only outputting position values
 		stride = sizeof(XMFLOAT4);
 
+	}
+	else if (isPackedMesh)
+	{
+
+		// Baked chunks of 16 bit positions and octahedral normals
+		stride = sizeof(PackedVertex);
+
 	}
 	else
 	{
@@ -89,6 +272,13 @@ void EmptyMesh::setIndexCount(int count)
 
 }
 
+bool EmptyMesh::isPacked()
+{
+
+	return isPackedMesh;
+
+}
+
 void EmptyMesh::setTopology(D3D11_PRIMITIVE_TOPOLOGY topologyInput)
 {
 
@@ -5,8 +5,10 @@
 #define _EMPTY_MESH_H_
 
 #include "../DXFramework/BaseMesh.h"
+#include "TerrainTypes.h"
+#include "ComputeBackend.h"
 
-class EmptyMesh
+class EmptyMesh : public MeshTarget
 {
 
 public:
@@ -15,12 +17,24 @@ public:
 	~EmptyMesh();
 
 	void initBuffers(ID3D11DeviceContext* deviceContext, ID3D11Buffer* vertexBuffer, ID3D11Buffer* indexBuffer = NULL);
+	// Creates a vertex buffer owned by this mesh from vertices generated on the CPU
+	// The index count is set to the vertex count, so the mesh is drawn with Draw() rather than DrawAuto()
+	void uploadVertices(const MeshVertex* vertices, int vertexCount);
+	// Creates vertex and index buffers owned by this mesh, e.g. straight from a mapped ChunkMeshFile chunk
+	// The mesh must have been created as indexed; the index count is set so it is drawn with DrawIndexed()
+	void uploadIndexedVertices(const MeshVertex* vertices, int vertexCount, const unsigned int* indices, int indexCount);
+	// As above for PackedVertex chunks, which must be rendered with the light shader's packed variant
+	void uploadIndexedVertices(const PackedVertex* vertices, int vertexCount, const unsigned int* indices, int indexCount);
+	// MeshTarget: receives the output of a compute backend
+	void setVertices(const MeshVertex* vertices, int vertexCount);
+	void setVertexBuffer(void* nativeBuffer, int vertexCount);
 	void sendData(ID3D11DeviceContext* deviceContext);
 	// Will return 0 by default - make sure to set an index count
 	int getIndexCount();
 
 	void setTopology(D3D11_PRIMITIVE_TOPOLOGY topologyInput);
 	void setIndexCount(int count);
+	bool isPacked();
 
 protected:
 
@@ -31,11 +45,24 @@ protected:
 
 	D3D11_PRIMITIVE_TOPOLOGY topology;
 
+	// Only set for meshes uploaded from the CPU; buffers from other sources are released by their owners
+	ID3D11Device* device;
+	ID3D11Buffer* ownedVertexBuffer;
+	ID3D11Buffer* ownedIndexBuffer;
+
 	// Checks to make sure the input assembler stage gets the right info sent to it
 	bool isIndexedMesh;
 	bool isVoxelMesh;
+	bool isPackedMesh;
 	int indexCount;
 
+private:
+
+	void releaseOwnedBuffer();
+	// Create the owned buffers from CPU data; both expect the old ones to have been released
+	void createVertexBuffer(const void* vertices, unsigned int vertexSize, int vertexCount);
+	void createIndexBuffer(const unsigned int* indices, int indexCount);
+
 };
 
 #endif // !_EMPTY_MESH_H_
\ No newline at end of file
@@ -0,0 +1,303 @@
+#include "GPUProfiler.h"
+#include <cstring>
+
+// Weight of the newest frame in the moving averages
+static const double averageWeight = 0.1;
+
+NullQueryBackend::NullQueryBackend(int llatency)
+{
+
+	latency = llatency;
+	framesEnded = 0;
+	memset(&nextResults, 0, sizeof(nextResults));
+	memset(isStageRecorded, 0, sizeof(isStageRecorded));
+	nextResults.frequency = 1000000;
+
+}
+
+void NullQueryBackend::Init(int slotCount)
+{
+
+	slotResults.reset(new FrameQueryResults[slotCount]);
+	slotReadyFrames.reset(new int[slotCount]);
+
+	for (int i = 0; i < slotCount; i++)
+	{
+
+		slotReadyFrames[i] = -1;
+
+	}
+
+}
+
+void NullQueryBackend::BeginFrame(int slot)
+{
+
+	slotReadyFrames[slot] = -1;
+	memset(isStageRecorded, 0, sizeof(isStageRecorded));
+
+}
+
+void NullQueryBackend::EndFrame(int slot)
+{
+
+	// Emulate the GPU running a few frames behind
+	slotResults[slot] = nextResults;
+	slotReadyFrames[slot] = framesEnded + latency;
+	framesEnded++;
+
+	for (int stage = 0; stage < PROFILER_STAGE_COUNT; stage++)
+	{
+
+		slotResults[slot].stages[stage].isRecorded = isStageRecorded[stage];
+
+	}
+
+}
+
+void NullQueryBackend::BeginStage(int, int stage)
+{
+
+	isStageRecorded[stage] = true;
+
+}
+
+void NullQueryBackend::EndStage(int, int)
+{
+
+}
+
+bool NullQueryBackend::GetResults(int slot, FrameQueryResults& results)
+{
+
+	if (slotReadyFrames[slot] < 0 || framesEnded <= slotReadyFrames[slot])
+	{
+
+		return false;
+
+	}
+
+	results = slotResults[slot];
+
+	return true;
+
+}
+
+void NullQueryBackend::setResults(const FrameQueryResults& results)
+{
+
+	nextResults = results;
+
+}
+
+GPUProfiler::GPUProfiler(ProfilerQueryBackend* lbackend, int lslotCount) : backend(lbackend)
+{
+
+	slotCount = lslotCount;
+	currentSlot = 0;
+	oldestPending = 0;
+	pendingFrames = 0;
+	isRecording = false;
+	droppedFrames = 0;
+	lastFrameMilliseconds = 0.0;
+
+	memset(statistics, 0, sizeof(statistics));
+
+	backend->Init(slotCount);
+
+}
+
+void GPUProfiler::BeginFrame()
+{
+
+	// Every slot is still waiting on the GPU, so give up on the oldest rather than stall
+	if (pendingFrames == slotCount)
+	{
+
+		oldestPending = (oldestPending + 1) % slotCount;
+		pendingFrames--;
+		droppedFrames++;
+
+	}
+
+	currentSlot = (oldestPending + pendingFrames) % slotCount;
+	isRecording = true;
+
+	backend->BeginFrame(currentSlot);
+
+}
+
+void GPUProfiler::EndFrame()
+{
+
+	if (!isRecording)
+	{
+
+		return;
+
+	}
+
+	backend->EndFrame(currentSlot);
+
+	isRecording = false;
+	pendingFrames++;
+
+}
+
+void GPUProfiler::BeginStage(ProfilerStage stage)
+{
+
+	if (isRecording)
+	{
+
+		backend->BeginStage(currentSlot, stage);
+
+	}
+
+}
+
+void GPUProfiler::EndStage(ProfilerStage stage)
+{
+
+	if (isRecording)
+	{
+
+		backend->EndStage(currentSlot, stage);
+
+	}
+
+}
+
+int GPUProfiler::Update()
+{
+
+	int resolved = 0;
+
+	// Results come back in submission order, so stop at the first frame that isn't ready
+	while (pendingFrames > 0)
+	{
+
+		FrameQueryResults results;
+
+		if (!backend->GetResults(oldestPending, results))
+		{
+
+			break;
+
+		}
+
+		if (results.isDisjoint || results.frequency == 0)
+		{
+
+			droppedFrames++;
+
+		}
+		else
+		{
+
+			Accumulate(results);
+			resolved++;
+
+		}
+
+		oldestPending = (oldestPending + 1) % slotCount;
+		pendingFrames--;
+
+	}
+
+	return resolved;
+
+}
+
+void GPUProfiler::Accumulate(const FrameQueryResults& results)
+{
+
+	lastFrameMilliseconds = 0.0;
+
+	for (int i = 0; i < PROFILER_STAGE_COUNT; i++)
+	{
+
+		const StageQueryResults& stage = results.stages[i];
+		StageStatistics& stageStatistics = statistics[i];
+
+		if (!stage.isRecorded)
+		{
+
+			continue;
+
+		}
+
+		double milliseconds = 0.0;
+
+		if (stage.endTimestamp > stage.beginTimestamp)
+		{
+
+			milliseconds = (double)(stage.endTimestamp - stage.beginTimestamp) * 1000.0 / (double)results.frequency;
+
+		}
+
+		stageStatistics.lastMilliseconds = milliseconds;
+		lastFrameMilliseconds += milliseconds;
+
+		if (stageStatistics.framesResolved == 0)
+		{
+
+			stageStatistics.averageMilliseconds = milliseconds;
+
+		}
+		else
+		{
+
+			stageStatistics.averageMilliseconds += (milliseconds - stageStatistics.averageMilliseconds) * averageWeight;
+
+		}
+
+		stageStatistics.csInvocations = stage.csInvocations;
+		stageStatistics.gsInvocations = stage.gsInvocations;
+		stageStatistics.gsPrimitives = stage.gsPrimitives;
+		stageStatistics.soPrimitivesWritten = stage.soPrimitivesWritten;
+		stageStatistics.soPrimitivesNeeded = stage.soPrimitivesNeeded;
+		stageStatistics.hasOverflowed = stage.soPrimitivesNeeded > stage.soPrimitivesWritten;
+		stageStatistics.framesResolved++;
+
+	}
+
+}
+
+const StageStatistics& GPUProfiler::getStageStatistics(ProfilerStage stage) const
+{
+
+	return statistics[stage];
+
+}
+
+double GPUProfiler::getLastFrameMilliseconds() const
+{
+
+	return lastFrameMilliseconds;
+
+}
+
+int GPUProfiler::getDroppedFrames() const
+{
+
+	return droppedFrames;
+
+}
+
+const char* GPUProfiler::getStageName(ProfilerStage stage)
+{
+
+	switch (stage)
+	{
+
+	case PROFILER_STAGE_NOISE:
+		return "Noise generation";
+	case PROFILER_STAGE_MARCHING_CUBES:
+		return "Marching cubes";
+	default:
+		return "Unknown";
+
+	}
+
+}
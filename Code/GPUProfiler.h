@@ -0,0 +1,176 @@
+// GPU profiler
+// Measures GPU execution time and pipeline statistics for each stage of the generation pipeline
+// Queries are issued into a ring of slots and read back a few frames later, so reading them never stalls the CPU
+// The queries themselves go through a ProfilerQueryBackend: D3D11QueryBackend on Windows, or NullQueryBackend,
+// which fabricates results so the aggregation logic here can run (and be tested) without a GPU
+#ifndef _GPU_PROFILER_H_
+#define _GPU_PROFILER_H_
+
+#include <memory>
+
+// Stages of App1::Run that are profiled, when it runs on the D3D11 backend
+// Allocating the volume only creates a texture, so has no GPU work of its own to time
+enum ProfilerStage
+{
+
+	PROFILER_STAGE_NOISE = 0,			// D3D11ComputeBackend::DispatchNoise, the GradientNoise shader
+	PROFILER_STAGE_MARCHING_CUBES,		// D3D11ComputeBackend::ExtractSurface, MCShader's or MCComputeShader's passes
+	PROFILER_STAGE_COUNT
+
+};
+
+// Raw query results for one stage, as returned by the backend
+struct StageQueryResults
+{
+
+	// Cleared if the stage wasn't bracketed in the frame, e.g. the noise when only the isovalue changed; the rest is then undefined
+	bool isRecorded;
+
+	unsigned long long beginTimestamp;
+	unsigned long long endTimestamp;
+
+	// Pipeline statistics
+	unsigned long long csInvocations;
+	unsigned long long gsInvocations;
+	unsigned long long gsPrimitives;
+
+	// Stream output statistics
+	unsigned long long soPrimitivesWritten;
+	unsigned long long soPrimitivesNeeded;
+
+};
+
+// Raw query results for one profiled frame
+struct FrameQueryResults
+{
+
+	// Timestamp ticks per second
+	unsigned long long frequency;
+	// If set, the timestamps are unreliable (e.g. the GPU clock changed) and must be discarded
+	bool isDisjoint;
+
+	StageQueryResults stages[PROFILER_STAGE_COUNT];
+
+};
+
+// Aggregated statistics for one stage
+struct StageStatistics
+{
+
+	// Time of the most recently resolved frame, and an exponential moving average
+	double lastMilliseconds;
+	double averageMilliseconds;
+
+	unsigned long long csInvocations;
+	unsigned long long gsInvocations;
+	unsigned long long gsPrimitives;
+	unsigned long long soPrimitivesWritten;
+	unsigned long long soPrimitivesNeeded;
+
+	// Set if the stream output buffer was too small to hold every primitive in the last frame
+	bool hasOverflowed;
+
+	int framesResolved;
+
+};
+
+class ProfilerQueryBackend
+{
+
+public:
+
+	virtual ~ProfilerQueryBackend() {}
+
+	// Create the queries for the given number of ring slots
+	virtual void Init(int slotCount) = 0;
+
+	virtual void BeginFrame(int slot) = 0;
+	virtual void EndFrame(int slot) = 0;
+	virtual void BeginStage(int slot, int stage) = 0;
+	virtual void EndStage(int slot, int stage) = 0;
+
+	// Must not block; returns false if the GPU hasn't finished with this slot yet
+	virtual bool GetResults(int slot, FrameQueryResults& results) = 0;
+
+};
+
+// Backend with no GPU behind it
+// Results become available once a fixed number of further frames have ended, and are filled from values set by the caller
+class NullQueryBackend : public ProfilerQueryBackend
+{
+
+public:
+
+	NullQueryBackend(int latency = 2);
+
+	void Init(int slotCount);
+	void BeginFrame(int slot);
+	void EndFrame(int slot);
+	void BeginStage(int slot, int stage);
+	void EndStage(int slot, int stage);
+	bool GetResults(int slot, FrameQueryResults& results);
+
+	// Results reported for every frame ended from now on, for the stages each frame brackets
+	void setResults(const FrameQueryResults& results);
+
+private:
+
+	FrameQueryResults nextResults;
+	// Stages bracketed in the frame being recorded
+	bool isStageRecorded[PROFILER_STAGE_COUNT];
+	std::unique_ptr<FrameQueryResults[]> slotResults;
+	// Frame count at which each slot's results become available, or -1 while the slot is being recorded
+	std::unique_ptr<int[]> slotReadyFrames;
+	int framesEnded;
+	int latency;
+
+};
+
+class GPUProfiler
+{
+
+public:
+
+	// The profiler takes ownership of the backend
+	// slotCount is how many frames can be in flight before the oldest has to be dropped
+	GPUProfiler(ProfilerQueryBackend* backend, int slotCount = 4);
+
+	void BeginFrame();
+	void EndFrame();
+	// Stages, and EndFrame, outside a frame are ignored
+	void BeginStage(ProfilerStage stage);
+	void EndStage(ProfilerStage stage);
+
+	// Polls the backend for finished frames and folds them into the statistics
+	// Stages a frame didn't bracket keep the statistics of the last frame that did
+	// Returns the number of frames resolved by this call
+	int Update();
+
+	const StageStatistics& getStageStatistics(ProfilerStage stage) const;
+	// Sum of the stage times of the last resolved frame, counting only the stages it bracketed
+	double getLastFrameMilliseconds() const;
+	// Frames dropped because they were disjoint or the ring overflowed before they resolved
+	int getDroppedFrames() const;
+
+	static const char* getStageName(ProfilerStage stage);
+
+private:
+
+	void Accumulate(const FrameQueryResults& results);
+
+	std::unique_ptr<ProfilerQueryBackend> backend;
+
+	StageStatistics statistics[PROFILER_STAGE_COUNT];
+	double lastFrameMilliseconds;
+
+	int slotCount;
+	// Slot of the frame currently being recorded; frames between oldestPending and currentSlot are awaiting results
+	int currentSlot;
+	int oldestPending;
+	int pendingFrames;
+	bool isRecording;
+	int droppedFrames;
+
+};
+
+#endif // !_GPU_PROFILER_H_
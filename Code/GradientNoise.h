@@ -26,6 +26,9 @@ private:
 		int isSimplex;
 		float heightBase;
 		float heightMultiplier;
+		int isHashed;
+		unsigned int seed;
+		XMFLOAT2 padding;
 
 	};
 
@@ -39,7 +42,7 @@ public:
 
 	// Update the noise values when they're changed by user input
 	void UpdateNoiseValues(float amplitude, float frequency, float persistence, int octaves, float meshScaleFactor, XMFLOAT3 noiseScaleFactors, 
-		XMFLOAT3 offsets, bool ridged, bool simplex, float hBase, float hMult);
+		XMFLOAT3 offsets, bool ridged, bool simplex, float hBase, float hMult, bool hashed, unsigned int lseed);
 	// Update the mesh values when the mesh size is changed
 	void UpdateMeshValues(int x, int y, int z);
 
@@ -82,6 +85,9 @@ private:
 	// Height increment values
 	float heightBase;
 	float heightMultiplier;
+	// Hashed gradients in place of the permutation texture, and their seed
+	bool isHashed;
+	unsigned int seed;
 
 	// Mesh size values - determines number of thread groups to dispatch
 	// And hence final output texture size
@@ -0,0 +1,979 @@
+// Headless marching cubes application
+// Command line parsing and the helpers shared by the benchmarks, which live in the Headless*Benchmarks.cpp files
+#include "HeadlessApp.h"
+#include "HeadlessTests.h"
+#include "../CPUComputeBackend.h"
+#include "../VertexWelder.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+HeadlessApp::HeadlessApp()
+{
+
+	mode = "generate";
+	repetitions = 5;
+	maxThreads = (int)std::thread::hardware_concurrency();
+	slabDepth = 8;
+	frames = 600;
+	requestInterval = 10;
+	frameMilliseconds = 16;
+	memoryBudget = 256;
+	outputPath = "terrain.mcvb";
+	cacheDirectory = "volume_cache";
+	cacheSize = 1024;
+	chunkSize = 4;
+	chunkPath = "terrain.mccm";
+	isPackedChunks = false;
+	isOptimizedChunks = false;
+	simplifyRatio = 1.0f;
+	simplifyError = FLT_MAX;
+	extractionMethod = EXTRACTION_MARCHING_CUBES;
+	vertexCount = 0;
+
+	meshSize = 64;
+	dimsX = 0;
+	dimsY = 0;
+	dimsZ = 0;
+	meshScaleFactor = 64.0f / meshSize;
+	noiseScaleFactors[0] = 1.0f;
+	noiseScaleFactors[1] = 2.7f;
+	noiseScaleFactors[2] = 1.0f;
+
+	isovalue = 0.0f;
+
+	frequency = 0.02f;
+	amplitude = 1.0f;
+	octaves = 6;
+	persistence = 0.45f;
+	offsets[0] = offsets[1] = offsets[2] = 0.0f;
+	isSimplex = false;
+	isRidged = false;
+	isHashed = false;
+	seed = 0;
+	heightBase = -0.7f;
+	heightMultiplier = 3.0f;
+
+}
+
+HeadlessApp::~HeadlessApp()
+{
+
+	if (fileStream.is_open())
+	{
+
+		fileStream.close();
+
+	}
+
+}
+
+bool HeadlessApp::init(int argc, char** argv)
+{
+
+	for (int i = 1; i < argc; i++)
+	{
+
+		const char* arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (strcmp(arg, "--bench") == 0 && hasValue)
+		{
+
+			mode = argv[++i];
+
+		}
+		else if (strcmp(arg, "--selftest") == 0)
+		{
+
+			mode = "selftest";
+
+		}
+		else if (strcmp(arg, "--size") == 0 && hasValue)
+		{
+
+			meshSize = atoi(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--dims") == 0 && hasValue)
+		{
+
+			if (sscanf(argv[++i], "%dx%dx%d", &dimsX, &dimsY, &dimsZ) != 3)
+			{
+
+				printUsage();
+				return false;
+
+			}
+
+		}
+		else if (strcmp(arg, "--threads") == 0 && hasValue)
+		{
+
+			maxThreads = atoi(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--slab") == 0 && hasValue)
+		{
+
+			slabDepth = atoi(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--repeat") == 0 && hasValue)
+		{
+
+			repetitions = atoi(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--frames") == 0 && hasValue)
+		{
+
+			frames = atoi(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--interval") == 0 && hasValue)
+		{
+
+			requestInterval = atoi(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--frame-ms") == 0 && hasValue)
+		{
+
+			frameMilliseconds = atoi(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--budget") == 0 && hasValue)
+		{
+
+			memoryBudget = atoi(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--output") == 0 && hasValue)
+		{
+
+			outputPath = argv[++i];
+
+		}
+		else if (strcmp(arg, "--cache") == 0 && hasValue)
+		{
+
+			cacheDirectory = argv[++i];
+
+		}
+		else if (strcmp(arg, "--cache-size") == 0 && hasValue)
+		{
+
+			cacheSize = atoi(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--chunk-size") == 0 && hasValue)
+		{
+
+			chunkSize = atoi(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--chunk-file") == 0 && hasValue)
+		{
+
+			chunkPath = argv[++i];
+
+		}
+		else if (strcmp(arg, "--packed") == 0)
+		{
+
+			isPackedChunks = true;
+
+		}
+		else if (strcmp(arg, "--optimize") == 0)
+		{
+
+			isOptimizedChunks = true;
+
+		}
+		else if (strcmp(arg, "--simplify") == 0 && hasValue)
+		{
+
+			simplifyRatio = (float)atof(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--max-error") == 0 && hasValue)
+		{
+
+			simplifyError = (float)atof(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--extraction") == 0 && hasValue)
+		{
+
+			const char* name = argv[++i];
+
+			if (strcmp(name, "mc") == 0)
+			{
+
+				extractionMethod = EXTRACTION_MARCHING_CUBES;
+
+			}
+			else if (strcmp(name, "nets") == 0)
+			{
+
+				extractionMethod = EXTRACTION_SURFACE_NETS;
+
+			}
+			else if (strcmp(name, "dc") == 0)
+			{
+
+				extractionMethod = EXTRACTION_DUAL_CONTOURING;
+
+			}
+			else
+			{
+
+				printUsage();
+				return false;
+
+			}
+
+		}
+		else if (strcmp(arg, "--isovalue") == 0 && hasValue)
+		{
+
+			isovalue = (float)atof(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--octaves") == 0 && hasValue)
+		{
+
+			octaves = atoi(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--frequency") == 0 && hasValue)
+		{
+
+			frequency = (float)atof(argv[++i]);
+
+		}
+		else if (strcmp(arg, "--simplex") == 0)
+		{
+
+			isSimplex = true;
+
+		}
+		else if (strcmp(arg, "--ridged") == 0)
+		{
+
+			isRidged = true;
+
+		}
+		else if (strcmp(arg, "--hashed") == 0)
+		{
+
+			isHashed = true;
+
+		}
+		else if (strcmp(arg, "--seed") == 0 && hasValue)
+		{
+
+			seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+
+		}
+		else
+		{
+
+			printUsage();
+			return false;
+
+		}
+
+	}
+
+	// Without --dims the volume is a cube; with it, the width takes the place of --size
+	if (dimsX == 0)
+	{
+
+		dimsX = meshSize;
+		dimsY = meshSize;
+		dimsZ = meshSize;
+
+	}
+	else
+	{
+
+		meshSize = dimsX;
+
+	}
+
+	if (meshSize < 2 || dimsY < 2 || dimsZ < 2 || maxThreads < 1 || repetitions < 1 || frames < 1 || requestInterval < 1 || memoryBudget < 1 || cacheSize < 1 || chunkSize < 1)
+	{
+
+		printUsage();
+		return false;
+
+	}
+
+	// Keep sampling the same region of noise regardless of resolution, as App1 does
+	meshScaleFactor = 64.0f / meshSize;
+
+	return true;
+
+}
+
+int HeadlessApp::run()
+{
+
+	if (mode == "selftest")
+	{
+
+		return RunSelfTests() == 0 ? 0 : 1;
+
+	}
+
+	if (mode == "generate")
+	{
+
+		JobScheduler scheduler(maxThreads);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		Run(&scheduler);
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		printf("%dx%dx%d volume: %zu triangles in %.2f ms on %d threads\n", dimsX, dimsY, dimsZ, vertexCount / 3,
+			getMilliseconds(start, end), scheduler.getThreadCount());
+
+	}
+	else if (mode == "scaling")
+	{
+
+		BenchmarkScaling();
+
+	}
+	else if (mode == "latency")
+	{
+
+		BenchmarkLatency();
+
+	}
+	else if (mode == "compute")
+	{
+
+		BenchmarkComputePasses();
+
+	}
+	else if (mode == "shift")
+	{
+
+		BenchmarkShift();
+
+	}
+	else if (mode == "bricks")
+	{
+
+		BenchmarkBricks();
+
+	}
+	else if (mode == "multi")
+	{
+
+		BenchmarkMultipleIsoValues();
+
+	}
+	else if (mode == "signs")
+	{
+
+		BenchmarkSigns();
+
+	}
+	else if (mode == "streaming")
+	{
+
+		BenchmarkStreaming();
+
+	}
+	else if (mode == "outofcore")
+	{
+
+		BenchmarkOutOfCore();
+
+	}
+	else if (mode == "cache")
+	{
+
+		BenchmarkCache();
+
+	}
+	else if (mode == "chunks")
+	{
+
+		BenchmarkChunks();
+
+	}
+	else if (mode == "packed")
+	{
+
+		BenchmarkPackedVertices();
+
+	}
+	else if (mode == "meshopt")
+	{
+
+		BenchmarkMeshOptimization();
+
+	}
+	else if (mode == "simplify")
+	{
+
+		BenchmarkSimplification();
+
+	}
+	else if (mode == "dual")
+	{
+
+		BenchmarkExtractionMethods();
+
+	}
+	else if (mode == "tritable")
+	{
+
+		BenchmarkTriTableLookup();
+
+	}
+	else if (mode == "aniso")
+	{
+
+		BenchmarkAnisotropicVolumes();
+
+	}
+	else if (mode == "apron")
+	{
+
+		BenchmarkAprons();
+
+	}
+	else if (mode == "materials")
+	{
+
+		BenchmarkMaterials();
+
+	}
+	else if (mode == "hash")
+	{
+
+		BenchmarkHashedNoise();
+
+	}
+	else if (mode == "lattice")
+	{
+
+		BenchmarkLatticeNoise();
+
+	}
+	else
+	{
+
+		printUsage();
+		return 1;
+
+	}
+
+	return 0;
+
+}
+
+void HeadlessApp::Run(JobScheduler* scheduler)
+{
+
+	// The same steps as App1::Run, through the CPU compute backend
+	CPUComputeBackend backend(scheduler);
+	GenerationParameters parameters = getGenerationParameters();
+
+	backend.setSlabDepth(slabDepth);
+	backend.setExtractionMethod(parameters.extractionMethod);
+	backend.AllocateVolume(parameters.dimsX, parameters.dimsY, parameters.dimsZ);
+	backend.DispatchNoise(parameters.noise);
+	backend.ExtractSurface(parameters.isoValue, parameters.meshScaleFactor);
+	backend.ReleaseVolume();
+
+	vertexCount = backend.getVertexCount();
+
+}
+
+size_t HeadlessApp::getPeakMemory()
+{
+
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+
+	return counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	// Linux reports the peak resident set in kilobytes
+	return (size_t)usage.ru_maxrss * 1024;
+#endif
+
+}
+
+void HeadlessApp::OpenResults(const std::string& path)
+{
+
+	fileStream = std::ofstream(path, std::ofstream::app);
+
+}
+
+double HeadlessApp::getMilliseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+
+	return std::chrono::duration<double, std::milli>(end - start).count();
+
+}
+
+bool HeadlessApp::IsSameTriangles(const std::vector<MeshVertex>& a, const std::vector<MeshVertex>& b)
+{
+
+	if (a.size() != b.size())
+	{
+
+		return false;
+
+	}
+
+	// Sort both meshes by triangle, comparing the raw bytes of its three vertices
+	const size_t triangleSize = sizeof(MeshVertex) * 3;
+	std::vector<const unsigned char*> trianglesA(a.size() / 3);
+	std::vector<const unsigned char*> trianglesB(b.size() / 3);
+
+	for (size_t i = 0; i < trianglesA.size(); i++)
+	{
+
+		trianglesA[i] = reinterpret_cast<const unsigned char*>(&a[i * 3]);
+		trianglesB[i] = reinterpret_cast<const unsigned char*>(&b[i * 3]);
+
+	}
+
+	auto isLess = [triangleSize](const unsigned char* x, const unsigned char* y) { return memcmp(x, y, triangleSize) < 0; };
+	std::sort(trianglesA.begin(), trianglesA.end(), isLess);
+	std::sort(trianglesB.begin(), trianglesB.end(), isLess);
+
+	for (size_t i = 0; i < trianglesA.size(); i++)
+	{
+
+		if (memcmp(trianglesA[i], trianglesB[i], triangleSize) != 0)
+		{
+
+			return false;
+
+		}
+
+	}
+
+	return true;
+
+}
+
+GenerationParameters HeadlessApp::getGenerationParameters()
+{
+
+	GenerationParameters parameters;
+	parameters.dimsX = dimsX;
+	parameters.dimsY = dimsY;
+	parameters.dimsZ = dimsZ;
+	parameters.noise = getNoiseParameters();
+	parameters.isoValue = isovalue;
+	parameters.meshScaleFactor = meshScaleFactor;
+	parameters.extractionMethod = extractionMethod;
+
+	return parameters;
+
+}
+
+NoiseParameters HeadlessApp::getNoiseParameters()
+{
+
+	NoiseParameters parameters;
+	parameters.amplitude = amplitude;
+	parameters.frequency = frequency;
+	parameters.persistence = persistence;
+	parameters.octaves = octaves;
+	parameters.meshScaleFactor = meshScaleFactor;
+	parameters.noiseOffsets[0] = offsets[0];
+	parameters.noiseOffsets[1] = offsets[1];
+	parameters.noiseOffsets[2] = offsets[2];
+	parameters.noiseScaleFactors[0] = noiseScaleFactors[0];
+	parameters.noiseScaleFactors[1] = noiseScaleFactors[1];
+	parameters.noiseScaleFactors[2] = noiseScaleFactors[2];
+	parameters.isRidged = isRidged;
+	parameters.isSimplex = isSimplex;
+	parameters.heightBase = heightBase;
+	parameters.heightMultiplier = heightMultiplier;
+	parameters.isHashed = isHashed;
+	parameters.seed = seed;
+
+	return parameters;
+
+}
+
+void HeadlessApp::printUsage()
+{
+
+	printf("Usage: headless [options]\n");
+	printf("  --bench <mode>       generate (default), scaling, latency, compute, shift, bricks, multi, signs, streaming, outofcore, cache, chunks, packed, meshopt, simplify, dual, tritable, aniso, apron, materials, hash or lattice\n");
+	printf("  --selftest           run the self-tests of the GPU-facing pieces and exit non-zero if any fail\n");
+	printf("  --size <n>           mesh size in voxels along each axis (default 64)\n");
+	printf("  --dims <x>x<y>x<z>   volume dimensions for generate, any sizes, e.g. 256x64x256; the width replaces --size\n");
+	printf("  --threads <n>        worker threads; the maximum thread count for the scaling benchmark\n");
+	printf("  --slab <n>           Z slices per noise/extraction job (default 8)\n");
+	printf("  --repeat <n>         timed runs averaged per measurement (default 5)\n");
+	printf("  --frames <n>         frames simulated by the latency benchmark (default 600)\n");
+	printf("  --interval <n>       frames between parameter changes in the latency benchmark (default 10)\n");
+	printf("  --frame-ms <n>       simulated vsync interval in the latency benchmark (default 16)\n");
+	printf("  --budget <MB>        memory budget for out-of-core generation (default 256)\n");
+	printf("  --output <path>      mesh file written by out-of-core generation (default terrain.mcvb)\n");
+	printf("  --cache <dir>        directory of the volume cache (default volume_cache)\n");
+	printf("  --cache-size <MB>    size bound of the volume cache (default 1024)\n");
+	printf("  --chunk-size <n>     width in cells of baked chunks (default 4)\n");
+	printf("  --chunk-file <path>  chunk mesh file written and loaded by the chunks benchmark (default terrain.mccm)\n");
+	printf("  --packed             bake chunks with 12 byte packed vertices instead of 28 byte ones\n");
+	printf("  --optimize           reorder baked chunks for the vertex cache and vertex fetch\n");
+	printf("  --simplify <ratio>   simplify baked chunks to this fraction of their triangles (default 1.0)\n");
+	printf("  --max-error <d>      largest simplification error allowed, in mesh units (default unbounded)\n");
+	printf("  --extraction <name>  mc (marching cubes, default), nets (surface nets) or dc (dual contouring)\n");
+	printf("  --isovalue <v>       isovalue for the surface (default 0.0)\n");
+	printf("  --octaves <n>        fBm octaves (default 6)\n");
+	printf("  --frequency <v>      fBm base frequency (default 0.02)\n");
+	printf("  --simplex            use Simplex noise instead of Perlin noise\n");
+	printf("  --ridged             use ridged turbulence\n");
+	printf("  --hashed             hash the noise gradients instead of using the permutation table\n");
+	printf("  --seed <n>           seed of the hashed gradients (default 0)\n");
+
+}
+
+void HeadlessApp::getSortedChunkVertices(const ChunkMeshFile& chunkFile, std::vector<const MeshVertex*>& vertices)
+{
+
+	vertices.clear();
+
+	for (int c = 0; c < chunkFile.getChunkCount(); c++)
+	{
+
+		for (unsigned int v = 0; v < chunkFile.getChunk(c).vertexCount; v++)
+		{
+
+			vertices.push_back(&chunkFile.getVertices(c)[v]);
+
+		}
+
+	}
+
+	auto isLess = [](const MeshVertex* x, const MeshVertex* y) { return memcmp(x->position, y->position, sizeof(x->position)) < 0; };
+	std::sort(vertices.begin(), vertices.end(), isLess);
+
+}
+
+double HeadlessApp::getSeamNormalAngle(const ChunkMeshFile& chunkFile)
+{
+
+	// The copies of a seam vertex in neighbouring chunks sit together once sorted
+	std::vector<const MeshVertex*> vertices;
+	getSortedChunkVertices(chunkFile, vertices);
+
+	double largest = 0.0;
+
+	for (size_t i = 1; i < vertices.size(); i++)
+	{
+
+		const MeshVertex* first = vertices[i - 1];
+		const MeshVertex* second = vertices[i];
+
+		if (memcmp(first->position, second->position, sizeof(first->position)) != 0)
+		{
+
+			continue;
+
+		}
+
+		float dot = first->normal[0] * second->normal[0] + first->normal[1] * second->normal[1] + first->normal[2] * second->normal[2];
+		largest = std::max(largest, acos(std::min(std::max((double)dot, -1.0), 1.0)) * 180.0 / 3.14159265358979);
+
+	}
+
+	return largest;
+
+}
+
+size_t HeadlessApp::CountOpenEdges(const std::vector<MeshVertex>& triangles)
+{
+
+	// Merge by position alone; chunks on either side of a seam give a shared vertex the same position
+	std::vector<MeshVertex> positions(triangles);
+
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+
+		positions[i].normal[0] = 0.0f;
+		positions[i].normal[1] = 0.0f;
+		positions[i].normal[2] = 0.0f;
+
+	}
+
+	VertexWelder welder;
+	std::vector<MeshVertex> vertices;
+	std::vector<unsigned int> indices;
+	welder.Weld(positions.data(), positions.size(), vertices, indices);
+
+	std::vector<unsigned long long> edges;
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+
+		// Triangles with a repeated vertex cover no area, and the simplifier drops them
+		if (indices[i] == indices[i + 1] || indices[i + 1] == indices[i + 2] || indices[i] == indices[i + 2])
+		{
+
+			continue;
+
+		}
+
+		for (int k = 0; k < 3; k++)
+		{
+
+			unsigned long long a = indices[i + k];
+			unsigned long long b = indices[i + (k + 1) % 3];
+			edges.push_back(a < b ? (a << 32) | b : (b << 32) | a);
+
+		}
+
+	}
+
+	std::sort(edges.begin(), edges.end());
+
+	size_t openEdges = 0;
+
+	for (size_t i = 0; i < edges.size();)
+	{
+
+		size_t end = i + 1;
+
+		while (end < edges.size() && edges[end] == edges[i])
+		{
+
+			end++;
+
+		}
+
+		openEdges += end - i == 1 ? 1 : 0;
+		i = end;
+
+	}
+
+	return openEdges;
+
+}
+
+size_t HeadlessApp::CountBorderVertices(const std::vector<unsigned int>& indices, size_t vertexCount)
+{
+
+	// As MeshSimplifier::LockBorders, after dropping the triangles with a repeated vertex as the simplifier does
+	std::vector<unsigned long long> edges;
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+
+		if (indices[i] == indices[i + 1] || indices[i + 1] == indices[i + 2] || indices[i] == indices[i + 2])
+		{
+
+			continue;
+
+		}
+
+		for (int k = 0; k < 3; k++)
+		{
+
+			unsigned long long a = indices[i + k];
+			unsigned long long b = indices[i + (k + 1) % 3];
+			edges.push_back(a < b ? (a << 32) | b : (b << 32) | a);
+
+		}
+
+	}
+
+	std::sort(edges.begin(), edges.end());
+
+	std::vector<bool> isBorder(vertexCount, false);
+
+	for (size_t i = 0; i < edges.size();)
+	{
+
+		size_t end = i + 1;
+
+		while (end < edges.size() && edges[end] == edges[i])
+		{
+
+			end++;
+
+		}
+
+		if (end - i != 2)
+		{
+
+			isBorder[(size_t)(edges[i] >> 32)] = true;
+			isBorder[(size_t)(edges[i] & 0xFFFFFFFF)] = true;
+
+		}
+
+		i = end;
+
+	}
+
+	return (size_t)std::count(isBorder.begin(), isBorder.end(), true);
+
+}
+
+float HeadlessApp::getSurfaceDistance(const DensityVolume& volume, const float* p, float* gradient) const
+{
+
+	// Central differences half a voxel either side, within the trilinear cell around the point
+	const float h = 0.5f;
+	gradient[0] = (volume.Sample(p[0] + h, p[1], p[2]) - volume.Sample(p[0] - h, p[1], p[2])) / (2.0f * h);
+	gradient[1] = (volume.Sample(p[0], p[1] + h, p[2]) - volume.Sample(p[0], p[1] - h, p[2])) / (2.0f * h);
+	gradient[2] = (volume.Sample(p[0], p[1], p[2] + h) - volume.Sample(p[0], p[1], p[2] - h)) / (2.0f * h);
+
+	float length = sqrtf(gradient[0] * gradient[0] + gradient[1] * gradient[1] + gradient[2] * gradient[2]);
+	float offset = fabsf(volume.Sample(p[0], p[1], p[2]) - isovalue);
+
+	return length > 0.0f ? offset / length : 0.0f;
+
+}
+
+float HeadlessApp::getPointTriangleDistanceSquared(const float* p, const float* a, const float* b, const float* c)
+{
+
+	// Closest point by Voronoi region of the triangle (Ericson, Real-Time Collision Detection 5.1.5)
+	float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+	float ap[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+	float d1 = ab[0] * ap[0] + ab[1] * ap[1] + ab[2] * ap[2];
+	float d2 = ac[0] * ap[0] + ac[1] * ap[1] + ac[2] * ap[2];
+	float closest[3];
+
+	float bp[3] = { p[0] - b[0], p[1] - b[1], p[2] - b[2] };
+	float d3 = ab[0] * bp[0] + ab[1] * bp[1] + ab[2] * bp[2];
+	float d4 = ac[0] * bp[0] + ac[1] * bp[1] + ac[2] * bp[2];
+
+	float cp[3] = { p[0] - c[0], p[1] - c[1], p[2] - c[2] };
+	float d5 = ab[0] * cp[0] + ab[1] * cp[1] + ab[2] * cp[2];
+	float d6 = ac[0] * cp[0] + ac[1] * cp[1] + ac[2] * cp[2];
+
+	float vc = d1 * d4 - d3 * d2;
+	float vb = d5 * d2 - d1 * d6;
+	float va = d3 * d6 - d5 * d4;
+
+	if (d1 <= 0.0f && d2 <= 0.0f)
+	{
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+
+			closest[axis] = a[axis];
+
+		}
+
+	}
+	else if (d3 >= 0.0f && d4 <= d3)
+	{
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+
+			closest[axis] = b[axis];
+
+		}
+
+	}
+	else if (d6 >= 0.0f && d5 <= d6)
+	{
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+
+			closest[axis] = c[axis];
+
+		}
+
+	}
+	else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+	{
+
+		float v = d1 / (d1 - d3);
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+
+			closest[axis] = a[axis] + v * ab[axis];
+
+		}
+
+	}
+	else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+	{
+
+		float w = d2 / (d2 - d6);
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+
+			closest[axis] = a[axis] + w * ac[axis];
+
+		}
+
+	}
+	else if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+	{
+
+		float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+
+			closest[axis] = b[axis] + w * (c[axis] - b[axis]);
+
+		}
+
+	}
+	else
+	{
+
+		float denominator = 1.0f / (va + vb + vc);
+		float v = vb * denominator;
+		float w = vc * denominator;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+
+			closest[axis] = a[axis] + ab[axis] * v + ac[axis] * w;
+
+		}
+
+	}
+
+	float dx = p[0] - closest[0];
+	float dy = p[1] - closest[1];
+	float dz = p[2] - closest[2];
+
+	return dx * dx + dy * dy + dz * dz;
+
+}
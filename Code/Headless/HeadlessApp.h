@@ -0,0 +1,185 @@
+// Headless application
+// Runs the CPU generation pipeline without a window or a D3D11 device, for servers and benchmarking
+// Parameters and their defaults match App1
+#ifndef _HEADLESS_APP_H_
+#define _HEADLESS_APP_H_
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include "../CPUPipeline.h"
+#include "../ChunkMeshFile.h"
+
+class HeadlessApp
+{
+
+public:
+
+	HeadlessApp();
+	~HeadlessApp();
+
+	// Parses command line options; returns false if they were invalid
+	bool init(int argc, char** argv);
+
+	// Runs whichever mode was requested on the command line
+	int run();
+
+protected:
+
+	// Run function encapsulating all of the steps necessary to generate a new mesh
+	void Run(JobScheduler* scheduler);
+
+	// Whole volume generation (HeadlessPipelineBenchmarks.cpp)
+	// Times the pipeline for every thread count from 1 to maxThreads
+	void BenchmarkScaling();
+	// Measures frame loop latency while parameter changes trigger regenerations, synchronously and in the background
+	void BenchmarkLatency();
+	// Times the classify/scan/emit passes of the compute shader path against the single pass extractor and checks they match
+	void BenchmarkComputePasses();
+	// Times scrolling a toroidal volume by each shift distance against regenerating the whole volume
+	void BenchmarkShift();
+	// Measures throughput and peak memory of the streaming pipeline, then of the in-core pipeline for comparison
+	void BenchmarkStreaming();
+	// Generates the volume out of core under the memory budget, streaming the mesh to the output file
+	void BenchmarkOutOfCore();
+	// Times a cold start that generates and stores the volume against warm starts that map it from the volume cache
+	void BenchmarkCache();
+	// Finds the band of Y the surface of the --size cube occupies, then generates the same terrain in a volume only that
+	// tall, comparing time, memory and the meshes
+	void BenchmarkAnisotropicVolumes();
+
+	// Extraction from a generated volume (HeadlessExtractionBenchmarks.cpp)
+	// Times brick tree re-extraction against re-extracting every cell over a sweep of isovalues, by active brick fraction
+	void BenchmarkBricks();
+	// Times extracting several isovalues in one pass against one pass per isovalue, and checks the meshes match
+	void BenchmarkMultipleIsoValues();
+	// Times classification and extraction from the packed sign volume against reading the float corners
+	void BenchmarkSigns();
+	// Extracts the standard parameter sets with marching cubes, surface nets and dual contouring, reporting the triangles
+	// and vertices each makes, its extraction time, how far its triangles stray from the isosurface and how many are slivers
+	void BenchmarkExtractionMethods();
+	// Times reading the triangles of every active cell's case from the -1 terminated table, as the geometry shader's
+	// bounds checked texture loads do and as a plain array, against the packed table, and checks all three agree
+	void BenchmarkTriTableLookup();
+	// Checks the material weights packed into each vertex against light_ps.hlsl's rules, and reports the texture samples
+	// the pixel shader can skip with them and what working them out adds to extraction
+	void BenchmarkMaterials();
+
+	// Chunk baking (HeadlessChunkBenchmarks.cpp)
+	// Bakes the volume into a chunk mesh file, then times mapping it and drawing every chunk against reading it into memory
+	void BenchmarkChunks();
+	// Reports the memory and vertex fetch savings of packed vertices at each mesh size up to --size, and their error
+	void BenchmarkPackedVertices();
+	// Bakes chunks with and without the mesh optimizer, reporting vertex cache and fetch statistics and the optimizer's cost
+	void BenchmarkMeshOptimization();
+	// Bakes chunks simplified to a range of triangle ratios, reporting the triangles removed, the distance to the
+	// unsimplified surface, the open edges of the whole terrain (which only rise if a seam opens) and the throughput
+	void BenchmarkSimplification();
+	// Bakes chunks of each size from the shared volume, where chunks fetch their neighbours' voxels, and from per-chunk
+	// volumes with aprons, comparing the voxels generated and the time, and checking the meshes match and where the normals differ
+	void BenchmarkAprons();
+
+	// Noise (HeadlessNoiseBenchmarks.cpp)
+	// Compares the hashed noise bases against the permutation table ones: throughput, value statistics and correlation, and
+	// the time to fill a whole fBm volume with each
+	void BenchmarkHashedNoise();
+	// Times filling the volume a voxel at a time against a lattice cell at a time, for each octave alone and for the whole
+	// fBm at a range of base frequencies, and checks the two give the same densities
+	void BenchmarkLatticeNoise();
+
+	void printUsage();
+
+private:
+
+	NoiseParameters getNoiseParameters();
+	GenerationParameters getGenerationParameters();
+	// Open a benchmark's CSV file as fileStream, appending to the results of earlier runs
+	void OpenResults(const std::string& path);
+	// Milliseconds between two time points
+	static double getMilliseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+	// Stand-in for App1::render: reads every vertex of the front mesh
+	float RenderFrame(const std::vector<MeshVertex>& vertices);
+	// The same for a chunk mesh file, reading every chunk's vertices through its indices
+	static float RenderChunks(const ChunkMeshFile& chunkFile);
+	// Height of vertex i of a blob in either chunk vertex format
+	static float getVertexHeight(const char* vertices, ChunkVertexFormat format, unsigned int i);
+	// Runs the simulated frame loop and reports the frame times in milliseconds
+	void RunFrameLoop(bool isBackground, std::vector<double>& frameTimes, int& meshesSwapped);
+	// Peak resident memory of the process so far, in bytes
+	static size_t getPeakMemory();
+	// True if two meshes hold the same triangles, regardless of the order they were emitted in
+	static bool IsSameTriangles(const std::vector<MeshVertex>& a, const std::vector<MeshVertex>& b);
+	// Edges used by only one triangle of a triangle soup, once vertices at the same position are merged
+	static size_t CountOpenEdges(const std::vector<MeshVertex>& triangles);
+	// Number of vertices of an indexed mesh on an edge not shared by exactly two triangles, which the simplifier locks
+	static size_t CountBorderVertices(const std::vector<unsigned int>& indices, size_t vertexCount);
+	// Every vertex of every chunk of a chunk mesh file in CHUNK_VERTEX_MESH format, sorted by position
+	static void getSortedChunkVertices(const ChunkMeshFile& chunkFile, std::vector<const MeshVertex*>& vertices);
+	// Largest angle in degrees between the normals of vertices at the same position in different chunks of a chunk mesh file
+	static double getSeamNormalAngle(const ChunkMeshFile& chunkFile);
+	// First order distance in voxels from a point in voxel space to the isosurface, |f(p) - isovalue| / |grad f(p)|
+	// The gradient is returned through gradient
+	float getSurfaceDistance(const DensityVolume& volume, const float* p, float* gradient) const;
+	// Squared distance from a point to the closest point of a triangle
+	static float getPointTriangleDistanceSquared(const float* p, const float* a, const float* b, const float* c);
+
+	std::string mode;
+	std::ofstream fileStream;
+
+	// Number of timed runs averaged for each benchmark measurement
+	int repetitions;
+	int maxThreads;
+	int slabDepth;
+	// Frames simulated by the latency benchmark, and how often the parameters change
+	int frames;
+	int requestInterval;
+	// Simulated vsync interval; the frame loop waits out the remainder of each frame like Present would
+	int frameMilliseconds;
+	// Memory budget and mesh file for out-of-core generation
+	int memoryBudget;
+	std::string outputPath;
+	// Directory and size bound of the volume cache
+	std::string cacheDirectory;
+	int cacheSize;
+	// Chunk width and file for chunk mesh baking
+	int chunkSize;
+	std::string chunkPath;
+	bool isPackedChunks;
+	bool isOptimizedChunks;
+	// Chunk simplification; a ratio of 1.0 and an error of FLT_MAX leave chunks unsimplified
+	float simplifyRatio;
+	float simplifyError;
+	// Surface extraction used by generate and the chunk benchmarks
+	ExtractionMethod extractionMethod;
+
+	size_t vertexCount;
+
+	// Values for calculating the isosurface
+	float isovalue;
+	int meshSize;
+	// Volume dimensions for generate; --size sets all three, --dims each separately
+	int dimsX;
+	int dimsY;
+	int dimsZ;
+
+	float meshScaleFactor;
+	float noiseScaleFactors[3];
+
+	// Noise values
+	float frequency;
+	float amplitude;
+	int octaves;
+	float persistence;
+	float offsets[3];
+
+	bool isRidged;
+	bool isSimplex;
+	bool isHashed;
+	unsigned int seed;
+
+	float heightBase;
+	float heightMultiplier;
+
+};
+
+#endif // !_HEADLESS_APP_H_
@@ -0,0 +1,949 @@
+// Headless chunk benchmarks
+// Baking chunk mesh files: mapping and drawing them, packed vertices, the mesh optimizer, simplification and aprons
+#include "HeadlessApp.h"
+#include "../CPUMarchingCubes.h"
+#include "../ChunkMeshWriter.h"
+#include "../MeshOptimizer.h"
+#include "../VertexPacker.h"
+#include "../VertexWelder.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+void HeadlessApp::BenchmarkChunks()
+{
+
+	JobScheduler scheduler(maxThreads);
+	CPUPipeline pipeline(&scheduler);
+	pipeline.setSlabDepth(slabDepth);
+	pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	pipeline.UpdateNoiseValues(getNoiseParameters());
+	pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+	pipeline.setMeshOptimization(isOptimizedChunks);
+	pipeline.setSimplification(simplifyRatio, simplifyError);
+	pipeline.setExtractionMethod(extractionMethod);
+	pipeline.Run();
+
+	// Bake: each chunk is extracted, welded, optionally optimized and streamed to the file by the job that made it
+	ChunkMeshWriter writer;
+
+	if (!writer.Open(chunkPath.c_str(), chunkSize, chunkSize * meshScaleFactor, isPackedChunks ? CHUNK_VERTEX_PACKED : CHUNK_VERTEX_MESH))
+	{
+
+		printf("Couldn't create %s\n", chunkPath.c_str());
+		return;
+
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	pipeline.WriteChunks(chunkSize, writer);
+	bool isWritten = writer.Close();
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	double bakeTime = getMilliseconds(start, end);
+
+	// Mapped load: open and check the file, then draw every chunk, which is the first touch of the blobs
+	double openTime = 0.0;
+	double firstDrawTime = 0.0;
+	float checksum = 0.0f;
+	ChunkMeshFile chunkFile;
+
+	for (int i = 0; i < repetitions; i++)
+	{
+
+		start = std::chrono::steady_clock::now();
+		bool isOpen = chunkFile.Open(chunkPath.c_str());
+		std::chrono::steady_clock::time_point openEnd = std::chrono::steady_clock::now();
+
+		if (!isOpen)
+		{
+
+			printf("Couldn't load %s\n", chunkPath.c_str());
+			return;
+
+		}
+
+		checksum = RenderChunks(chunkFile);
+		end = std::chrono::steady_clock::now();
+
+		openTime += getMilliseconds(start, openEnd);
+		firstDrawTime += getMilliseconds(openEnd, end);
+
+	}
+
+	openTime /= repetitions;
+	firstDrawTime /= repetitions;
+
+	// Read load for comparison: the whole file is read into memory before anything can be drawn
+	double readTime = 0.0;
+	float readChecksum = 0.0f;
+
+	for (int i = 0; i < repetitions; i++)
+	{
+
+		start = std::chrono::steady_clock::now();
+
+		std::ifstream file(chunkPath.c_str(), std::ifstream::binary | std::ifstream::ate);
+		std::vector<char> contents((size_t)file.tellg());
+		file.seekg(0);
+		file.read(contents.data(), contents.size());
+
+		const ChunkMeshFile::Header* header = reinterpret_cast<const ChunkMeshFile::Header*>(contents.data());
+		const ChunkMeshFile::ChunkEntry* chunks = reinterpret_cast<const ChunkMeshFile::ChunkEntry*>(contents.data() + header->chunkTableOffset);
+		readChecksum = 0.0f;
+
+		for (unsigned int c = 0; c < header->chunkCount; c++)
+		{
+
+			const char* chunkVertices = contents.data() + chunks[c].vertexOffset;
+			const unsigned int* chunkIndices = reinterpret_cast<const unsigned int*>(contents.data() + chunks[c].indexOffset);
+
+			for (unsigned int v = 0; v < chunks[c].indexCount; v++)
+			{
+
+				readChecksum += getVertexHeight(chunkVertices, (ChunkVertexFormat)header->vertexFormat, chunkIndices[v]);
+
+			}
+
+		}
+
+		end = std::chrono::steady_clock::now();
+		readTime += getMilliseconds(start, end);
+
+	}
+
+	readTime /= repetitions;
+
+	// Every chunk must be found by its coordinate, and the chunks together must hold the pipeline's triangles
+	// Packed chunks can't match exactly, so they must be within half a quantisation step of the pipeline's positions
+	bool isMatching = checksum == readChecksum;
+	std::vector<MeshVertex> chunkTriangles;
+	VertexPacker packer;
+
+	for (int c = 0; c < chunkFile.getChunkCount(); c++)
+	{
+
+		const ChunkMeshFile::ChunkEntry& chunk = chunkFile.getChunk(c);
+		isMatching = isMatching && chunkFile.FindChunk(chunk.coords[0], chunk.coords[1], chunk.coords[2]) == c;
+		chunkFile.getPacker(c, packer);
+
+		for (unsigned int v = 0; v < chunk.indexCount; v++)
+		{
+
+			MeshVertex vertex;
+			unsigned int index = chunkFile.getIndices(c)[v];
+
+			if (isPackedChunks)
+			{
+
+				packer.Unpack(chunkFile.getPackedVertices(c)[index], vertex);
+
+			}
+			else
+			{
+
+				vertex = chunkFile.getVertices(c)[index];
+
+			}
+
+			chunkTriangles.push_back(vertex);
+
+		}
+
+	}
+
+	bool isSimplified = simplifyRatio < 1.0f || simplifyError < FLT_MAX;
+
+	if (isSimplified)
+	{
+
+		// Simplified chunks hold fewer triangles by design; only their seams can be checked against the pipeline's mesh
+		// Packed seam vertices are decoded from each chunk's own box, so they can't be merged by position for the check
+		if (!isPackedChunks)
+		{
+
+			isMatching = isMatching && CountOpenEdges(chunkTriangles) == CountOpenEdges(pipeline.getVertices());
+
+		}
+
+	}
+	else if (isPackedChunks)
+	{
+
+		double pipelineSum = 0.0;
+		double chunkSum = 0.0;
+
+		for (size_t i = 0; i < pipeline.getVertices().size(); i++)
+		{
+
+			pipelineSum += (double)pipeline.getVertices()[i].position[0] + pipeline.getVertices()[i].position[1] + pipeline.getVertices()[i].position[2];
+
+		}
+
+		for (size_t i = 0; i < chunkTriangles.size(); i++)
+		{
+
+			chunkSum += (double)chunkTriangles[i].position[0] + chunkTriangles[i].position[1] + chunkTriangles[i].position[2];
+
+		}
+
+		double halfStep = 0.5 * chunkFile.getChunkExtent() / 65535.0;
+		isMatching = isMatching && chunkTriangles.size() == pipeline.getVertices().size() && fabs(pipelineSum - chunkSum) <= 3.0 * halfStep * chunkTriangles.size();
+
+	}
+	else
+	{
+
+		isMatching = isMatching && IsSameTriangles(pipeline.getVertices(), chunkTriangles);
+
+	}
+
+	double megabyte = 1024.0 * 1024.0;
+	double fileMegabytes = writer.getFileSize() / megabyte;
+	double soupMegabytes = pipeline.getVertices().size() * sizeof(MeshVertex) / megabyte;
+
+	OpenResults("chunks.csv");
+
+	fileStream << "mesh size" << "," << "chunk size" << "," << "vertex bytes" << "," << "threads" << "," << "chunks" << "," << "vertices" << "," << "indices" << "," << "file (MB)" << "," << "soup (MB)" << ","
+		<< "bake (ms)" << "," << "open (ms)" << "," << "first draw (ms)" << "," << "read (ms)" << "," << "matching" << std::endl;
+	fileStream << meshSize << "," << chunkSize << "," << ChunkMeshFile::getVertexSize(writer.getVertexFormat()) << "," << scheduler.getThreadCount() << "," << writer.getChunkCount() << "," << writer.getVertexCount() << "," << writer.getIndexCount() << ","
+		<< fileMegabytes << "," << soupMegabytes << "," << bakeTime << "," << openTime << "," << firstDrawTime << "," << readTime << "," << isMatching << std::endl << std::endl;
+
+	printf("%d^3 volume in %d^3 cell chunks of %s vertices on %d threads\n", meshSize, chunkSize, isPackedChunks ? "packed" : "full", scheduler.getThreadCount());
+	printf("  baked %d chunks, %llu vertices and %llu indices, to %s (%.2f MB against %.2f MB unindexed)%s in %.2f ms\n", writer.getChunkCount(),
+		writer.getVertexCount(), writer.getIndexCount(), chunkPath.c_str(), fileMegabytes, soupMegabytes, isWritten ? "" : " - WRITE FAILED", bakeTime);
+	printf("  mapped load:      %10.3f ms to open, %.3f ms to first draw every chunk\n", openTime, firstDrawTime);
+	printf("  read load:        %10.3f ms to read and draw every chunk\n", readTime);
+	printf("  output %s\n", !isMatching ? "DIFFERS" : (!isSimplified ? "matches" : (isPackedChunks ? "simplified, seams not compared" : "simplified with its seams intact")));
+
+}
+
+float HeadlessApp::RenderChunks(const ChunkMeshFile& chunkFile)
+{
+
+	float sum = 0.0f;
+
+	for (int c = 0; c < chunkFile.getChunkCount(); c++)
+	{
+
+		const char* vertices = chunkFile.getVertexFormat() == CHUNK_VERTEX_PACKED ?
+			reinterpret_cast<const char*>(chunkFile.getPackedVertices(c)) : reinterpret_cast<const char*>(chunkFile.getVertices(c));
+		const unsigned int* indices = chunkFile.getIndices(c);
+		unsigned int indexCount = chunkFile.getChunk(c).indexCount;
+
+		for (unsigned int i = 0; i < indexCount; i++)
+		{
+
+			sum += getVertexHeight(vertices, chunkFile.getVertexFormat(), indices[i]);
+
+		}
+
+	}
+
+	return sum;
+
+}
+
+float HeadlessApp::getVertexHeight(const char* vertices, ChunkVertexFormat format, unsigned int i)
+{
+
+	// Packed heights are left quantised, as the input assembler would read them before the vertex shader decodes them
+	if (format == CHUNK_VERTEX_PACKED)
+	{
+
+		return reinterpret_cast<const PackedVertex*>(vertices)[i].position[1];
+
+	}
+
+	return reinterpret_cast<const MeshVertex*>(vertices)[i].position[1];
+
+}
+
+void HeadlessApp::BenchmarkPackedVertices()
+{
+
+	JobScheduler scheduler(maxThreads);
+	CPUMarchingCubes marchingCubes;
+	VertexWelder welder;
+	const double pi = 3.14159265358979;
+
+	OpenResults("packed.csv");
+
+	fileStream << "mesh size" << "," << "triangles" << "," << "full (bytes)" << "," << "packed (bytes)" << "," << "indexed full (bytes)" << "," << "indexed packed (bytes)" << ","
+		<< "full extract (ms)" << "," << "packed extract (ms)" << "," << "max position error (cells)" << "," << "max normal error (degrees)" << std::endl;
+
+	printf("%9s %10s %12s %12s %14s %15s %10s %10s %12s %12s\n", "mesh size", "triangles", "full (MB)", "packed (MB)", "idx full (MB)", "idx packed (MB)",
+		"extract", "packed", "pos err", "normal err");
+
+	// Every size from 32 up to the requested one, doubling each time
+	for (int size = 32; size <= meshSize; size *= 2)
+	{
+
+		float scale = 64.0f / size;
+
+		CPUPipeline pipeline(&scheduler);
+		pipeline.setSlabDepth(slabDepth);
+		pipeline.UpdateMeshValues(size, size, size);
+		pipeline.UpdateNoiseValues(getNoiseParameters());
+		pipeline.UpdateExtractionValues(isovalue, scale);
+		pipeline.Run();
+
+		// The whole volume is one box here; chunks use the same encoding over a smaller box
+		const DensityVolume& volume = pipeline.getVolume();
+		int cells = CPUMarchingCubes::getCellCount(size);
+		float origin[3] = { 0.0f, 0.0f, 0.0f };
+		VertexPacker packer;
+		packer.setBox(origin, cells * scale);
+		marchingCubes.UpdateValues(isovalue, scale);
+
+		std::vector<MeshVertex> fullVertices;
+		std::vector<PackedVertex> packedVertices;
+		double fullExtractTime = 0.0;
+		double packedExtractTime = 0.0;
+
+		for (int i = 0; i < repetitions; i++)
+		{
+
+			fullVertices.clear();
+			packedVertices.clear();
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			marchingCubes.Run(volume, 0, cells, 0, cells, 0, cells, fullVertices);
+			std::chrono::steady_clock::time_point fullEnd = std::chrono::steady_clock::now();
+			marchingCubes.Run(volume, 0, cells, 0, cells, 0, cells, packer, packedVertices);
+			std::chrono::steady_clock::time_point packedEnd = std::chrono::steady_clock::now();
+
+			fullExtractTime += getMilliseconds(start, fullEnd);
+			packedExtractTime += getMilliseconds(fullEnd, packedEnd);
+
+		}
+
+		fullExtractTime /= repetitions;
+		packedExtractTime /= repetitions;
+
+		// Both runs emit the same vertices in the same order, so the error can be measured vertex by vertex
+		double maxPositionError = 0.0;
+		double maxNormalError = 0.0;
+
+		for (size_t v = 0; v < fullVertices.size() && v < packedVertices.size(); v++)
+		{
+
+			MeshVertex unpacked;
+			packer.Unpack(packedVertices[v], unpacked);
+
+			double dot = 0.0;
+
+			for (int a = 0; a < 3; a++)
+			{
+
+				maxPositionError = std::max(maxPositionError, (double)fabsf(unpacked.position[a] - fullVertices[v].position[a]) / scale);
+				dot += (double)unpacked.normal[a] * fullVertices[v].normal[a];
+
+			}
+
+			maxNormalError = std::max(maxNormalError, acos(std::min(1.0, dot)) * 180.0 / pi);
+
+		}
+
+		std::vector<MeshVertex> weldedFull;
+		std::vector<PackedVertex> weldedPacked;
+		std::vector<unsigned int> indices;
+		welder.Weld(fullVertices.data(), fullVertices.size(), weldedFull, indices);
+		welder.Weld(packedVertices.data(), packedVertices.size(), weldedPacked, indices);
+
+		size_t fullBytes = fullVertices.size() * sizeof(MeshVertex);
+		size_t packedBytes = packedVertices.size() * sizeof(PackedVertex);
+		size_t indexedFullBytes = weldedFull.size() * sizeof(MeshVertex) + indices.size() * sizeof(unsigned int);
+		size_t indexedPackedBytes = weldedPacked.size() * sizeof(PackedVertex) + indices.size() * sizeof(unsigned int);
+		double megabyte = 1024.0 * 1024.0;
+
+		fileStream << size << "," << fullVertices.size() / 3 << "," << fullBytes << "," << packedBytes << "," << indexedFullBytes << "," << indexedPackedBytes << ","
+			<< fullExtractTime << "," << packedExtractTime << "," << maxPositionError << "," << maxNormalError << std::endl;
+
+		printf("%9d %10zu %12.2f %12.2f %14.2f %15.2f %8.2fms %8.2fms %12.6f %12.4f\n", size, fullVertices.size() / 3, fullBytes / megabyte, packedBytes / megabyte,
+			indexedFullBytes / megabyte, indexedPackedBytes / megabyte, fullExtractTime, packedExtractTime, maxPositionError, maxNormalError);
+
+	}
+
+	fileStream << std::endl;
+
+	printf("Packed vertices are %zu bytes against %zu (%.0f%% less vertex memory and fetch bandwidth per vertex)\n", sizeof(PackedVertex), sizeof(MeshVertex),
+		100.0 * (1.0 - (double)sizeof(PackedVertex) / sizeof(MeshVertex)));
+
+}
+
+void HeadlessApp::BenchmarkMeshOptimization()
+{
+
+	JobScheduler scheduler(maxThreads);
+	CPUPipeline pipeline(&scheduler);
+	pipeline.setSlabDepth(slabDepth);
+	pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	pipeline.UpdateNoiseValues(getNoiseParameters());
+	pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+	pipeline.Run();
+
+	ChunkVertexFormat format = isPackedChunks ? CHUNK_VERTEX_PACKED : CHUNK_VERTEX_MESH;
+	MeshOptimizer optimizer;
+	double bakeTimes[2] = { 0.0, 0.0 };
+	double heightSums[2] = { 0.0, 0.0 };
+	unsigned long long indexCounts[2] = { 0, 0 };
+	double optimizeTime = 0.0;
+
+	OpenResults("meshopt.csv");
+
+	fileStream << "mesh size" << "," << "chunk size" << "," << "vertex bytes" << "," << "optimized" << "," << "bake (ms)" << "," << "ACMR (16)" << "," << "ATVR (16)" << ","
+		<< "ACMR (32)" << "," << "ATVR (32)" << "," << "overfetch" << std::endl;
+
+	printf("%d^3 volume in %d^3 cell chunks of %s vertices on %d threads\n", meshSize, chunkSize, isPackedChunks ? "packed" : "full", maxThreads);
+	printf("%10s %10s %10s %10s %10s %10s %10s\n", "order", "bake (ms)", "ACMR 16", "ATVR 16", "ACMR 32", "ATVR 32", "overfetch");
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+
+		pipeline.setMeshOptimization(pass == 1);
+
+		std::chrono::steady_clock::time_point start;
+		std::chrono::steady_clock::time_point end;
+
+		for (int i = 0; i < repetitions; i++)
+		{
+
+			ChunkMeshWriter writer;
+
+			if (!writer.Open(chunkPath.c_str(), chunkSize, chunkSize * meshScaleFactor, format))
+			{
+
+				printf("Couldn't create %s\n", chunkPath.c_str());
+				return;
+
+			}
+
+			start = std::chrono::steady_clock::now();
+			pipeline.WriteChunks(chunkSize, writer);
+			writer.Close();
+			end = std::chrono::steady_clock::now();
+			bakeTimes[pass] += getMilliseconds(start, end);
+
+		}
+
+		bakeTimes[pass] /= repetitions;
+
+		ChunkMeshFile chunkFile;
+
+		if (!chunkFile.Open(chunkPath.c_str()))
+		{
+
+			printf("Couldn't load %s\n", chunkPath.c_str());
+			return;
+
+		}
+
+		// Each chunk is its own draw, so the caches start empty for every chunk
+		MeshOptimizer::CacheStatistics small = { 0, 0, 0 };
+		MeshOptimizer::CacheStatistics large = { 0, 0, 0 };
+		unsigned long long bytesFetched = 0;
+		unsigned long long vertexBytes = 0;
+		unsigned int vertexSize = ChunkMeshFile::getVertexSize(format);
+		std::vector<MeshVertex> vertices;
+		std::vector<PackedVertex> packedVertices;
+		std::vector<unsigned int> indices;
+
+		for (int c = 0; c < chunkFile.getChunkCount(); c++)
+		{
+
+			const ChunkMeshFile::ChunkEntry& chunk = chunkFile.getChunk(c);
+			const unsigned int* chunkIndices = chunkFile.getIndices(c);
+			const char* chunkVertices = isPackedChunks ? reinterpret_cast<const char*>(chunkFile.getPackedVertices(c)) : reinterpret_cast<const char*>(chunkFile.getVertices(c));
+
+			MeshOptimizer::CacheStatistics statistics = optimizer.AnalyzeVertexCache(chunkIndices, chunk.indexCount, chunk.vertexCount, 16);
+			small.misses += statistics.misses;
+			small.triangleCount += statistics.triangleCount;
+			small.vertexCount += statistics.vertexCount;
+
+			statistics = optimizer.AnalyzeVertexCache(chunkIndices, chunk.indexCount, chunk.vertexCount, 32);
+			large.misses += statistics.misses;
+			large.triangleCount += statistics.triangleCount;
+			large.vertexCount += statistics.vertexCount;
+
+			bytesFetched += optimizer.AnalyzeVertexFetch(chunkIndices, chunk.indexCount, chunk.vertexCount, vertexSize);
+			vertexBytes += (unsigned long long)chunk.vertexCount * vertexSize;
+			indexCounts[pass] += chunk.indexCount;
+
+			// Reordering must keep every triangle, so the heights of all the corners drawn add up the same
+			for (unsigned int v = 0; v < chunk.indexCount; v++)
+			{
+
+				heightSums[pass] += getVertexHeight(chunkVertices, format, chunkIndices[v]);
+
+			}
+
+			// The optimizer's own cost, single threaded, from the unoptimized order
+			if (pass == 0)
+			{
+
+				indices.assign(chunkIndices, chunkIndices + chunk.indexCount);
+
+				if (isPackedChunks)
+				{
+
+					packedVertices.assign(chunkFile.getPackedVertices(c), chunkFile.getPackedVertices(c) + chunk.vertexCount);
+
+				}
+				else
+				{
+
+					vertices.assign(chunkFile.getVertices(c), chunkFile.getVertices(c) + chunk.vertexCount);
+
+				}
+
+				start = std::chrono::steady_clock::now();
+				optimizer.OptimizeVertexCache(indices.data(), indices.size(), chunk.vertexCount);
+
+				if (isPackedChunks)
+				{
+
+					optimizer.OptimizeVertexFetch(packedVertices, indices);
+
+				}
+				else
+				{
+
+					optimizer.OptimizeVertexFetch(vertices, indices);
+
+				}
+
+				end = std::chrono::steady_clock::now();
+				optimizeTime += getMilliseconds(start, end);
+
+			}
+
+		}
+
+		double smallACMR = small.triangleCount > 0 ? (double)small.misses / small.triangleCount : 0.0;
+		double smallATVR = small.vertexCount > 0 ? (double)small.misses / small.vertexCount : 0.0;
+		double largeACMR = large.triangleCount > 0 ? (double)large.misses / large.triangleCount : 0.0;
+		double largeATVR = large.vertexCount > 0 ? (double)large.misses / large.vertexCount : 0.0;
+		double overfetch = vertexBytes > 0 ? (double)bytesFetched / vertexBytes : 0.0;
+
+		fileStream << meshSize << "," << chunkSize << "," << vertexSize << "," << (pass == 1 ? "yes" : "no") << "," << bakeTimes[pass] << "," << smallACMR << "," << smallATVR << ","
+			<< largeACMR << "," << largeATVR << "," << overfetch << std::endl;
+
+		printf("%10s %10.2f %10.3f %10.3f %10.3f %10.3f %10.3f\n", pass == 1 ? "optimized" : "scan", bakeTimes[pass], smallACMR, smallATVR, largeACMR, largeATVR, overfetch);
+
+	}
+
+	fileStream << std::endl;
+
+	size_t triangleCount = (size_t)(indexCounts[0] / 3);
+	bool isMatching = indexCounts[0] == indexCounts[1] && fabs(heightSums[0] - heightSums[1]) <= 1e-9 * (fabs(heightSums[0]) + 1.0);
+
+	printf("  optimizer:  %.2f ms single threaded for %zu triangles (%.1f ns per triangle), %.2f ms more to bake on %d threads\n", optimizeTime, triangleCount,
+		triangleCount > 0 ? optimizeTime * 1e6 / triangleCount : 0.0, bakeTimes[1] - bakeTimes[0], maxThreads);
+	printf("  %s\n", isMatching ? "triangles match" : "triangles DIFFER");
+
+}
+
+void HeadlessApp::BenchmarkSimplification()
+{
+
+	JobScheduler scheduler(maxThreads);
+	CPUPipeline pipeline(&scheduler);
+	pipeline.setSlabDepth(slabDepth);
+	pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	pipeline.UpdateNoiseValues(getNoiseParameters());
+	pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+	pipeline.Run();
+
+	const DensityVolume& volume = pipeline.getVolume();
+	CPUMarchingCubes marchingCubes;
+	marchingCubes.UpdateValues(isovalue, meshScaleFactor);
+	VertexWelder welder;
+
+	// The seams are checked in mesh space, which packed chunks only reach after rounding, so this bench bakes full vertices
+	const float ratios[] = { 1.0f, 0.5f, 0.25f, 0.1f };
+	const int ratioCount = sizeof(ratios) / sizeof(ratios[0]);
+	double baseBakeTime = 0.0;
+	size_t baseTriangles = 0;
+
+	OpenResults("simplify.csv");
+
+	fileStream << "mesh size" << "," << "chunk size" << "," << "threads" << "," << "target ratio" << "," << "max error" << "," << "triangles" << "," << "removed" << ","
+		<< "bake (ms)" << "," << "simplify (ms)" << "," << "Mtriangles/s" << "," << "mean distance (cells)" << "," << "max distance (cells)" << "," << "vanished vertices" << ","
+		<< "open edges" << std::endl;
+
+	printf("%d^3 volume in %d^3 cell chunks on %d threads\n", meshSize, chunkSize, maxThreads);
+	printf("%8s %12s %9s %11s %13s %12s %14s %14s %9s %11s\n", "ratio", "triangles", "removed", "bake (ms)", "simplify (ms)", "Mtris/s", "mean (cells)", "max (cells)", "vanished",
+		"open edges");
+
+	int chunksX = (CPUMarchingCubes::getCellCount(meshSize) + chunkSize - 1) / chunkSize;
+	size_t lockedVertices = 0;
+	size_t originalVertices = 0;
+
+	for (int r = 0; r < ratioCount; r++)
+	{
+
+		pipeline.setSimplification(ratios[r], simplifyError);
+
+		double bakeTime = 0.0;
+
+		for (int i = 0; i < repetitions; i++)
+		{
+
+			ChunkMeshWriter writer;
+
+			if (!writer.Open(chunkPath.c_str(), chunkSize, chunkSize * meshScaleFactor, CHUNK_VERTEX_MESH))
+			{
+
+				printf("Couldn't create %s\n", chunkPath.c_str());
+				return;
+
+			}
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			pipeline.WriteChunks(chunkSize, writer);
+			writer.Close();
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+			bakeTime += getMilliseconds(start, end);
+
+		}
+
+		bakeTime /= repetitions;
+
+		ChunkMeshFile chunkFile;
+
+		if (!chunkFile.Open(chunkPath.c_str()))
+		{
+
+			printf("Couldn't load %s\n", chunkPath.c_str());
+			return;
+
+		}
+
+		// Distance from every vertex of each unsimplified chunk to its simplified triangles
+		// A chunk that lost all of its triangles has nothing to measure against, so its vertices are counted as vanished instead
+		std::vector<MeshVertex> soup;
+		std::vector<MeshVertex> original;
+		std::vector<unsigned int> originalIndices;
+		std::vector<MeshVertex> triangles;
+		double distanceSum = 0.0;
+		double maxDistance = 0.0;
+		size_t distanceCount = 0;
+		size_t vanishedCount = 0;
+		size_t triangleCount = 0;
+
+		for (int chunkIndex = 0; chunkIndex < chunksX * chunksX * chunksX; chunkIndex++)
+		{
+
+			int xBegin = chunkIndex % chunksX * chunkSize;
+			int yBegin = chunkIndex / chunksX % chunksX * chunkSize;
+			int zBegin = chunkIndex / (chunksX * chunksX) * chunkSize;
+
+			soup.clear();
+			marchingCubes.Run(volume, xBegin, xBegin + chunkSize, yBegin, yBegin + chunkSize, zBegin, zBegin + chunkSize, soup);
+
+			if (soup.empty())
+			{
+
+				continue;
+
+			}
+
+			welder.Weld(soup.data(), soup.size(), original, originalIndices);
+
+			// The share of vertices on a chunk's border bounds how far the chunks can be simplified
+			if (r == 0)
+			{
+
+				lockedVertices += CountBorderVertices(originalIndices, original.size());
+				originalVertices += original.size();
+
+			}
+
+			int c = chunkFile.FindChunk(xBegin / chunkSize, yBegin / chunkSize, zBegin / chunkSize);
+
+			if (c < 0 || chunkFile.getChunk(c).indexCount == 0)
+			{
+
+				vanishedCount += original.size();
+				continue;
+
+			}
+
+			const ChunkMeshFile::ChunkEntry& chunk = chunkFile.getChunk(c);
+			const MeshVertex* chunkVertices = chunkFile.getVertices(c);
+			const unsigned int* chunkIndices = chunkFile.getIndices(c);
+
+			for (unsigned int v = 0; v < chunk.indexCount; v++)
+			{
+
+				triangles.push_back(chunkVertices[chunkIndices[v]]);
+
+			}
+
+			for (size_t v = 0; v < original.size(); v++)
+			{
+
+				const float* p = original[v].position;
+				float best = FLT_MAX;
+
+				for (unsigned int t = 0; t + 2 < chunk.indexCount && best > 0.0f; t += 3)
+				{
+
+					const float* a = chunkVertices[chunkIndices[t]].position;
+					const float* b = chunkVertices[chunkIndices[t + 1]].position;
+					const float* e = chunkVertices[chunkIndices[t + 2]].position;
+
+					// Skip triangles whose bounding box is already further away than the closest one so far
+					float boxDistance = 0.0f;
+
+					for (int axis = 0; axis < 3; axis++)
+					{
+
+						float low = std::min(a[axis], std::min(b[axis], e[axis]));
+						float high = std::max(a[axis], std::max(b[axis], e[axis]));
+						float outside = p[axis] < low ? low - p[axis] : (p[axis] > high ? p[axis] - high : 0.0f);
+						boxDistance += outside * outside;
+
+					}
+
+					if (boxDistance < best)
+					{
+
+						best = std::min(best, getPointTriangleDistanceSquared(p, a, b, e));
+
+					}
+
+				}
+
+				double distance = sqrt((double)best) / meshScaleFactor;
+				distanceSum += distance;
+				maxDistance = std::max(maxDistance, distance);
+				distanceCount++;
+
+			}
+
+			triangleCount += chunk.indexCount / 3;
+
+		}
+
+		if (r == 0)
+		{
+
+			baseBakeTime = bakeTime;
+			baseTriangles = triangleCount;
+
+		}
+
+		size_t openEdges = CountOpenEdges(triangles);
+		double removed = baseTriangles > 0 ? 1.0 - (double)triangleCount / baseTriangles : 0.0;
+		double simplifyTime = bakeTime - baseBakeTime;
+		double throughput = simplifyTime > 0.0 ? baseTriangles / (simplifyTime * 1000.0) : 0.0;
+		double meanDistance = distanceCount > 0 ? distanceSum / distanceCount : 0.0;
+
+		fileStream << meshSize << "," << chunkSize << "," << maxThreads << "," << ratios[r] << "," << simplifyError << "," << triangleCount << "," << removed << ","
+			<< bakeTime << "," << simplifyTime << "," << throughput << "," << meanDistance << "," << maxDistance << "," << vanishedCount << "," << openEdges << std::endl;
+
+		printf("%8.2f %12zu %8.1f%% %11.2f %13.2f %12.2f %14.4f %14.4f %9zu %11zu\n", ratios[r], triangleCount, removed * 100.0, bakeTime, simplifyTime, throughput,
+			meanDistance, maxDistance, vanishedCount, openEdges);
+
+	}
+
+	fileStream << std::endl;
+
+	printf("%.1f%% of the unsimplified vertices are on a chunk border and locked\n", originalVertices > 0 ? 100.0 * lockedVertices / originalVertices : 0.0);
+
+}
+
+void HeadlessApp::BenchmarkAprons()
+{
+
+	JobScheduler scheduler(maxThreads);
+	CPUPipeline pipeline(&scheduler);
+	pipeline.setSlabDepth(slabDepth);
+	pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	pipeline.UpdateNoiseValues(getNoiseParameters());
+	pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+	pipeline.setExtractionMethod(extractionMethod);
+
+	// Full vertices, so the normals can be compared
+	std::string apronPath = chunkPath + ".apron";
+	int apron = pipeline.getMinimumApron();
+	int cells = CPUMarchingCubes::getCellCount(meshSize);
+	size_t volumeVoxels = (size_t)meshSize * meshSize * meshSize;
+	const int chunkSizes[] = { 8, 16, 32, 64 };
+	const double degrees = 180.0 / 3.14159265358979;
+
+	OpenResults("aprons.csv");
+
+	fileStream << "mesh size" << "," << "chunk size" << "," << "apron" << "," << "threads" << "," << "chunks" << "," << "fetch voxels" << "," << "apron voxels" << "," << "fetch (ms)" << "," << "apron (ms)" << ","
+		<< "vertices" << "," << "face vertices changed" << "," << "face change (deg)" << "," << "interior change (deg)" << "," << "fetch seam (deg)" << "," << "apron seam (deg)" << "," << "matching" << std::endl;
+
+	printf("%d^3 volume, %d voxel apron, on %d threads\n", meshSize, apron, scheduler.getThreadCount());
+	printf("%6s %7s %12s %12s %10s %10s %10s %13s %12s %12s %12s\n", "chunk", "chunks", "fetch voxels", "apron voxels", "overhead", "fetch (ms)", "apron (ms)", "face vertices", "face (deg)", "interior", "apron seam");
+
+	for (int chunkSize : chunkSizes)
+	{
+
+		if (chunkSize > cells)
+		{
+
+			continue;
+
+		}
+
+		// Voxels the aprons generate, counting each chunk's cells clipped to the volume
+		size_t apronVoxels = 0;
+
+		for (int z = 0; z < cells; z += chunkSize)
+		{
+
+			for (int y = 0; y < cells; y += chunkSize)
+			{
+
+				for (int x = 0; x < cells; x += chunkSize)
+				{
+
+					apronVoxels += (size_t)(std::min(chunkSize, cells - x) + 1 + 2 * apron) * (std::min(chunkSize, cells - y) + 1 + 2 * apron) * (std::min(chunkSize, cells - z) + 1 + 2 * apron);
+
+				}
+
+			}
+
+		}
+
+		// Neighbour fetch: the whole volume is generated before any chunk is extracted, so each chunk reads its
+		// neighbours' voxels for its stencil
+		double fetchTime = 0.0;
+		double apronTime = 0.0;
+
+		for (int i = 0; i < repetitions; i++)
+		{
+
+			ChunkMeshWriter writer;
+			writer.Open(chunkPath.c_str(), chunkSize, chunkSize * meshScaleFactor, CHUNK_VERTEX_MESH);
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			pipeline.Run();
+			pipeline.WriteChunks(chunkSize, writer);
+			writer.Close();
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+			fetchTime += getMilliseconds(start, end);
+
+		}
+
+		for (int i = 0; i < repetitions; i++)
+		{
+
+			ChunkMeshWriter writer;
+			writer.Open(apronPath.c_str(), chunkSize, chunkSize * meshScaleFactor, CHUNK_VERTEX_MESH);
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			pipeline.GenerateChunks(chunkSize, apron, writer);
+			writer.Close();
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+			apronTime += getMilliseconds(start, end);
+
+		}
+
+		fetchTime /= repetitions;
+		apronTime /= repetitions;
+
+		ChunkMeshFile fetchFile;
+		ChunkMeshFile apronFile;
+
+		if (!fetchFile.Open(chunkPath.c_str()) || !apronFile.Open(apronPath.c_str()))
+		{
+
+			printf("Couldn't load %s or %s\n", chunkPath.c_str(), apronPath.c_str());
+			return;
+
+		}
+
+		// Both files hold the same surface; within a voxel of the volume's faces the shared volume clamps the normals'
+		// samples, and dual contouring's gradients, so only vertices there should change by more than the rounding of
+		// sampling at positions relative to a different origin
+		// Positions come from terrain coordinates in both, so away from the faces every vertex has a bit for bit copy
+		// Dual contouring can move a vertex near a face, which can change how a quad is split, so the vertices are matched
+		// by position rather than by their order in each chunk
+		const double roundingAngle = 0.1;
+		std::vector<const MeshVertex*> fetchVertices;
+		std::vector<const MeshVertex*> apronVertices;
+		getSortedChunkVertices(fetchFile, fetchVertices);
+		getSortedChunkVertices(apronFile, apronVertices);
+
+		size_t faceChanges = 0;
+		size_t interiorMoves = 0;
+		double faceAngle = 0.0;
+		double interiorAngle = 0.0;
+		float faceLimit = (cells - 1) * meshScaleFactor;
+		auto isLess = [](const MeshVertex* x, const MeshVertex* y) { return memcmp(x->position, y->position, sizeof(x->position)) < 0; };
+
+		for (size_t v = 0; v < fetchVertices.size(); v++)
+		{
+
+			const MeshVertex* fetchVertex = fetchVertices[v];
+			std::vector<const MeshVertex*>::const_iterator found = std::lower_bound(apronVertices.begin(), apronVertices.end(), fetchVertex, isLess);
+			bool isMoved = found == apronVertices.end() || isLess(fetchVertex, *found);
+			double angle = 0.0;
+
+			if (!isMoved)
+			{
+
+				const MeshVertex* apronVertex = *found;
+				float dot = fetchVertex->normal[0] * apronVertex->normal[0] + fetchVertex->normal[1] * apronVertex->normal[1] + fetchVertex->normal[2] * apronVertex->normal[2];
+				angle = acos(std::min(std::max((double)dot, -1.0), 1.0)) * degrees;
+
+			}
+
+			bool isNearFace = false;
+
+			for (int k = 0; k < 3; k++)
+			{
+
+				isNearFace = isNearFace || fetchVertex->position[k] <= meshScaleFactor || fetchVertex->position[k] >= faceLimit;
+
+			}
+
+			if (isNearFace)
+			{
+
+				faceChanges += isMoved || angle > roundingAngle ? 1 : 0;
+				faceAngle = std::max(faceAngle, angle);
+
+			}
+			else
+			{
+
+				interiorMoves += isMoved ? 1 : 0;
+				interiorAngle = std::max(interiorAngle, angle);
+
+			}
+
+		}
+
+		double fetchSeam = getSeamNormalAngle(fetchFile);
+		double apronSeam = getSeamNormalAngle(apronFile);
+		bool isMatching = fetchFile.getChunkCount() == apronFile.getChunkCount() && fetchVertices.size() == apronVertices.size() && interiorMoves == 0 &&
+			interiorAngle < roundingAngle && apronSeam < roundingAngle;
+
+		fileStream << meshSize << "," << chunkSize << "," << apron << "," << scheduler.getThreadCount() << "," << fetchFile.getChunkCount() << "," << volumeVoxels << "," << apronVoxels << "," << fetchTime << "," << apronTime << ","
+			<< fetchVertices.size() << "," << faceChanges << "," << faceAngle << "," << interiorAngle << "," << fetchSeam << "," << apronSeam << "," << isMatching << std::endl;
+
+		printf("%6d %7d %12zu %12zu %9.2fx %10.2f %10.2f %13zu %12.2f %12.4f %12.4f%s\n", chunkSize, fetchFile.getChunkCount(), volumeVoxels, apronVoxels, (double)apronVoxels / volumeVoxels,
+			fetchTime, apronTime, faceChanges, faceAngle, interiorAngle, apronSeam, isMatching ? "" : " - DIFFERS");
+
+	}
+
+	fileStream << std::endl;
+
+	printf("  overhead is the voxels the aprons generate against the shared volume; face vertices are those within a voxel\n");
+	printf("  of the volume's faces that the aprons change, with normals turned by at most face (deg); interior and apron seam\n");
+	printf("  are the largest normal changes elsewhere and between copies of a seam vertex in neighbouring chunks, in degrees\n");
+
+}
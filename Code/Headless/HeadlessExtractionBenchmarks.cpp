@@ -0,0 +1,838 @@
+// Headless extraction benchmarks
+// Extraction from a generated volume: the brick tree, multiple isovalues, the sign volume, the dual extractors, the
+// triangle table and material weights
+#include "HeadlessApp.h"
+#include "../BrickTree.h"
+#include "../CPUMarchingCubes.h"
+#include "../CPUNoise.h"
+#include "../MarchingCubesTables.h"
+#include "../MaterialWeights.h"
+#include "../SignVolume.h"
+#include "../VertexWelder.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+void HeadlessApp::BenchmarkBricks()
+{
+
+	JobScheduler scheduler(maxThreads);
+	CPUPipeline pipeline(&scheduler);
+
+	pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	pipeline.UpdateNoiseValues(getNoiseParameters());
+	pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+	pipeline.Run();
+
+	// Sweep isovalues across the range of the volume, from a surface near the bottom to one near the top
+	const DensityVolume& volume = pipeline.getVolume();
+	const float* data = volume.getData();
+	size_t voxelCount = (size_t)meshSize * meshSize * meshSize;
+	float minimum = *std::min_element(data, data + voxelCount);
+	float maximum = *std::max_element(data, data + voxelCount);
+
+	const int isovalueCount = 9;
+	float isovalues[isovalueCount];
+	std::vector<double> fullTimes(isovalueCount, 0.0);
+	std::vector<std::vector<MeshVertex>> fullVertices(isovalueCount);
+
+	// Baseline: re-extract every cell, as happened on every isovalue change before the tree
+	pipeline.setBrickSize(0);
+
+	for (int i = 0; i < isovalueCount; i++)
+	{
+
+		isovalues[i] = minimum + (maximum - minimum) * (i + 1) / (isovalueCount + 1);
+		pipeline.UpdateExtractionValues(isovalues[i], meshScaleFactor);
+
+		for (int r = 0; r < repetitions; r++)
+		{
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			pipeline.RunExtraction();
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+			fullTimes[i] += getMilliseconds(start, end);
+
+		}
+
+		fullTimes[i] /= repetitions;
+		fullVertices[i] = pipeline.getVertices();
+
+	}
+
+	OpenResults("bricks.csv");
+
+	fileStream << "mesh size" << "," << "brick size" << "," << "isovalue" << "," << "active bricks" << "," << "total bricks" << "," << "active fraction" << ","
+		<< "full (ms)" << "," << "bricks (ms)" << "," << "speedup" << "," << "triangles" << "," << "matching" << std::endl;
+
+	const int brickSizes[] = { 4, 8 };
+
+	for (int b = 0; b < 2; b++)
+	{
+
+		int brickSize = brickSizes[b];
+
+		// The tree is built once per volume, so its cost is reported separately from the re-extractions
+		BrickTree tree;
+		std::chrono::steady_clock::time_point buildStart = std::chrono::steady_clock::now();
+		tree.Build(volume, brickSize);
+		std::chrono::steady_clock::time_point buildEnd = std::chrono::steady_clock::now();
+
+		double buildTime = getMilliseconds(buildStart, buildEnd);
+
+		printf("%d^3 volume, %d^3 bricks: %d bricks in %d levels, built in %.2f ms\n", meshSize, brickSize, tree.getBrickCount(), tree.getLevelCount(), buildTime);
+		printf("%10s %14s %12s %12s %10s %12s %9s\n", "isovalue", "active bricks", "full (ms)", "bricks (ms)", "speedup", "triangles", "matching");
+
+		pipeline.setBrickSize(brickSize);
+
+		// Builds the pipeline's own tree outside the timed runs
+		pipeline.RunExtraction();
+
+		for (int i = 0; i < isovalueCount; i++)
+		{
+
+			pipeline.UpdateExtractionValues(isovalues[i], meshScaleFactor);
+
+			double time = 0.0;
+
+			for (int r = 0; r < repetitions; r++)
+			{
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				pipeline.RunExtraction();
+				std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+				time += getMilliseconds(start, end);
+
+			}
+
+			time /= repetitions;
+
+			double activeFraction = (double)pipeline.getActiveBrickCount() / pipeline.getBrickCount();
+			bool isMatching = IsSameTriangles(pipeline.getVertices(), fullVertices[i]);
+
+			fileStream << meshSize << "," << brickSize << "," << isovalues[i] << "," << pipeline.getActiveBrickCount() << "," << pipeline.getBrickCount() << ","
+				<< activeFraction << "," << fullTimes[i] << "," << time << "," << fullTimes[i] / time << "," << pipeline.getVertices().size() / 3 << "," << isMatching << std::endl;
+			printf("%10.3f %7d (%3.0f%%) %12.2f %12.2f %10.2f %12zu %9s\n", isovalues[i], pipeline.getActiveBrickCount(), activeFraction * 100.0,
+				fullTimes[i], time, fullTimes[i] / time, pipeline.getVertices().size() / 3, isMatching ? "yes" : "NO");
+
+		}
+
+	}
+
+	fileStream << std::endl;
+
+}
+
+void HeadlessApp::BenchmarkMultipleIsoValues()
+{
+
+	JobScheduler scheduler(maxThreads);
+	CPUPipeline pipeline(&scheduler);
+
+	pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	pipeline.UpdateNoiseValues(getNoiseParameters());
+	pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+	pipeline.Run();
+
+	// Brick passes go through the brick tree as RunExtraction does, so build it before anything is timed
+	pipeline.RunExtraction();
+
+	// Full passes re-extract every cell of the same volume, as each isovalue would without the tree
+	CPUPipeline fullPipeline(&scheduler);
+
+	fullPipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	fullPipeline.UpdateNoiseValues(getNoiseParameters());
+	fullPipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+	fullPipeline.setBrickSize(0);
+	fullPipeline.Run();
+
+	const DensityVolume& volume = pipeline.getVolume();
+	const float* data = volume.getData();
+	size_t voxelCount = (size_t)meshSize * meshSize * meshSize;
+	float minimum = *std::min_element(data, data + voxelCount);
+	float maximum = *std::max_element(data, data + voxelCount);
+
+	OpenResults("multi_isovalue.csv");
+
+	fileStream << "mesh size" << "," << "isovalues" << "," << "full passes (ms)" << "," << "brick passes (ms)" << "," << "single pass (ms)" << "," << "speedup over full" << ","
+		<< "speedup over bricks" << "," << "triangles" << "," << "matching" << std::endl;
+	printf("%10s %17s %18s %17s %10s %12s %12s %9s\n", "isovalues", "full passes (ms)", "brick passes (ms)", "single pass (ms)", "vs full", "vs bricks", "triangles", "matching");
+
+	for (int count = 1; count <= 8; count *= 2)
+	{
+
+		// Spread the shells evenly through the volume's range
+		std::vector<float> isoValues(count);
+
+		for (int i = 0; i < count; i++)
+		{
+
+			isoValues[i] = minimum + (maximum - minimum) * (i + 1) / (count + 1);
+
+		}
+
+		std::vector<size_t> fullVertexCounts(count);
+		std::vector<std::vector<MeshVertex>> brickMeshes(count);
+		std::vector<std::vector<MeshVertex>> multipleMeshes;
+		double fullTime = 0.0;
+		double brickTime = 0.0;
+		double multipleTime = 0.0;
+
+		for (int r = 0; r < repetitions; r++)
+		{
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			for (int i = 0; i < count; i++)
+			{
+
+				fullPipeline.UpdateExtractionValues(isoValues[i], meshScaleFactor);
+				fullPipeline.RunExtraction();
+				fullVertexCounts[i] = fullPipeline.getVertices().size();
+
+			}
+
+			std::chrono::steady_clock::time_point fullEnd = std::chrono::steady_clock::now();
+
+			for (int i = 0; i < count; i++)
+			{
+
+				pipeline.UpdateExtractionValues(isoValues[i], meshScaleFactor);
+				pipeline.RunExtraction();
+				brickMeshes[i] = pipeline.getVertices();
+
+			}
+
+			std::chrono::steady_clock::time_point brickEnd = std::chrono::steady_clock::now();
+			pipeline.RunMultipleExtraction(isoValues, multipleMeshes);
+			std::chrono::steady_clock::time_point multipleEnd = std::chrono::steady_clock::now();
+
+			fullTime += getMilliseconds(start, fullEnd);
+			brickTime += getMilliseconds(fullEnd, brickEnd);
+			multipleTime += getMilliseconds(brickEnd, multipleEnd);
+
+		}
+
+		fullTime /= repetitions;
+		brickTime /= repetitions;
+		multipleTime /= repetitions;
+
+		// The brick passes visit each shell's cells in the same order as the single pass, so each shell should be byte for byte
+		// identical to theirs; the full passes emit in slab order instead, so only their sizes are compared
+		bool isMatching = true;
+		size_t triangleCount = 0;
+
+		for (int i = 0; i < count; i++)
+		{
+
+			isMatching = isMatching && brickMeshes[i].size() == multipleMeshes[i].size() && fullVertexCounts[i] == multipleMeshes[i].size() &&
+				(brickMeshes[i].empty() || memcmp(brickMeshes[i].data(), multipleMeshes[i].data(), brickMeshes[i].size() * sizeof(MeshVertex)) == 0);
+			triangleCount += multipleMeshes[i].size() / 3;
+
+		}
+
+		fileStream << meshSize << "," << count << "," << fullTime << "," << brickTime << "," << multipleTime << "," << fullTime / multipleTime << ","
+			<< brickTime / multipleTime << "," << triangleCount << "," << isMatching << std::endl;
+		printf("%10d %17.2f %18.2f %17.2f %9.2fx %11.2fx %12zu %9s\n", count, fullTime, brickTime, multipleTime, fullTime / multipleTime, brickTime / multipleTime,
+			triangleCount, isMatching ? "yes" : "NO");
+
+	}
+
+	fileStream << std::endl;
+
+}
+
+void HeadlessApp::BenchmarkSigns()
+{
+
+	// Everything here is single threaded, so the timings compare the per cell work directly
+	CPUNoise noise;
+	noise.UpdateNoiseValues(getNoiseParameters());
+
+	CPUMarchingCubes marchingCubes;
+	marchingCubes.UpdateValues(isovalue, meshScaleFactor);
+
+	DensityVolume volume;
+	volume.Allocate(meshSize, meshSize, meshSize);
+
+	SignVolume signs;
+	signs.Allocate(meshSize, meshSize, meshSize);
+	signs.setIsoValue(isovalue);
+
+	std::vector<MeshVertex> floatVertices;
+	std::vector<MeshVertex> signVertices;
+	std::vector<unsigned int> cubeIndices;
+	std::vector<unsigned int> triangleCounts;
+	size_t activeCells = 0;
+	double noiseTime = 0.0;
+	double fusedNoiseTime = 0.0;
+	double packTime = 0.0;
+	double floatClassifyTime = 0.0;
+	double signClassifyTime = 0.0;
+	double floatExtractTime = 0.0;
+	double signExtractTime = 0.0;
+
+	for (int i = 0; i < repetitions; i++)
+	{
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		noise.Run(volume, 0, meshSize);
+		std::chrono::steady_clock::time_point noiseEnd = std::chrono::steady_clock::now();
+		noise.Run(volume, signs, 0, meshSize);
+		std::chrono::steady_clock::time_point fusedNoiseEnd = std::chrono::steady_clock::now();
+		signs.Build(volume, 0, meshSize);
+		std::chrono::steady_clock::time_point packEnd = std::chrono::steady_clock::now();
+
+		marchingCubes.Classify(volume, cubeIndices, triangleCounts);
+		std::chrono::steady_clock::time_point floatClassifyEnd = std::chrono::steady_clock::now();
+		activeCells = CPUMarchingCubes::CountActiveCells(signs, 0, meshSize);
+		std::chrono::steady_clock::time_point signClassifyEnd = std::chrono::steady_clock::now();
+
+		floatVertices.clear();
+		marchingCubes.Run(volume, 0, meshSize, floatVertices);
+		std::chrono::steady_clock::time_point floatExtractEnd = std::chrono::steady_clock::now();
+		signVertices.clear();
+		marchingCubes.Run(volume, signs, 0, meshSize, signVertices);
+		std::chrono::steady_clock::time_point signExtractEnd = std::chrono::steady_clock::now();
+
+		noiseTime += getMilliseconds(start, noiseEnd);
+		fusedNoiseTime += getMilliseconds(noiseEnd, fusedNoiseEnd);
+		packTime += getMilliseconds(fusedNoiseEnd, packEnd);
+		floatClassifyTime += getMilliseconds(packEnd, floatClassifyEnd);
+		signClassifyTime += getMilliseconds(floatClassifyEnd, signClassifyEnd);
+		floatExtractTime += getMilliseconds(signClassifyEnd, floatExtractEnd);
+		signExtractTime += getMilliseconds(floatExtractEnd, signExtractEnd);
+
+	}
+
+	noiseTime /= repetitions;
+	fusedNoiseTime /= repetitions;
+	packTime /= repetitions;
+	floatClassifyTime /= repetitions;
+	signClassifyTime /= repetitions;
+	floatExtractTime /= repetitions;
+	signExtractTime /= repetitions;
+
+	bool isMatching = floatVertices.size() == signVertices.size() &&
+		(floatVertices.empty() || memcmp(floatVertices.data(), signVertices.data(), floatVertices.size() * sizeof(MeshVertex)) == 0);
+
+	int cells = CPUMarchingCubes::getCellCount(meshSize);
+	size_t cellCount = (size_t)cells * cells * cells;
+	size_t floatBytes = (size_t)meshSize * meshSize * meshSize * sizeof(float);
+	size_t signBytes = (size_t)signs.getWordsPerRow() * meshSize * meshSize * sizeof(uint64_t);
+
+	OpenResults("signs.csv");
+
+	fileStream << "mesh size" << "," << "float volume (bytes)" << "," << "sign volume (bytes)" << "," << "active cells" << "," << "noise (ms)" << "," << "noise + signs (ms)" << "," << "pack (ms)" << ","
+		<< "float classify (ms)" << "," << "sign classify (ms)" << "," << "float extract (ms)" << "," << "sign extract (ms)" << "," << "matching" << std::endl;
+	fileStream << meshSize << "," << floatBytes << "," << signBytes << "," << activeCells << "," << noiseTime << "," << fusedNoiseTime << "," << packTime << ","
+		<< floatClassifyTime << "," << signClassifyTime << "," << floatExtractTime << "," << signExtractTime << "," << isMatching << std::endl << std::endl;
+
+	printf("%d^3 volume: %zu of %zu cells active (%.1f%%), %zu float bytes against %zu sign bytes\n", meshSize, activeCells, cellCount,
+		100.0 * activeCells / cellCount, floatBytes, signBytes);
+	printf("  noise:            %10.2f ms, %.2f ms with fused signs, %.2f ms to repack\n", noiseTime, fusedNoiseTime, packTime);
+	printf("  classify:         %10.2f ms from floats, %.2f ms from signs (%.1fx)\n", floatClassifyTime, signClassifyTime, floatClassifyTime / signClassifyTime);
+	printf("  extract:          %10.2f ms from floats, %.2f ms from signs (%.2fx)\n", floatExtractTime, signExtractTime, floatExtractTime / signExtractTime);
+	printf("  output %s\n", isMatching ? "matches" : "DIFFERS");
+
+}
+
+void HeadlessApp::BenchmarkExtractionMethods()
+{
+
+	JobScheduler scheduler(maxThreads);
+	CPUPipeline pipeline(&scheduler);
+	pipeline.setSlabDepth(slabDepth);
+	pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+	// Every method extracts every cell of the same volume
+	pipeline.setBrickSize(0);
+
+	const ExtractionMethod methods[] = { EXTRACTION_MARCHING_CUBES, EXTRACTION_SURFACE_NETS, EXTRACTION_DUAL_CONTOURING };
+	const char* methodNames[] = { "marching cubes", "surface nets", "dual contouring" };
+	const int methodCount = sizeof(methods) / sizeof(methods[0]);
+
+	// The four combinations of the noise options App1 offers
+	const char* setNames[] = { "perlin", "simplex", "perlin ridged", "simplex ridged" };
+	const int setCount = sizeof(setNames) / sizeof(setNames[0]);
+
+	// Triangles with an angle under this many degrees are counted as slivers
+	const float sliverAngle = 10.0f;
+	const float degrees = 180.0f / 3.14159265f;
+
+	VertexWelder welder;
+	std::vector<MeshVertex> welded;
+	std::vector<unsigned int> indices;
+
+	OpenResults("dual.csv");
+
+	fileStream << "mesh size" << "," << "threads" << "," << "noise" << "," << "method" << "," << "triangles" << "," << "vertices" << "," << "extraction (ms)" << ","
+		<< "mean distance (voxels)" << "," << "max distance (voxels)" << "," << "mean normal error (degrees)" << "," << "mean min angle (degrees)" << "," << "slivers" << std::endl;
+
+	printf("%d^3 volume on %d threads; distances from triangle centroids and edge midpoints to the isosurface, slivers under %.0f degrees\n", meshSize, maxThreads, sliverAngle);
+	printf("%15s %16s %11s %11s %10s %11s %11s %12s %11s %9s\n", "noise", "method", "triangles", "vertices", "time (ms)", "mean (vx)", "max (vx)", "normal (deg)", "min angle", "slivers");
+
+	for (int set = 0; set < setCount; set++)
+	{
+
+		NoiseParameters parameters = getNoiseParameters();
+		parameters.isSimplex = set == 1 || set == 3;
+		parameters.isRidged = set >= 2;
+		pipeline.UpdateNoiseValues(parameters);
+		pipeline.setExtractionMethod(EXTRACTION_MARCHING_CUBES);
+		pipeline.Run();
+
+		const DensityVolume& volume = pipeline.getVolume();
+
+		for (int m = 0; m < methodCount; m++)
+		{
+
+			pipeline.setExtractionMethod(methods[m]);
+
+			double extractionTime = 0.0;
+
+			for (int i = 0; i < repetitions; i++)
+			{
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				pipeline.RunExtraction();
+				std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+				extractionTime += getMilliseconds(start, end);
+
+			}
+
+			extractionTime /= repetitions;
+
+			const std::vector<MeshVertex>& triangles = pipeline.getVertices();
+			welder.Weld(triangles.data(), triangles.size(), welded, indices);
+
+			double distanceSum = 0.0;
+			double maxDistance = 0.0;
+			size_t distanceCount = 0;
+			double normalErrorSum = 0.0;
+			size_t normalCount = 0;
+			double minAngleSum = 0.0;
+			size_t sliverCount = 0;
+			size_t triangleCount = triangles.size() / 3;
+
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+
+				// Corners in voxel space, where the density is sampled
+				float corners[3][3];
+
+				for (int k = 0; k < 3; k++)
+				{
+
+					for (int a = 0; a < 3; a++)
+					{
+
+						corners[k][a] = triangles[t * 3 + k].position[a] / meshScaleFactor;
+
+					}
+
+				}
+
+				float samples[4][3];
+				float gradient[3];
+
+				for (int a = 0; a < 3; a++)
+				{
+
+					samples[0][a] = (corners[0][a] + corners[1][a] + corners[2][a]) / 3.0f;
+					samples[1][a] = (corners[0][a] + corners[1][a]) * 0.5f;
+					samples[2][a] = (corners[1][a] + corners[2][a]) * 0.5f;
+					samples[3][a] = (corners[2][a] + corners[0][a]) * 0.5f;
+
+				}
+
+				for (int k = 0; k < 4; k++)
+				{
+
+					double distance = getSurfaceDistance(volume, samples[k], gradient);
+					distanceSum += distance;
+					maxDistance = std::max(maxDistance, distance);
+					distanceCount++;
+
+				}
+
+				// Shading error: the angle between the face and the isosurface's normal at its centroid
+				getSurfaceDistance(volume, samples[0], gradient);
+
+				float e1[3] = { corners[1][0] - corners[0][0], corners[1][1] - corners[0][1], corners[1][2] - corners[0][2] };
+				float e2[3] = { corners[2][0] - corners[0][0], corners[2][1] - corners[0][1], corners[2][2] - corners[0][2] };
+				float face[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				float faceLength = sqrtf(face[0] * face[0] + face[1] * face[1] + face[2] * face[2]);
+				float gradientLength = sqrtf(gradient[0] * gradient[0] + gradient[1] * gradient[1] + gradient[2] * gradient[2]);
+
+				if (faceLength > 0.0f && gradientLength > 0.0f)
+				{
+
+					// Faces point down the density gradient, as marching cubes winds them
+					float cosine = -(face[0] * gradient[0] + face[1] * gradient[1] + face[2] * gradient[2]) / (faceLength * gradientLength);
+					normalErrorSum += acosf(std::min(std::max(cosine, -1.0f), 1.0f)) * degrees;
+					normalCount++;
+
+				}
+
+				// The smallest angle is opposite the shortest side; a triangle with no area has a smallest angle of 0
+				float sides[3];
+
+				for (int k = 0; k < 3; k++)
+				{
+
+					const float* a = corners[k];
+					const float* b = corners[(k + 1) % 3];
+					sides[k] = sqrtf((b[0] - a[0]) * (b[0] - a[0]) + (b[1] - a[1]) * (b[1] - a[1]) + (b[2] - a[2]) * (b[2] - a[2]));
+
+				}
+
+				std::sort(sides, sides + 3);
+				float minAngle = 0.0f;
+
+				if (faceLength > 0.0f && sides[0] > 0.0f)
+				{
+
+					float cosine = (sides[1] * sides[1] + sides[2] * sides[2] - sides[0] * sides[0]) / (2.0f * sides[1] * sides[2]);
+					minAngle = acosf(std::min(std::max(cosine, -1.0f), 1.0f)) * degrees;
+
+				}
+
+				minAngleSum += minAngle;
+
+				if (minAngle < sliverAngle)
+				{
+
+					sliverCount++;
+
+				}
+
+			}
+
+			double meanDistance = distanceCount > 0 ? distanceSum / distanceCount : 0.0;
+			double meanNormalError = normalCount > 0 ? normalErrorSum / normalCount : 0.0;
+			double meanMinAngle = triangleCount > 0 ? minAngleSum / triangleCount : 0.0;
+			double sliverFraction = triangleCount > 0 ? (double)sliverCount / triangleCount : 0.0;
+
+			fileStream << meshSize << "," << maxThreads << "," << setNames[set] << "," << methodNames[m] << "," << triangleCount << "," << welded.size() << "," << extractionTime << ","
+				<< meanDistance << "," << maxDistance << "," << meanNormalError << "," << meanMinAngle << "," << sliverFraction << std::endl;
+
+			printf("%15s %16s %11zu %11zu %10.2f %11.4f %11.4f %12.2f %11.2f %8.1f%%\n", setNames[set], methodNames[m], triangleCount, welded.size(), extractionTime,
+				meanDistance, maxDistance, meanNormalError, meanMinAngle, sliverFraction * 100.0);
+
+		}
+
+	}
+
+	fileStream << std::endl;
+
+}
+
+void HeadlessApp::BenchmarkTriTableLookup()
+{
+
+	JobScheduler scheduler(maxThreads);
+	CPUPipeline pipeline(&scheduler);
+	pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	pipeline.UpdateNoiseValues(getNoiseParameters());
+	pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+	pipeline.Run();
+
+	CPUMarchingCubes marchingCubes;
+	marchingCubes.UpdateValues(isovalue, meshScaleFactor);
+	std::vector<unsigned int> cubeIndices;
+	std::vector<unsigned int> triangleCounts;
+	marchingCubes.Classify(pipeline.getVolume(), cubeIndices, triangleCounts);
+
+	// The cases of the active cells, in the order the extractor meets them
+	std::vector<int> cases;
+	unsigned long long triangleCount = 0;
+
+	for (size_t i = 0; i < cubeIndices.size(); i++)
+	{
+
+		if (triangleCounts[i] > 0)
+		{
+
+			cases.push_back((int)cubeIndices[i]);
+			triangleCount += triangleCounts[i];
+
+		}
+
+	}
+
+	if (cases.empty())
+	{
+
+		printf("No active cells at this isovalue\n");
+		return;
+
+	}
+
+	// Repeat the cases so each timing covers a few million lookups
+	int passes = std::max(1, (int)(4000000 / cases.size()));
+	const uint64_t* packedTable = getPackedTriTable();
+	const char* names[] = { "checked loads", "int table", "packed table" };
+	const size_t tableBytes[] = { sizeof(triTable), sizeof(triTable), 256 * sizeof(uint64_t) };
+	double times[3] = { 0.0, 0.0, 0.0 };
+	unsigned long long checksums[3] = { 0, 0, 0 };
+
+	for (int r = 0; r < repetitions; r++)
+	{
+
+		for (int method = 0; method < 3; method++)
+		{
+
+			unsigned long long checksum = 0;
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			for (int pass = 0; pass < passes; pass++)
+			{
+
+				for (size_t c = 0; c < cases.size(); c++)
+				{
+
+					int cubeIndex = cases[c];
+
+					if (method == 0)
+					{
+
+						// marching_cubes_gs.hlsl: triTableValue bounds checks every load, and the terminator is loaded again each triangle
+						for (int i = 0; (i < 16 ? triTable[cubeIndex][i] : -1) != -1; i += 3)
+						{
+
+							checksum += (i < 16 ? triTable[cubeIndex][i] : -1) + (i + 1 < 16 ? triTable[cubeIndex][i + 1] : -1) + (i + 2 < 16 ? triTable[cubeIndex][i + 2] : -1);
+
+						}
+
+					}
+					else if (method == 1)
+					{
+
+						for (int i = 0; triTable[cubeIndex][i] != -1; i++)
+						{
+
+							checksum += triTable[cubeIndex][i];
+
+						}
+
+					}
+					else
+					{
+
+						uint64_t edges = packedTable[cubeIndex];
+						int caseTriangles = (int)(edges >> 60);
+
+						for (int t = 0; t < caseTriangles; t++, edges >>= 12)
+						{
+
+							checksum += (edges & 0xF) + ((edges >> 4) & 0xF) + ((edges >> 8) & 0xF);
+
+						}
+
+					}
+
+				}
+
+			}
+
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+			times[method] += getMilliseconds(start, end);
+			checksums[method] = checksum;
+
+		}
+
+	}
+
+	bool isMatching = checksums[0] == checksums[1] && checksums[1] == checksums[2];
+	double lookups = (double)cases.size() * passes;
+	double vertices = (double)triangleCount * 3 * passes;
+
+	OpenResults("tritable.csv");
+
+	fileStream << "mesh size" << "," << "active cells" << "," << "triangles" << "," << "table" << "," << "table bytes" << "," << "ns per cell" << "," << "ns per vertex" << "," << "matching" << std::endl;
+
+	printf("%d^3 volume: %zu active cells, %llu triangles, %d passes; edge checksums %s\n", meshSize, cases.size(), triangleCount, passes, isMatching ? "match" : "DIFFER");
+	printf("%16s %12s %12s %14s\n", "table", "bytes", "ns per cell", "ns per vertex");
+
+	for (int method = 0; method < 3; method++)
+	{
+
+		double time = times[method] / repetitions;
+		double cellTime = time * 1000000.0 / lookups;
+		double vertexTime = time * 1000000.0 / vertices;
+
+		fileStream << meshSize << "," << cases.size() << "," << triangleCount << "," << names[method] << "," << tableBytes[method] << "," << cellTime << "," << vertexTime << "," << isMatching << std::endl;
+
+		printf("%16s %12zu %12.3f %14.3f\n", names[method], tableBytes[method], cellTime, vertexTime);
+
+	}
+
+	fileStream << std::endl;
+
+}
+
+void HeadlessApp::BenchmarkMaterials()
+{
+
+	JobScheduler scheduler(maxThreads);
+	CPUPipeline pipeline(&scheduler);
+	pipeline.setSlabDepth(slabDepth);
+	pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	pipeline.UpdateNoiseValues(getNoiseParameters());
+	pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+	pipeline.setExtractionMethod(extractionMethod);
+	pipeline.Run();
+
+	std::vector<MeshVertex> vertices = pipeline.getVertices();
+
+	if (vertices.empty())
+	{
+
+		printf("%d^3 volume has no surface\n", meshSize);
+		return;
+
+	}
+
+	// Each vertex's packed weights against light_ps.hlsl's rules evaluated at the vertex, in both packed forms
+	float layerError = 0.0f;
+	float shortLayerError = 0.0f;
+	float axisError = 0.0f;
+	float shortAxisError = 0.0f;
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+
+		const MeshVertex& vertex = vertices[i];
+		float layers[MATERIAL_LAYER_COUNT];
+		float axes[3];
+		float shortLayers[MATERIAL_LAYER_COUNT];
+		float shortAxes[3];
+		float referenceAxes[3];
+		MaterialWeights::Unpack(vertex.position[3], layers, axes);
+		MaterialWeights::Unpack(MaterialWeights::UnpackShort(MaterialWeights::PackShort(vertex.position[3])), shortLayers, shortAxes);
+		MaterialWeights::CalculateAxes(vertex.normal, referenceAxes);
+
+		for (int k = 0; k < 3; k++)
+		{
+
+			float reference = MaterialWeights::getReferenceWeight(vertex.position[1], vertex.normal[1], k);
+			layerError = std::max(layerError, fabsf(layers[k] - reference));
+			shortLayerError = std::max(shortLayerError, fabsf(shortLayers[k] - reference));
+			axisError = std::max(axisError, fabsf(axes[k] - referenceAxes[k]));
+			shortAxisError = std::max(shortAxisError, fabsf(shortAxes[k] - referenceAxes[k]));
+
+		}
+
+	}
+
+	// Texture samples the pixel shader takes on each triangle: one per projection with weight at any of its vertices,
+	// for each layer with weight at any of its vertices, against the 9 of sampling every layer and projection
+	// Weighting by area stands in for the pixels each triangle covers
+	double samples = 0.0;
+	double areaSamples = 0.0;
+	double totalArea = 0.0;
+	size_t layerCounts[4] = { 0, 0, 0, 0 };
+	size_t triangleCount = vertices.size() / 3;
+
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+
+		bool isLayerUsed[MATERIAL_LAYER_COUNT] = { false, false, false };
+		bool isAxisUsed[3] = { false, false, false };
+
+		for (int v = 0; v < 3; v++)
+		{
+
+			float layers[MATERIAL_LAYER_COUNT];
+			float axes[3];
+			MaterialWeights::Unpack(vertices[t * 3 + v].position[3], layers, axes);
+
+			for (int k = 0; k < 3; k++)
+			{
+
+				isLayerUsed[k] = isLayerUsed[k] || layers[k] > 0.0f;
+				isAxisUsed[k] = isAxisUsed[k] || axes[k] > 0.0f;
+
+			}
+
+		}
+
+		int layersUsed = (int)isLayerUsed[0] + (int)isLayerUsed[1] + (int)isLayerUsed[2];
+		int axesUsed = (int)isAxisUsed[0] + (int)isAxisUsed[1] + (int)isAxisUsed[2];
+
+		const float* a = vertices[t * 3].position;
+		const float* b = vertices[t * 3 + 1].position;
+		const float* c = vertices[t * 3 + 2].position;
+		float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		float cross[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		double area = 0.5 * sqrt((double)cross[0] * cross[0] + (double)cross[1] * cross[1] + (double)cross[2] * cross[2]);
+
+		samples += layersUsed * axesUsed;
+		areaSamples += area * layersUsed * axesUsed;
+		totalArea += area;
+		layerCounts[layersUsed]++;
+
+	}
+
+	samples /= triangleCount;
+	areaSamples = totalArea > 0.0 ? areaSamples / totalArea : 0.0;
+
+	// Cost of working the weights out at extraction, against the extraction it adds to
+	double applyTime = 0.0;
+
+	for (int i = 0; i < repetitions; i++)
+	{
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		for (size_t v = 0; v < vertices.size(); v++)
+		{
+
+			MaterialWeights::Apply(vertices[v]);
+
+		}
+
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		applyTime += getMilliseconds(start, end);
+
+	}
+
+	applyTime /= repetitions;
+
+	double pipelineTime = 0.0;
+
+	for (int i = 0; i < repetitions; i++)
+	{
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		pipeline.Run();
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		pipelineTime += getMilliseconds(start, end);
+
+	}
+
+	pipelineTime /= repetitions;
+
+	bool isMatching = IsSameTriangles(vertices, pipeline.getVertices());
+
+	OpenResults("materials.csv");
+
+	fileStream << "mesh size" << "," << "triangles" << "," << "layer error" << "," << "axis error" << "," << "packed layer error" << "," << "packed axis error" << "," << "one layer" << "," << "two layers" << "," << "three layers" << ","
+		<< "samples per triangle" << "," << "samples per area" << "," << "weights (ms)" << "," << "pipeline (ms)" << "," << "matching" << std::endl;
+	fileStream << meshSize << "," << triangleCount << "," << layerError << "," << axisError << "," << shortLayerError << "," << shortAxisError << "," << layerCounts[1] << "," << layerCounts[2] << "," << layerCounts[3] << ","
+		<< samples << "," << areaSamples << "," << applyTime << "," << pipelineTime << "," << isMatching << std::endl << std::endl;
+
+	printf("%d^3 volume, %zu triangles\n", meshSize, triangleCount);
+	printf("  largest weight error against light_ps.hlsl's rules: layers %.4f, axes %.4f (packed vertices %.4f, %.4f)\n", layerError, axisError, shortLayerError, shortAxisError);
+	printf("  triangles using 1, 2 and 3 layers: %.1f%%, %.1f%%, %.1f%%\n", 100.0 * layerCounts[1] / triangleCount, 100.0 * layerCounts[2] / triangleCount, 100.0 * layerCounts[3] / triangleCount);
+	printf("  texture samples per pixel: %.2f per triangle, %.2f by area, against 9\n", samples, areaSamples);
+	printf("  weights: %.2f ms for %zu vertices (%.1f ns each), %.1f%% of the %.2f ms pipeline; reapplying them %s\n", applyTime, vertices.size(),
+		applyTime * 1e6 / vertices.size(), 100.0 * applyTime / pipelineTime, pipelineTime, isMatching ? "matches" : "DIFFERS");
+
+}
@@ -0,0 +1,19 @@
+// Headless generator entry point
+// Built separately from the DXFramework application, together with the portable files in Code/
+#include "HeadlessApp.h"
+
+int main(int argc, char** argv)
+{
+
+	HeadlessApp app;
+
+	if (!app.init(argc, argv))
+	{
+
+		return 1;
+
+	}
+
+	return app.run();
+
+}
@@ -0,0 +1,328 @@
+// Headless noise benchmarks
+// The hashed gradient bases and lattice cell noise filling against the permutation table and voxel at a time paths
+#include "HeadlessApp.h"
+#include "../CPUNoise.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+void HeadlessApp::BenchmarkHashedNoise()
+{
+
+	// Noise basis samples on a grid of spacing 0.173, so consecutive samples share lattice cells and the grid never lines up with the lattice
+	const float spacing = 0.173f;
+	const char* basisNames[2] = { "Perlin", "Simplex" };
+	const char* sourceNames[3] = { "table", "hashed", "reseeded" };
+	size_t sampleCount = (size_t)meshSize * meshSize * meshSize;
+
+	NoiseParameters parameters = getNoiseParameters();
+	parameters.seed = seed;
+	CPUNoise noise;
+	noise.UpdateNoiseValues(parameters);
+	parameters.seed = seed + 1;
+	CPUNoise reseededNoise;
+	reseededNoise.UpdateNoiseValues(parameters);
+
+	OpenResults("hash.csv");
+
+	fileStream << "mesh size" << "," << "basis" << "," << "gradients" << "," << "samples" << "," << "time (ms)" << "," << "samples per us" << ","
+		<< "mean" << "," << "std dev" << "," << "min" << "," << "max" << "," << "neighbour correlation" << "," << "correlation with table" << std::endl;
+
+	printf("%zu samples %.3f apart, seeds %u and %u, single threaded\n", sampleCount, spacing, seed, seed + 1);
+	printf("%8s %10s %10s %11s %8s %8s %8s %8s %12s %11s\n", "basis", "gradients", "time (ms)", "samples/us", "mean", "std dev", "min", "max", "neighbour r", "table r");
+
+	std::vector<float> samples[3];
+
+	for (int basis = 0; basis < 2; basis++)
+	{
+
+		for (int source = 0; source < 3; source++)
+		{
+
+			const CPUNoise& sourceNoise = source == 2 ? reseededNoise : noise;
+			std::vector<float>& values = samples[source];
+			values.resize(sampleCount);
+			double time = 0.0;
+
+			for (int i = 0; i < repetitions; i++)
+			{
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				size_t index = 0;
+
+				for (int z = 0; z < meshSize; z++)
+				{
+
+					for (int y = 0; y < meshSize; y++)
+					{
+
+						for (int x = 0; x < meshSize; x++, index++)
+						{
+
+							float px = x * spacing + 0.5f;
+							float py = y * spacing + 0.5f;
+							float pz = z * spacing + 0.5f;
+
+							if (source == 0)
+							{
+
+								values[index] = basis == 0 ? sourceNoise.noise3(px, py, pz) : sourceNoise.snoise3(px, py, pz);
+
+							}
+							else
+							{
+
+								values[index] = basis == 0 ? sourceNoise.hnoise3(px, py, pz) : sourceNoise.hsnoise3(px, py, pz);
+
+							}
+
+						}
+
+					}
+
+				}
+
+				std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+				time += getMilliseconds(start, end);
+
+			}
+
+			time /= repetitions;
+
+			// Value statistics, how strongly each sample predicts its neighbour along X, and how much of the table noise survives
+			double sum = 0.0;
+			double sumSquares = 0.0;
+			float minimum = FLT_MAX;
+			float maximum = -FLT_MAX;
+
+			for (size_t i = 0; i < sampleCount; i++)
+			{
+
+				sum += values[i];
+				sumSquares += (double)values[i] * values[i];
+				minimum = std::min(minimum, values[i]);
+				maximum = std::max(maximum, values[i]);
+
+			}
+
+			double mean = sum / sampleCount;
+			double variance = sumSquares / sampleCount - mean * mean;
+			double neighbourCovariance = 0.0;
+			double tableCovariance = 0.0;
+			double tableMean = 0.0;
+			double tableVariance = 0.0;
+			size_t neighbourCount = 0;
+
+			for (size_t i = 0; i < sampleCount; i++)
+			{
+
+				if ((i + 1) % meshSize != 0)
+				{
+
+					neighbourCovariance += (values[i] - mean) * (values[i + 1] - mean);
+					neighbourCount++;
+
+				}
+
+				tableMean += samples[0][i];
+
+			}
+
+			tableMean /= sampleCount;
+
+			for (size_t i = 0; i < sampleCount; i++)
+			{
+
+				tableCovariance += (values[i] - mean) * (samples[0][i] - tableMean);
+				tableVariance += (samples[0][i] - tableMean) * (samples[0][i] - tableMean);
+
+			}
+
+			double neighbourCorrelation = variance > 0.0 ? neighbourCovariance / neighbourCount / variance : 0.0;
+			double tableCorrelation = variance > 0.0 && tableVariance > 0.0 ? tableCovariance / sampleCount / sqrt(variance * tableVariance / sampleCount) : 0.0;
+			double throughput = time > 0.0 ? sampleCount / (time * 1000.0) : 0.0;
+
+			fileStream << meshSize << "," << basisNames[basis] << "," << sourceNames[source] << "," << sampleCount << "," << time << "," << throughput << ","
+				<< mean << "," << sqrt(variance) << "," << minimum << "," << maximum << "," << neighbourCorrelation << "," << tableCorrelation << std::endl;
+
+			printf("%8s %10s %10.2f %11.2f %8.4f %8.4f %8.4f %8.4f %12.4f %11.4f\n", basisNames[basis], sourceNames[source], time, throughput,
+				mean, sqrt(variance), minimum, maximum, neighbourCorrelation, tableCorrelation);
+
+		}
+
+	}
+
+	// The whole fBm volume, which evaluates the basis once per octave per voxel (twice when ridged)
+	DensityVolume volume;
+	volume.Allocate(meshSize, meshSize, meshSize);
+	double volumeTimes[2] = { 0.0, 0.0 };
+
+	for (int source = 0; source < 2; source++)
+	{
+
+		parameters = getNoiseParameters();
+		parameters.isHashed = source == 1;
+		parameters.seed = seed;
+		noise.UpdateNoiseValues(parameters);
+
+		for (int i = 0; i < repetitions; i++)
+		{
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			noise.Run(volume, 0, meshSize);
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+			volumeTimes[source] += getMilliseconds(start, end);
+
+		}
+
+		volumeTimes[source] /= repetitions;
+
+	}
+
+	fileStream << "volume" << "," << "table (ms)" << "," << "hashed (ms)" << std::endl;
+	fileStream << meshSize << "," << volumeTimes[0] << "," << volumeTimes[1] << std::endl << std::endl;
+
+	printf("%d^3 %s fBm volume, %d octaves: table %.2f ms, hashed %.2f ms (%.2fx)\n", meshSize, isSimplex ? "Simplex" : "Perlin", octaves,
+		volumeTimes[0], volumeTimes[1], volumeTimes[1] > 0.0 ? volumeTimes[0] / volumeTimes[1] : 0.0);
+
+}
+
+void HeadlessApp::BenchmarkLatticeNoise()
+{
+
+	// Base frequencies around the default, each timed one octave at a time and as the whole fBm
+	const float frequencies[4] = { 0.005f, 0.01f, 0.02f, 0.04f };
+	const int frequencyCount = 4;
+
+	DensityVolume voxelVolume;
+	voxelVolume.Allocate(meshSize, meshSize, meshSize);
+	DensityVolume latticeVolume;
+	latticeVolume.Allocate(meshSize, meshSize, meshSize);
+
+	CPUNoise noise;
+	NoiseParameters fBmParameters = getNoiseParameters();
+
+	OpenResults("lattice.csv");
+
+	fileStream << "mesh size" << "," << "noise" << "," << "base frequency" << "," << "octave" << "," << "cell width (voxels)" << "," << "voxels per cell" << ","
+		<< "per voxel (ms)" << "," << "per cell (ms)" << "," << "speedup" << "," << "mismatches" << std::endl;
+
+	printf("%d^3 volume, %s%s %s noise, single threaded; octave \"all\" is the whole %d octave fBm\n", meshSize, isHashed ? "hashed " : "", isRidged ? "ridged" : "plain",
+		isSimplex ? "Simplex" : "Perlin", octaves);
+	printf("%10s %7s %12s %12s %12s %12s %9s %11s\n", "frequency", "octave", "cell width", "voxels/cell", "voxel (ms)", "cell (ms)", "speedup", "mismatches");
+
+	for (int f = 0; f < frequencyCount; f++)
+	{
+
+		// One row per octave, then one for all of them together
+		for (int k = 0; k <= octaves; k++)
+		{
+
+			NoiseParameters parameters = fBmParameters;
+			parameters.frequency = frequencies[f];
+			float octaveFrequency = frequencies[f];
+
+			if (k < octaves)
+			{
+
+				for (int i = 0; i < k; i++)
+				{
+
+					octaveFrequency *= 2.0f;
+
+				}
+
+				parameters.frequency = octaveFrequency;
+				parameters.octaves = 1;
+
+			}
+
+			noise.UpdateNoiseValues(parameters);
+
+			double voxelTime = 0.0;
+			double latticeTime = 0.0;
+
+			for (int i = 0; i < repetitions; i++)
+			{
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+				for (int z = 0; z < meshSize; z++)
+				{
+
+					for (int y = 0; y < meshSize; y++)
+					{
+
+						float* row = voxelVolume.getData() + voxelVolume.index(0, y, z);
+
+						for (int x = 0; x < meshSize; x++)
+						{
+
+							row[x] = noise.Density(x, y, z, meshSize);
+
+						}
+
+					}
+
+				}
+
+				std::chrono::steady_clock::time_point voxelEnd = std::chrono::steady_clock::now();
+				noise.Run(latticeVolume, 0, meshSize);
+				std::chrono::steady_clock::time_point latticeEnd = std::chrono::steady_clock::now();
+
+				voxelTime += getMilliseconds(start, voxelEnd);
+				latticeTime += getMilliseconds(voxelEnd, latticeEnd);
+
+			}
+
+			voxelTime /= repetitions;
+			latticeTime /= repetitions;
+
+			size_t mismatches = 0;
+			size_t voxelCount = (size_t)meshSize * meshSize * meshSize;
+
+			for (size_t i = 0; i < voxelCount; i++)
+			{
+
+				if (voxelVolume.getData()[i] != latticeVolume.getData()[i])
+				{
+
+					mismatches++;
+
+				}
+
+			}
+
+			// Lattice cell size in voxels along each axis at this octave's frequency
+			float cellWidth = 1.0f / (octaveFrequency * meshScaleFactor * noiseScaleFactors[0]);
+			float cellHeight = 1.0f / (octaveFrequency * meshScaleFactor * noiseScaleFactors[1]);
+			float cellDepth = 1.0f / (octaveFrequency * meshScaleFactor * noiseScaleFactors[2]);
+			double voxelsPerCell = (double)cellWidth * cellHeight * cellDepth;
+			double speedup = latticeTime > 0.0 ? voxelTime / latticeTime : 0.0;
+
+			if (k < octaves)
+			{
+
+				fileStream << meshSize << "," << (isSimplex ? "Simplex" : "Perlin") << "," << frequencies[f] << "," << k << "," << cellWidth << "," << voxelsPerCell << ","
+					<< voxelTime << "," << latticeTime << "," << speedup << "," << mismatches << std::endl;
+				printf("%10.3f %7d %12.1f %12.1f %12.2f %12.2f %8.2fx %11zu\n", frequencies[f], k, cellWidth, voxelsPerCell, voxelTime, latticeTime, speedup, mismatches);
+
+			}
+			else
+			{
+
+				fileStream << meshSize << "," << (isSimplex ? "Simplex" : "Perlin") << "," << frequencies[f] << "," << "all" << "," << "" << "," << "" << ","
+					<< voxelTime << "," << latticeTime << "," << speedup << "," << mismatches << std::endl;
+				printf("%10.3f %7s %12s %12s %12.2f %12.2f %8.2fx %11zu\n", frequencies[f], "all", "", "", voxelTime, latticeTime, speedup, mismatches);
+
+			}
+
+		}
+
+	}
+
+	fileStream << std::endl;
+
+}
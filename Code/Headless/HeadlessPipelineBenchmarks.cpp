@@ -0,0 +1,739 @@
+// Headless pipeline benchmarks
+// Whole volume generation: thread scaling, frame latency, the compute passes, toroidal shifts, streaming, out-of-core
+// generation, the volume cache and anisotropic volumes
+#include "HeadlessApp.h"
+#include "../AsyncRegenerator.h"
+#include "../CPUMarchingCubes.h"
+#include "../MeshFileWriter.h"
+#include "../StreamingPipeline.h"
+#include "../ToroidalVolume.h"
+#include "../VolumeCache.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+void HeadlessApp::BenchmarkScaling()
+{
+
+	OpenResults("scaling.csv");
+
+	fileStream << "mesh size" << "," << "threads" << "," << "time (ms)" << "," << "speedup" << "," << "triangles" << std::endl;
+	printf("%8s %10s %10s %10s\n", "threads", "time (ms)", "speedup", "triangles");
+
+	double singleThreadTime = 0.0;
+
+	for (int threads = 1; threads <= maxThreads; threads++)
+	{
+
+		JobScheduler scheduler(threads);
+
+		// Warm up once so the first measurement doesn't pay for page faults on the volume
+		Run(&scheduler);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < repetitions; i++)
+		{
+
+			Run(&scheduler);
+
+		}
+
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		double time = getMilliseconds(start, end) / repetitions;
+
+		if (threads == 1)
+		{
+
+			singleThreadTime = time;
+
+		}
+
+		fileStream << meshSize << "," << threads << "," << time << "," << singleThreadTime / time << "," << vertexCount / 3 << std::endl;
+		printf("%8d %10.2f %10.2f %10zu\n", threads, time, singleThreadTime / time, vertexCount / 3);
+
+	}
+
+	fileStream << std::endl;
+
+}
+
+void HeadlessApp::BenchmarkLatency()
+{
+
+	OpenResults("latency.csv");
+
+	fileStream << "mesh size" << "," << "mode" << "," << "mean frame (ms)" << "," << "p99 frame (ms)" << "," << "max frame (ms)" << "," << "meshes swapped" << std::endl;
+	printf("%12s %16s %16s %16s %16s\n", "mode", "mean frame (ms)", "p99 frame (ms)", "max frame (ms)", "meshes swapped");
+
+	for (int background = 0; background < 2; background++)
+	{
+
+		std::vector<double> frameTimes;
+		int meshesSwapped = 0;
+
+		RunFrameLoop(background == 1, frameTimes, meshesSwapped);
+
+		double total = 0.0;
+
+		for (size_t i = 0; i < frameTimes.size(); i++)
+		{
+
+			total += frameTimes[i];
+
+		}
+
+		std::sort(frameTimes.begin(), frameTimes.end());
+
+		double mean = total / frameTimes.size();
+		double p99 = frameTimes[(frameTimes.size() * 99) / 100];
+		double maximum = frameTimes.back();
+		const char* modeName = background ? "background" : "synchronous";
+
+		fileStream << meshSize << "," << modeName << "," << mean << "," << p99 << "," << maximum << "," << meshesSwapped << std::endl;
+		printf("%12s %16.3f %16.3f %16.3f %16d\n", modeName, mean, p99, maximum, meshesSwapped);
+
+	}
+
+	fileStream << std::endl;
+
+}
+
+void HeadlessApp::RunFrameLoop(bool isBackground, std::vector<double>& frameTimes, int& meshesSwapped)
+{
+
+	JobScheduler scheduler(maxThreads);
+	CPUPipeline pipeline(&scheduler);
+	AsyncRegenerator regenerator(maxThreads);
+
+	// The front buffer that the simulated render reads every frame
+	std::vector<MeshVertex> frontMesh;
+	float checksum = 0.0f;
+
+	meshesSwapped = 0;
+	frameTimes.clear();
+
+	for (int frame = 0; frame < frames; frame++)
+	{
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		// Emulate the user dragging an offset, as App1::gui would
+		if (frame % requestInterval == 0)
+		{
+
+			offsets[0] += 1.0f;
+
+			if (isBackground)
+			{
+
+				regenerator.Request(getGenerationParameters());
+
+			}
+			else
+			{
+
+				GenerationParameters parameters = getGenerationParameters();
+				pipeline.UpdateMeshValues(parameters.dimsX, parameters.dimsY, parameters.dimsZ);
+				pipeline.UpdateNoiseValues(parameters.noise);
+				pipeline.UpdateExtractionValues(parameters.isoValue, parameters.meshScaleFactor);
+				pipeline.Run();
+				pipeline.swapVertices(frontMesh);
+				meshesSwapped++;
+
+			}
+
+		}
+
+		if (isBackground)
+		{
+
+			std::unique_ptr<GeneratedMesh> mesh = regenerator.TakeCompleted();
+
+			if (mesh)
+			{
+
+				frontMesh.swap(mesh->vertices);
+				meshesSwapped++;
+
+			}
+
+		}
+
+		checksum += RenderFrame(frontMesh);
+
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		frameTimes.push_back(getMilliseconds(start, end));
+
+		// Wait for the next simulated vsync
+		std::this_thread::sleep_until(start + std::chrono::milliseconds(frameMilliseconds));
+
+	}
+
+	offsets[0] = 0.0f;
+
+	// Keep the simulated render from being optimised away
+	if (checksum == 1.0f)
+	{
+
+		printf("\n");
+
+	}
+
+}
+
+float HeadlessApp::RenderFrame(const std::vector<MeshVertex>& vertices)
+{
+
+	float sum = 0.0f;
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+
+		sum += vertices[i].position[1];
+
+	}
+
+	return sum;
+
+}
+
+void HeadlessApp::BenchmarkComputePasses()
+{
+
+	// Only the volume is needed from the pipeline; extraction is timed single threaded below
+	JobScheduler scheduler(maxThreads);
+	CPUPipeline pipeline(&scheduler);
+
+	pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	pipeline.UpdateNoiseValues(getNoiseParameters());
+	pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+	pipeline.Run();
+
+	const DensityVolume& volume = pipeline.getVolume();
+	CPUMarchingCubes marchingCubes;
+	marchingCubes.UpdateValues(isovalue, meshScaleFactor);
+
+	std::vector<MeshVertex> singlePassVertices;
+	std::vector<MeshVertex> computeVertices;
+	std::vector<unsigned int> cubeIndices;
+	std::vector<unsigned int> triangleOffsets;
+	double singlePassTime = 0.0;
+	double classifyTime = 0.0;
+	double scanTime = 0.0;
+	double emitTime = 0.0;
+
+	for (int i = 0; i < repetitions; i++)
+	{
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		singlePassVertices.clear();
+		marchingCubes.Run(volume, 0, meshSize, singlePassVertices);
+		std::chrono::steady_clock::time_point singlePassEnd = std::chrono::steady_clock::now();
+
+		marchingCubes.Classify(volume, cubeIndices, triangleOffsets);
+		std::chrono::steady_clock::time_point classifyEnd = std::chrono::steady_clock::now();
+		CPUMarchingCubes::ExclusiveScan(triangleOffsets);
+		std::chrono::steady_clock::time_point scanEnd = std::chrono::steady_clock::now();
+		marchingCubes.Emit(volume, cubeIndices, triangleOffsets, computeVertices);
+		std::chrono::steady_clock::time_point emitEnd = std::chrono::steady_clock::now();
+
+		singlePassTime += getMilliseconds(start, singlePassEnd);
+		classifyTime += getMilliseconds(singlePassEnd, classifyEnd);
+		scanTime += getMilliseconds(classifyEnd, scanEnd);
+		emitTime += getMilliseconds(scanEnd, emitEnd);
+
+	}
+
+	// The scanned offsets preserve cell order, so both paths should produce identical vertex streams
+	bool isMatching = singlePassVertices.size() == computeVertices.size() &&
+		(singlePassVertices.empty() || memcmp(singlePassVertices.data(), computeVertices.data(), singlePassVertices.size() * sizeof(MeshVertex)) == 0);
+
+	singlePassTime /= repetitions;
+	classifyTime /= repetitions;
+	scanTime /= repetitions;
+	emitTime /= repetitions;
+
+	OpenResults("compute_passes.csv");
+
+	fileStream << "mesh size" << "," << "single pass (ms)" << "," << "classify (ms)" << "," << "scan (ms)" << "," << "emit (ms)" << "," << "triangles" << "," << "matching" << std::endl;
+	fileStream << meshSize << "," << singlePassTime << "," << classifyTime << "," << scanTime << "," << emitTime << "," << computeVertices.size() / 3 << "," << isMatching << std::endl << std::endl;
+
+	printf("%d^3 volume, %zu triangles\n", meshSize, computeVertices.size() / 3);
+	printf("  single pass:        %10.2f ms\n", singlePassTime);
+	printf("  classify/scan/emit: %10.2f ms (%.2f + %.2f + %.2f)\n", classifyTime + scanTime + emitTime, classifyTime, scanTime, emitTime);
+	printf("  output %s\n", isMatching ? "matches" : "DIFFERS");
+
+}
+
+void HeadlessApp::BenchmarkShift()
+{
+
+	ToroidalVolume volume;
+	volume.Allocate(meshSize, meshSize, meshSize);
+	volume.UpdateNoiseValues(getNoiseParameters());
+	volume.UpdateExtractionValues(isovalue, meshScaleFactor);
+
+	// Baseline: generate and extract the whole window
+	double fullTime = 0.0;
+
+	for (int i = 0; i < repetitions; i++)
+	{
+
+		volume.Allocate(meshSize, meshSize, meshSize);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		volume.Update(i * meshSize, 0);
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		fullTime += getMilliseconds(start, end);
+
+	}
+
+	fullTime /= repetitions;
+
+	OpenResults("shift.csv");
+
+	fileStream << "mesh size" << "," << "shift (voxels)" << "," << "time (ms)" << "," << "speedup" << "," << "voxels generated" << "," << "chunks extracted" << "," << "chunks kept" << "," << "matching" << std::endl;
+	fileStream << meshSize << "," << "full" << "," << fullTime << "," << 1.0 << "," << (size_t)meshSize * meshSize * meshSize << ",,," << std::endl;
+	printf("full regeneration: %.2f ms\n", fullTime);
+	printf("%8s %10s %10s %16s %16s %12s %9s\n", "shift", "time (ms)", "speedup", "voxels generated", "chunks extracted", "chunks kept", "matching");
+
+	std::vector<MeshVertex> scrolledVertices;
+	std::vector<MeshVertex> freshVertices;
+
+	for (int shift = 1; shift <= meshSize; shift *= 2)
+	{
+
+		// Start from a fully generated window, then scroll it along X
+		int origin = 0;
+		volume.Allocate(meshSize, meshSize, meshSize);
+		volume.Update(origin, 0);
+
+		double time = 0.0;
+
+		for (int i = 0; i < repetitions; i++)
+		{
+
+			origin += shift;
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			volume.Update(origin, 0);
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+			time += getMilliseconds(start, end);
+
+		}
+
+		time /= repetitions;
+
+		// The scrolled mesh should be identical to one generated from scratch at the final position
+		ToroidalVolume freshVolume;
+		freshVolume.Allocate(meshSize, meshSize, meshSize);
+		freshVolume.UpdateNoiseValues(getNoiseParameters());
+		freshVolume.UpdateExtractionValues(isovalue, meshScaleFactor);
+		freshVolume.Update(origin, 0);
+
+		volume.getVertices(scrolledVertices);
+		freshVolume.getVertices(freshVertices);
+
+		bool isMatching = scrolledVertices.size() == freshVertices.size() &&
+			(freshVertices.empty() || memcmp(scrolledVertices.data(), freshVertices.data(), freshVertices.size() * sizeof(MeshVertex)) == 0);
+
+		fileStream << meshSize << "," << shift << "," << time << "," << fullTime / time << "," << volume.getVoxelsGenerated() << ","
+			<< volume.getChunksExtracted() << "," << volume.getChunksKept() << "," << isMatching << std::endl;
+		printf("%8d %10.2f %10.2f %16zu %16d %12d %9s\n", shift, time, fullTime / time, volume.getVoxelsGenerated(),
+			volume.getChunksExtracted(), volume.getChunksKept(), isMatching ? "yes" : "NO");
+
+	}
+
+	fileStream << std::endl;
+
+}
+
+void HeadlessApp::BenchmarkStreaming()
+{
+
+	JobScheduler scheduler(maxThreads);
+	size_t voxelCount = (size_t)meshSize * meshSize * meshSize;
+	size_t baselineMemory = getPeakMemory();
+
+	// Streamed slabs aren't kept, so the peak below is the window plus a slab of vertices
+	// The checksum compares the two meshes without holding the streamed one
+	size_t streamedTriangles = 0;
+	double streamedChecksum = 0.0;
+
+	StreamingPipeline streaming(&scheduler);
+	streaming.setSlabDepth(slabDepth);
+	streaming.UpdateMeshValues(meshSize, meshSize, meshSize);
+	streaming.UpdateNoiseValues(getNoiseParameters());
+	streaming.UpdateExtractionValues(isovalue, meshScaleFactor);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	streaming.Run([&streamedTriangles, &streamedChecksum](const std::vector<MeshVertex>& vertices)
+	{
+
+		streamedTriangles += vertices.size() / 3;
+
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+
+			streamedChecksum += (double)vertices[i].position[0] + vertices[i].position[1] + vertices[i].position[2];
+
+		}
+
+	});
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	double streamingTime = getMilliseconds(start, end);
+	size_t streamingMemory = getPeakMemory();
+	size_t windowBytes = streaming.getWindowBytes();
+	streaming.releaseWindow();
+
+	// The in-core pipeline runs second, as the process peak can only grow
+	CPUPipeline pipeline(&scheduler);
+	pipeline.setSlabDepth(slabDepth);
+	pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	pipeline.UpdateNoiseValues(getNoiseParameters());
+	pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+
+	start = std::chrono::steady_clock::now();
+	pipeline.Run();
+	end = std::chrono::steady_clock::now();
+
+	double inCoreTime = getMilliseconds(start, end);
+	size_t inCoreMemory = getPeakMemory();
+
+	const std::vector<MeshVertex>& vertices = pipeline.getVertices();
+	double inCoreChecksum = 0.0;
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+
+		inCoreChecksum += (double)vertices[i].position[0] + vertices[i].position[1] + vertices[i].position[2];
+
+	}
+
+	// Positions in the window are offset back into the volume afterwards, which can round differently in the last bit
+	bool isMatching = streamedTriangles == vertices.size() / 3 &&
+		fabs(streamedChecksum - inCoreChecksum) <= 1e-6 * (fabs(inCoreChecksum) + 1.0);
+
+	double megabyte = 1024.0 * 1024.0;
+
+	OpenResults("streaming.csv");
+
+	fileStream << "mesh size" << "," << "mode" << "," << "time (ms)" << "," << "Mvoxels/s" << "," << "peak RSS (MB)" << "," << "volume or window (MB)" << "," << "triangles" << "," << "matching" << std::endl;
+	fileStream << meshSize << "," << "streaming" << "," << streamingTime << "," << voxelCount / streamingTime / 1000.0 << "," << streamingMemory / megabyte << ","
+		<< windowBytes / megabyte << "," << streamedTriangles << "," << isMatching << std::endl;
+	fileStream << meshSize << "," << "in-core" << "," << inCoreTime << "," << voxelCount / inCoreTime / 1000.0 << "," << inCoreMemory / megabyte << ","
+		<< voxelCount * sizeof(float) / megabyte << "," << vertices.size() / 3 << "," << isMatching << std::endl << std::endl;
+
+	printf("%d^3 volume on %d threads, process baseline %.1f MB\n", meshSize, scheduler.getThreadCount(), baselineMemory / megabyte);
+	printf("%10s %12s %12s %16s %18s %12s\n", "mode", "time (ms)", "Mvoxels/s", "peak RSS (MB)", "volume/window (MB)", "triangles");
+	printf("%10s %12.1f %12.2f %16.1f %18.2f %12zu\n", "streaming", streamingTime, voxelCount / streamingTime / 1000.0, streamingMemory / megabyte, windowBytes / megabyte, streamedTriangles);
+	printf("%10s %12.1f %12.2f %16.1f %18.2f %12zu\n", "in-core", inCoreTime, voxelCount / inCoreTime / 1000.0, inCoreMemory / megabyte, voxelCount * sizeof(float) / megabyte, vertices.size() / 3);
+	printf("  output %s\n", isMatching ? "matches" : "DIFFERS");
+
+}
+
+void HeadlessApp::BenchmarkOutOfCore()
+{
+
+	JobScheduler scheduler(maxThreads);
+	StreamingPipeline pipeline(&scheduler);
+	size_t voxelCount = (size_t)meshSize * meshSize * meshSize;
+	size_t budgetBytes = (size_t)memoryBudget << 20;
+	size_t baselineMemory = getPeakMemory();
+
+	pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	pipeline.UpdateNoiseValues(getNoiseParameters());
+	pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+
+	if (!pipeline.setMemoryBudget(budgetBytes))
+	{
+
+		printf("A %d MB budget is too small for a %d^3 volume\n", memoryBudget, meshSize);
+		return;
+
+	}
+
+	MeshFileWriter writer;
+
+	if (!writer.Open(outputPath.c_str(), pipeline.getFileBufferBytes()))
+	{
+
+		printf("Couldn't create %s\n", outputPath.c_str());
+		return;
+
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	pipeline.Run(writer);
+	bool isWritten = writer.Close();
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	double time = getMilliseconds(start, end);
+	size_t peakMemory = getPeakMemory();
+	size_t triangleCount = (size_t)(writer.getVertexCount() / 3);
+	double fileMegabytes = (sizeof(MeshFileWriter::Header) + writer.getVertexCount() * sizeof(MeshVertex)) / (1024.0 * 1024.0);
+
+	// The budget covers what the pipeline allocates, on top of whatever the process already used
+	double megabyte = 1024.0 * 1024.0;
+	bool isWithinBudget = peakMemory <= baselineMemory + budgetBytes;
+
+	OpenResults("outofcore.csv");
+
+	fileStream << "mesh size" << "," << "threads" << "," << "budget (MB)" << "," << "planned (MB)" << "," << "baseline RSS (MB)" << "," << "peak RSS (MB)" << ","
+		<< "time (s)" << "," << "Mvoxels/s" << "," << "triangles" << "," << "file (MB)" << "," << "within budget" << std::endl;
+	fileStream << meshSize << "," << scheduler.getThreadCount() << "," << memoryBudget << "," << pipeline.getPlannedBytes() / megabyte << "," << baselineMemory / megabyte << ","
+		<< peakMemory / megabyte << "," << time / 1000.0 << "," << voxelCount / time / 1000.0 << "," << triangleCount << "," << fileMegabytes << "," << isWithinBudget << std::endl << std::endl;
+
+	printf("%d^3 volume on %d threads, %d MB budget (%.1f MB planned, %.1f MB window)\n", meshSize, scheduler.getThreadCount(), memoryBudget,
+		pipeline.getPlannedBytes() / megabyte, pipeline.getWindowBytes() / megabyte);
+	printf("  %.2f s, %.2f Mvoxels/s, %zu triangles written to %s (%.1f MB)%s\n", time / 1000.0, voxelCount / time / 1000.0, triangleCount,
+		outputPath.c_str(), fileMegabytes, isWritten ? "" : " - WRITE FAILED");
+	printf("  peak RSS %.1f MB over a %.1f MB baseline, %s the budget\n", peakMemory / megabyte, baselineMemory / megabyte, isWithinBudget ? "within" : "OVER");
+
+}
+
+void HeadlessApp::BenchmarkCache()
+{
+
+	JobScheduler scheduler(maxThreads);
+	VolumeCache cache;
+
+	if (!cache.Open(cacheDirectory, (unsigned long long)cacheSize << 20))
+	{
+
+		printf("Couldn't open the volume cache in %s\n", cacheDirectory.c_str());
+		return;
+
+	}
+
+	// Start cold, so the first cached run has to generate and store the volume
+	cache.Clear();
+
+	// Reference mesh from a pipeline without the cache
+	CPUPipeline reference(&scheduler);
+	reference.setSlabDepth(slabDepth);
+	reference.UpdateMeshValues(meshSize, meshSize, meshSize);
+	reference.UpdateNoiseValues(getNoiseParameters());
+	reference.UpdateExtractionValues(isovalue, meshScaleFactor);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	reference.Run();
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	double uncachedTime = getMilliseconds(start, end);
+
+	// Cold start: a miss, so the volume is generated, extracted and written to the cache
+	double coldTime = 0.0;
+
+	{
+
+		CPUPipeline pipeline(&scheduler);
+		pipeline.setSlabDepth(slabDepth);
+		pipeline.setVolumeCache(&cache);
+		pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+		pipeline.UpdateNoiseValues(getNoiseParameters());
+		pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+
+		start = std::chrono::steady_clock::now();
+		pipeline.Run();
+		end = std::chrono::steady_clock::now();
+
+		coldTime = getMilliseconds(start, end);
+
+	}
+
+	// Warm starts: a fresh pipeline each time, as after restarting the application, so only the cache carries over
+	double warmTime = 0.0;
+	bool isMatching = true;
+
+	for (int i = 0; i < repetitions; i++)
+	{
+
+		CPUPipeline pipeline(&scheduler);
+		pipeline.setSlabDepth(slabDepth);
+		pipeline.setVolumeCache(&cache);
+		pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+		pipeline.UpdateNoiseValues(getNoiseParameters());
+		pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+
+		start = std::chrono::steady_clock::now();
+		pipeline.Run();
+		end = std::chrono::steady_clock::now();
+
+		warmTime += getMilliseconds(start, end);
+
+		const std::vector<MeshVertex>& a = reference.getVertices();
+		const std::vector<MeshVertex>& b = pipeline.getVertices();
+		isMatching = isMatching && a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(MeshVertex)) == 0);
+
+	}
+
+	warmTime /= repetitions;
+
+	// The lookup and mapping on their own, without the extraction
+	unsigned long long key = VolumeCache::HashKey(getNoiseParameters(), meshSize, meshSize, meshSize);
+	double mapTime = 0.0;
+
+	for (int i = 0; i < repetitions; i++)
+	{
+
+		MappedFile file;
+		DensityVolume volume;
+
+		start = std::chrono::steady_clock::now();
+		cache.Load(key, meshSize, meshSize, meshSize, file, volume);
+		end = std::chrono::steady_clock::now();
+
+		mapTime += getMilliseconds(start, end);
+
+	}
+
+	mapTime /= repetitions;
+
+	double megabyte = 1024.0 * 1024.0;
+
+	OpenResults("cache.csv");
+
+	fileStream << "mesh size" << "," << "threads" << "," << "uncached (ms)" << "," << "cold (ms)" << "," << "warm (ms)" << "," << "map (ms)" << ","
+		<< "cached (MB)" << "," << "hits" << "," << "misses" << "," << "matching" << std::endl;
+	fileStream << meshSize << "," << scheduler.getThreadCount() << "," << uncachedTime << "," << coldTime << "," << warmTime << "," << mapTime << ","
+		<< cache.getCachedBytes() / megabyte << "," << cache.getHitCount() << "," << cache.getMissCount() << "," << isMatching << std::endl << std::endl;
+
+	printf("%d^3 volume on %d threads, %.1f MB cached in %s\n", meshSize, scheduler.getThreadCount(), cache.getCachedBytes() / megabyte, cacheDirectory.c_str());
+	printf("  uncached:         %10.2f ms\n", uncachedTime);
+	printf("  cold start:       %10.2f ms (generate and store)\n", coldTime);
+	printf("  warm start:       %10.2f ms (map and extract, %.1fx faster than uncached)\n", warmTime, uncachedTime / warmTime);
+	printf("  map only:         %10.2f ms\n", mapTime);
+	printf("  %d hits, %d misses, output %s\n", cache.getHitCount(), cache.getMissCount(), isMatching ? "matches" : "DIFFERS");
+
+}
+
+void HeadlessApp::BenchmarkAnisotropicVolumes()
+{
+
+	JobScheduler scheduler(maxThreads);
+	CPUPipeline pipeline(&scheduler);
+	NoiseParameters cubeNoise = getNoiseParameters();
+
+	pipeline.UpdateMeshValues(meshSize, meshSize, meshSize);
+	pipeline.UpdateNoiseValues(cubeNoise);
+	pipeline.UpdateExtractionValues(isovalue, meshScaleFactor);
+
+	// Warm up once so the first measurement doesn't pay for page faults on the volume
+	pipeline.Run();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < repetitions; i++)
+	{
+
+		pipeline.Run();
+
+	}
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	double cubeTime = getMilliseconds(start, end) / repetitions;
+
+	std::vector<MeshVertex> cubeVertices = pipeline.getVertices();
+
+	if (cubeVertices.empty())
+	{
+
+		printf("%d^3 volume has no surface\n", meshSize);
+		return;
+
+	}
+
+	// The band of Y the surface occupies, in voxels
+	float minY = FLT_MAX;
+	float maxY = -FLT_MAX;
+
+	for (size_t i = 0; i < cubeVertices.size(); i++)
+	{
+
+		minY = std::min(minY, cubeVertices[i].position[1] / meshScaleFactor);
+		maxY = std::max(maxY, cubeVertices[i].position[1] / meshScaleFactor);
+
+	}
+
+	// Keep a layer of voxels either side, so every cell cut off is one the surface doesn't pass through
+	int yBegin = std::max((int)floorf(minY) - 1, 0);
+	int yEnd = std::min((int)ceilf(maxY) + 2, meshSize);
+	int height = yEnd - yBegin;
+
+	// The same terrain in a volume that only spans the band: move the noise up by yBegin voxels, and keep the height
+	// gradient's change per voxel while it spans fewer voxels
+	NoiseParameters bandNoise = cubeNoise;
+	bandNoise.noiseOffsets[1] += yBegin * meshScaleFactor * noiseScaleFactors[1];
+	bandNoise.heightBase += heightMultiplier * yBegin / meshSize;
+	bandNoise.heightMultiplier = heightMultiplier * height / meshSize;
+
+	pipeline.UpdateMeshValues(meshSize, height, meshSize);
+	pipeline.UpdateNoiseValues(bandNoise);
+	pipeline.Run();
+
+	start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < repetitions; i++)
+	{
+
+		pipeline.Run();
+
+	}
+
+	end = std::chrono::steady_clock::now();
+	double bandTime = getMilliseconds(start, end) / repetitions;
+
+	const std::vector<MeshVertex>& bandVertices = pipeline.getVertices();
+
+	// The noise is sampled at positions that round differently, so compare the counts and position sums as the streaming
+	// benchmark does, with the band's vertices moved back up to where they sit in the cube
+	double cubeChecksum = 0.0;
+	double bandChecksum = 0.0;
+
+	for (size_t i = 0; i < cubeVertices.size(); i++)
+	{
+
+		cubeChecksum += (double)cubeVertices[i].position[0] + cubeVertices[i].position[1] + cubeVertices[i].position[2];
+
+	}
+
+	for (size_t i = 0; i < bandVertices.size(); i++)
+	{
+
+		bandChecksum += (double)bandVertices[i].position[0] + bandVertices[i].position[1] + yBegin * meshScaleFactor + bandVertices[i].position[2];
+
+	}
+
+	bool isMatching = cubeVertices.size() == bandVertices.size() && fabs(bandChecksum - cubeChecksum) <= 1e-5 * (fabs(cubeChecksum) + 1.0);
+
+	double megabyte = 1024.0 * 1024.0;
+	size_t cubeVoxels = (size_t)meshSize * meshSize * meshSize;
+	size_t bandVoxels = (size_t)meshSize * height * meshSize;
+
+	OpenResults("aniso.csv");
+
+	fileStream << "mesh size" << "," << "volume" << "," << "dims" << "," << "voxels" << "," << "volume (MB)" << "," << "time (ms)" << "," << "Mvoxels/s" << "," << "triangles" << "," << "matching" << std::endl;
+	fileStream << meshSize << "," << "cube" << "," << meshSize << "x" << meshSize << "x" << meshSize << "," << cubeVoxels << "," << cubeVoxels * sizeof(float) / megabyte << ","
+		<< cubeTime << "," << cubeVoxels / cubeTime / 1000.0 << "," << cubeVertices.size() / 3 << "," << isMatching << std::endl;
+	fileStream << meshSize << "," << "band" << "," << meshSize << "x" << height << "x" << meshSize << "," << bandVoxels << "," << bandVoxels * sizeof(float) / megabyte << ","
+		<< bandTime << "," << bandVoxels / bandTime / 1000.0 << "," << bandVertices.size() / 3 << "," << isMatching << std::endl << std::endl;
+
+	printf("%d^3 volume: surface in Y [%d, %d), %d of %d voxels tall; meshes %s\n", meshSize, yBegin, yEnd, height, meshSize, isMatching ? "match" : "DIFFER");
+	printf("%16s %12s %12s %12s %12s\n", "dims", "volume (MB)", "time (ms)", "Mvoxels/s", "triangles");
+	printf("%5dx%4dx%5d %12.1f %12.2f %12.2f %12zu\n", meshSize, meshSize, meshSize, cubeVoxels * sizeof(float) / megabyte, cubeTime, cubeVoxels / cubeTime / 1000.0, cubeVertices.size() / 3);
+	printf("%5dx%4dx%5d %12.1f %12.2f %12.2f %12zu\n", meshSize, height, meshSize, bandVoxels * sizeof(float) / megabyte, bandTime, bandVoxels / bandTime / 1000.0, bandVertices.size() / 3);
+	printf("  %.0f%% of the voxels, %.2fx faster\n", 100.0 * bandVoxels / cubeVoxels, cubeTime / bandTime);
+
+}
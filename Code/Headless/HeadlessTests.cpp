@@ -0,0 +1,1223 @@
+#include "HeadlessTests.h"
+#include "../CPUMarchingCubes.h"
+#include "../CellIndex.h"
+#include "../GPUProfiler.h"
+#include "../MaterialWeights.h"
+#include "../OutputBufferPredictor.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Where the shader sources are read from; CMake points this at Code/shaders
+#ifndef HEADLESS_SHADER_DIRECTORY
+#define HEADLESS_SHADER_DIRECTORY "../shaders"
+#endif
+
+// Prints one check's result and counts it if it failed
+static void Check(bool isPassed, const char* name, int& failures)
+{
+
+	printf("  %s %s\n", isPassed ? "pass" : "FAIL", name);
+
+	if (!isPassed)
+	{
+
+		failures++;
+
+	}
+
+}
+
+static bool IsNear(double a, double b)
+{
+
+	return fabs(a - b) < 1e-9;
+
+}
+
+// Reads a shader source into source, returning false if it can't be opened
+static bool ReadShader(const char* name, std::string& source)
+{
+
+	std::ifstream file(std::string(HEADLESS_SHADER_DIRECTORY) + "/" + name);
+
+	if (!file)
+	{
+
+		return false;
+
+	}
+
+	std::stringstream stream;
+	stream << file.rdbuf();
+	source = stream.str();
+
+	return true;
+
+}
+
+// The expression returned by the shader function whose declaration starts with signature, e.g. "uint CellIndex("
+static bool FindReturnExpression(const std::string& source, const char* signature, std::string& expression)
+{
+
+	size_t start = source.find(signature);
+	size_t returnStart = start == std::string::npos ? start : source.find("return ", start);
+	size_t returnEnd = returnStart == std::string::npos ? returnStart : source.find(';', returnStart);
+
+	if (returnEnd == std::string::npos)
+	{
+
+		return false;
+
+	}
+
+	expression = source.substr(returnStart + 7, returnEnd - returnStart - 7);
+
+	return true;
+
+}
+
+// Evaluates the uint arithmetic of a shader expression: |, &, <<, >>, +, -, *, /, % and brackets over literals and named
+// values such as "cell.x"; a uint3 constructor gives one value per argument; returns false on anything else
+class ShaderExpression
+{
+
+public:
+
+	ShaderExpression(const std::string& ltext, const std::map<std::string, unsigned int>& lvalues) : text(ltext), values(lvalues), position(0)
+	{
+
+	}
+
+	bool Evaluate(std::vector<unsigned int>& results)
+	{
+
+		results.clear();
+		SkipSpaces();
+
+		bool isVector = text.compare(position, 6, "uint3(") == 0;
+
+		if (isVector)
+		{
+
+			position += 6;
+
+		}
+
+		do
+		{
+
+			unsigned int value;
+
+			if (!ParseOr(value))
+			{
+
+				return false;
+
+			}
+
+			results.push_back(value);
+
+		} while (isVector && Accept(','));
+
+		return (!isVector || Accept(')')) && (SkipSpaces(), position == text.size());
+
+	}
+
+private:
+
+	void SkipSpaces()
+	{
+
+		while (position < text.size() && isspace((unsigned char)text[position]))
+		{
+
+			position++;
+
+		}
+
+	}
+
+	bool Accept(char c)
+	{
+
+		SkipSpaces();
+
+		if (position < text.size() && text[position] == c)
+		{
+
+			position++;
+			return true;
+
+		}
+
+		return false;
+
+	}
+
+	bool ParseOr(unsigned int& value)
+	{
+
+		if (!ParseAnd(value))
+		{
+
+			return false;
+
+		}
+
+		unsigned int operand;
+
+		while (Accept('|'))
+		{
+
+			if (!ParseAnd(operand))
+			{
+
+				return false;
+
+			}
+
+			value |= operand;
+
+		}
+
+		return true;
+
+	}
+
+	bool ParseAnd(unsigned int& value)
+	{
+
+		if (!ParseShift(value))
+		{
+
+			return false;
+
+		}
+
+		unsigned int operand;
+
+		while (Accept('&'))
+		{
+
+			if (!ParseShift(operand))
+			{
+
+				return false;
+
+			}
+
+			value &= operand;
+
+		}
+
+		return true;
+
+	}
+
+	bool ParseShift(unsigned int& value)
+	{
+
+		if (!ParseSum(value))
+		{
+
+			return false;
+
+		}
+
+		for (;;)
+		{
+
+			SkipSpaces();
+
+			bool isLeft = text.compare(position, 2, "<<") == 0;
+			bool isRight = text.compare(position, 2, ">>") == 0;
+			unsigned int operand;
+
+			if (!isLeft && !isRight)
+			{
+
+				return true;
+
+			}
+
+			position += 2;
+
+			if (!ParseSum(operand) || operand >= 32)
+			{
+
+				return false;
+
+			}
+
+			value = isLeft ? value << operand : value >> operand;
+
+		}
+
+	}
+
+	bool ParseSum(unsigned int& value)
+	{
+
+		if (!ParseProduct(value))
+		{
+
+			return false;
+
+		}
+
+		for (;;)
+		{
+
+			unsigned int operand;
+
+			if (Accept('+'))
+			{
+
+				if (!ParseProduct(operand))
+				{
+
+					return false;
+
+				}
+
+				value += operand;
+
+			}
+			else if (Accept('-'))
+			{
+
+				if (!ParseProduct(operand))
+				{
+
+					return false;
+
+				}
+
+				value -= operand;
+
+			}
+			else
+			{
+
+				return true;
+
+			}
+
+		}
+
+	}
+
+	bool ParseProduct(unsigned int& value)
+	{
+
+		if (!ParseFactor(value))
+		{
+
+			return false;
+
+		}
+
+		for (;;)
+		{
+
+			char op = Accept('*') ? '*' : Accept('/') ? '/' : Accept('%') ? '%' : 0;
+			unsigned int operand;
+
+			if (op == 0)
+			{
+
+				return true;
+
+			}
+
+			if (!ParseFactor(operand) || (op != '*' && operand == 0))
+			{
+
+				return false;
+
+			}
+
+			value = op == '*' ? value * operand : op == '/' ? value / operand : value % operand;
+
+		}
+
+	}
+
+	bool ParseFactor(unsigned int& value)
+	{
+
+		if (Accept('('))
+		{
+
+			return ParseOr(value) && Accept(')');
+
+		}
+
+		size_t start = position;
+
+		while (position < text.size() && (isalnum((unsigned char)text[position]) || text[position] == '_' || text[position] == '.'))
+		{
+
+			position++;
+
+		}
+
+		std::string name = text.substr(start, position - start);
+
+		if (name.empty())
+		{
+
+			return false;
+
+		}
+
+		// Decimal or hex, with or without a u suffix
+		if (isdigit((unsigned char)name[0]))
+		{
+
+			char* end;
+			value = (unsigned int)strtoul(name.c_str(), &end, 0);
+			return *end == 0 || strcmp(end, "u") == 0;
+
+		}
+
+		std::map<std::string, unsigned int>::const_iterator found = values.find(name);
+
+		if (found == values.end())
+		{
+
+			return false;
+
+		}
+
+		value = found->second;
+
+		return true;
+
+	}
+
+	const std::string& text;
+	const std::map<std::string, unsigned int>& values;
+	size_t position;
+
+};
+
+// Results with every stage taking the given time at 1 MHz
+static FrameQueryResults MakeFrameResults(unsigned long long microseconds)
+{
+
+	FrameQueryResults results;
+	memset(&results, 0, sizeof(results));
+	results.frequency = 1000000;
+
+	for (int i = 0; i < PROFILER_STAGE_COUNT; i++)
+	{
+
+		results.stages[i].beginTimestamp = 1000;
+		results.stages[i].endTimestamp = 1000 + microseconds;
+
+	}
+
+	return results;
+
+}
+
+// Records one frame with every stage bracketed, as App1::Run does
+static void RecordFrame(GPUProfiler& profiler)
+{
+
+	profiler.BeginFrame();
+
+	for (int i = 0; i < PROFILER_STAGE_COUNT; i++)
+	{
+
+		profiler.BeginStage((ProfilerStage)i);
+		profiler.EndStage((ProfilerStage)i);
+
+	}
+
+	profiler.EndFrame();
+
+}
+
+static void TestProfiler(int& failures)
+{
+
+	printf("GPUProfiler\n");
+
+	// Frames resolve only once the backend's latency has passed, and then in submission order
+	{
+
+		NullQueryBackend* backend = new NullQueryBackend(2);
+		GPUProfiler profiler(backend, 4);
+		backend->setResults(MakeFrameResults(2000));
+
+		RecordFrame(profiler);
+		bool isWaiting = profiler.Update() == 0;
+		RecordFrame(profiler);
+		isWaiting = isWaiting && profiler.Update() == 0;
+		RecordFrame(profiler);
+		int resolved = profiler.Update();
+
+		Check(isWaiting && resolved == 1, "results are held back for the backend's latency", failures);
+		Check(IsNear(profiler.getStageStatistics(PROFILER_STAGE_NOISE).lastMilliseconds, 2.0), "stage time converts ticks to milliseconds", failures);
+		Check(IsNear(profiler.getLastFrameMilliseconds(), 2.0 * PROFILER_STAGE_COUNT), "frame time sums the stages", failures);
+
+		// The two frames still in flight took 2 ms, then one of 4 ms resolves; the average starts at the first frame and
+		// moves a tenth of the way to each new one
+		backend->setResults(MakeFrameResults(4000));
+
+		for (int i = 0; i < 3; i++)
+		{
+
+			RecordFrame(profiler);
+			profiler.Update();
+
+		}
+
+		const StageStatistics& noise = profiler.getStageStatistics(PROFILER_STAGE_NOISE);
+
+		Check(noise.framesResolved == 4 && IsNear(noise.lastMilliseconds, 4.0) && IsNear(noise.averageMilliseconds, 2.0 + (4.0 - 2.0) * 0.1),
+			"moving average weights each new frame by a tenth", failures);
+		Check(profiler.getDroppedFrames() == 0, "no frames dropped while the ring keeps up", failures);
+
+	}
+
+	// Disjoint frames are dropped without touching the statistics
+	{
+
+		NullQueryBackend* backend = new NullQueryBackend(0);
+		GPUProfiler profiler(backend, 4);
+		backend->setResults(MakeFrameResults(1000));
+		RecordFrame(profiler);
+		profiler.Update();
+
+		FrameQueryResults disjoint = MakeFrameResults(9000);
+		disjoint.isDisjoint = true;
+		backend->setResults(disjoint);
+		RecordFrame(profiler);
+		int resolved = profiler.Update();
+		const StageStatistics& noise = profiler.getStageStatistics(PROFILER_STAGE_NOISE);
+
+		Check(resolved == 0 && profiler.getDroppedFrames() == 1, "disjoint frames are dropped", failures);
+		Check(noise.framesResolved == 1 && IsNear(noise.averageMilliseconds, 1.0), "disjoint frames leave the statistics alone", failures);
+
+	}
+
+	// A backend further behind than the ring is deep drops the oldest frames rather than stalling
+	{
+
+		NullQueryBackend* backend = new NullQueryBackend(10);
+		GPUProfiler profiler(backend, 4);
+		backend->setResults(MakeFrameResults(1000));
+
+		for (int i = 0; i < 6; i++)
+		{
+
+			RecordFrame(profiler);
+			profiler.Update();
+
+		}
+
+		Check(profiler.getDroppedFrames() == 2, "a full ring drops its oldest frame", failures);
+
+	}
+
+	// Stream output that needed more primitives than it wrote is flagged as an overflow
+	{
+
+		NullQueryBackend* backend = new NullQueryBackend(0);
+		GPUProfiler profiler(backend, 4);
+		FrameQueryResults results = MakeFrameResults(1000);
+		results.stages[PROFILER_STAGE_MARCHING_CUBES].soPrimitivesWritten = 100;
+		results.stages[PROFILER_STAGE_MARCHING_CUBES].soPrimitivesNeeded = 150;
+		backend->setResults(results);
+		RecordFrame(profiler);
+		profiler.Update();
+
+		Check(profiler.getStageStatistics(PROFILER_STAGE_MARCHING_CUBES).hasOverflowed && !profiler.getStageStatistics(PROFILER_STAGE_NOISE).hasOverflowed,
+			"stream output overflow is flagged on its stage", failures);
+
+	}
+
+	// A frame that only re-extracts leaves the noise stage's statistics as they were
+	{
+
+		NullQueryBackend* backend = new NullQueryBackend(0);
+		GPUProfiler profiler(backend, 4);
+		backend->setResults(MakeFrameResults(1000));
+		RecordFrame(profiler);
+		profiler.Update();
+
+		backend->setResults(MakeFrameResults(3000));
+		profiler.BeginFrame();
+		profiler.BeginStage(PROFILER_STAGE_MARCHING_CUBES);
+		profiler.EndStage(PROFILER_STAGE_MARCHING_CUBES);
+		profiler.EndFrame();
+		int resolved = profiler.Update();
+		const StageStatistics& noise = profiler.getStageStatistics(PROFILER_STAGE_NOISE);
+
+		Check(resolved == 1 && IsNear(profiler.getStageStatistics(PROFILER_STAGE_MARCHING_CUBES).lastMilliseconds, 3.0), "a bracketed stage is updated", failures);
+		Check(noise.framesResolved == 1 && IsNear(noise.lastMilliseconds, 1.0), "a skipped stage keeps its statistics", failures);
+		Check(IsNear(profiler.getLastFrameMilliseconds(), 3.0), "frame time counts only the bracketed stages", failures);
+
+	}
+
+}
+
+static void TestOutputBufferPredictor(int& failures)
+{
+
+	printf("OutputBufferPredictor\n");
+
+	// An overflow asks for a rerun, and the rerun's buffer holds everything the overflowing extraction needed
+	{
+
+		OutputBufferPredictor predictor;
+		unsigned int heuristic = predictor.PredictCapacity(64, 64, 64);
+		bool isOverflowed = predictor.Record(heuristic + 1000, heuristic);
+		unsigned int regrown = predictor.PredictCapacity(64, 64, 64);
+		bool isRerunOverflowed = predictor.Record(heuristic + 1000, regrown);
+
+		Check(isOverflowed && predictor.getOverflowCount() == 1, "an overflow is reported", failures);
+		Check(regrown >= (heuristic + 1000) * OutputBufferPredictor::headroom, "the buffer regrows to the exact need plus headroom", failures);
+		Check(!isRerunOverflowed && predictor.getOverflowCount() == 1, "the rerun fits", failures);
+
+	}
+
+	// The buffer grows with the volume, at the learned triangles per voxel
+	{
+
+		OutputBufferPredictor predictor;
+		unsigned int capacity = predictor.PredictCapacity(64, 64, 64);
+		predictor.Record(capacity * 3 / 4, capacity);
+		unsigned int larger = predictor.PredictCapacity(128, 128, 128);
+
+		Check(larger >= capacity * 3 / 4 * 8, "a larger volume gets a proportionally larger buffer", failures);
+
+	}
+
+	// Underused buffers only shrink after a run of them, and then part of the way
+	{
+
+		OutputBufferPredictor predictor;
+		unsigned int capacity = predictor.PredictCapacity(64, 64, 64);
+		predictor.Record(capacity * 3 / 4, capacity);
+		unsigned int dense = predictor.PredictCapacity(64, 64, 64);
+		unsigned int sparse = dense / 10;
+		bool isHeld = true;
+
+		for (int i = 0; i < OutputBufferPredictor::shrinkAfter - 1; i++)
+		{
+
+			predictor.Record(sparse, predictor.PredictCapacity(64, 64, 64));
+			isHeld = isHeld && predictor.getLastCapacity() == dense;
+
+		}
+
+		predictor.Record(sparse, predictor.PredictCapacity(64, 64, 64));
+		unsigned int shrunk = predictor.PredictCapacity(64, 64, 64);
+
+		Check(isHeld, "the buffer holds its size through fewer underused runs than shrinkAfter", failures);
+		Check(shrunk < dense && shrunk > sparse * OutputBufferPredictor::headroom, "it then shrinks part of the way towards the recent need", failures);
+
+	}
+
+	// One sparse volume ending a run of moderately used ones doesn't shrink the buffer below what those needed
+	{
+
+		OutputBufferPredictor predictor;
+		unsigned int capacity = predictor.PredictCapacity(64, 64, 64);
+		predictor.Record(capacity * 3 / 4, capacity);
+		unsigned int dense = predictor.PredictCapacity(64, 64, 64);
+		unsigned int moderate = (unsigned int)(dense * OutputBufferPredictor::underuseThreshold) - 100;
+
+		for (int i = 0; i < OutputBufferPredictor::shrinkAfter - 1; i++)
+		{
+
+			predictor.Record(moderate, predictor.PredictCapacity(64, 64, 64));
+
+		}
+
+		predictor.Record(moderate / 100, predictor.PredictCapacity(64, 64, 64));
+		bool isOverflowed = predictor.Record(moderate, predictor.PredictCapacity(64, 64, 64));
+
+		Check(!isOverflowed && predictor.getOverflowCount() == 0, "a sparse volume after underused ones doesn't cause an overflow", failures);
+
+	}
+
+}
+
+// Whether every cell of a grid of cells maps to its own index and back, on the CPU and through cell_index_fx.hlsl's copy
+static bool IsCellIndexRoundTrip(int cellsX, int cellsY, int cellsZ, const std::string& indexExpression, const std::string& coordinatesExpression)
+{
+
+	std::map<std::string, unsigned int> values;
+	values["counts.x"] = cellsX;
+	values["counts.y"] = cellsY;
+
+	unsigned int index = 0;
+
+	for (int z = 0; z < cellsZ; z++)
+	{
+
+		for (int y = 0; y < cellsY; y++)
+		{
+
+			for (int x = 0; x < cellsX; x++, index++)
+			{
+
+				CellCoordinates cell = GetCellCoordinates(index, cellsX, cellsY);
+
+				if (CellIndex(x, y, z, cellsX, cellsY) != index || cell.x != (unsigned int)x || cell.y != (unsigned int)y || cell.z != (unsigned int)z)
+				{
+
+					return false;
+
+				}
+
+				values["cell.x"] = x;
+				values["cell.y"] = y;
+				values["cell.z"] = z;
+				values["index"] = index;
+
+				std::vector<unsigned int> shaderIndex;
+				std::vector<unsigned int> shaderCell;
+
+				if (!ShaderExpression(indexExpression, values).Evaluate(shaderIndex) || !ShaderExpression(coordinatesExpression, values).Evaluate(shaderCell) ||
+					shaderIndex.size() != 1 || shaderIndex[0] != index || shaderCell.size() != 3 || shaderCell[0] != cell.x || shaderCell[1] != cell.y || shaderCell[2] != cell.z)
+				{
+
+					return false;
+
+				}
+
+			}
+
+		}
+
+	}
+
+	return true;
+
+}
+
+// Whether a compute dispatch of 8 cubed thread groups over a grid of cells, with the threads past its edge discarded as
+// the classify and emit passes do, writes every cell index exactly once
+static bool IsDispatchCovering(int cellsX, int cellsY, int cellsZ)
+{
+
+	std::vector<int> writes((size_t)cellsX * cellsY * cellsZ, 0);
+	int threadsX = (cellsX + 7) / 8 * 8;
+	int threadsY = (cellsY + 7) / 8 * 8;
+	int threadsZ = (cellsZ + 7) / 8 * 8;
+
+	for (int z = 0; z < threadsZ; z++)
+	{
+
+		for (int y = 0; y < threadsY; y++)
+		{
+
+			for (int x = 0; x < threadsX; x++)
+			{
+
+				if (x >= cellsX || y >= cellsY || z >= cellsZ)
+				{
+
+					continue;
+
+				}
+
+				writes[CellIndex(x, y, z, cellsX, cellsY)]++;
+
+			}
+
+		}
+
+	}
+
+	for (size_t i = 0; i < writes.size(); i++)
+	{
+
+		if (writes[i] != 1)
+		{
+
+			return false;
+
+		}
+
+	}
+
+	return true;
+
+}
+
+// Whether the geometry shader path's vertex IDs, one per voxel, reach every cell exactly once once the voxels on the far
+// faces, which have no cell, are left out
+static bool IsVoxelDrawCovering(int dimsX, int dimsY, int dimsZ)
+{
+
+	int cellsX = CPUMarchingCubes::getCellCount(dimsX);
+	int cellsY = CPUMarchingCubes::getCellCount(dimsY);
+	int cellsZ = CPUMarchingCubes::getCellCount(dimsZ);
+	std::vector<int> writes((size_t)cellsX * cellsY * cellsZ, 0);
+	unsigned int voxelCount = (unsigned int)dimsX * dimsY * dimsZ;
+
+	for (unsigned int vertexID = 0; vertexID < voxelCount; vertexID++)
+	{
+
+		CellCoordinates voxel = GetCellCoordinates(vertexID, dimsX, dimsY);
+
+		if ((int)voxel.x >= cellsX || (int)voxel.y >= cellsY || (int)voxel.z >= cellsZ)
+		{
+
+			continue;
+
+		}
+
+		writes[CellIndex(voxel.x, voxel.y, voxel.z, cellsX, cellsY)]++;
+
+	}
+
+	for (size_t i = 0; i < writes.size(); i++)
+	{
+
+		if (writes[i] != 1)
+		{
+
+			return false;
+
+		}
+
+	}
+
+	return true;
+
+}
+
+// Fills a volume with hashed densities in [-1, 1], so neighbouring cells take unrelated configurations and a swapped
+// axis changes them
+static void FillHashedVolume(DensityVolume& volume)
+{
+
+	for (int z = 0; z < volume.getDimsZ(); z++)
+	{
+
+		for (int y = 0; y < volume.getDimsY(); y++)
+		{
+
+			for (int x = 0; x < volume.getDimsX(); x++)
+			{
+
+				unsigned int hash = (unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u ^ (unsigned int)z * 83492791u;
+				hash ^= hash >> 13;
+				hash *= 0x5bd1e995u;
+				hash ^= hash >> 15;
+
+				volume.set(x, y, z, (hash & 0xFFFF) / 32767.5f - 1.0f);
+
+			}
+
+		}
+
+	}
+
+}
+
+static void TestCellIndex(int& failures)
+{
+
+	printf("CellIndex\n");
+
+	std::string source;
+	std::string indexExpression;
+	std::string coordinatesExpression;
+	bool isShaderRead = ReadShader("cell_index_fx.hlsl", source) && FindReturnExpression(source, "uint CellIndex(", indexExpression) &&
+		FindReturnExpression(source, "uint3 CellCoordinates(", coordinatesExpression);
+
+	Check(isShaderRead, "cell_index_fx.hlsl is found and holds both functions", failures);
+
+	// Voxel dimensions with no two the same, from the smallest volume, a single cell, upwards; most give cell counts that
+	// aren't multiples of the 8 thread group size
+	const int dims[][3] = {
+
+		{ 2, 2, 2 }, { 2, 9, 3 }, { 13, 2, 7 }, { 3, 17, 2 }, { 66, 5, 10 }, { 9, 31, 20 }, { 17, 9, 33 }
+
+	};
+
+	const int dimsCount = sizeof(dims) / sizeof(dims[0]);
+	bool isRoundTrip = true;
+	bool isDispatchCovering = true;
+	bool isVoxelDrawCovering = true;
+
+	for (int i = 0; i < dimsCount; i++)
+	{
+
+		int cellsX = CPUMarchingCubes::getCellCount(dims[i][0]);
+		int cellsY = CPUMarchingCubes::getCellCount(dims[i][1]);
+		int cellsZ = CPUMarchingCubes::getCellCount(dims[i][2]);
+
+		isRoundTrip = isRoundTrip && isShaderRead && IsCellIndexRoundTrip(cellsX, cellsY, cellsZ, indexExpression, coordinatesExpression);
+		isDispatchCovering = isDispatchCovering && IsDispatchCovering(cellsX, cellsY, cellsZ);
+		isVoxelDrawCovering = isVoxelDrawCovering && IsVoxelDrawCovering(dims[i][0], dims[i][1], dims[i][2]);
+
+	}
+
+	Check(CPUMarchingCubes::getCellCount(2) == 1 && CPUMarchingCubes::getCellCount(1) == 0 && CPUMarchingCubes::getCellCount(0) == 0,
+		"a volume has one fewer cell than voxels along each axis, and none below two voxels", failures);
+	Check(isRoundTrip, "every cell maps to its index and back, on the CPU and in the shader", failures);
+	Check(isDispatchCovering, "a dispatch of whole thread groups writes every cell once", failures);
+	Check(isVoxelDrawCovering, "one vertex per voxel reaches every cell once", failures);
+
+	// Classify stores each cell's configuration at CellIndex, and Emit reading them in index order gives Run's mesh
+	{
+
+		CPUMarchingCubes marchingCubes;
+		marchingCubes.UpdateValues(0.0f, 1.0f);
+
+		DensityVolume volume;
+		volume.Allocate(11, 6, 4);
+		FillHashedVolume(volume);
+
+		std::vector<unsigned int> cubeIndices;
+		std::vector<unsigned int> triangleCounts;
+		marchingCubes.Classify(volume, cubeIndices, triangleCounts);
+
+		// Corners in the geometry shader's order, as Classify reads them
+		static const int cornerOffsets[8][3] = {
+
+			{ 0, 0, 1 }, { 1, 0, 1 }, { 1, 0, 0 }, { 0, 0, 0 },
+			{ 0, 1, 1 }, { 1, 1, 1 }, { 1, 1, 0 }, { 0, 1, 0 }
+
+		};
+
+		int cellsX = CPUMarchingCubes::getCellCount(volume.getDimsX());
+		int cellsY = CPUMarchingCubes::getCellCount(volume.getDimsY());
+		int cellsZ = CPUMarchingCubes::getCellCount(volume.getDimsZ());
+		bool isOrdered = cubeIndices.size() == (size_t)cellsX * cellsY * cellsZ;
+
+		for (int z = 0; z < cellsZ && isOrdered; z++)
+		{
+
+			for (int y = 0; y < cellsY; y++)
+			{
+
+				for (int x = 0; x < cellsX; x++)
+				{
+
+					unsigned int cubeIndex = 0;
+
+					for (int c = 0; c < 8; c++)
+					{
+
+						if (volume.get(x + cornerOffsets[c][0], y + cornerOffsets[c][1], z + cornerOffsets[c][2]) < 0.0f)
+						{
+
+							cubeIndex |= 1 << c;
+
+						}
+
+					}
+
+					isOrdered = isOrdered && cubeIndices[CellIndex(x, y, z, cellsX, cellsY)] == cubeIndex;
+
+				}
+
+			}
+
+		}
+
+		std::vector<MeshVertex> emitted;
+		std::vector<MeshVertex> run;
+		CPUMarchingCubes::ExclusiveScan(triangleCounts);
+		marchingCubes.Emit(volume, cubeIndices, triangleCounts, emitted);
+		marchingCubes.Run(volume, 0, cellsZ, run);
+
+		Check(isOrdered, "Classify stores each cell's configuration at its CellIndex", failures);
+		Check(!run.empty() && emitted.size() == run.size() && memcmp(emitted.data(), run.data(), run.size() * sizeof(MeshVertex)) == 0,
+			"Emit in CellIndex order gives the same mesh as Run", failures);
+
+	}
+
+}
+
+// Whether quantised weights sum to count, leave a weight of 0 at 0 and are each within one level of the exact weight
+static bool IsQuantised(const float* weights, int count, const int* quantised)
+{
+
+	float sum = weights[0] + weights[1] + weights[2];
+
+	if (quantised[0] + quantised[1] + quantised[2] != count)
+	{
+
+		return false;
+
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+
+		float exact = sum > 0.0f ? weights[i] / sum * count : count / 3.0f;
+
+		if (quantised[i] < 0 || fabsf(quantised[i] - exact) >= 1.0f || (sum > 0.0f && weights[i] == 0.0f && quantised[i] != 0))
+		{
+
+			return false;
+
+		}
+
+	}
+
+	return true;
+
+}
+
+// Whether unpacked weights are within a level of the exact ones, summing to 1, with each zero weight still zero
+static bool IsUnpacked(const float* weights, const float* unpacked, int count)
+{
+
+	float sum = 0.0f;
+
+	for (int i = 0; i < 3; i++)
+	{
+
+		if (fabsf(unpacked[i] - weights[i]) > 1.0f / count + 1e-5f || (weights[i] == 0.0f && unpacked[i] != 0.0f))
+		{
+
+			return false;
+
+		}
+
+		sum += unpacked[i];
+
+	}
+
+	return fabsf(sum - 1.0f) < 1e-5f;
+
+}
+
+static void TestMaterialWeights(int& failures)
+{
+
+	printf("MaterialWeights\n");
+
+	// CalculateLayers against light_ps.hlsl's colour blend evaluated literally, over a grid of heights and normals
+	// spanning every branch of the shader, including the slope thresholds themselves
+	{
+
+		bool isMatching = true;
+
+		for (int h = -8; h <= 48; h++)
+		{
+
+			for (int n = -64; n <= 64; n++)
+			{
+
+				float y = h * 0.25f;
+				float normalY = n / 64.0f;
+				float layers[MATERIAL_LAYER_COUNT];
+				MaterialWeights::CalculateLayers(y, normalY, layers);
+
+				for (int layer = 0; layer < MATERIAL_LAYER_COUNT; layer++)
+				{
+
+					isMatching = isMatching && fabsf(layers[layer] - MaterialWeights::getReferenceWeight(y, normalY, layer)) <= 1e-5f;
+
+				}
+
+			}
+
+		}
+
+		Check(isMatching, "layer weights match light_ps.hlsl", failures);
+
+	}
+
+	// Pack, Unpack and the 16 bit form over the weights of vertices at a spread of heights and normals, including flat
+	// ground, which has two zero projections, steep slopes, which have no sand or grass, and a zero normal
+	{
+
+		bool isQuantised = true;
+		bool isInRange = true;
+		bool isUnpacked = true;
+		bool isShortUnpacked = true;
+		bool isShortStable = true;
+
+		for (int h = -4; h <= 24; h++)
+		{
+
+			for (int n = 0; n <= 40; n++)
+			{
+
+				float angle = n * 0.157f;
+				float normal[3] = { n == 40 ? 0.0f : sinf(angle) * 0.6f, n == 40 ? 0.0f : cosf(angle), n == 40 ? 0.0f : sinf(angle) * 0.8f };
+				float layers[MATERIAL_LAYER_COUNT];
+				float axes[3];
+				MaterialWeights::CalculateLayers(h * 0.5f, normal[1], layers);
+				MaterialWeights::CalculateAxes(normal, axes);
+
+				int quantisedLayers[3];
+				int quantisedAxes[3];
+				MaterialWeights::Quantise(layers, MaterialWeights::levels, quantisedLayers);
+				MaterialWeights::Quantise(axes, MaterialWeights::levels, quantisedAxes);
+				isQuantised = isQuantised && IsQuantised(layers, MaterialWeights::levels, quantisedLayers) && IsQuantised(axes, MaterialWeights::levels, quantisedAxes);
+
+				// An ordinary float from 2 up to 8, so w never reads as a denormal, infinity or NaN; the top bit of Y is the
+				// exponent's lowest
+				float packed = MaterialWeights::Pack(layers, axes);
+				isInRange = isInRange && std::isnormal(packed) && packed >= 2.0f && packed < 8.0f;
+
+				float unpackedLayers[MATERIAL_LAYER_COUNT];
+				float unpackedAxes[3];
+				MaterialWeights::Unpack(packed, unpackedLayers, unpackedAxes);
+				isUnpacked = isUnpacked && IsUnpacked(layers, unpackedLayers, MaterialWeights::levels) && IsUnpacked(axes, unpackedAxes, MaterialWeights::levels);
+
+				// The 16 bit form loses up to a level of each form, and packing what it unpacks to gives it back
+				unsigned short packedShort = MaterialWeights::PackShort(packed);
+				float widened = MaterialWeights::UnpackShort(packedShort);
+				MaterialWeights::Unpack(widened, unpackedLayers, unpackedAxes);
+				isShortUnpacked = isShortUnpacked && std::isnormal(widened) && widened >= 2.0f && widened < 8.0f &&
+					IsUnpacked(layers, unpackedLayers, MaterialWeights::levels * MaterialWeights::shortLevels / (MaterialWeights::levels + MaterialWeights::shortLevels)) &&
+					IsUnpacked(axes, unpackedAxes, MaterialWeights::levels * MaterialWeights::shortLevels / (MaterialWeights::levels + MaterialWeights::shortLevels));
+				isShortStable = isShortStable && MaterialWeights::PackShort(widened) == packedShort;
+
+			}
+
+		}
+
+		Check(isQuantised, "quantised weights sum to 63 and a zero weight stays zero", failures);
+		Check(isInRange, "packed weights are an ordinary float from 2 up to 8", failures);
+		Check(isUnpacked, "unpacked weights are within a level and sum to 1", failures);
+		Check(isShortUnpacked, "the 16 bit form unpacks to within a level of each form", failures);
+		Check(isShortStable, "the 16 bit form survives a round trip through the 32 bit form", failures);
+
+	}
+
+	// Every valid 16 bit value, four 4 bit weights with sand and grass, and X and Y, summing to at most 15, round trips
+	{
+
+		bool isRoundTrip = true;
+
+		for (unsigned int packedShort = 0; packedShort <= 0xFFFF; packedShort++)
+		{
+
+			if ((packedShort & 0xF) + ((packedShort >> 4) & 0xF) > 15 || ((packedShort >> 8) & 0xF) + ((packedShort >> 12) & 0xF) > 15)
+			{
+
+				continue;
+
+			}
+
+			isRoundTrip = isRoundTrip && MaterialWeights::PackShort(MaterialWeights::UnpackShort((unsigned short)packedShort)) == packedShort;
+
+		}
+
+		Check(isRoundTrip, "every 16 bit value round trips", failures);
+
+	}
+
+	// material_fx.hlsl's PackMaterial quantises to the same levels and sets the same bits as Pack
+	{
+
+		std::string source;
+		std::string expression;
+		bool isShaderRead = ReadShader("material_fx.hlsl", source) && FindReturnExpression(source, "float PackMaterial(", expression) &&
+			expression.compare(0, 8, "asfloat(") == 0 && expression[expression.size() - 1] == ')';
+
+		Check(isShaderRead, "material_fx.hlsl is found and PackMaterial returns asfloat of its bits", failures);
+
+		// Both QuantiseWeights calls take the C++ level count as their last argument
+		size_t body = source.find("float PackMaterial(");
+		size_t bodyEnd = source.find("return ", body == std::string::npos ? 0 : body);
+		int quantiseCalls = 0;
+		bool isLevelMatching = isShaderRead;
+
+		for (size_t call = source.find("QuantiseWeights(", body); isShaderRead && call < bodyEnd; call = source.find("QuantiseWeights(", call + 1))
+		{
+
+			size_t end = source.find(");", call);
+			size_t comma = source.rfind(',', end);
+			isLevelMatching = isLevelMatching && atoi(source.substr(comma + 1, end - comma - 1).c_str()) == MaterialWeights::levels;
+			quantiseCalls++;
+
+		}
+
+		Check(isLevelMatching && quantiseCalls == 2, "PackMaterial quantises to 63 levels", failures);
+
+		bool isLayoutMatching = isShaderRead;
+
+		if (isShaderRead)
+		{
+
+			std::string bitsExpression = expression.substr(8, expression.size() - 9);
+			std::map<std::string, unsigned int> values;
+
+			// Each weight in turn at every level, and a mix of all four
+			for (int i = 0; i < 5 * (MaterialWeights::levels + 1) && isLayoutMatching; i++)
+			{
+
+				int level = i % (MaterialWeights::levels + 1);
+				int weight = i / (MaterialWeights::levels + 1);
+				int quantisedLayers[3] = { weight == 0 || weight == 4 ? level : 0, weight == 1 || weight == 4 ? (MaterialWeights::levels - level) / 2 : 0, 0 };
+				int quantisedAxes[3] = { weight == 2 || weight == 4 ? level / 3 : 0, weight == 3 || weight == 4 ? (MaterialWeights::levels - level) : 0, 0 };
+				float layers[3];
+				float axes[3];
+
+				for (int k = 0; k < 2; k++)
+				{
+
+					layers[k] = quantisedLayers[k] / (float)MaterialWeights::levels;
+					axes[k] = quantisedAxes[k] / (float)MaterialWeights::levels;
+
+				}
+
+				layers[2] = (MaterialWeights::levels - quantisedLayers[0] - quantisedLayers[1]) / (float)MaterialWeights::levels;
+				axes[2] = (MaterialWeights::levels - quantisedAxes[0] - quantisedAxes[1]) / (float)MaterialWeights::levels;
+
+				values["layers.x"] = quantisedLayers[0];
+				values["layers.y"] = quantisedLayers[1];
+				values["axes.x"] = quantisedAxes[0];
+				values["axes.y"] = quantisedAxes[1];
+
+				std::vector<unsigned int> shaderBits;
+				unsigned int bits = MaterialWeights::packedExponent | (quantisedLayers[0] << MaterialWeights::sandShift) | (quantisedLayers[1] << MaterialWeights::grassShift) |
+					(quantisedAxes[0] << MaterialWeights::axisXShift) | (quantisedAxes[1] << MaterialWeights::axisYShift);
+				float packed = MaterialWeights::Pack(layers, axes);
+				unsigned int packedBits;
+				memcpy(&packedBits, &packed, sizeof(packedBits));
+
+				isLayoutMatching = ShaderExpression(bitsExpression, values).Evaluate(shaderBits) && shaderBits.size() == 1 && shaderBits[0] == bits && packedBits == bits;
+
+			}
+
+		}
+
+		Check(isLayoutMatching, "PackMaterial's bit layout matches Pack", failures);
+
+	}
+
+}
+
+int RunSelfTests()
+{
+
+	int failures = 0;
+
+	TestProfiler(failures);
+	TestOutputBufferPredictor(failures);
+	TestCellIndex(failures);
+	TestMaterialWeights(failures);
+
+	printf("%d check%s failed\n", failures, failures == 1 ? "" : "s");
+
+	return failures;
+
+}
@@ -0,0 +1,10 @@
+// Headless self-tests
+// Checks of the pipeline pieces that otherwise only run against a GPU, driven through their portable fakes
+// Run with headless --selftest, which ctest does; each check prints its result and any failure fails the run
+#ifndef _HEADLESS_TESTS_H_
+#define _HEADLESS_TESTS_H_
+
+// Runs every self-test; returns the number of failed checks
+int RunSelfTests();
+
+#endif // !_HEADLESS_TESTS_H_
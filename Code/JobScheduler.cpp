@@ -0,0 +1,289 @@
+#include "JobScheduler.h"
+
+int JobGraph::AddJob(std::function<void()> function)
+{
+
+	Job job;
+	job.function = function;
+	job.dependencyCount = 0;
+
+	jobs.push_back(job);
+
+	return (int)jobs.size() - 1;
+
+}
+
+void JobGraph::AddDependency(int job, int dependsOn)
+{
+
+	jobs[dependsOn].dependents.push_back(job);
+	jobs[job].dependencyCount++;
+
+}
+
+int JobGraph::getJobCount() const
+{
+
+	return (int)jobs.size();
+
+}
+
+void JobGraph::Clear()
+{
+
+	jobs.clear();
+
+}
+
+JobScheduler::JobScheduler(int threadCount)
+{
+
+	if (threadCount <= 0)
+	{
+
+		threadCount = (int)std::thread::hardware_concurrency();
+
+		if (threadCount <= 0)
+		{
+
+			threadCount = 1;
+
+		}
+
+	}
+
+	currentGraph = nullptr;
+	remainingJobs = 0;
+	queuedJobs = 0;
+	isShuttingDown = false;
+
+	for (int i = 0; i < threadCount; i++)
+	{
+
+		queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+
+	}
+
+	for (int i = 0; i < threadCount; i++)
+	{
+
+		workers.push_back(std::thread(&JobScheduler::WorkerLoop, this, i));
+
+	}
+
+}
+
+JobScheduler::~JobScheduler()
+{
+
+	{
+
+		std::lock_guard<std::mutex> lock(stateMutex);
+		isShuttingDown = true;
+
+	}
+
+	workAvailable.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+
+		workers[i].join();
+
+	}
+
+}
+
+int JobScheduler::getThreadCount() const
+{
+
+	return (int)workers.size();
+
+}
+
+void JobScheduler::Run(JobGraph& graph)
+{
+
+	std::lock_guard<std::mutex> runLock(runMutex);
+
+	int jobCount = graph.getJobCount();
+
+	if (jobCount == 0)
+	{
+
+		return;
+
+	}
+
+	currentGraph = &graph;
+	pendingDependencies.reset(new std::atomic<int>[jobCount]);
+	remainingJobs = jobCount;
+
+	for (int i = 0; i < jobCount; i++)
+	{
+
+		pendingDependencies[i] = graph.jobs[i].dependencyCount;
+
+	}
+
+	// Spread the initially ready jobs across the workers; stealing evens out any imbalance after this
+	int nextWorker = 0;
+
+	for (int i = 0; i < jobCount; i++)
+	{
+
+		if (graph.jobs[i].dependencyCount == 0)
+		{
+
+			PushJob(nextWorker, i);
+			nextWorker = (nextWorker + 1) % (int)queues.size();
+
+		}
+
+	}
+
+	// Wait for the final job to finish
+	std::unique_lock<std::mutex> lock(stateMutex);
+	graphComplete.wait(lock, [this] { return remainingJobs.load() == 0; });
+
+	currentGraph = nullptr;
+
+}
+
+void JobScheduler::WorkerLoop(int workerIndex)
+{
+
+	while (true)
+	{
+
+		int job;
+
+		if (PopJob(workerIndex, job) || StealJob(workerIndex, job))
+		{
+
+			ExecuteJob(workerIndex, job);
+			continue;
+
+		}
+
+		// Nothing to do anywhere, so sleep until a job is queued
+		std::unique_lock<std::mutex> lock(stateMutex);
+		workAvailable.wait(lock, [this] { return isShuttingDown || queuedJobs.load() > 0; });
+
+		if (isShuttingDown)
+		{
+
+			return;
+
+		}
+
+	}
+
+}
+
+void JobScheduler::PushJob(int workerIndex, int job)
+{
+
+	{
+
+		std::lock_guard<std::mutex> lock(queues[workerIndex]->mutex);
+		queues[workerIndex]->jobs.push_back(job);
+		queuedJobs++;
+
+	}
+
+	// Taking the state lock ensures a worker can't miss this between checking queuedJobs and sleeping
+	{
+
+		std::lock_guard<std::mutex> lock(stateMutex);
+
+	}
+
+	workAvailable.notify_one();
+
+}
+
+bool JobScheduler::PopJob(int workerIndex, int& job)
+{
+
+	std::lock_guard<std::mutex> lock(queues[workerIndex]->mutex);
+
+	if (queues[workerIndex]->jobs.empty())
+	{
+
+		return false;
+
+	}
+
+	job = queues[workerIndex]->jobs.back();
+	queues[workerIndex]->jobs.pop_back();
+	queuedJobs--;
+
+	return true;
+
+}
+
+bool JobScheduler::StealJob(int workerIndex, int& job)
+{
+
+	int workerCount = (int)queues.size();
+
+	for (int i = 1; i < workerCount; i++)
+	{
+
+		WorkerQueue& victim = *queues[(workerIndex + i) % workerCount];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+
+		if (!victim.jobs.empty())
+		{
+
+			job = victim.jobs.front();
+			victim.jobs.pop_front();
+			queuedJobs--;
+
+			return true;
+
+		}
+
+	}
+
+	return false;
+
+}
+
+void JobScheduler::ExecuteJob(int workerIndex, int job)
+{
+
+	JobGraph::Job& graphJob = currentGraph->jobs[job];
+
+	graphJob.function();
+
+	// Release dependents onto our own deque; being pushed last, they are what this worker runs next
+	for (size_t i = 0; i < graphJob.dependents.size(); i++)
+	{
+
+		int dependent = graphJob.dependents[i];
+
+		if (--pendingDependencies[dependent] == 0)
+		{
+
+			PushJob(workerIndex, dependent);
+
+		}
+
+	}
+
+	if (--remainingJobs == 0)
+	{
+
+		{
+
+			std::lock_guard<std::mutex> lock(stateMutex);
+
+		}
+
+		graphComplete.notify_all();
+
+	}
+
+}
@@ -0,0 +1,106 @@
+// Job scheduler
+// Runs a graph of dependent jobs on a pool of worker threads
+// Each worker owns a deque of ready jobs: it pushes and pops at the back (most recently readied work first),
+// while idle workers steal from the front of other workers' deques (oldest work first)
+#ifndef _JOB_SCHEDULER_H_
+#define _JOB_SCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A set of jobs and the dependencies between them
+// Build the graph up front, then hand it to JobScheduler::Run
+class JobGraph
+{
+
+public:
+
+	// Adds a job and returns its handle
+	int AddJob(std::function<void()> function);
+	// The job will not start until dependsOn has finished
+	void AddDependency(int job, int dependsOn);
+
+	int getJobCount() const;
+
+	void Clear();
+
+private:
+
+	friend class JobScheduler;
+
+	struct Job
+	{
+
+		std::function<void()> function;
+		std::vector<int> dependents;
+		int dependencyCount;
+
+	};
+
+	std::vector<Job> jobs;
+
+};
+
+class JobScheduler
+{
+
+public:
+
+	// A thread count of 0 uses one worker per hardware thread
+	JobScheduler(int threadCount = 0);
+	~JobScheduler();
+
+	// Executes every job in the graph, respecting dependencies
+	// Blocks the calling thread until the whole graph has completed
+	void Run(JobGraph& graph);
+
+	int getThreadCount() const;
+
+private:
+
+	struct WorkerQueue
+	{
+
+		std::mutex mutex;
+		std::deque<int> jobs;
+
+	};
+
+	void WorkerLoop(int workerIndex);
+
+	// Queue a ready job on the given worker's deque and wake an idle worker
+	void PushJob(int workerIndex, int job);
+	// Take the most recently pushed job from the worker's own deque
+	bool PopJob(int workerIndex, int& job);
+	// Take the oldest job from another worker's deque
+	bool StealJob(int workerIndex, int& job);
+	// Run a job, then release any dependents that are now ready onto this worker's deque
+	void ExecuteJob(int workerIndex, int job);
+
+	std::vector<std::thread> workers;
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+	// State of the graph currently being executed
+	JobGraph* currentGraph;
+	std::unique_ptr<std::atomic<int>[]> pendingDependencies;
+	std::atomic<int> remainingJobs;
+	std::atomic<int> queuedJobs;
+
+	// Only one graph runs at a time
+	std::mutex runMutex;
+
+	// Sleeping/waking of idle workers and the thread waiting in Run
+	std::mutex stateMutex;
+	std::condition_variable workAvailable;
+	std::condition_variable graphComplete;
+	bool isShuttingDown;
+
+};
+
+#endif // !_JOB_SCHEDULER_H_
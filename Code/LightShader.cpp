@@ -55,6 +55,31 @@ LightShader::~LightShader()
 
 	}
 
+	// Release the packed vertex shader, its layout and its chunk buffer
+	if (chunkBuffer)
+	{
+
+		chunkBuffer->Release();
+		chunkBuffer = 0;
+
+	}
+
+	if (packedLayout)
+	{
+
+		packedLayout->Release();
+		packedLayout = 0;
+
+	}
+
+	if (packedVertexShader)
+	{
+
+		packedVertexShader->Release();
+		packedVertexShader = 0;
+
+	}
+
 	//Release base shader components
 	BaseShader::~BaseShader();
 
@@ -68,10 +93,12 @@ void LightShader::initShader(WCHAR* vsFilename, WCHAR* psFilename, InputLayoutTy
 	D3D11_SAMPLER_DESC samplerDesc;
 	D3D11_BUFFER_DESC lightBufferDesc;
 	D3D11_BUFFER_DESC cameraBufferDesc;
+	D3D11_BUFFER_DESC chunkBufferDesc;
 
 	// Load (+ compile) shader files
 	loadVertexShader(vsFilename, inputLayout);
 	loadPixelShader(psFilename);
+	loadPackedVertexShader(L"light_packed_vs.cso");
 
 	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader
 	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
@@ -125,6 +152,77 @@ void LightShader::initShader(WCHAR* vsFilename, WCHAR* psFilename, InputLayoutTy
 
 	renderer->CreateBuffer(&cameraBufferDesc, NULL, &cameraBuffer);
 
+	// Setup chunk buffer, for the packed vertex shader
+	chunkBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	chunkBufferDesc.ByteWidth = sizeof(ChunkBufferType);
+	chunkBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	chunkBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	chunkBufferDesc.MiscFlags = 0;
+	chunkBufferDesc.StructureByteStride = 0;
+
+	renderer->CreateBuffer(&chunkBufferDesc, NULL, &chunkBuffer);
+
+}
+
+void LightShader::loadPackedVertexShader(WCHAR* filename)
+{
+
+	ID3DBlob* vertexShaderBuffer;
+
+	packedVertexShader = 0;
+	packedLayout = 0;
+
+	// Reads compiled shader into buffer (bytecode)
+	HRESULT result = D3DReadFileToBlob(filename, &vertexShaderBuffer);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, filename, L"File not found", MB_OK);
+		exit(0);
+
+	}
+
+	result = renderer->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &packedVertexShader);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, filename, L"Failed to create vertex shader", MB_OK);
+		exit(0);
+
+	}
+
+	// PackedVertex: four unorm16 position components (w holding the material weights) and two snorm16 octahedral normal components
+	D3D11_INPUT_ELEMENT_DESC polygonLayout[2];
+
+	polygonLayout[0].SemanticName = "POSITION";
+	polygonLayout[0].SemanticIndex = 0;
+	polygonLayout[0].Format = DXGI_FORMAT_R16G16B16A16_UNORM;
+	polygonLayout[0].InputSlot = 0;
+	polygonLayout[0].AlignedByteOffset = 0;
+	polygonLayout[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[0].InstanceDataStepRate = 0;
+
+	polygonLayout[1].SemanticName = "NORMAL";
+	polygonLayout[1].SemanticIndex = 0;
+	polygonLayout[1].Format = DXGI_FORMAT_R16G16_SNORM;
+	polygonLayout[1].InputSlot = 0;
+	polygonLayout[1].AlignedByteOffset = 8;
+	polygonLayout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[1].InstanceDataStepRate = 0;
+
+	result = renderer->CreateInputLayout(polygonLayout, 2, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &packedLayout);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, filename, L"Failed to create input layout", MB_OK);
+		exit(0);
+
+	}
+
+	// Release shader bytecode now that the shader and layout have been created
+	vertexShaderBuffer->Release();
+	vertexShaderBuffer = 0;
+
 }
 
 
@@ -196,17 +294,32 @@ void LightShader::setShaderParameters(ID3D11DeviceContext* deviceContext, const
 
 }
 
-void LightShader::render(ID3D11DeviceContext* deviceContext, int indexCount)
+void LightShader::setChunkBox(ID3D11DeviceContext* deviceContext, const float* origin, float extent)
+{
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	ChunkBufferType* chunkPtr;
+
+	deviceContext->Map(chunkBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	chunkPtr = (ChunkBufferType*)mappedResource.pData;
+	chunkPtr->chunkOrigin = XMFLOAT3(origin[0], origin[1], origin[2]);
+	chunkPtr->chunkExtent = extent;
+	deviceContext->Unmap(chunkBuffer, 0);
+	deviceContext->VSSetConstantBuffers(2, 1, &chunkBuffer);
+
+}
+
+void LightShader::render(ID3D11DeviceContext* deviceContext, int vertexCount, bool isIndexed, bool isPacked)
 {
 
 	// Set the sampler state in the pixel shader
 	deviceContext->PSSetSamplers(0, 1, &sampleState);
 
 	// Set the vertex input layout
-	deviceContext->IASetInputLayout(layout);
+	deviceContext->IASetInputLayout(isPacked ? packedLayout : layout);
 
 	// Set the vertex and pixel shaders that will be used to render
-	deviceContext->VSSetShader(vertexShader, NULL, 0);
+	deviceContext->VSSetShader(isPacked ? packedVertexShader : vertexShader, NULL, 0);
 	deviceContext->PSSetShader(pixelShader, NULL, 0);
 
 	// if Hull shader is not null then set HS and DS
@@ -240,7 +353,25 @@ void LightShader::render(ID3D11DeviceContext* deviceContext, int indexCount)
 	}
 
 	// Render the geometry using DrawAuto due to stream output geometry
-	deviceContext->DrawAuto();
+	// Meshes generated on the CPU have a known vertex count instead, and baked chunks a known index count
+	if (vertexCount > 0 && isIndexed)
+	{
+
+		deviceContext->DrawIndexed(vertexCount, 0, 0);
+
+	}
+	else if (vertexCount > 0)
+	{
+
+		deviceContext->Draw(vertexCount, 0);
+
+	}
+	else
+	{
+
+		deviceContext->DrawAuto();
+
+	}
 
 }
 
@@ -38,6 +38,15 @@ private:
 
 	};
 
+	// Struct used for creating the chunk cbuffer for the packed vertex shader
+	struct ChunkBufferType
+	{
+
+		XMFLOAT3 chunkOrigin;
+		float chunkExtent;
+
+	};
+
 public:
 
 	LightShader(ID3D11Device* device, HWND hwnd, InputLayoutType inputLayout);
@@ -46,11 +55,17 @@ public:
 	void setShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX &world, const XMMATRIX &view, const XMMATRIX &projection, 
 		ID3D11ShaderResourceView* texture1, ID3D11ShaderResourceView* texture2, ID3D11ShaderResourceView* texture3, ID3D11ShaderResourceView* texture4, 
 		Light* light, Camera* camera, float meshScaleFactor);
-	void render(ID3D11DeviceContext* deviceContext, int vertexCount);
+	// Set the box that packed vertices are relative to, before rendering a packed chunk
+	void setChunkBox(ID3D11DeviceContext* deviceContext, const float* origin, float extent);
+	// Draws vertexCount vertices, or vertexCount indices if isIndexed is set; a count of 0 uses DrawAuto()
+	// isPacked reads the vertex buffer as PackedVertex, decoded with the box from setChunkBox
+	void render(ID3D11DeviceContext* deviceContext, int vertexCount, bool isIndexed = false, bool isPacked = false);
 
 private:
 
 	void initShader(WCHAR*, WCHAR*, InputLayoutType inputLayout);
+	// Load the PACKED_VERTEX variant of the vertex shader, with its own input layout
+	void loadPackedVertexShader(WCHAR* filename);
 
 private:
 
@@ -58,6 +73,9 @@ private:
 	ID3D11SamplerState* sampleState;
 	ID3D11Buffer* lightBuffer;
 	ID3D11Buffer* cameraBuffer;
+	ID3D11Buffer* chunkBuffer;
+	ID3D11VertexShader* packedVertexShader;
+	ID3D11InputLayout* packedLayout;
 
 };
 
@@ -0,0 +1,670 @@
+// Marching cubes compute shader
+#include "MCComputeShader.h"
+#include "MarchingCubesTables.h"
+#include "CPUMarchingCubes.h"
+
+// Elements scanned by each prefix scan thread group, see BLOCK_SIZE in prefix_scan_cs.hlsl
+static const UINT scanBlockSize = 512;
+// Thread groups per dispatch dimension allowed by D3D11
+static const UINT maxGroupsPerDimension = 65535;
+
+MCComputeShader::MCComputeShader(ID3D11Device* device, HWND hwnd) : BaseComputeShader(device, hwnd)
+{
+
+	scanShader = nullptr;
+	scanAddShader = nullptr;
+	emitShader = nullptr;
+
+	caseTriangleCountBuffer = nullptr;
+	cubeIndexBuffer = nullptr;
+	extractionBuffer = nullptr;
+	outputBuffer = nullptr;
+	readbackBuffer = nullptr;
+
+	caseTriangleCountSRV = nullptr;
+	cubeIndexUAV = nullptr;
+	cubeIndexSRV = nullptr;
+	triangleOffsetSRV = nullptr;
+	outputBufferUAV = nullptr;
+	noiseSRV = nullptr;
+	triTableSRV = nullptr;
+	sampleState = nullptr;
+
+	outputBufferCapacity = 0;
+	triangleCount = 0;
+
+	isoValue = 0.0f;
+	meshScaleFactor = 1.0f;
+
+	dimsX = 0;
+	dimsY = 0;
+	dimsZ = 0;
+
+	initShader(L"marching_cubes_classify_cs.cso", 0);
+
+}
+
+MCComputeShader::~MCComputeShader()
+{
+
+	releaseBuffers();
+	releaseOutputBuffer();
+	releaseReadbackBuffer();
+
+	if (caseTriangleCountSRV)
+	{
+
+		caseTriangleCountSRV->Release();
+		caseTriangleCountSRV = nullptr;
+
+	}
+
+	if (caseTriangleCountBuffer)
+	{
+
+		caseTriangleCountBuffer->Release();
+		caseTriangleCountBuffer = nullptr;
+
+	}
+
+	if (extractionBuffer)
+	{
+
+		extractionBuffer->Release();
+		extractionBuffer = nullptr;
+
+	}
+
+	if (sampleState)
+	{
+
+		sampleState->Release();
+		sampleState = nullptr;
+
+	}
+
+	if (scanShader)
+	{
+
+		scanShader->Release();
+		scanShader = nullptr;
+
+	}
+
+	if (scanAddShader)
+	{
+
+		scanAddShader->Release();
+		scanAddShader = nullptr;
+
+	}
+
+	if (emitShader)
+	{
+
+		emitShader->Release();
+		emitShader = nullptr;
+
+	}
+
+}
+
+void MCComputeShader::initShader(WCHAR* filename, int elements)
+{
+
+	// Load each pass from file
+	loadComputeShader(filename);
+	loadComputeShader(L"prefix_scan_cs.cso", &scanShader);
+	loadComputeShader(L"prefix_add_cs.cso", &scanAddShader);
+	loadComputeShader(L"marching_cubes_emit_cs.cso", &emitShader);
+
+	initCaseTriangleCounts();
+	initExtractionBuffer();
+
+	// Normals are sampled between voxels, so the emit pass needs a linear sampler
+	D3D11_SAMPLER_DESC samplerDesc;
+	ZeroMemory(&samplerDesc, sizeof(samplerDesc));
+	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.MipLODBias = 0.0f;
+	samplerDesc.MaxAnisotropy = 1;
+	samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+	samplerDesc.MinLOD = 0;
+	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+
+	if (renderer->CreateSamplerState(&samplerDesc, &sampleState) != S_OK)
+	{
+
+		MessageBox(NULL, L"Failed to create sampler state", L"Marching Cubes Compute Shader", MB_OK);
+		exit(0);
+
+	}
+
+}
+
+void MCComputeShader::initCaseTriangleCounts()
+{
+
+	// Shared with the CPU extractor so both paths agree on how many triangles each configuration emits
+	const int* counts = getCaseTriangleCounts();
+	UINT caseTriangleCounts[256];
+
+	for (int i = 0; i < 256; i++)
+	{
+
+		caseTriangleCounts[i] = counts[i];
+
+	}
+
+	HRESULT result = CreateStructuredBuffer(sizeof(UINT), 256, caseTriangleCounts, &caseTriangleCountBuffer);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, L"Failed to create case triangle count buffer", L"Marching Cubes Compute Shader", MB_OK);
+		exit(0);
+
+	}
+
+	result = CreateBufferSRV(caseTriangleCountBuffer, &caseTriangleCountSRV);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, L"Failed to create buffer SRV", L"Marching Cubes Compute Shader", MB_OK);
+		exit(0);
+
+	}
+
+}
+
+void MCComputeShader::initExtractionBuffer()
+{
+
+	// Filled in at the start of each Run, as the values and the output capacity can change independently
+	HRESULT result = CreateConstantBuffer(sizeof(ExtractionBufferType), nullptr, &extractionBuffer);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, L"Failed to create constant buffer", L"Marching Cubes Compute Shader", MB_OK);
+		exit(0);
+
+	}
+
+}
+
+void MCComputeShader::initCellBuffer(UINT count, ID3D11Buffer** buffer, ID3D11UnorderedAccessView** bufferUAV, ID3D11ShaderResourceView** bufferSRV)
+{
+
+	HRESULT result = CreateStructuredBuffer(sizeof(UINT), count, nullptr, buffer);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, L"Failed to create structured buffer", L"Marching Cubes Compute Shader", MB_OK);
+		exit(0);
+
+	}
+
+	result = CreateBufferUAV(*buffer, bufferUAV);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, L"Failed to create buffer UAV", L"Marching Cubes Compute Shader", MB_OK);
+		exit(0);
+
+	}
+
+	if (bufferSRV)
+	{
+
+		result = CreateBufferSRV(*buffer, bufferSRV);
+		if (result != S_OK)
+		{
+
+			MessageBox(NULL, L"Failed to create buffer SRV", L"Marching Cubes Compute Shader", MB_OK);
+			exit(0);
+
+		}
+
+	}
+
+}
+
+void MCComputeShader::UpdateMeshValues(int x, int y, int z)
+{
+
+	// The per cell buffers only depend on the mesh size, so keep them between runs when it hasn't changed
+	if (cubeIndexBuffer && x == dimsX && y == dimsY && z == dimsZ)
+	{
+
+		return;
+
+	}
+
+	releaseBuffers();
+
+	dimsX = x;
+	dimsY = y;
+	dimsZ = z;
+
+	UINT cellCount = CPUMarchingCubes::getCellCount(dimsX) * CPUMarchingCubes::getCellCount(dimsY) * CPUMarchingCubes::getCellCount(dimsZ);
+
+	if (cellCount == 0)
+	{
+
+		return;
+
+	}
+
+	initCellBuffer(cellCount, &cubeIndexBuffer, &cubeIndexUAV, &cubeIndexSRV);
+
+	// Build the scan levels, each holding the block totals of the level below, until a single element holds the grand total
+	UINT elementCount = cellCount;
+
+	while (true)
+	{
+
+		ScanLevel level;
+		level.elementCount = elementCount;
+
+		UINT groups = (elementCount + scanBlockSize - 1) / scanBlockSize;
+		level.groupsX = groups < maxGroupsPerDimension ? groups : maxGroupsPerDimension;
+		level.groupsY = (groups + level.groupsX - 1) / level.groupsX;
+
+		// Level 0 holds the triangle offsets read by the emit pass
+		initCellBuffer(elementCount, &level.buffer, &level.bufferUAV, scanLevels.empty() ? &triangleOffsetSRV : nullptr);
+
+		ScanBufferType scanBufferData;
+		scanBufferData.elementCount = elementCount;
+		scanBufferData.groupsX = level.groupsX;
+		scanBufferData.padding[0] = 0;
+		scanBufferData.padding[1] = 0;
+
+		HRESULT result = CreateConstantBuffer(sizeof(ScanBufferType), &scanBufferData, &level.scanBuffer);
+		if (result != S_OK)
+		{
+
+			MessageBox(NULL, L"Failed to create constant buffer", L"Marching Cubes Compute Shader", MB_OK);
+			exit(0);
+
+		}
+
+		scanLevels.push_back(level);
+
+		if (elementCount == 1 && scanLevels.size() > 1)
+		{
+
+			break;
+
+		}
+
+		elementCount = groups;
+
+	}
+
+}
+
+void MCComputeShader::UpdateValues(float liso, float lscale)
+{
+
+	isoValue = liso;
+	meshScaleFactor = lscale;
+
+}
+
+void MCComputeShader::setNoiseTexture(ID3D11ShaderResourceView* noiseTexture)
+{
+
+	noiseSRV = noiseTexture;
+
+}
+
+void MCComputeShader::setTriTableTexture(ID3D11ShaderResourceView* triTableTexture)
+{
+
+	triTableSRV = triTableTexture;
+
+}
+
+void MCComputeShader::Run(ID3D11DeviceContext* deviceContext)
+{
+
+	UINT cellsX = CPUMarchingCubes::getCellCount(dimsX);
+	UINT cellsY = CPUMarchingCubes::getCellCount(dimsY);
+	UINT cellsZ = CPUMarchingCubes::getCellCount(dimsZ);
+
+	if (scanLevels.empty() || !outputBuffer)
+	{
+
+		return;
+
+	}
+
+	// Update the extraction parameters
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	if (deviceContext->Map(extractionBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource) == S_OK)
+	{
+
+		ExtractionBufferType* dataPtr = (ExtractionBufferType*)mappedResource.pData;
+		dataPtr->cellCounts[0] = cellsX;
+		dataPtr->cellCounts[1] = cellsY;
+		dataPtr->cellCounts[2] = cellsZ;
+		dataPtr->isoValue = isoValue;
+		dataPtr->dimensions = XMFLOAT3(dimsX, dimsY, dimsZ);
+		dataPtr->meshScaleFactor = meshScaleFactor;
+		dataPtr->triangleCapacity = outputBufferCapacity;
+		dataPtr->padding[0] = 0;
+		dataPtr->padding[1] = 0;
+		dataPtr->padding[2] = 0;
+		deviceContext->Unmap(extractionBuffer, 0);
+
+	}
+
+	// One thread per cell; the shaders discard threads past the edge of the volume
+	UINT groupsX = (cellsX + 7) / 8;
+	UINT groupsY = (cellsY + 7) / 8;
+	UINT groupsZ = (cellsZ + 7) / 8;
+
+	ID3D11UnorderedAccessView* nullUAVs[2] = { nullptr, nullptr };
+	ID3D11ShaderResourceView* nullSRVs[5] = { nullptr, nullptr, nullptr, nullptr, nullptr };
+
+	// 1: Classify each cell and write its triangle count into the bottom scan level
+	deviceContext->CSSetShader(computeShader, nullptr, 0);
+	deviceContext->CSSetConstantBuffers(0, 1, &extractionBuffer);
+	deviceContext->CSSetShaderResources(0, 1, &noiseSRV);
+	deviceContext->CSSetShaderResources(1, 1, &caseTriangleCountSRV);
+	deviceContext->CSSetUnorderedAccessViews(0, 1, &cubeIndexUAV, nullptr);
+	deviceContext->CSSetUnorderedAccessViews(1, 1, &scanLevels[0].bufferUAV, nullptr);
+
+	deviceContext->Dispatch(groupsX, groupsY, groupsZ);
+
+	deviceContext->CSSetUnorderedAccessViews(0, 2, nullUAVs, nullptr);
+
+	// 2: Turn the triangle counts into output offsets
+	RunPrefixSum(deviceContext);
+
+	// 3: Emit every cell's triangles at its offset
+	deviceContext->CSSetShader(emitShader, nullptr, 0);
+	deviceContext->CSSetConstantBuffers(0, 1, &extractionBuffer);
+	deviceContext->CSSetShaderResources(0, 1, &noiseSRV);
+	deviceContext->CSSetShaderResources(1, 1, &caseTriangleCountSRV);
+	deviceContext->CSSetShaderResources(2, 1, &triTableSRV);
+	deviceContext->CSSetShaderResources(3, 1, &cubeIndexSRV);
+	deviceContext->CSSetShaderResources(4, 1, &triangleOffsetSRV);
+	deviceContext->CSSetSamplers(0, 1, &sampleState);
+	deviceContext->CSSetUnorderedAccessViews(0, 1, &outputBufferUAV, nullptr);
+
+	deviceContext->Dispatch(groupsX, groupsY, groupsZ);
+
+	// Reset the shader now we're done, unbinding the output so it can be used as a vertex buffer
+	deviceContext->CSSetShader(nullptr, nullptr, 0);
+	deviceContext->CSSetShaderResources(0, 5, nullSRVs);
+	deviceContext->CSSetUnorderedAccessViews(0, 1, nullUAVs, nullptr);
+
+}
+
+void MCComputeShader::RunPrefixSum(ID3D11DeviceContext* deviceContext)
+{
+
+	ID3D11UnorderedAccessView* nullUAVs[2] = { nullptr, nullptr };
+	int topLevel = (int)scanLevels.size() - 1;
+
+	// Scan each level in blocks, writing the block totals into the level above
+	// The last scan is a single block, so its total is the number of triangles in the mesh
+	deviceContext->CSSetShader(scanShader, nullptr, 0);
+
+	for (int i = 0; i < topLevel; i++)
+	{
+
+		deviceContext->CSSetConstantBuffers(0, 1, &scanLevels[i].scanBuffer);
+		deviceContext->CSSetUnorderedAccessViews(0, 1, &scanLevels[i].bufferUAV, nullptr);
+		deviceContext->CSSetUnorderedAccessViews(1, 1, &scanLevels[i + 1].bufferUAV, nullptr);
+		deviceContext->Dispatch(scanLevels[i].groupsX, scanLevels[i].groupsY, 1);
+
+	}
+
+	// Then add the scanned totals back down into every block that isn't first in its level
+	deviceContext->CSSetShader(scanAddShader, nullptr, 0);
+
+	for (int i = topLevel - 2; i >= 0; i--)
+	{
+
+		deviceContext->CSSetConstantBuffers(0, 1, &scanLevels[i].scanBuffer);
+		deviceContext->CSSetUnorderedAccessViews(0, 1, &scanLevels[i].bufferUAV, nullptr);
+		deviceContext->CSSetUnorderedAccessViews(1, 1, &scanLevels[i + 1].bufferUAV, nullptr);
+		deviceContext->Dispatch(scanLevels[i].groupsX, scanLevels[i].groupsY, 1);
+
+	}
+
+	deviceContext->CSSetUnorderedAccessViews(0, 2, nullUAVs, nullptr);
+
+}
+
+void MCComputeShader::reInitOutputBuffer(int x, int y, int z)
+{
+
+	unsigned int capacity = outputBufferPredictor.PredictCapacity(x, y, z);
+
+	// Reuse the current buffer if it's already the right size
+	if (outputBuffer && capacity == outputBufferCapacity)
+	{
+
+		return;
+
+	}
+
+	releaseOutputBuffer();
+
+	// Raw buffer so the emit pass can write it by byte address, which can also be bound as a vertex buffer
+	// (append/structured buffers can't be used as vertex buffers)
+	D3D11_BUFFER_DESC outputBufferDesc;
+	ZeroMemory(&outputBufferDesc, sizeof(outputBufferDesc));
+	outputBufferDesc.ByteWidth = (sizeof(XMFLOAT4) + sizeof(XMFLOAT3)) * 3 * capacity;	// Vertex size * 3 vertices per triangle
+	outputBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	outputBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER | D3D11_BIND_UNORDERED_ACCESS;
+	outputBufferDesc.CPUAccessFlags = 0;
+	outputBufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+	outputBufferDesc.StructureByteStride = 0;
+
+	HRESULT result = renderer->CreateBuffer(&outputBufferDesc, nullptr, &outputBuffer);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, L"Failed to create output buffer", L"Marching Cubes Compute Shader", MB_OK);
+		exit(0);
+
+	}
+
+	result = CreateBufferUAV(outputBuffer, &outputBufferUAV);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, L"Failed to create buffer UAV", L"Marching Cubes Compute Shader", MB_OK);
+		exit(0);
+
+	}
+
+	outputBufferCapacity = capacity;
+
+}
+
+bool MCComputeShader::checkOverflow(ID3D11DeviceContext* deviceContext)
+{
+
+	// Mapping without flags waits for the extraction to finish; the mesh is drawn with this count, so unlike MCShader's
+	// stream output queries it can't be left for a later frame unless the mesh is swapped in later too
+	bool hasOverflowed = false;
+
+	requestTriangleCount(deviceContext);
+	readTriangleCount(deviceContext, 0, hasOverflowed);
+
+	return hasOverflowed;
+
+}
+
+void MCComputeShader::requestTriangleCount(ID3D11DeviceContext* deviceContext)
+{
+
+	releaseReadbackBuffer();
+
+	if (scanLevels.empty())
+	{
+
+		triangleCount = 0;
+		return;
+
+	}
+
+	// The top scan level holds the exact triangle total, whether or not it all fit in the output buffer
+	readbackBuffer = CopyToSystemBuffer(deviceContext, scanLevels.back().buffer);
+
+}
+
+bool MCComputeShader::pollTriangleCount(ID3D11DeviceContext* deviceContext, bool& hasOverflowed)
+{
+
+	return readTriangleCount(deviceContext, D3D11_MAP_FLAG_DO_NOT_WAIT, hasOverflowed);
+
+}
+
+bool MCComputeShader::readTriangleCount(ID3D11DeviceContext* deviceContext, UINT mapFlags, bool& hasOverflowed)
+{
+
+	hasOverflowed = false;
+
+	// Nothing was copied if there are no cells, or if the staging buffer couldn't be created
+	if (!readbackBuffer)
+	{
+
+		return true;
+
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	HRESULT result = deviceContext->Map(readbackBuffer, 0, D3D11_MAP_READ, mapFlags, &mappedResource);
+
+	if (result == DXGI_ERROR_WAS_STILL_DRAWING)
+	{
+
+		return false;
+
+	}
+
+	if (result == S_OK)
+	{
+
+		triangleCount = *(UINT*)mappedResource.pData;
+		deviceContext->Unmap(readbackBuffer, 0);
+
+	}
+
+	releaseReadbackBuffer();
+
+	hasOverflowed = outputBufferPredictor.Record(triangleCount, outputBufferCapacity);
+
+	return true;
+
+}
+
+void MCComputeShader::releaseReadbackBuffer()
+{
+
+	if (readbackBuffer)
+	{
+
+		readbackBuffer->Release();
+		readbackBuffer = nullptr;
+
+	}
+
+}
+
+ID3D11Buffer* MCComputeShader::getOutputBuffer()
+{
+
+	return outputBuffer;
+
+}
+
+int MCComputeShader::getVertexCount()
+{
+
+	// Triangles past the capacity were dropped by the emit pass
+	return (triangleCount < outputBufferCapacity ? triangleCount : outputBufferCapacity) * 3;
+
+}
+
+void MCComputeShader::releaseOutputBuffer()
+{
+
+	if (outputBufferUAV)
+	{
+
+		outputBufferUAV->Release();
+		outputBufferUAV = nullptr;
+
+	}
+
+	if (outputBuffer)
+	{
+
+		outputBuffer->Release();
+		outputBuffer = nullptr;
+
+	}
+
+	outputBufferCapacity = 0;
+
+}
+
+void MCComputeShader::releaseBuffers()
+{
+
+	if (cubeIndexUAV)
+	{
+
+		cubeIndexUAV->Release();
+		cubeIndexUAV = nullptr;
+
+	}
+
+	if (cubeIndexSRV)
+	{
+
+		cubeIndexSRV->Release();
+		cubeIndexSRV = nullptr;
+
+	}
+
+	if (cubeIndexBuffer)
+	{
+
+		cubeIndexBuffer->Release();
+		cubeIndexBuffer = nullptr;
+
+	}
+
+	if (triangleOffsetSRV)
+	{
+
+		triangleOffsetSRV->Release();
+		triangleOffsetSRV = nullptr;
+
+	}
+
+	for (size_t i = 0; i < scanLevels.size(); i++)
+	{
+
+		scanLevels[i].bufferUAV->Release();
+		scanLevels[i].buffer->Release();
+		scanLevels[i].scanBuffer->Release();
+
+	}
+
+	scanLevels.clear();
+
+	dimsX = 0;
+	dimsY = 0;
+	dimsZ = 0;
+
+}
@@ -0,0 +1,141 @@
+// Marching cubes compute shader
+// Generates the output mesh with compute passes instead of the geometry shader and stream output:
+// classify each cell, prefix sum the triangle counts, then emit every cell's triangles at its scanned offset
+// CPUMarchingCubes::Classify, ExclusiveScan and Emit are the reference implementation of the same passes
+#ifndef _MARCHING_CUBES_COMPUTE_SHADER_H_
+#define _MARCHING_CUBES_COMPUTE_SHADER_H_
+
+#include <vector>
+#include "BaseComputeShader.h"
+#include "OutputBufferPredictor.h"
+
+class MCComputeShader : public BaseComputeShader
+{
+
+private:
+
+	// Matches ExtractionBuffer in marching_cubes_fx.hlsl
+	struct ExtractionBufferType
+	{
+
+		UINT cellCounts[3];
+		float isoValue;
+		XMFLOAT3 dimensions;
+		float meshScaleFactor;
+		UINT triangleCapacity;
+		UINT padding[3];
+
+	};
+
+	// Matches ScanBuffer in prefix_scan_cs.hlsl and prefix_add_cs.hlsl
+	struct ScanBufferType
+	{
+
+		UINT elementCount;
+		UINT groupsX;
+		UINT padding[2];
+
+	};
+
+	// One level of the multi-level prefix sum
+	// Level 0 is the per cell triangle counts; each level above holds the block totals of the one below
+	struct ScanLevel
+	{
+
+		ID3D11Buffer* buffer;
+		ID3D11UnorderedAccessView* bufferUAV;
+		ID3D11Buffer* scanBuffer;
+		UINT elementCount;
+		UINT groupsX;
+		UINT groupsY;
+
+	};
+
+public:
+
+	MCComputeShader(ID3D11Device* device, HWND hwnd);
+	~MCComputeShader();
+
+	void initShader(WCHAR* csFilename, int elements);
+	// Runs the classify, scan and emit passes; the noise texture and output buffer must be set up first
+	void Run(ID3D11DeviceContext* deviceContext);
+
+	// Update the mesh values when the mesh size is changed, recreating the per cell buffers
+	void UpdateMeshValues(int x, int y, int z);
+	// Update the values used for calculating the isosurface
+	void UpdateValues(float isoValue, float meshScaleFactor);
+
+	void setNoiseTexture(ID3D11ShaderResourceView* noiseTexture);
+	void setTriTableTexture(ID3D11ShaderResourceView* triTableTexture);
+
+	// Re-initialise the output buffer from the output buffer predictor, as MCShader does for stream output
+	void reInitOutputBuffer(int x, int y, int z);
+	// Reads back the scanned triangle total from the last Run and feeds it to the predictor, waiting for the GPU to finish
+	// Returns true if the output buffer was too small; the caller should then call reInitOutputBuffer and Run again
+	bool checkOverflow(ID3D11DeviceContext* deviceContext);
+	// As checkOverflow, split so that nothing waits: requestTriangleCount starts copying the total from the last Run back,
+	// and pollTriangleCount returns false until the copy has arrived, then reads it and sets hasOverflowed as checkOverflow would return
+	void requestTriangleCount(ID3D11DeviceContext* deviceContext);
+	bool pollTriangleCount(ID3D11DeviceContext* deviceContext, bool& hasOverflowed);
+
+	// Returns the output buffer - to be used as a vertex buffer in an EmptyMesh
+	ID3D11Buffer* getOutputBuffer();
+	// Number of vertices written by the last Run, valid after checkOverflow
+	int getVertexCount();
+
+	void releaseOutputBuffer();
+	void releaseBuffers();
+
+private:
+
+	void initCaseTriangleCounts();
+	void initExtractionBuffer();
+	// Creates a structured uint buffer with an unordered access view and optionally a shader resource view
+	void initCellBuffer(UINT count, ID3D11Buffer** buffer, ID3D11UnorderedAccessView** bufferUAV, ID3D11ShaderResourceView** bufferSRV);
+
+	// Scans the level 0 triangle counts in place into triangle offsets
+	void RunPrefixSum(ID3D11DeviceContext* deviceContext);
+	// Map the copy made by requestTriangleCount with the given flags; returns false if the GPU hasn't written it yet
+	bool readTriangleCount(ID3D11DeviceContext* deviceContext, UINT mapFlags, bool& hasOverflowed);
+	void releaseReadbackBuffer();
+
+	// One shader per pass; the base class computeShader holds the classify pass
+	ID3D11ComputeShader* scanShader;
+	ID3D11ComputeShader* scanAddShader;
+	ID3D11ComputeShader* emitShader;
+
+	// Buffers
+	ID3D11Buffer* caseTriangleCountBuffer;			// Triangles emitted by each of the 256 cube configurations
+	ID3D11Buffer* cubeIndexBuffer;					// Cube configuration of each cell
+	ID3D11Buffer* extractionBuffer;					// Isovalue, scaling and cell counts
+	ID3D11Buffer* outputBuffer;						// Raw vertex buffer written by the emit pass
+	ID3D11Buffer* readbackBuffer;					// Staging copy of the scanned triangle total, until it has been read
+	std::vector<ScanLevel> scanLevels;
+
+	// Views
+	ID3D11ShaderResourceView* caseTriangleCountSRV;
+	ID3D11UnorderedAccessView* cubeIndexUAV;
+	ID3D11ShaderResourceView* cubeIndexSRV;
+	ID3D11ShaderResourceView* triangleOffsetSRV;	// Level 0 of the scan, read by the emit pass
+	ID3D11UnorderedAccessView* outputBufferUAV;
+	ID3D11ShaderResourceView* noiseSRV;				// Owned by the gradient noise shader
+	ID3D11ShaderResourceView* triTableSRV;			// Owned by the triangle table texture
+
+	ID3D11SamplerState* sampleState;
+
+	// Sizes the output buffer from previous triangle counts
+	OutputBufferPredictor outputBufferPredictor;
+	// Capacity of the current output buffer, in triangles
+	unsigned int outputBufferCapacity;
+	unsigned int triangleCount;
+
+	float isoValue;
+	float meshScaleFactor;
+
+	int dimsX;
+	int dimsY;
+	int dimsZ;
+
+};
+
+#endif // !_MARCHING_CUBES_COMPUTE_SHADER_H_
@@ -4,8 +4,22 @@
 
 MCShader::MCShader(ID3D11Device* device, ID3D11DeviceContext* deviceContext, HWND hwnd) : BaseShader(device, hwnd)
 {
+
+	outputBuffer = nullptr;
+	outputBufferCapacity = 0;
+	soStatisticsQuery = nullptr;
+	soOverflowQuery = nullptr;
+	isQueryPending = false;
+	primitivesWritten = 0;
+	packedGeometryShader = nullptr;
+	packedTriTableBuffer = nullptr;
+	isPackedTriTable = false;
+	voxelsX = 0;
+	voxelsY = 0;
+	voxelsZ = 0;
 	
 	initShader(L"marching_cubes_vs.cso", L"marching_cubes_ps.cso", L"marching_cubes_gs.cso", deviceContext);
+	initQueries();
 
 }
 
@@ -48,6 +62,14 @@ MCShader::~MCShader()
 
 	}
 
+	if (packedGeometryShader)
+	{
+
+		packedGeometryShader->Release();
+		packedGeometryShader = 0;
+
+	}
+
 	if (triTableSRV)
 	{
 
@@ -56,6 +78,22 @@ MCShader::~MCShader()
 
 	}
 
+	if (soStatisticsQuery)
+	{
+
+		soStatisticsQuery->Release();
+		soStatisticsQuery = 0;
+
+	}
+
+	if (soOverflowQuery)
+	{
+
+		soOverflowQuery->Release();
+		soOverflowQuery = 0;
+
+	}
+
 	//Release base shader components
 	BaseShader::~BaseShader();
 
@@ -75,8 +113,9 @@ void MCShader::initShader(WCHAR* vsFilename, WCHAR* psFilename, WCHAR* gsFilenam
 	D3D11_BUFFER_DESC paramBufferDesc;
 	
 	// Load (+ compile) shader files
-	loadVertexShader(vsFilename, POS4XUINT);
-	loadSOGeometryShader(gsFilename, deviceContext);
+	loadVertexIDShader(vsFilename);
+	loadSOGeometryShader(gsFilename, deviceContext, &streamOutputGeometryShader);
+	loadSOGeometryShader(L"marching_cubes_packed_gs.cso", deviceContext, &packedGeometryShader);
 	loadPixelShader(psFilename);
 
 	// Create a texture sampler state description
@@ -111,7 +150,7 @@ void MCShader::initShader(WCHAR* vsFilename, WCHAR* psFilename, WCHAR* gsFilenam
 }
 
 void MCShader::setShaderParameters(ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView* noiseTexture, ID3D11ShaderResourceView* rockTexture,
-	float isoValue, float meshSize, float scaleFactor)
+	float isoValue, float scaleFactor)
 {
 
 	HRESULT result;
@@ -122,21 +161,68 @@ void MCShader::setShaderParameters(ID3D11DeviceContext* deviceContext, ID3D11Sha
 	result = deviceContext->Map(paramBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
 	paramBufferPtr = (ParamBufferType*)mappedResource.pData;
 	paramBufferPtr->isoValue = isoValue;
-	paramBufferPtr->meshSize = meshSize;
 	paramBufferPtr->meshScaleFactor = scaleFactor;
-	paramBufferPtr->padding = 0.0f;
+	paramBufferPtr->padding[0] = 0.0f;
+	paramBufferPtr->padding[1] = 0.0f;
+	paramBufferPtr->meshSize = XMFLOAT3((float)voxelsX, (float)voxelsY, (float)voxelsZ);
+	paramBufferPtr->meshSizePadding = 0.0f;
 	deviceContext->Unmap(paramBuffer, 0);
 
-	// Now set the constant buffer in the geometry shader with the updated values.
+	// Now set the constant buffer in the vertex and geometry shaders with the updated values.
+	deviceContext->VSSetConstantBuffers(0, 1, &paramBuffer);
 	deviceContext->GSSetConstantBuffers(0, 1, &paramBuffer);
 
 	// Set the texture resources
 	deviceContext->GSSetShaderResources(0, 1, &noiseTexture);
-	deviceContext->GSSetShaderResources(1, 1, &triTableSRV);
+
+	if (isPackedTriTable)
+	{
+
+		deviceContext->GSSetConstantBuffers(1, 1, &packedTriTableBuffer);
+
+	}
+	else
+	{
+
+		deviceContext->GSSetShaderResources(1, 1, &triTableSRV);
+
+	}
 
 }
 
-void MCShader::loadSOGeometryShader(WCHAR* filename, ID3D11DeviceContext* deviceContext)
+void MCShader::loadVertexIDShader(WCHAR* filename)
+{
+
+	ID3DBlob* vertexShaderBuffer;
+
+	vertexShader = 0;
+	layout = 0;
+
+	// Reads compiled shader into buffer (bytecode)
+	HRESULT result = D3DReadFileToBlob(filename, &vertexShaderBuffer);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, filename, L"File not found", MB_OK);
+		exit(0);
+
+	}
+
+	result = renderer->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, filename, L"Failed to create vertex shader", MB_OK);
+		exit(0);
+
+	}
+
+	vertexShaderBuffer->Release();
+	vertexShaderBuffer = 0;
+
+}
+
+void MCShader::loadSOGeometryShader(WCHAR* filename, ID3D11DeviceContext* deviceContext, ID3D11GeometryShader** geometryShader)
 {
 
 	ID3D10Blob* geometryShaderBuffer;
@@ -192,7 +278,7 @@ void MCShader::loadSOGeometryShader(WCHAR* filename, ID3D11DeviceContext* device
 
 	// Create the geometry shader from the buffer
 	result = renderer->CreateGeometryShaderWithStreamOutput(geometryShaderBuffer->GetBufferPointer(), geometryShaderBuffer->GetBufferSize(), SODeclarationEntry, _countof(SODeclarationEntry),
-		NULL, 0, D3D11_SO_NO_RASTERIZED_STREAM, NULL, &streamOutputGeometryShader);
+		NULL, 0, D3D11_SO_NO_RASTERIZED_STREAM, NULL, geometryShader);
 	if (result != S_OK)
 	{
 
@@ -206,6 +292,34 @@ void MCShader::loadSOGeometryShader(WCHAR* filename, ID3D11DeviceContext* device
 
 }
 
+void MCShader::initQueries()
+{
+
+	D3D11_QUERY_DESC queryDesc;
+	ZeroMemory(&queryDesc, sizeof(queryDesc));
+
+	queryDesc.Query = D3D11_QUERY_SO_STATISTICS_STREAM0;
+	HRESULT result = renderer->CreateQuery(&queryDesc, &soStatisticsQuery);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, L"Failed to create stream output statistics query", L"Fail", MB_OK);
+		exit(0);
+
+	}
+
+	queryDesc.Query = D3D11_QUERY_SO_OVERFLOW_PREDICATE_STREAM0;
+	result = renderer->CreateQuery(&queryDesc, &soOverflowQuery);
+	if (result != S_OK)
+	{
+
+		MessageBox(NULL, L"Failed to create stream output overflow query", L"Fail", MB_OK);
+		exit(0);
+
+	}
+
+}
+
 ID3D11Buffer* MCShader::getOutputBuffer()
 {
 
@@ -224,38 +338,37 @@ void MCShader::releaseOutputBuffer()
 
 	}
 
+	outputBufferCapacity = 0;
+
 }
 
 void MCShader::reInitOutputBuffer(int x, int y, int z)
 {
 
-	releaseOutputBuffer();
-
 	voxelsX = x;
 	voxelsY = y;
 	voxelsZ = z;
 
-	// Define a divisor to set the scale of the SO buffer according to sampling dimensions
-	// This needs to change due to the fact as the scale of the resolution of the sampling dimensions increases,
-	// the number of empty cells also increases, i.e. more voxels correlates with fewer triangles per voxel.
-	// Using this, we can save memory by allocating proportionally less space for larger volumes
-	int divisorHeuristic = 1;
+	// The predictor starts from a divisor heuristic (more voxels correlates with fewer triangles per voxel),
+	// then sizes the buffer from the primitive counts of previous extractions
+	unsigned int capacity = outputBufferPredictor.PredictCapacity(voxelsX, voxelsY, voxelsZ);
 
-	if (voxelsX >= 64)
+	// Reuse the current buffer if it's already the right size
+	if (outputBuffer && capacity == outputBufferCapacity)
 	{
 
-		// This will need to change if we're considering multiple dimensions
-		// Fortunately, right now all dimensions are equal, so we can run this code on only the X dimension
-		divisorHeuristic = voxelsX / 32;
+		return;
 
 	}
 
+	releaseOutputBuffer();
+
 	// Create the stream output buffer
 	HRESULT result;
 	D3D11_BUFFER_DESC outputBufferDesc;
 	ZeroMemory(&outputBufferDesc, sizeof(outputBufferDesc));
-	outputBufferDesc.ByteWidth = (sizeof(XMFLOAT4) + sizeof(XMFLOAT3)) * ((voxelsX * voxelsY * voxelsZ) / divisorHeuristic);// Vertex size * number of voxels
-	outputBufferDesc.Usage = D3D11_USAGE_DEFAULT;															// This is almost certainly going to be a bigger buffer than necessary
+	outputBufferDesc.ByteWidth = (sizeof(XMFLOAT4) + sizeof(XMFLOAT3)) * 3 * capacity;	// Vertex size * 3 vertices per triangle
+	outputBufferDesc.Usage = D3D11_USAGE_DEFAULT;
 	outputBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER | D3D11_BIND_STREAM_OUTPUT;
 	outputBufferDesc.CPUAccessFlags = 0;
 	outputBufferDesc.MiscFlags = 0;
@@ -269,25 +382,37 @@ void MCShader::reInitOutputBuffer(int x, int y, int z)
 		exit(0);
 	}
 
+	outputBufferCapacity = capacity;
+
 }
 
-void MCShader::render(ID3D11DeviceContext* deviceContext, int indexCount)
+void MCShader::render(ID3D11DeviceContext* deviceContext, int voxelCount)
 {
 
-	// Set the vertex input layout
-	deviceContext->IASetInputLayout(layout);
+	// No input layout or vertex buffer: each voxel comes from SV_VertexID, so nothing is read by the input assembler
+	ID3D11Buffer* pNullVertexBuffer = 0;
+	UINT nullStride = 0;
+	UINT nullOffset = 0;
+	deviceContext->IASetInputLayout(nullptr);
+	deviceContext->IASetVertexBuffers(0, 1, &pNullVertexBuffer, &nullStride, &nullOffset);
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_POINTLIST);
 
 	deviceContext->GSSetSamplers(0, 1, &sampleState);
 
 	// Set the vertex and pixel shaders that will be used to render
 	deviceContext->VSSetShader(vertexShader, NULL, 0);
-	deviceContext->GSSetShader(streamOutputGeometryShader, NULL, 0);
+	deviceContext->GSSetShader(isPackedTriTable ? packedGeometryShader : streamOutputGeometryShader, NULL, 0);
 
 	UINT offset[1] = { 0 };
 	deviceContext->SOSetTargets(1, &outputBuffer, offset);
 
-	// Render the geometry
-	deviceContext->DrawIndexed(indexCount, 0, 0);
+	// Render the geometry, counting how many primitives the stream output stage needed to write
+	deviceContext->Begin(soStatisticsQuery);
+	deviceContext->Begin(soOverflowQuery);
+	deviceContext->Draw(voxelCount, 0);
+	deviceContext->End(soOverflowQuery);
+	deviceContext->End(soStatisticsQuery);
+	isQueryPending = true;
 
 	ID3D11Buffer* pNullBuffer = 0;
 	deviceContext->SOSetTargets(1, &pNullBuffer, offset);
@@ -304,4 +429,64 @@ void MCShader::setTriTableTexture(ID3D11ShaderResourceView* triTableTexture)
 
 	triTableSRV = triTableTexture;
 
-}
\ No newline at end of file
+}
+
+void MCShader::setPackedTriTable(ID3D11Buffer* packedTriTable)
+{
+
+	packedTriTableBuffer = packedTriTable;
+
+}
+
+void MCShader::setPackedTriTableEnabled(bool isEnabled)
+{
+
+	isPackedTriTable = isEnabled;
+
+}
+
+bool MCShader::pollOverflow(ID3D11DeviceContext* deviceContext)
+{
+
+	if (!isQueryPending)
+	{
+
+		return false;
+
+	}
+
+	D3D11_QUERY_DATA_SO_STATISTICS statistics;
+	BOOL hasOverflowed = FALSE;
+
+	// As the GPU profiler reads its queries, never wait: if the GPU hasn't finished the extraction, try again next frame
+	if (deviceContext->GetData(soStatisticsQuery, &statistics, sizeof(statistics), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+		deviceContext->GetData(soOverflowQuery, &hasOverflowed, sizeof(hasOverflowed), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+	{
+
+		return false;
+
+	}
+
+	isQueryPending = false;
+	primitivesWritten = statistics.NumPrimitivesWritten;
+
+	// PrimitivesStorageNeeded is exact even when the buffer overflowed, so the predictor can regrow to the right size in one step
+	bool needsRerun = outputBufferPredictor.Record(statistics.PrimitivesStorageNeeded, outputBufferCapacity);
+
+	return needsRerun || hasOverflowed == TRUE;
+
+}
+
+bool MCShader::hasPendingQueries() const
+{
+
+	return isQueryPending;
+
+}
+
+int MCShader::getVertexCount() const
+{
+
+	return (int)primitivesWritten * 3;
+
+}
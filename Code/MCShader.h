@@ -4,6 +4,7 @@
 #define _MARCHING_CUBES_SHADER_H_
 
 #include "../DXFramework/BaseShader.h"
+#include "OutputBufferPredictor.h"
 
 using namespace std;
 using namespace DirectX;
@@ -11,15 +12,16 @@ using namespace DirectX;
 class MCShader : public BaseShader
 {
 
-	// Buffer to hold the geometry shader parameters
-	// Will later include variables for multidimensional scaling and cell scaling
+	// Buffer to hold the vertex and geometry shader parameters
+	// meshSize is the number of voxels in each dimension, which need not be equal
 	struct ParamBufferType
 	{
 
 		float isoValue;
-		float meshSize;
 		float meshScaleFactor;
-		float padding;
+		float padding[2];
+		XMFLOAT3 meshSize;
+		float meshSizePadding;
 
 	};
 
@@ -28,17 +30,33 @@ public:
 	MCShader(ID3D11Device* device, ID3D11DeviceContext* deviceContext, HWND hwnd);
 	~MCShader();
 
+	// The mesh size is the one last passed to reInitOutputBuffer
 	void setShaderParameters(ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView* noiseTexture, ID3D11ShaderResourceView* rockTexture,
-		float isoValue, float meshSize, float scaleFactor);
+		float isoValue, float scaleFactor);
 
 	// Returns the stream output buffer - to be used as a vertex buffer in an EmptyMesh
 	ID3D11Buffer* getOutputBuffer();
 	void setTriTableTexture(ID3D11ShaderResourceView* triTableTexture);
+	// Packed triangle table constant buffer, read by the marching_cubes_packed_gs variant
+	void setPackedTriTable(ID3D11Buffer* packedTriTable);
+	// Extract with the packed table variant instead of the triangle table texture
+	void setPackedTriTableEnabled(bool isEnabled);
 
 	// Re-initialise the output buffer if the amount of geometry we expect to output changes
+	// The size comes from the output buffer predictor; the buffer is only recreated when that size changes
 	void reInitOutputBuffer(int x, int y, int z);
 
-	void render(ID3D11DeviceContext* deviceContext, int indexCount);
+	// Draws one point per voxel with no vertex buffer bound; the vertex shader works out each voxel from its vertex ID
+	void render(ID3D11DeviceContext* deviceContext, int voxelCount);
+
+	// Reads the stream output queries of the last render without waiting, feeding the exact primitive count to the predictor
+	// Returns true if they show the output buffer overflowed; the caller should then regenerate, which regrows the buffer
+	// Returns false if there is nothing new, including while the GPU is still working on the render
+	bool pollOverflow(ID3D11DeviceContext* deviceContext);
+	// True from a render until pollOverflow has read its queries
+	bool hasPendingQueries() const;
+	// Vertices the last render wrote, valid once pollOverflow has read its queries
+	int getVertexCount() const;
 
 	void releaseOutputBuffer();
 
@@ -46,8 +64,12 @@ private:
 
 	void initShader(WCHAR*, WCHAR*, InputLayoutType inputLayout);
 	void initShader(WCHAR* vs, WCHAR* ps, WCHAR* gs, ID3D11DeviceContext* deviceContext);
+	// Function for loading the vertex shader from file; it only reads SV_VertexID, so there is no input layout
+	void loadVertexIDShader(WCHAR* filename);
 	// Function for loading the geometry shader from file
-	void loadSOGeometryShader(WCHAR* filename, ID3D11DeviceContext* deviceContext);
+	void loadSOGeometryShader(WCHAR* filename, ID3D11DeviceContext* deviceContext, ID3D11GeometryShader** geometryShader);
+	// Creates the stream output statistics and overflow queries
+	void initQueries();
 
 private:
 
@@ -55,11 +77,27 @@ private:
 	ID3D11Buffer* outputBuffer;
 	ID3D11Buffer* paramBuffer;
 
-	// Geometry shader
+	// Geometry shader, and its variant reading the packed triangle table
 	ID3D11GeometryShader* streamOutputGeometryShader;
+	ID3D11GeometryShader* packedGeometryShader;
 
 	// Triangle table texture to be passed to the shader
 	ID3D11ShaderResourceView* triTableSRV;
+	// Packed triangle table for the variant, owned by the triangle table texture
+	ID3D11Buffer* packedTriTableBuffer;
+	bool isPackedTriTable;
+
+	// Stream output queries wrapped around each render
+	ID3D11Query* soStatisticsQuery;
+	ID3D11Query* soOverflowQuery;
+	// Set by render until pollOverflow has read the queries' results
+	bool isQueryPending;
+	unsigned long long primitivesWritten;
+
+	// Sizes the output buffer from previous primitive counts
+	OutputBufferPredictor outputBufferPredictor;
+	// Capacity of the current output buffer, in triangles
+	unsigned int outputBufferCapacity;
 	
 	// Values for mesh scaling purposes
 	int voxelsX;
@@ -0,0 +1,168 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+
+	data = nullptr;
+	size = 0;
+
+#ifdef _WIN32
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = nullptr;
+#endif
+
+}
+
+MappedFile::~MappedFile()
+{
+
+	Close();
+
+}
+
+bool MappedFile::Open(const char* path)
+{
+
+	Close();
+
+#ifdef _WIN32
+	fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+
+		return false;
+
+	}
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+
+		Close();
+		return false;
+
+	}
+
+	mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+
+	if (!mappingHandle)
+	{
+
+		Close();
+		return false;
+
+	}
+
+	data = (char*)MapViewOfFile(mappingHandle, FILE_MAP_COPY, 0, 0, 0);
+	size = (size_t)fileSize.QuadPart;
+#else
+	int descriptor = open(path, O_RDONLY);
+
+	if (descriptor < 0)
+	{
+
+		return false;
+
+	}
+
+	struct stat status;
+
+	if (fstat(descriptor, &status) != 0 || status.st_size == 0)
+	{
+
+		close(descriptor);
+		return false;
+
+	}
+
+	// A private mapping can be written to without touching the file, and the descriptor isn't needed once it exists
+	void* mapping = mmap(nullptr, (size_t)status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+	close(descriptor);
+
+	data = mapping == MAP_FAILED ? nullptr : (char*)mapping;
+	size = (size_t)status.st_size;
+#endif
+
+	if (!data)
+	{
+
+		Close();
+		return false;
+
+	}
+
+	return true;
+
+}
+
+void MappedFile::Close()
+{
+
+#ifdef _WIN32
+	if (data)
+	{
+
+		UnmapViewOfFile(data);
+
+	}
+
+	if (mappingHandle)
+	{
+
+		CloseHandle(mappingHandle);
+		mappingHandle = nullptr;
+
+	}
+
+	if (fileHandle != INVALID_HANDLE_VALUE)
+	{
+
+		CloseHandle(fileHandle);
+		fileHandle = INVALID_HANDLE_VALUE;
+
+	}
+#else
+	if (data)
+	{
+
+		munmap(data, size);
+
+	}
+#endif
+
+	data = nullptr;
+	size = 0;
+
+}
+
+bool MappedFile::isOpen() const
+{
+
+	return data != nullptr;
+
+}
+
+char* MappedFile::getData() const
+{
+
+	return data;
+
+}
+
+size_t MappedFile::getSize() const
+{
+
+	return size;
+
+}
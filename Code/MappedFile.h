@@ -0,0 +1,41 @@
+// Mapped file
+// Maps a whole file into memory, so that data stored in it can be used in place without being read or decoded
+// Mappings are copy-on-write: writing to the memory never changes the file
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+#include <cstddef>
+
+class MappedFile
+{
+
+public:
+
+	MappedFile();
+	~MappedFile();
+
+	// Map the file at path, replacing any current mapping; returns false if it can't be opened or mapped
+	bool Open(const char* path);
+	void Close();
+
+	bool isOpen() const;
+	char* getData() const;
+	size_t getSize() const;
+
+private:
+
+	// Not copyable, as the mapping has a single owner
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	char* data;
+	size_t size;
+
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#endif
+
+};
+
+#endif // !_MAPPED_FILE_H_
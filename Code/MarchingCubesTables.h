@@ -0,0 +1,20 @@
+// Marching cubes tables
+// Paul Bourke's edge and triangulation tables, shared by the triangle table texture and the CPU extractor
+#ifndef _MARCHING_CUBES_TABLES_H_
+#define _MARCHING_CUBES_TABLES_H_
+
+#include <cstdint>
+
+// Bitmask of intersected edges for each of the 256 cube configurations
+extern const int edgeTable[256];
+// Up to 5 triangles (as edge indices) for each cube configuration, terminated by -1
+extern const int triTable[256][16];
+
+// triTable packed into one 64-bit word per cube configuration (2 KB against 16 KB), generated from it at compile time
+// The triangles' edge indices take 4 bits each from the lowest bits up, and the triangle count the top 4 bits, so a
+// case is read with one load and no search for the -1 terminator
+const uint64_t* getPackedTriTable();
+// Number of triangles in each cube configuration (0 to 5), generated from triTable at compile time
+const int* getCaseTriangleCounts();
+
+#endif // !_MARCHING_CUBES_TABLES_H_
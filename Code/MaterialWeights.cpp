@@ -0,0 +1,121 @@
+#include "MaterialWeights.h"
+#include <cmath>
+#include <cstring>
+
+const int MaterialWeights::levels;
+const int MaterialWeights::shortLevels;
+const unsigned int MaterialWeights::packedExponent;
+const int MaterialWeights::sandShift;
+const int MaterialWeights::grassShift;
+const int MaterialWeights::axisXShift;
+const int MaterialWeights::axisYShift;
+
+float MaterialWeights::Pack(const float* layers, const float* axes)
+{
+
+	int quantisedLayers[3];
+	int quantisedAxes[3];
+	Quantise(layers, levels, quantisedLayers);
+	Quantise(axes, levels, quantisedAxes);
+
+	// Rock and Z are what's left of 63
+	unsigned int bits = packedExponent | (quantisedLayers[MATERIAL_SAND] << sandShift) | (quantisedLayers[MATERIAL_GRASS] << grassShift) |
+		(quantisedAxes[0] << axisXShift) | (quantisedAxes[1] << axisYShift);
+
+	float packed;
+	memcpy(&packed, &bits, sizeof(packed));
+	return packed;
+
+}
+
+void MaterialWeights::Unpack(float packed, float* layers, float* axes)
+{
+
+	unsigned int bits;
+	memcpy(&bits, &packed, sizeof(bits));
+
+	int sand = (bits >> sandShift) & levels;
+	int grass = (bits >> grassShift) & levels;
+	int x = (bits >> axisXShift) & levels;
+	int y = (bits >> axisYShift) & levels;
+
+	layers[MATERIAL_SAND] = sand / (float)levels;
+	layers[MATERIAL_GRASS] = grass / (float)levels;
+	layers[MATERIAL_ROCK] = (levels - sand - grass) / (float)levels;
+	axes[0] = x / (float)levels;
+	axes[1] = y / (float)levels;
+	axes[2] = (levels - x - y) / (float)levels;
+
+}
+
+void MaterialWeights::Apply(MeshVertex& vertex)
+{
+
+	float layers[MATERIAL_LAYER_COUNT];
+	float axes[3];
+	CalculateLayers(vertex.position[1], vertex.normal[1], layers);
+	CalculateAxes(vertex.normal, axes);
+	vertex.position[3] = Pack(layers, axes);
+
+}
+
+unsigned short MaterialWeights::PackShort(float packed)
+{
+
+	float layers[MATERIAL_LAYER_COUNT];
+	float axes[3];
+	Unpack(packed, layers, axes);
+
+	int quantisedLayers[3];
+	int quantisedAxes[3];
+	Quantise(layers, shortLevels, quantisedLayers);
+	Quantise(axes, shortLevels, quantisedAxes);
+
+	return (unsigned short)(quantisedLayers[MATERIAL_SAND] | (quantisedLayers[MATERIAL_GRASS] << 4) | (quantisedAxes[0] << 8) | (quantisedAxes[1] << 12));
+
+}
+
+float MaterialWeights::UnpackShort(unsigned short packed)
+{
+
+	// Widen each 4 bit weight back to 6 bits through floats, so the result is a normal packed value
+	int sand = packed & 0xF;
+	int grass = (packed >> 4) & 0xF;
+	int x = (packed >> 8) & 0xF;
+	int y = (packed >> 12) & 0xF;
+
+	float layers[MATERIAL_LAYER_COUNT] = { sand / (float)shortLevels, grass / (float)shortLevels, (shortLevels - sand - grass) / (float)shortLevels };
+	float axes[3] = { x / (float)shortLevels, y / (float)shortLevels, (shortLevels - x - y) / (float)shortLevels };
+
+	return Pack(layers, axes);
+
+}
+
+void MaterialWeights::Quantise(const float* weights, int count, int* quantised)
+{
+
+	float sum = weights[0] + weights[1] + weights[2];
+	float remainders[3];
+	int total = 0;
+
+	for (int i = 0; i < 3; i++)
+	{
+
+		float scaled = sum > 0.0f ? weights[i] / sum * count : count / 3.0f;
+		quantised[i] = (int)floorf(scaled);
+		remainders[i] = scaled - quantised[i];
+		total += quantised[i];
+
+	}
+
+	// Hand the levels lost to rounding down to the weights that lost the most
+	for (; total < count; total++)
+	{
+
+		int largest = remainders[0] >= remainders[1] ? (remainders[0] >= remainders[2] ? 0 : 2) : (remainders[1] >= remainders[2] ? 1 : 2);
+		quantised[largest]++;
+		remainders[largest] = -1.0f;
+
+	}
+
+}
@@ -0,0 +1,181 @@
+// Material weights
+// Per-vertex form of light_ps.hlsl's texturing: how much of each texture layer a vertex shows, from its height and
+// slope, and how much each triplanar projection contributes, from its normal
+// The extractors pack both into the w component of each vertex's position, which was always 1, so the pixel shader can
+// skip the layers and projections a triangle doesn't use; material_fx.hlsl does the same on the GPU
+#ifndef _MATERIAL_WEIGHTS_H_
+#define _MATERIAL_WEIGHTS_H_
+
+#include "TerrainTypes.h"
+
+// Texture layers in the order their weights are stored
+// light_ps.hlsl binds a slope texture too, but never samples it, so it has no weight
+enum MaterialLayer
+{
+
+	MATERIAL_SAND,
+	MATERIAL_GRASS,
+	MATERIAL_ROCK,
+	MATERIAL_LAYER_COUNT
+
+};
+
+class MaterialWeights
+{
+
+public:
+
+	// Layer weights of a vertex at mesh space height y whose unit normal has the given Y component, summing to 1
+	static constexpr void CalculateLayers(float y, float normalY, float* layers)
+	{
+
+		// Sand below a height of 0, fading out by 1 / 0.15, with a fifth power falloff
+		float height = Saturate(y * 0.15f);
+		height = height * height * height * height * height;
+
+		float slope = 1.0f - normalY;
+		float sand = 1.0f - height;
+		float grass = 0.0f;
+		float rock = 1.0f;
+
+		// Flat ground blends from sand and grass towards sand and rock, then steep slopes towards bare rock
+		if (slope < 0.3f)
+		{
+
+			float blend = slope / 0.3f;
+			grass = height * (1.0f - blend);
+			rock = height * blend;
+
+		}
+		else if (slope < 0.7f)
+		{
+
+			float blend = (slope - 0.3f) * (1.0f / (0.7f - 0.3f));
+			sand *= 1.0f - blend;
+			rock = height * (1.0f - blend) + blend;
+
+		}
+		else
+		{
+
+			sand = 0.0f;
+
+		}
+
+		layers[MATERIAL_SAND] = sand;
+		layers[MATERIAL_GRASS] = grass;
+		layers[MATERIAL_ROCK] = rock;
+
+	}
+
+	// Triplanar blend weights of the projections along X, Y and Z for a normal, summing to 1
+	static constexpr void CalculateAxes(const float* normal, float* axes)
+	{
+
+		float x = Abs(normal[0]);
+		float y = Abs(normal[1]);
+		float z = Abs(normal[2]);
+		float sum = x + y + z;
+
+		// A zero normal (a flat density) has no direction, so blend the three evenly
+		axes[0] = sum > 0.0f ? x / sum : 1.0f / 3.0f;
+		axes[1] = sum > 0.0f ? y / sum : 1.0f / 3.0f;
+		axes[2] = sum > 0.0f ? z / sum : 1.0f / 3.0f;
+
+	}
+
+	// Quantise each set to 6 bits, with the third weight of each implied by the other two, and return the bits as the
+	// float stored in w; the top bits are fixed so the float is always an ordinary number from 2 up to 8
+	static float Pack(const float* layers, const float* axes);
+	static void Unpack(float packed, float* layers, float* axes);
+	// Write the packed weights of a vertex whose position and normal are set into its position's w
+	static void Apply(MeshVertex& vertex);
+
+	// The 16 bits PackedVertex keeps in its w, with 4 bits per weight
+	static unsigned short PackShort(float packed);
+	static float UnpackShort(unsigned short packed);
+
+	// Quantise three weights summing to 1 into integers summing to count, rounding by largest remainder so that the
+	// sum stays exact and a weight of 0 stays 0
+	static void Quantise(const float* weights, int count, int* quantised);
+
+	// light_ps.hlsl's texture colour evaluated literally, with each layer's texture replaced by a colour that is 1 in
+	// that layer's channel; the channel of the given layer is that layer's weight
+	static constexpr float getReferenceWeight(float y, float normalY, int layer)
+	{
+
+		float sandColor[3] = { 1.0f, 0.0f, 0.0f };
+		float grassColor[3] = { 0.0f, 1.0f, 0.0f };
+		float rockColor[3] = { 0.0f, 0.0f, 1.0f };
+
+		float height = Saturate(y * 0.15f);
+		height = height * height * height * height * height;
+
+		float groundColor = Lerp(sandColor[layer], grassColor[layer], height);
+		float slopeColor = Lerp(sandColor[layer], rockColor[layer], height);
+
+		float slope = 1.0f - normalY;
+		float textureColor = 0.0f;
+
+		if (slope < 0.3f)
+		{
+
+			textureColor = Lerp(groundColor, slopeColor, slope / 0.3f);
+
+		}
+
+		if ((slope < 0.7f) && (slope >= 0.3f))
+		{
+
+			textureColor = Lerp(slopeColor, rockColor[layer], (slope - 0.3f) * (1.0f / (0.7f - 0.3f)));
+
+		}
+
+		if (slope >= 0.7f)
+		{
+
+			textureColor = rockColor[layer];
+
+		}
+
+		return textureColor;
+
+	}
+
+	// Levels of each weight in the 32 and 16 bit forms
+	static const int levels = 63;
+	static const int shortLevels = 15;
+
+	// Bit layout of the 32 bit form: a fixed top byte over sand, grass, X and Y from the lowest bits up, 6 bits each
+	static const unsigned int packedExponent = 0x40000000u;
+	static const int sandShift = 0;
+	static const int grassShift = 6;
+	static const int axisXShift = 12;
+	static const int axisYShift = 18;
+
+private:
+
+	static constexpr float Saturate(float value)
+	{
+
+		return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+
+	}
+
+	static constexpr float Lerp(float a, float b, float t)
+	{
+
+		return a + (b - a) * t;
+
+	}
+
+	static constexpr float Abs(float value)
+	{
+
+		return value < 0.0f ? -value : value;
+
+	}
+
+};
+
+#endif // !_MATERIAL_WEIGHTS_H_
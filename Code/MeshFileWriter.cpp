@@ -0,0 +1,126 @@
+#include "MeshFileWriter.h"
+#include <cstddef>
+#include <cstring>
+
+const unsigned int MeshFileWriter::version = 2;
+
+MeshFileWriter::MeshFileWriter()
+{
+
+	bufferUsed = 0;
+	vertexCount = 0;
+
+}
+
+MeshFileWriter::~MeshFileWriter()
+{
+
+	if (file.is_open())
+	{
+
+		Close();
+
+	}
+
+}
+
+bool MeshFileWriter::Open(const char* path, size_t bufferBytes)
+{
+
+	file.open(path, std::ofstream::binary | std::ofstream::trunc);
+
+	if (!file.is_open())
+	{
+
+		return false;
+
+	}
+
+	// A buffer smaller than one vertex would never hold anything
+	buffer.resize(bufferBytes > sizeof(MeshVertex) ? bufferBytes : sizeof(MeshVertex));
+	bufferUsed = 0;
+	vertexCount = 0;
+
+	// Write a placeholder header, completed by Close
+	Header header;
+	memcpy(header.magic, "MCVB", 4);
+	header.version = version;
+	header.vertexSize = sizeof(MeshVertex);
+	header.padding = 0;
+	header.vertexCount = 0;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	return file.good();
+
+}
+
+void MeshFileWriter::Write(const MeshVertex* vertices, size_t count)
+{
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	size_t bytes = count * sizeof(MeshVertex);
+
+	if (bufferUsed + bytes > buffer.size())
+	{
+
+		Flush();
+
+	}
+
+	// Anything that can't fit in the buffer at all goes straight to the file
+	if (bytes > buffer.size())
+	{
+
+		file.write(reinterpret_cast<const char*>(vertices), bytes);
+
+	}
+	else
+	{
+
+		memcpy(buffer.data() + bufferUsed, vertices, bytes);
+		bufferUsed += bytes;
+
+	}
+
+	vertexCount += count;
+
+}
+
+void MeshFileWriter::Flush()
+{
+
+	if (bufferUsed > 0)
+	{
+
+		file.write(buffer.data(), bufferUsed);
+		bufferUsed = 0;
+
+	}
+
+}
+
+bool MeshFileWriter::Close()
+{
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	Flush();
+
+	file.seekp(offsetof(Header, vertexCount));
+	file.write(reinterpret_cast<const char*>(&vertexCount), sizeof(vertexCount));
+
+	bool isGood = file.good();
+	file.close();
+	std::vector<char>().swap(buffer);
+
+	return isGood;
+
+}
+
+unsigned long long MeshFileWriter::getVertexCount() const
+{
+
+	return vertexCount;
+
+}
@@ -0,0 +1,58 @@
+// Mesh file writer
+// Streams vertices to a binary file through a fixed size buffer, so a mesh larger than memory can be written out as it is generated
+// The file is a header followed by the raw vertices, laid out as MeshVertex (and so as the stream output buffer);
+// the header's vertex count is filled in on Close
+#ifndef _MESH_FILE_WRITER_H_
+#define _MESH_FILE_WRITER_H_
+
+#include <fstream>
+#include <mutex>
+#include <vector>
+#include "TerrainTypes.h"
+
+class MeshFileWriter
+{
+
+public:
+
+	// Matches the start of the file
+	struct Header
+	{
+
+		char magic[4];
+		unsigned int version;
+		unsigned int vertexSize;
+		unsigned int padding;
+		unsigned long long vertexCount;
+
+	};
+
+	MeshFileWriter();
+	~MeshFileWriter();
+
+	// Create the file and allocate a write buffer of bufferBytes; returns false if the file can't be created
+	bool Open(const char* path, size_t bufferBytes);
+	// Append vertices; safe to call from several threads, and the vertices of one call are kept together
+	void Write(const MeshVertex* vertices, size_t count);
+	// Flush the buffer and write the final vertex count; returns false if any write failed
+	bool Close();
+
+	unsigned long long getVertexCount() const;
+
+	static const unsigned int version;
+
+private:
+
+	// Write out the buffered bytes; the caller holds the mutex
+	void Flush();
+
+	std::ofstream file;
+	std::mutex mutex;
+
+	std::vector<char> buffer;
+	size_t bufferUsed;
+	unsigned long long vertexCount;
+
+};
+
+#endif // !_MESH_FILE_WRITER_H_
@@ -0,0 +1,322 @@
+#include "MeshOptimizer.h"
+
+const unsigned int MeshOptimizer::unassigned;
+const unsigned int MeshOptimizer::fetchLineSize;
+const unsigned int MeshOptimizer::fetchLineCount;
+
+MeshOptimizer::MeshOptimizer()
+{
+
+	cacheSize = 16;
+	cursor = 0;
+
+}
+
+void MeshOptimizer::setCacheSize(unsigned int size)
+{
+
+	cacheSize = size > 3 ? size : 3;
+
+}
+
+void MeshOptimizer::OptimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount)
+{
+
+	size_t triangleCount = indexCount / 3;
+
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+
+		return;
+
+	}
+
+	// Triangles using each vertex, as offsets into one adjacency list; a vertex used twice by a triangle lists it twice
+	adjacencyOffsets.assign(vertexCount + 1, 0);
+	liveCounts.assign(vertexCount, 0);
+
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+
+		liveCounts[indices[i]]++;
+
+	}
+
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveCounts[v];
+
+	}
+
+	adjacency.resize(triangleCount * 3);
+	remap.assign(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+
+		adjacency[remap[indices[i]]++] = (unsigned int)(i / 3);
+
+	}
+
+	cacheTimes.assign(vertexCount, 0);
+	isEmitted.assign(triangleCount, false);
+	deadEnds.clear();
+	output.clear();
+	output.reserve(triangleCount * 3);
+	cursor = 0;
+
+	// Time stamps start past the cache size, so no vertex begins in the cache
+	unsigned int timeStamp = cacheSize + 1;
+	int fanningVertex = 0;
+
+	while (fanningVertex >= 0)
+	{
+
+		candidates.clear();
+
+		// Emit every remaining triangle around the fanning vertex
+		for (unsigned int a = adjacencyOffsets[fanningVertex]; a < adjacencyOffsets[fanningVertex + 1]; a++)
+		{
+
+			unsigned int triangle = adjacency[a];
+
+			if (isEmitted[triangle])
+			{
+
+				continue;
+
+			}
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+
+				unsigned int v = indices[triangle * 3 + corner];
+
+				output.push_back(v);
+				deadEnds.push_back(v);
+				candidates.push_back(v);
+				liveCounts[v]--;
+
+				if (timeStamp - cacheTimes[v] > cacheSize)
+				{
+
+					cacheTimes[v] = timeStamp;
+					timeStamp++;
+
+				}
+
+			}
+
+			isEmitted[triangle] = true;
+
+		}
+
+		fanningVertex = GetNextVertex(vertexCount, timeStamp);
+
+	}
+
+	for (size_t i = 0; i < output.size(); i++)
+	{
+
+		indices[i] = output[i];
+
+	}
+
+}
+
+int MeshOptimizer::GetNextVertex(size_t vertexCount, unsigned int timeStamp)
+{
+
+	int best = -1;
+	int bestPriority = -1;
+
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+
+		unsigned int v = candidates[i];
+
+		if (liveCounts[v] == 0)
+		{
+
+			continue;
+
+		}
+
+		// Candidates that would fall out of the cache while their own triangles are emitted get the lowest priority
+		int priority = 0;
+		unsigned int age = timeStamp - cacheTimes[v];
+
+		if (age + 2 * liveCounts[v] <= cacheSize)
+		{
+
+			priority = (int)age;
+
+		}
+
+		if (priority > bestPriority)
+		{
+
+			bestPriority = priority;
+			best = (int)v;
+
+		}
+
+	}
+
+	if (best >= 0)
+	{
+
+		return best;
+
+	}
+
+	// Dead end: fall back to a recently used vertex that still has triangles
+	while (!deadEnds.empty())
+	{
+
+		unsigned int v = deadEnds.back();
+		deadEnds.pop_back();
+
+		if (liveCounts[v] > 0)
+		{
+
+			return (int)v;
+
+		}
+
+	}
+
+	// Then to the next vertex in input order that still has triangles, which the cursor never passes twice
+	while (cursor < vertexCount)
+	{
+
+		if (liveCounts[cursor] > 0)
+		{
+
+			return (int)cursor;
+
+		}
+
+		cursor++;
+
+	}
+
+	return -1;
+
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices)
+{
+
+	ReorderVertices(vertices, indices);
+
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<PackedVertex>& vertices, std::vector<unsigned int>& indices)
+{
+
+	ReorderVertices(vertices, indices);
+
+}
+
+template <typename Vertex>
+void MeshOptimizer::ReorderVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+
+	remap.assign(vertices.size(), unassigned);
+	std::vector<Vertex> reordered;
+	reordered.reserve(vertices.size());
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+
+		unsigned int& newIndex = remap[indices[i]];
+
+		if (newIndex == unassigned)
+		{
+
+			newIndex = (unsigned int)reordered.size();
+			reordered.push_back(vertices[indices[i]]);
+
+		}
+
+		indices[i] = newIndex;
+
+	}
+
+	vertices.swap(reordered);
+
+}
+
+MeshOptimizer::CacheStatistics MeshOptimizer::AnalyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int lcacheSize)
+{
+
+	CacheStatistics statistics;
+	statistics.misses = 0;
+	statistics.triangleCount = indexCount / 3;
+	statistics.vertexCount = vertexCount;
+
+	// A FIFO cache holds the last cacheSize vertices that missed, so a vertex is cached if fewer than cacheSize
+	// misses have happened since its own; the counter starts past the cache size so nothing begins cached
+	unsigned long long missCounter = lcacheSize + 1;
+	std::vector<unsigned long long> missTimes(vertexCount, 0);
+
+	for (size_t i = 0; i < statistics.triangleCount * 3; i++)
+	{
+
+		unsigned int v = indices[i];
+
+		if (missCounter - missTimes[v] > lcacheSize)
+		{
+
+			missTimes[v] = missCounter;
+			missCounter++;
+			statistics.misses++;
+
+		}
+
+	}
+
+	return statistics;
+
+}
+
+unsigned long long MeshOptimizer::AnalyzeVertexFetch(const unsigned int* indices, size_t indexCount, size_t vertexCount, size_t vertexSize)
+{
+
+	unsigned long long bytesFetched = 0;
+	std::vector<unsigned long long> lines(fetchLineCount, ~0ull);
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+
+		if (indices[i] >= vertexCount)
+		{
+
+			continue;
+
+		}
+
+		// A vertex can straddle two lines
+		unsigned long long first = (unsigned long long)indices[i] * vertexSize / fetchLineSize;
+		unsigned long long last = ((unsigned long long)indices[i] * vertexSize + vertexSize - 1) / fetchLineSize;
+
+		for (unsigned long long line = first; line <= last; line++)
+		{
+
+			if (lines[line % fetchLineCount] != line)
+			{
+
+				lines[line % fetchLineCount] = line;
+				bytesFetched += fetchLineSize;
+
+			}
+
+		}
+
+	}
+
+	return bytesFetched;
+
+}
@@ -0,0 +1,74 @@
+// Mesh optimizer
+// Reorders an indexed triangle list for the post-transform vertex cache (Tipsify, Sander et al. 2007), then reorders its
+// vertices into the order the triangles first use them, so vertex fetches walk the buffer forwards
+// Marching cubes emits triangles in cell scan order, which revisits each vertex a row or a slice of cells later
+#ifndef _MESH_OPTIMIZER_H_
+#define _MESH_OPTIMIZER_H_
+
+#include <cstddef>
+#include <vector>
+#include "TerrainTypes.h"
+
+class MeshOptimizer
+{
+
+public:
+
+	// Result of simulating a FIFO post-transform cache over an index list
+	struct CacheStatistics
+	{
+
+		unsigned long long misses;
+		unsigned long long triangleCount;
+		unsigned long long vertexCount;
+
+	};
+
+	MeshOptimizer();
+
+	// Size of the cache the triangle order is optimised for (default 16)
+	void setCacheSize(unsigned int size);
+
+	// Reorder the triangles of the index list in place; every index must be below vertexCount
+	void OptimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount);
+	// Reorder the vertices into order of first use and rewrite the indices to match; unused vertices are dropped
+	void OptimizeVertexFetch(std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices);
+	void OptimizeVertexFetch(std::vector<PackedVertex>& vertices, std::vector<unsigned int>& indices);
+
+	// Count the vertex shader invocations a FIFO cache of cacheSize entries would need to draw the index list
+	// ACMR is misses per triangle and ATVR misses per vertex; 0.5 and 1.0 are the ideal for a large regular grid
+	CacheStatistics AnalyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize);
+	// Bytes a direct mapped cache of 256 64-byte lines would read from the vertex buffer to draw the index list
+	// Divided by the buffer's size this is the overfetch, which is 1.0 when every line is read exactly once
+	unsigned long long AnalyzeVertexFetch(const unsigned int* indices, size_t indexCount, size_t vertexCount, size_t vertexSize);
+
+private:
+
+	template <typename Vertex>
+	void ReorderVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+	// Next vertex to fan around once the current one is done: the candidate that will still be in the cache after
+	// its remaining triangles are emitted and has been there longest, or the most recent dead end, or the next live vertex
+	int GetNextVertex(size_t vertexCount, unsigned int timeStamp);
+
+	unsigned int cacheSize;
+
+	// Scratch lists, kept for the next call
+	std::vector<unsigned int> adjacencyOffsets;
+	std::vector<unsigned int> adjacency;
+	std::vector<unsigned int> liveCounts;
+	std::vector<unsigned int> cacheTimes;
+	std::vector<unsigned int> deadEnds;
+	std::vector<unsigned int> candidates;
+	std::vector<bool> isEmitted;
+	std::vector<unsigned int> output;
+	std::vector<unsigned int> remap;
+	size_t cursor;
+
+	static const unsigned int unassigned = 0xFFFFFFFF;
+	static const unsigned int fetchLineSize = 64;
+	static const unsigned int fetchLineCount = 256;
+
+};
+
+#endif // !_MESH_OPTIMIZER_H_
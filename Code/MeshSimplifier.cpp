@@ -0,0 +1,507 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+float MeshSimplifier::Simplify(std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices, float targetRatio, float maxError)
+{
+
+	size_t vertexCount = vertices.size();
+	size_t targetCount = (size_t)(indices.size() / 3 * std::max(targetRatio, 0.0f));
+	double maxCost = (double)maxError * maxError;
+	float largestError = 0.0f;
+
+	// Marching cubes emits triangles with a repeated vertex where the surface passes exactly through a corner
+	size_t count = 0;
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+
+		if (indices[i] != indices[i + 1] && indices[i + 1] != indices[i + 2] && indices[i] != indices[i + 2])
+		{
+
+			indices[count++] = indices[i];
+			indices[count++] = indices[i + 1];
+			indices[count++] = indices[i + 2];
+
+		}
+
+	}
+
+	indices.resize(count);
+
+	if (indices.empty() || indices.size() / 3 <= targetCount)
+	{
+
+		return 0.0f;
+
+	}
+
+	// Each vertex starts with the planes of the triangles around it
+	Quadric empty;
+	memset(&empty, 0, sizeof(empty));
+	quadrics.assign(vertexCount, empty);
+
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+
+		const float* p0 = vertices[indices[i]].position;
+		const float* p1 = vertices[indices[i + 1]].position;
+		const float* p2 = vertices[indices[i + 2]].position;
+
+		double e1[3] = { (double)p1[0] - p0[0], (double)p1[1] - p0[1], (double)p1[2] - p0[2] };
+		double e2[3] = { (double)p2[0] - p0[0], (double)p2[1] - p0[1], (double)p2[2] - p0[2] };
+		double normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		double length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+		if (length == 0.0)
+		{
+
+			continue;
+
+		}
+
+		double a = normal[0] / length;
+		double b = normal[1] / length;
+		double c = normal[2] / length;
+		double d = -(a * p0[0] + b * p0[1] + c * p0[2]);
+
+		for (int k = 0; k < 3; k++)
+		{
+
+			AddPlane(quadrics[indices[i + k]], a, b, c, d);
+
+		}
+
+	}
+
+	LockBorders(indices, vertexCount);
+	FindComponents(indices, vertexCount);
+
+	remap.resize(vertexCount);
+
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+
+		remap[v] = (unsigned int)v;
+
+	}
+
+	while (indices.size() / 3 > targetCount)
+	{
+
+		BuildAdjacency(indices, vertexCount);
+
+		// Interior edges are shared by two triangles in opposite directions, so a < b lists each once
+		collapses.clear();
+
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+
+			unsigned int a = indices[i];
+			unsigned int b = indices[i % 3 == 2 ? i - 2 : i + 1];
+
+			if (a > b || (isLocked[a] && isLocked[b]))
+			{
+
+				continue;
+
+			}
+
+			Quadric combined = quadrics[a];
+			AddQuadric(combined, quadrics[b]);
+
+			double costToB = isLocked[a] ? HUGE_VAL : Error(combined, vertices[b].position);
+			double costToA = isLocked[b] ? HUGE_VAL : Error(combined, vertices[a].position);
+
+			Collapse collapse;
+			collapse.cost = (float)std::min(costToA, costToB);
+			collapse.from = costToB <= costToA ? a : b;
+			collapse.to = costToB <= costToA ? b : a;
+			collapses.push_back(collapse);
+
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+		isTouched.assign(vertexCount, false);
+		size_t triangleCount = indices.size() / 3;
+		bool isCollapsed = false;
+
+		for (size_t c = 0; c < collapses.size() && triangleCount > targetCount; c++)
+		{
+
+			const Collapse& collapse = collapses[c];
+
+			if (collapse.cost > maxCost)
+			{
+
+				break;
+
+			}
+
+			// Neither end may have moved or been moved onto this pass, so every remap this pass is a single step
+			if (isTouched[collapse.from] || isTouched[collapse.to] || IsFlipping(vertices, indices, collapse.from, collapse.to))
+			{
+
+				continue;
+
+			}
+
+			size_t removedCount = 0;
+
+			for (unsigned int a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; a++)
+			{
+
+				const unsigned int* triangle = &indices[adjacency[a] * 3];
+
+				if (remap[triangle[0]] == collapse.to || remap[triangle[1]] == collapse.to || remap[triangle[2]] == collapse.to)
+				{
+
+					removedCount++;
+
+				}
+
+			}
+
+			// Both ends are on the same piece, which has to keep a triangle so the surface doesn't disappear from the chunk
+			size_t& pieceTriangles = componentTriangles[components[collapse.to]];
+
+			if (removedCount >= pieceTriangles)
+			{
+
+				continue;
+
+			}
+
+			pieceTriangles -= removedCount;
+			triangleCount -= removedCount;
+			remap[collapse.from] = collapse.to;
+			AddQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+			isTouched[collapse.from] = true;
+			isTouched[collapse.to] = true;
+			largestError = std::max(largestError, sqrtf(collapse.cost));
+			isCollapsed = true;
+
+		}
+
+		if (!isCollapsed)
+		{
+
+			break;
+
+		}
+
+		// Apply the pass's collapses, dropping the triangles that lost an edge
+		count = 0;
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+
+			unsigned int a = remap[indices[i]];
+			unsigned int b = remap[indices[i + 1]];
+			unsigned int c = remap[indices[i + 2]];
+
+			if (a != b && b != c && a != c)
+			{
+
+				indices[count++] = a;
+				indices[count++] = b;
+				indices[count++] = c;
+
+			}
+
+		}
+
+		indices.resize(count);
+
+	}
+
+	// Remove the vertices that were moved away, keeping the order of the rest
+	const unsigned int unused = 0xFFFFFFFF;
+	remap.assign(vertexCount, unused);
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+
+		remap[indices[i]] = 0;
+
+	}
+
+	count = 0;
+
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+
+		if (remap[v] != unused)
+		{
+
+			remap[v] = (unsigned int)count;
+			vertices[count++] = vertices[v];
+
+		}
+
+	}
+
+	vertices.resize(count);
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+
+		indices[i] = remap[indices[i]];
+
+	}
+
+	return largestError;
+
+}
+
+void MeshSimplifier::AddPlane(Quadric& quadric, double a, double b, double c, double d)
+{
+
+	quadric.a2 += a * a;
+	quadric.ab += a * b;
+	quadric.ac += a * c;
+	quadric.ad += a * d;
+	quadric.b2 += b * b;
+	quadric.bc += b * c;
+	quadric.bd += b * d;
+	quadric.c2 += c * c;
+	quadric.cd += c * d;
+	quadric.d2 += d * d;
+
+}
+
+void MeshSimplifier::AddQuadric(Quadric& quadric, const Quadric& other)
+{
+
+	quadric.a2 += other.a2;
+	quadric.ab += other.ab;
+	quadric.ac += other.ac;
+	quadric.ad += other.ad;
+	quadric.b2 += other.b2;
+	quadric.bc += other.bc;
+	quadric.bd += other.bd;
+	quadric.c2 += other.c2;
+	quadric.cd += other.cd;
+	quadric.d2 += other.d2;
+
+}
+
+double MeshSimplifier::Error(const Quadric& quadric, const float* position)
+{
+
+	double x = position[0];
+	double y = position[1];
+	double z = position[2];
+
+	double error = quadric.a2 * x * x + 2.0 * quadric.ab * x * y + 2.0 * quadric.ac * x * z + 2.0 * quadric.ad * x
+		+ quadric.b2 * y * y + 2.0 * quadric.bc * y * z + 2.0 * quadric.bd * y
+		+ quadric.c2 * z * z + 2.0 * quadric.cd * z
+		+ quadric.d2;
+
+	// Rounding can leave a tiny negative error for a point on every plane
+	return std::max(error, 0.0);
+
+}
+
+void MeshSimplifier::LockBorders(const std::vector<unsigned int>& indices, size_t vertexCount)
+{
+
+	// Each edge as a key of its two vertices, smaller first, so both triangles sharing it give the same key
+	edges.resize(indices.size());
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+
+		unsigned long long a = indices[i];
+		unsigned long long b = indices[i % 3 == 2 ? i - 2 : i + 1];
+		edges[i] = a < b ? (a << 32) | b : (b << 32) | a;
+
+	}
+
+	std::sort(edges.begin(), edges.end());
+	isLocked.assign(vertexCount, false);
+
+	for (size_t i = 0; i < edges.size();)
+	{
+
+		size_t end = i + 1;
+
+		while (end < edges.size() && edges[end] == edges[i])
+		{
+
+			end++;
+
+		}
+
+		if (end - i != 2)
+		{
+
+			isLocked[(unsigned int)(edges[i] >> 32)] = true;
+			isLocked[(unsigned int)(edges[i] & 0xFFFFFFFF)] = true;
+
+		}
+
+		i = end;
+
+	}
+
+}
+
+void MeshSimplifier::FindComponents(const std::vector<unsigned int>& indices, size_t vertexCount)
+{
+
+	components.resize(vertexCount);
+
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+
+		components[v] = (unsigned int)v;
+
+	}
+
+	// Join the corners of every triangle, pointing the larger representative at the smaller
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+
+		for (int k = 1; k < 3; k++)
+		{
+
+			unsigned int a = FindComponent(indices[i]);
+			unsigned int b = FindComponent(indices[i + k]);
+
+			if (a != b)
+			{
+
+				components[std::max(a, b)] = std::min(a, b);
+
+			}
+
+		}
+
+	}
+
+	// Flatten the labels so the collapses can look a piece up directly; collapses never join two pieces
+	componentTriangles.assign(vertexCount, 0);
+
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+
+		components[v] = FindComponent((unsigned int)v);
+
+	}
+
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+
+		componentTriangles[components[indices[i]]]++;
+
+	}
+
+}
+
+unsigned int MeshSimplifier::FindComponent(unsigned int vertex)
+{
+
+	while (components[vertex] != vertex)
+	{
+
+		components[vertex] = components[components[vertex]];
+		vertex = components[vertex];
+
+	}
+
+	return vertex;
+
+}
+
+void MeshSimplifier::BuildAdjacency(const std::vector<unsigned int>& indices, size_t vertexCount)
+{
+
+	adjacencyOffsets.assign(vertexCount + 1, 0);
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+
+		adjacencyOffsets[indices[i] + 1]++;
+
+	}
+
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+
+		adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+
+	}
+
+	adjacency.resize(indices.size());
+	cursors.assign(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+
+		adjacency[cursors[indices[i]]++] = (unsigned int)(i / 3);
+
+	}
+
+}
+
+bool MeshSimplifier::IsFlipping(const std::vector<MeshVertex>& vertices, const std::vector<unsigned int>& indices, unsigned int from, unsigned int to) const
+{
+
+	for (unsigned int a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; a++)
+	{
+
+		const unsigned int* triangle = &indices[adjacency[a] * 3];
+		unsigned int corners[3] = { remap[triangle[0]], remap[triangle[1]], remap[triangle[2]] };
+
+		// Triangles on the collapsed edge disappear rather than turn
+		if (corners[0] == to || corners[1] == to || corners[2] == to)
+		{
+
+			continue;
+
+		}
+
+		const float* before[3];
+		const float* after[3];
+
+		for (int k = 0; k < 3; k++)
+		{
+
+			before[k] = vertices[corners[k]].position;
+			after[k] = corners[k] == from ? vertices[to].position : before[k];
+
+		}
+
+		float normalBefore[3];
+		float normalAfter[3];
+		TriangleNormal(before, normalBefore);
+		TriangleNormal(after, normalAfter);
+
+		// A triangle that turns over, or collapses to a line, would leave a fold or a crack
+		if (normalBefore[0] * normalAfter[0] + normalBefore[1] * normalAfter[1] + normalBefore[2] * normalAfter[2] <= 0.0f)
+		{
+
+			return true;
+
+		}
+
+	}
+
+	return false;
+
+}
+
+void MeshSimplifier::TriangleNormal(const float* const* corners, float* normal)
+{
+
+	float e1[3] = { corners[1][0] - corners[0][0], corners[1][1] - corners[0][1], corners[1][2] - corners[0][2] };
+	float e2[3] = { corners[2][0] - corners[0][0], corners[2][1] - corners[0][1], corners[2][2] - corners[0][2] };
+
+	normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+	normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+	normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+
+}
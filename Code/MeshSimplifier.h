@@ -0,0 +1,76 @@
+// Mesh simplifier
+// Quadric error edge collapse (Garland and Heckbert 1997) for one chunk's indexed mesh
+// Each collapse moves one end of an edge onto the other, so the kept vertex's normal stays valid; collapses are made in
+// passes, cheapest first, with each vertex in at most one collapse per pass
+// Vertices on an open or non-manifold edge are locked, so a chunk's border, and with it the seam to its neighbours, never moves
+// Every connected piece of surface keeps at least one triangle, so specks left by the noise shrink but never vanish
+#ifndef _MESH_SIMPLIFIER_H_
+#define _MESH_SIMPLIFIER_H_
+
+#include <cstddef>
+#include <vector>
+#include "TerrainTypes.h"
+
+class MeshSimplifier
+{
+
+public:
+
+	// Collapse edges until at most targetRatio of the triangles are left, or no collapse is left under maxError
+	// maxError is in mesh units, and bounds the distance from a moved vertex to the plane of every triangle it has absorbed
+	// (the square root of the summed squared distances); unused vertices are removed and the rest keep their order
+	// Returns the largest error of the collapses made
+	float Simplify(std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices, float targetRatio, float maxError);
+
+private:
+
+	// Sum of the squared distances to a set of planes, kept as the upper triangle of a symmetric 4x4 matrix
+	struct Quadric
+	{
+
+		double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+
+	};
+
+	struct Collapse
+	{
+
+		float cost;
+		unsigned int from;
+		unsigned int to;
+
+	};
+
+	static void AddPlane(Quadric& quadric, double a, double b, double c, double d);
+	static void AddQuadric(Quadric& quadric, const Quadric& other);
+	static double Error(const Quadric& quadric, const float* position);
+	// Unnormalised normal of the triangle with the three given corner positions
+	static void TriangleNormal(const float* const* corners, float* normal);
+
+	// Lock the vertices of every edge not shared by exactly two triangles
+	void LockBorders(const std::vector<unsigned int>& indices, size_t vertexCount);
+	// Label each vertex with the connected piece of surface it belongs to, and count the triangles of each piece
+	void FindComponents(const std::vector<unsigned int>& indices, size_t vertexCount);
+	// Representative vertex of the piece containing vertex, shortening the path to it as it goes
+	unsigned int FindComponent(unsigned int vertex);
+	// Vertex to triangle adjacency of the current triangles
+	void BuildAdjacency(const std::vector<unsigned int>& indices, size_t vertexCount);
+	// True if moving from onto to would turn any remaining triangle around from over
+	bool IsFlipping(const std::vector<MeshVertex>& vertices, const std::vector<unsigned int>& indices, unsigned int from, unsigned int to) const;
+
+	// Scratch lists, kept for the next call
+	std::vector<Quadric> quadrics;
+	std::vector<bool> isLocked;
+	std::vector<bool> isTouched;
+	std::vector<unsigned int> components;
+	std::vector<size_t> componentTriangles;
+	std::vector<unsigned int> remap;
+	std::vector<unsigned long long> edges;
+	std::vector<unsigned int> adjacencyOffsets;
+	std::vector<unsigned int> adjacency;
+	std::vector<unsigned int> cursors;
+	std::vector<Collapse> collapses;
+
+};
+
+#endif // !_MESH_SIMPLIFIER_H_
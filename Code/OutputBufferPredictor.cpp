@@ -0,0 +1,163 @@
+#include "OutputBufferPredictor.h"
+#include <algorithm>
+
+const float OutputBufferPredictor::headroom = 1.25f;
+const float OutputBufferPredictor::underuseThreshold = 0.5f;
+const int OutputBufferPredictor::shrinkAfter = 8;
+const double OutputBufferPredictor::shrinkRate = 0.5;
+const int OutputBufferPredictor::windowSize;
+
+OutputBufferPredictor::OutputBufferPredictor()
+{
+
+	trianglesPerVoxel = 0.0;
+	voxelCount = 0;
+	lastCapacity = 0;
+	underusedRuns = 0;
+	overflowCount = 0;
+	recentCount = 0;
+	recentNext = 0;
+
+	for (int i = 0; i < windowSize; i++)
+	{
+
+		recentMeasurements[i] = 0.0;
+
+	}
+
+}
+
+unsigned int OutputBufferPredictor::HeuristicCapacity(int x, int y, int z) const
+{
+
+	// As the resolution increases, the number of empty cells also increases, so allocate proportionally less space for larger volumes
+	// A surface crossing the volume grows with its largest cross-section rather than with its volume, so for a volume that
+	// isn't a cube, divide by the size of the dimension left out of that cross-section
+	unsigned long long voxels = (unsigned long long)x * y * z;
+	int depth = std::min(x, std::min(y, z));
+	int divisorHeuristic = 1;
+
+	if (std::max(x, std::max(y, z)) >= 64)
+	{
+
+		divisorHeuristic = std::max(depth / 32, 1);
+
+	}
+
+	// One vertex per voxel, three vertices to a triangle
+	return (unsigned int)((voxels / divisorHeuristic) / 3);
+
+}
+
+unsigned int OutputBufferPredictor::PredictCapacity(int x, int y, int z)
+{
+
+	voxelCount = (unsigned long long)x * y * z;
+
+	if (trianglesPerVoxel <= 0.0)
+	{
+
+		lastCapacity = HeuristicCapacity(x, y, z);
+
+	}
+	else
+	{
+
+		lastCapacity = (unsigned int)(trianglesPerVoxel * voxelCount * headroom) + 1;
+
+	}
+
+	return lastCapacity;
+
+}
+
+bool OutputBufferPredictor::Record(unsigned long long primitivesNeeded, unsigned int capacity)
+{
+
+	double measured = voxelCount > 0 ? (double)primitivesNeeded / voxelCount : 0.0;
+
+	recentMeasurements[recentNext] = measured;
+	recentNext = (recentNext + 1) % windowSize;
+	recentCount = std::min(recentCount + 1, windowSize);
+
+	if (primitivesNeeded > capacity)
+	{
+
+		// Triangles were dropped: learn the exact requirement and have the caller rerun with a bigger buffer
+		if (measured > trianglesPerVoxel)
+		{
+
+			trianglesPerVoxel = measured;
+
+		}
+
+		underusedRuns = 0;
+		overflowCount++;
+
+		return true;
+
+	}
+
+	if (primitivesNeeded < capacity * underuseThreshold)
+	{
+
+		// Only shrink after a run of underused buffers, and then only part of the way towards the densest recent volume,
+		// so that one sparse volume doesn't leave the buffer too small for the dense one after it
+		underusedRuns++;
+
+		if (trianglesPerVoxel <= 0.0)
+		{
+
+			trianglesPerVoxel = measured;
+			underusedRuns = 0;
+
+		}
+		else if (underusedRuns >= shrinkAfter)
+		{
+
+			double recentMaximum = 0.0;
+
+			for (int i = 0; i < recentCount; i++)
+			{
+
+				recentMaximum = std::max(recentMaximum, recentMeasurements[i]);
+
+			}
+
+			trianglesPerVoxel += (recentMaximum - trianglesPerVoxel) * shrinkRate;
+			underusedRuns = 0;
+
+		}
+
+	}
+	else
+	{
+
+		underusedRuns = 0;
+
+		if (trianglesPerVoxel <= 0.0)
+		{
+
+			trianglesPerVoxel = measured;
+
+		}
+
+	}
+
+	return false;
+
+}
+
+unsigned int OutputBufferPredictor::getLastCapacity() const
+{
+
+	return lastCapacity;
+
+}
+
+int OutputBufferPredictor::getOverflowCount() const
+{
+
+	return overflowCount;
+
+}
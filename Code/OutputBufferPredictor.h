@@ -0,0 +1,58 @@
+// Output buffer predictor
+// Decides how large the marching cubes stream output buffer should be
+// Starts from the original voxel count heuristic, then learns the number of triangles per voxel from the exact
+// primitive counts reported by SO_STATISTICS: it regrows (and asks for a rerun) on overflow, and once buffers have
+// stayed underused for a while it decays towards the largest of the recent measurements
+// Contains no DirectX code, so the sizing policy can be exercised without a GPU
+#ifndef _OUTPUT_BUFFER_PREDICTOR_H_
+#define _OUTPUT_BUFFER_PREDICTOR_H_
+
+class OutputBufferPredictor
+{
+
+public:
+
+	OutputBufferPredictor();
+
+	// Number of triangles the buffer should hold for a volume of the given dimensions
+	unsigned int PredictCapacity(int x, int y, int z);
+
+	// Feed back the result of an extraction into a buffer of the given capacity
+	// Returns true if the buffer overflowed, in which case the next prediction covers primitivesNeeded and the extraction should be rerun
+	bool Record(unsigned long long primitivesNeeded, unsigned int capacity);
+
+	unsigned int getLastCapacity() const;
+	int getOverflowCount() const;
+
+	// Spare space allocated on top of the measured requirement
+	static const float headroom;
+	// A buffer is underused when less than this fraction of it is filled
+	static const float underuseThreshold;
+	// Number of consecutive underused extractions before the buffer shrinks
+	static const int shrinkAfter;
+	// Fraction of the way each shrink moves towards the largest recent measurement
+	static const double shrinkRate;
+	// Number of recent measurements whose largest the buffer shrinks towards
+	static const int windowSize = 8;
+
+private:
+
+	// The original heuristic from MCShader::reInitOutputBuffer, in triangles
+	unsigned int HeuristicCapacity(int x, int y, int z) const;
+
+	// Learned triangles per voxel, or 0 before the first measurement
+	double trianglesPerVoxel;
+	unsigned long long voxelCount;
+
+	unsigned int lastCapacity;
+	int underusedRuns;
+	int overflowCount;
+
+	// Ring of the most recent triangles per voxel measurements
+	double recentMeasurements[windowSize];
+	int recentCount;
+	int recentNext;
+
+};
+
+#endif // !_OUTPUT_BUFFER_PREDICTOR_H_
@@ -0,0 +1,8 @@
+// Permutation table
+// Shared by the noise compute shader's permutation texture and the CPU noise implementation
+#ifndef _PERMUTATION_TABLE_H_
+#define _PERMUTATION_TABLE_H_
+
+extern const int permutationTable[512];
+
+#endif // !_PERMUTATION_TABLE_H_
@@ -0,0 +1,175 @@
+#include "SignVolume.h"
+
+SignVolume::SignVolume()
+{
+
+	isoValue = 0.0f;
+	wordsPerRow = 0;
+
+	dimsX = 0;
+	dimsY = 0;
+	dimsZ = 0;
+
+}
+
+void SignVolume::Allocate(int x, int y, int z)
+{
+
+	dimsX = x;
+	dimsY = y;
+	dimsZ = z;
+	wordsPerRow = (x + 63) / 64;
+
+	words.resize((size_t)wordsPerRow * y * z);
+
+}
+
+void SignVolume::Release()
+{
+
+	dimsX = 0;
+	dimsY = 0;
+	dimsZ = 0;
+	wordsPerRow = 0;
+
+	std::vector<uint64_t>().swap(words);
+
+}
+
+void SignVolume::setIsoValue(float liso)
+{
+
+	isoValue = liso;
+
+}
+
+float SignVolume::getIsoValue() const
+{
+
+	return isoValue;
+
+}
+
+void SignVolume::PackRow(const float* densities, int y, int z)
+{
+
+	uint64_t* row = &words[((size_t)z * dimsY + y) * wordsPerRow];
+
+	for (int w = 0; w < wordsPerRow; w++)
+	{
+
+		int count = dimsX - w * 64 < 64 ? dimsX - w * 64 : 64;
+		uint64_t word = 0;
+
+		// Bits past the end of the row stay clear
+		for (int b = 0; b < count; b++)
+		{
+
+			word |= (uint64_t)(densities[w * 64 + b] < isoValue) << b;
+
+		}
+
+		row[w] = word;
+
+	}
+
+}
+
+void SignVolume::PackRow(const float* densities, int y, int z, SignVolume* volumes, int count)
+{
+
+	// Volumes are taken eight at a time, so a group's thresholds and words can stay in registers
+	for (int first = 0; first < count; first += 8)
+	{
+
+		int groupCount = count - first < 8 ? count - first : 8;
+		float thresholds[8];
+
+		for (int k = 0; k < groupCount; k++)
+		{
+
+			thresholds[k] = volumes[first + k].isoValue;
+
+		}
+
+		const SignVolume& shape = volumes[first];
+		size_t rowIndex = ((size_t)z * shape.dimsY + y) * shape.wordsPerRow;
+
+		for (int w = 0; w < shape.wordsPerRow; w++)
+		{
+
+			int bitCount = shape.dimsX - w * 64 < 64 ? shape.dimsX - w * 64 : 64;
+			uint64_t groupWords[8] = {};
+
+			// Bits past the end of the row stay clear
+			for (int b = 0; b < bitCount; b++)
+			{
+
+				float density = densities[w * 64 + b];
+
+				for (int k = 0; k < groupCount; k++)
+				{
+
+					groupWords[k] |= (uint64_t)(density < thresholds[k]) << b;
+
+				}
+
+			}
+
+			for (int k = 0; k < groupCount; k++)
+			{
+
+				volumes[first + k].words[rowIndex + w] = groupWords[k];
+
+			}
+
+		}
+
+	}
+
+}
+
+void SignVolume::Build(const DensityVolume& volume, int zBegin, int zEnd)
+{
+
+	for (int z = zBegin; z < zEnd; z++)
+	{
+
+		for (int y = 0; y < dimsY; y++)
+		{
+
+			PackRow(volume.getData() + volume.index(0, y, z), y, z);
+
+		}
+
+	}
+
+}
+
+int SignVolume::getWordsPerRow() const
+{
+
+	return wordsPerRow;
+
+}
+
+int SignVolume::getDimsX() const
+{
+
+	return dimsX;
+
+}
+
+int SignVolume::getDimsY() const
+{
+
+	return dimsY;
+
+}
+
+int SignVolume::getDimsZ() const
+{
+
+	return dimsZ;
+
+}
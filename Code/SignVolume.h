@@ -0,0 +1,84 @@
+// Sign volume
+// One bit per voxel recording whether its density is below the isovalue, which is all marching cubes needs to classify a cell
+// Bits are packed into 64-bit words along X, so one word of each of the four rows around a row of cells gives the cube
+// configuration of 64 cells with shifts and bitwise operations, at 1/32 of the bandwidth of reading the float corners
+#ifndef _SIGN_VOLUME_H_
+#define _SIGN_VOLUME_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "DensityVolume.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+class SignVolume
+{
+
+public:
+
+	SignVolume();
+
+	// Resize the volume; the bits are undefined until rows have been packed
+	void Allocate(int x, int y, int z);
+	void Release();
+
+	// Changing the isovalue leaves the bits stale until they are packed again
+	void setIsoValue(float isoValue);
+	float getIsoValue() const;
+
+	// Pack the signs of one row of densities, e.g. straight from the noise stage while the row is still in cache
+	void PackRow(const float* densities, int y, int z);
+	// Pack the same row of several sign volumes of the same size, each at its own isovalue, loading each density once
+	// for every eight volumes rather than once per volume
+	static void PackRow(const float* densities, int y, int z, SignVolume* volumes, int count);
+	// Pack the Z slices [zBegin, zEnd) from a volume, for when the isovalue changed but the densities didn't
+	void Build(const DensityVolume& volume, int zBegin, int zEnd);
+
+	inline const uint64_t* getRow(int y, int z) const
+	{
+		return &words[((size_t)z * dimsY + y) * wordsPerRow];
+	}
+
+	int getWordsPerRow() const;
+	int getDimsX() const;
+	int getDimsY() const;
+	int getDimsZ() const;
+
+	static inline int PopCount(uint64_t value)
+	{
+#ifdef _MSC_VER
+		return (int)__popcnt64(value);
+#else
+		return __builtin_popcountll(value);
+#endif
+	}
+
+	// Index of the lowest set bit; value must not be zero
+	static inline int CountTrailingZeros(uint64_t value)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return (int)index;
+#else
+		return __builtin_ctzll(value);
+#endif
+	}
+
+private:
+
+	std::vector<uint64_t> words;
+
+	float isoValue;
+	int wordsPerRow;
+
+	int dimsX;
+	int dimsY;
+	int dimsZ;
+
+};
+
+#endif // !_SIGN_VOLUME_H_
@@ -0,0 +1,343 @@
+#include "StreamingPipeline.h"
+#include <cstring>
+
+StreamingPipeline::StreamingPipeline(JobScheduler* lscheduler)
+{
+
+	scheduler = lscheduler;
+	meshScaleFactor = 1.0f;
+
+	dimsX = 0;
+	dimsY = 0;
+	dimsZ = 0;
+	slabDepth = 8;
+
+	memoryBudget = 0;
+	flushVertices = 0;
+	fileBufferBytes = 1 << 20;
+
+}
+
+void StreamingPipeline::UpdateMeshValues(int x, int y, int z)
+{
+
+	dimsX = x;
+	dimsY = y;
+	dimsZ = z;
+
+}
+
+void StreamingPipeline::UpdateNoiseValues(const NoiseParameters& parameters)
+{
+
+	noise.UpdateNoiseValues(parameters);
+
+}
+
+void StreamingPipeline::UpdateExtractionValues(float isoValue, float lmeshScaleFactor)
+{
+
+	meshScaleFactor = lmeshScaleFactor;
+	marchingCubes.UpdateValues(isoValue, meshScaleFactor);
+
+}
+
+void StreamingPipeline::setSlabDepth(int depth)
+{
+
+	slabDepth = depth > 0 ? depth : 1;
+
+}
+
+bool StreamingPipeline::Run(const std::function<void(const std::vector<MeshVertex>&)>& onSlab, const std::function<bool()>& isCancelled)
+{
+
+	return RunSlabs(nullptr, onSlab, isCancelled);
+
+}
+
+bool StreamingPipeline::Run(MeshFileWriter& writer, const std::function<bool()>& isCancelled)
+{
+
+	return RunSlabs(&writer, nullptr, isCancelled);
+
+}
+
+bool StreamingPipeline::setMemoryBudget(size_t bytes)
+{
+
+	memoryBudget = bytes;
+
+	if (memoryBudget == 0)
+	{
+
+		return true;
+
+	}
+
+	// Worst case output of one row of cells, which an extraction buffer has to have room for on top of what it has gathered
+	size_t rowVertices = (size_t)CPUMarchingCubes::getCellCount(dimsX) * 15;
+	flushVertices = rowVertices;
+
+	// Each worker runs one extraction job at a time, holding its buffer and the signs of the two slices it classifies
+	size_t signBytes = (size_t)((dimsX + 63) / 64) * 8 * 4;
+	size_t jobBytes = (size_t)scheduler->getThreadCount() * ((flushVertices + rowVertices) * sizeof(MeshVertex) + signBytes);
+
+	fileBufferBytes = memoryBudget / 16;
+	fileBufferBytes = fileBufferBytes < (64 << 10) ? (64 << 10) : fileBufferBytes > (16 << 20) ? (16 << 20) : fileBufferBytes;
+
+	size_t sliceBytes = (size_t)dimsX * dimsY * sizeof(float);
+
+	if (jobBytes + fileBufferBytes + sliceBytes * 4 > memoryBudget)
+	{
+
+		return false;
+
+	}
+
+	// Whatever is left goes to the window, which needs three slices on top of the slab's
+	int slices = (int)((memoryBudget - jobBytes - fileBufferBytes) / sliceBytes);
+	int cellsZ = CPUMarchingCubes::getCellCount(dimsZ);
+
+	slabDepth = slices - 3 < cellsZ ? slices - 3 : cellsZ;
+	slabDepth = slabDepth > 0 ? slabDepth : 1;
+
+	return true;
+
+}
+
+size_t StreamingPipeline::getFileBufferBytes() const
+{
+
+	return fileBufferBytes;
+
+}
+
+size_t StreamingPipeline::getPlannedBytes() const
+{
+
+	size_t rowVertices = (size_t)CPUMarchingCubes::getCellCount(dimsX) * 15;
+	size_t signBytes = (size_t)((dimsX + 63) / 64) * 8 * 4;
+	size_t jobBytes = (size_t)scheduler->getThreadCount() * ((flushVertices + rowVertices) * sizeof(MeshVertex) + signBytes);
+
+	return getWindowBytes() + jobBytes + fileBufferBytes;
+
+}
+
+bool StreamingPipeline::RunSlabs(MeshFileWriter* writer, const std::function<void(const std::vector<MeshVertex>&)>& onSlab, const std::function<bool()>& isCancelled)
+{
+
+	int cellsZ = CPUMarchingCubes::getCellCount(dimsZ);
+	int previousBegin = 0;
+	int previousEnd = 0;
+
+	// Reserve the largest window up front, so the carried over slices never move during a resize
+	window.Allocate(dimsX, dimsY, slabDepth + 3 < dimsZ ? slabDepth + 3 : dimsZ);
+
+	for (int zBegin = 0; zBegin < cellsZ; zBegin += slabDepth)
+	{
+
+		if (isCancelled && isCancelled())
+		{
+
+			return false;
+
+		}
+
+		int zEnd = zBegin + slabDepth < cellsZ ? zBegin + slabDepth : cellsZ;
+		int sliceBegin, sliceEnd;
+		CPUMarchingCubes::getSliceRange(zBegin, zEnd, dimsZ, sliceBegin, sliceEnd);
+
+		RunSlab(zBegin, zEnd, sliceBegin, sliceEnd, previousBegin, previousEnd, writer);
+
+		if (onSlab)
+		{
+
+			onSlab(slabVertices);
+
+		}
+
+		previousBegin = sliceBegin;
+		previousEnd = sliceEnd;
+
+	}
+
+	return true;
+
+}
+
+void StreamingPipeline::RunSlab(int zBegin, int zEnd, int sliceBegin, int sliceEnd, int previousBegin, int previousEnd, MeshFileWriter* writer)
+{
+
+	size_t sliceSize = (size_t)dimsX * dimsY;
+	int keptBegin = sliceBegin > previousBegin ? sliceBegin : previousBegin;
+	int keptEnd = sliceEnd < previousEnd ? sliceEnd : previousEnd;
+
+	// Slide the slices shared with the previous window down to their new place before resizing it
+	if (keptBegin < keptEnd)
+	{
+
+		memmove(window.getData() + (keptBegin - sliceBegin) * sliceSize, window.getData() + (keptBegin - previousBegin) * sliceSize,
+			(keptEnd - keptBegin) * sliceSize * sizeof(float));
+
+	}
+
+	window.Allocate(dimsX, dimsY, sliceEnd - sliceBegin);
+	graph.Clear();
+
+	// Noise jobs for the slices that are new to this window
+	std::vector<int> noiseJobs(sliceEnd - sliceBegin, -1);
+
+	for (int z = sliceBegin; z < sliceEnd; z++)
+	{
+
+		if (z >= keptBegin && z < keptEnd)
+		{
+
+			continue;
+
+		}
+
+		noiseJobs[z - sliceBegin] = graph.AddJob([this, z, sliceBegin]
+		{
+
+			noise.RunSlice(window, z - sliceBegin, z, dimsY);
+
+		});
+
+	}
+
+	// Extraction jobs for each cell slice, waiting only on the new slices they read
+	int cellsX = CPUMarchingCubes::getCellCount(dimsX);
+	int cellsY = CPUMarchingCubes::getCellCount(dimsY);
+
+	sliceVertices.resize(writer ? 0 : zEnd - zBegin);
+
+	for (int z = zBegin; z < zEnd; z++)
+	{
+
+		int extractionJob = graph.AddJob([this, z, zBegin, sliceBegin, cellsX, cellsY, writer]
+		{
+
+			if (writer)
+			{
+
+				ExtractToWriter(z, sliceBegin, writer);
+				return;
+
+			}
+
+			std::vector<MeshVertex>& output = sliceVertices[z - zBegin];
+			output.clear();
+			marchingCubes.Run(window, 0, cellsX, 0, cellsY, z - sliceBegin, z - sliceBegin + 1, output);
+
+			// Move the vertices from the window's space into the volume's
+			float offsetZ = sliceBegin * meshScaleFactor;
+
+			for (size_t i = 0; i < output.size(); i++)
+			{
+
+				output[i].position[2] += offsetZ;
+
+			}
+
+		});
+
+		int sliceBeginRead, sliceEndRead;
+		CPUMarchingCubes::getSliceRange(z, z + 1, dimsZ, sliceBeginRead, sliceEndRead);
+
+		for (int s = sliceBeginRead; s < sliceEndRead; s++)
+		{
+
+			if (noiseJobs[s - sliceBegin] >= 0)
+			{
+
+				graph.AddDependency(extractionJob, noiseJobs[s - sliceBegin]);
+
+			}
+
+		}
+
+	}
+
+	scheduler->Run(graph);
+
+	slabVertices.clear();
+
+	for (size_t i = 0; i < sliceVertices.size(); i++)
+	{
+
+		slabVertices.insert(slabVertices.end(), sliceVertices[i].begin(), sliceVertices[i].end());
+
+	}
+
+}
+
+void StreamingPipeline::ExtractToWriter(int z, int sliceBegin, MeshFileWriter* writer)
+{
+
+	int cellsX = CPUMarchingCubes::getCellCount(dimsX);
+	int cellsY = CPUMarchingCubes::getCellCount(dimsY);
+	size_t rowVertices = (size_t)cellsX * 15;
+	size_t threshold = flushVertices > 0 ? flushVertices : rowVertices;
+	float offsetZ = sliceBegin * meshScaleFactor;
+
+	// Sized so that the rows added after the last write can never make it grow
+	std::vector<MeshVertex> output;
+	output.reserve(threshold + rowVertices);
+
+	auto writeOutput = [&output, offsetZ, writer]
+	{
+
+		for (size_t i = 0; i < output.size(); i++)
+		{
+
+			output[i].position[2] += offsetZ;
+
+		}
+
+		writer->Write(output.data(), output.size());
+		output.clear();
+
+	};
+
+	for (int y = 0; y < cellsY; y++)
+	{
+
+		marchingCubes.Run(window, 0, cellsX, y, y + 1, z - sliceBegin, z - sliceBegin + 1, output);
+
+		if (output.size() >= threshold)
+		{
+
+			writeOutput();
+
+		}
+
+	}
+
+	if (!output.empty())
+	{
+
+		writeOutput();
+
+	}
+
+}
+
+size_t StreamingPipeline::getWindowBytes() const
+{
+
+	size_t slices = slabDepth + 3 < dimsZ ? slabDepth + 3 : dimsZ;
+
+	return (size_t)dimsX * dimsY * slices * sizeof(float);
+
+}
+
+void StreamingPipeline::releaseWindow()
+{
+
+	window.Release();
+	std::vector<std::vector<MeshVertex>>().swap(sliceVertices);
+	std::vector<MeshVertex>().swap(slabVertices);
+
+}
@@ -0,0 +1,93 @@
+// Streaming pipeline
+// Generates and extracts the volume a slab of Z slices at a time without ever holding all of it
+// Only a window of the slices read by the current slab's cells is kept: the slab's cells plus one slice either side for the
+// central difference normals, with the last three slices carried over to the next slab, so memory is O(x * y) rather than
+// O(x * y * z). Each finished slab's vertices are handed to a callback in Z order, e.g. to upload or write them out
+// For volumes larger than memory, the vertices can instead be streamed straight to a MeshFileWriter under a fixed memory budget
+#ifndef _STREAMING_PIPELINE_H_
+#define _STREAMING_PIPELINE_H_
+
+#include <functional>
+#include <vector>
+#include "CPUNoise.h"
+#include "CPUMarchingCubes.h"
+#include "DensityVolume.h"
+#include "MeshFileWriter.h"
+#include "JobScheduler.h"
+
+class StreamingPipeline
+{
+
+public:
+
+	StreamingPipeline(JobScheduler* scheduler);
+
+	// Update the mesh values when the mesh size is changed
+	void UpdateMeshValues(int x, int y, int z);
+	// Update the noise values when they're changed by user input
+	void UpdateNoiseValues(const NoiseParameters& parameters);
+	// Update the values used for calculating the isosurface
+	void UpdateExtractionValues(float isoValue, float meshScaleFactor);
+	// Number of cell slices extracted per slab; the window holds this many plus three voxel slices
+	void setSlabDepth(int depth);
+
+	// Generate and extract the whole volume, calling onSlab with each slab's vertices in Z order
+	// The vertices are only valid for the duration of the call
+	// Returns false if isCancelled returned true, in which case the remaining slabs are skipped
+	bool Run(const std::function<void(const std::vector<MeshVertex>&)>& onSlab, const std::function<bool()>& isCancelled = nullptr);
+
+	// Generate and extract the whole volume, writing the vertices to a file as they are produced
+	// Each extraction job collects its cells' vertices in a bounded buffer and writes it out whenever it fills, so the
+	// triangles in the file are grouped by job and only in Z order when running on a single thread
+	bool Run(MeshFileWriter& writer, const std::function<bool()>& isCancelled = nullptr);
+
+	// Plan the slab depth and buffer sizes so that the window, the extraction buffers and the file buffer fit in bytes
+	// Call after UpdateMeshValues; 0 removes the budget. Returns false if even a single slice slab doesn't fit
+	bool setMemoryBudget(size_t bytes);
+	// Write buffer size for the MeshFileWriter, planned by setMemoryBudget
+	size_t getFileBufferBytes() const;
+	// Memory planned for the window and buffers, within the budget when one is set
+	size_t getPlannedBytes() const;
+
+	// Size of the slice window at the current dimensions and slab depth
+	size_t getWindowBytes() const;
+	// Free the window's memory between runs
+	void releaseWindow();
+
+private:
+
+	// Generate the voxel slices [sliceBegin, sliceEnd) into the window, keeping those shared with the previous window
+	// and extract the cells [zBegin, zEnd) into slabVertices, or into writer if one is given
+	void RunSlab(int zBegin, int zEnd, int sliceBegin, int sliceEnd, int previousBegin, int previousEnd, MeshFileWriter* writer);
+	// Extract one slice of cells from the window into the writer, a row at a time through a bounded buffer
+	void ExtractToWriter(int z, int sliceBegin, MeshFileWriter* writer);
+	// Walk the slabs, generating and extracting each in turn
+	bool RunSlabs(MeshFileWriter* writer, const std::function<void(const std::vector<MeshVertex>&)>& onSlab, const std::function<bool()>& isCancelled);
+
+	JobScheduler* scheduler;
+	JobGraph graph;
+
+	CPUNoise noise;
+	CPUMarchingCubes marchingCubes;
+	DensityVolume window;
+
+	// One output list per cell slice of the slab, concatenated in order once the slab is done
+	std::vector<std::vector<MeshVertex>> sliceVertices;
+	std::vector<MeshVertex> slabVertices;
+
+	float meshScaleFactor;
+
+	// Memory budget in bytes, or 0 for none
+	size_t memoryBudget;
+	// Vertices gathered by an extraction job before it writes them out; its buffer holds one more row of cells on top
+	size_t flushVertices;
+	size_t fileBufferBytes;
+
+	int dimsX;
+	int dimsY;
+	int dimsZ;
+	int slabDepth;
+
+};
+
+#endif // !_STREAMING_PIPELINE_H_
@@ -0,0 +1,76 @@
+// Terrain types
+// Plain data types shared by the CPU generation pipeline
+// Nothing in here depends on DirectX, so these can be used by the headless generator on any platform
+#ifndef _TERRAIN_TYPES_H_
+#define _TERRAIN_TYPES_H_
+
+// Holds the fBm noise values, mirroring GradientNoise's constant buffer
+struct NoiseParameters
+{
+
+	float amplitude;
+	float frequency;
+	float persistence;
+	int octaves;
+	float meshScaleFactor;
+	float noiseOffsets[3];
+	float noiseScaleFactors[3];
+	bool isRidged;
+	bool isSimplex;
+	float heightBase;
+	float heightMultiplier;
+	// Hash each lattice point's gradient from its coordinates and the seed instead of looking it up in the permutation table
+	// The seed has no effect on the table-driven noise
+	bool isHashed;
+	unsigned int seed;
+
+};
+
+// A single output vertex, laid out the same as the marching cubes stream output declaration
+// (float4 position followed by float3 normal, 28 bytes); position's w holds the vertex's packed MaterialWeights
+struct MeshVertex
+{
+
+	float position[4];
+	float normal[3];
+
+};
+
+// Compact vertex for meshes whose positions stay inside a known box, such as a chunk (12 bytes)
+// position holds x, y and z as 16-bit unorm fractions of the box, read as R16G16B16A16_UNORM, with the material weights in w;
+// normal is the octahedral encoding of the unit normal as 16-bit snorm, read as R16G16_SNORM, see VertexPacker
+struct PackedVertex
+{
+
+	unsigned short position[4];
+	short normal[2];
+
+};
+
+// How the isosurface is turned into triangles
+// Marching cubes emits up to five triangles per cell from its case tables; surface nets and dual contouring emit one
+// vertex per cell and one quad per edge the surface crosses, see CPUSurfaceNets
+enum ExtractionMethod
+{
+
+	EXTRACTION_MARCHING_CUBES,
+	EXTRACTION_SURFACE_NETS,
+	EXTRACTION_DUAL_CONTOURING
+
+};
+
+// Everything needed to generate one mesh: volume size, noise values, isosurface values and the extraction method
+struct GenerationParameters
+{
+
+	int dimsX;
+	int dimsY;
+	int dimsZ;
+	NoiseParameters noise;
+	float isoValue;
+	float meshScaleFactor;
+	ExtractionMethod extractionMethod;
+
+};
+
+#endif // !_TERRAIN_TYPES_H_
@@ -0,0 +1,348 @@
+#include "ToroidalVolume.h"
+#include <cstdlib>
+
+ToroidalVolume::ToroidalVolume()
+{
+
+	isValid = false;
+	originX = 0;
+	originZ = 0;
+	meshScaleFactor = 1.0f;
+	chunkSize = 8;
+
+	dimsX = 0;
+	dimsY = 0;
+	dimsZ = 0;
+
+	voxelsGenerated = 0;
+	chunksExtracted = 0;
+	chunksKept = 0;
+
+}
+
+void ToroidalVolume::Allocate(int x, int y, int z)
+{
+
+	dimsX = x;
+	dimsY = y;
+	dimsZ = z;
+
+	data.resize((size_t)x * y * z);
+	isValid = false;
+
+}
+
+void ToroidalVolume::UpdateNoiseValues(const NoiseParameters& parameters)
+{
+
+	noise.UpdateNoiseValues(parameters);
+	isValid = false;
+
+}
+
+void ToroidalVolume::UpdateExtractionValues(float isoValue, float lmeshScaleFactor)
+{
+
+	meshScaleFactor = lmeshScaleFactor;
+	marchingCubes.UpdateValues(isoValue, meshScaleFactor);
+	isValid = false;
+
+}
+
+void ToroidalVolume::setChunkSize(int size)
+{
+
+	chunkSize = size > 0 ? size : 1;
+	isValid = false;
+
+}
+
+void ToroidalVolume::Update(int lx, int lz)
+{
+
+	Region window = { lx, lx + dimsX, lz, lz + dimsZ };
+	Region previousWindow = { originX, originX + dimsX, originZ, originZ + dimsZ };
+	int shiftX = lx - originX;
+	int shiftZ = lz - originZ;
+
+	generatedRegions.clear();
+	voxelsGenerated = 0;
+	chunksExtracted = 0;
+	chunksKept = 0;
+
+	// Work out which voxels are newly exposed
+	// A shift of the whole window or more in either direction leaves nothing to reuse
+	if (!isValid || abs(shiftX) >= dimsX || abs(shiftZ) >= dimsZ)
+	{
+
+		generatedRegions.push_back(window);
+		chunks.clear();
+
+	}
+	else
+	{
+
+		// The slab exposed along X covers the full depth of the new window
+		if (shiftX > 0)
+		{
+
+			generatedRegions.push_back({ previousWindow.x1, window.x1, window.z0, window.z1 });
+
+		}
+		else if (shiftX < 0)
+		{
+
+			generatedRegions.push_back({ window.x0, previousWindow.x0, window.z0, window.z1 });
+
+		}
+
+		// The slab exposed along Z only covers the X range shared with the old window, as the rest was generated above
+		int sharedX0 = window.x0 > previousWindow.x0 ? window.x0 : previousWindow.x0;
+		int sharedX1 = window.x1 < previousWindow.x1 ? window.x1 : previousWindow.x1;
+
+		if (shiftZ > 0)
+		{
+
+			generatedRegions.push_back({ sharedX0, sharedX1, previousWindow.z1, window.z1 });
+
+		}
+		else if (shiftZ < 0)
+		{
+
+			generatedRegions.push_back({ sharedX0, sharedX1, window.z0, previousWindow.z0 });
+
+		}
+
+	}
+
+	// New voxels overwrite the ring slots of the ones that scrolled out of the window
+	for (size_t i = 0; i < generatedRegions.size(); i++)
+	{
+
+		GenerateRegion(generatedRegions[i]);
+
+	}
+
+	originX = lx;
+	originZ = lz;
+	isValid = true;
+
+	// Walk the chunks covering the window's cells, keeping any whose cells and stencil are unchanged
+	Region cellWindow = { window.x0, window.x1 - 1, window.z0, window.z1 - 1 };
+	std::map<std::pair<int, int>, Chunk> updatedChunks;
+
+	for (int cz = FloorDivide(cellWindow.z0, chunkSize); cz <= FloorDivide(cellWindow.z1 - 1, chunkSize); cz++)
+	{
+
+		for (int cx = FloorDivide(cellWindow.x0, chunkSize); cx <= FloorDivide(cellWindow.x1 - 1, chunkSize); cx++)
+		{
+
+			Chunk chunk;
+			chunk.cells.x0 = cx * chunkSize > cellWindow.x0 ? cx * chunkSize : cellWindow.x0;
+			chunk.cells.x1 = (cx + 1) * chunkSize < cellWindow.x1 ? (cx + 1) * chunkSize : cellWindow.x1;
+			chunk.cells.z0 = cz * chunkSize > cellWindow.z0 ? cz * chunkSize : cellWindow.z0;
+			chunk.cells.z1 = (cz + 1) * chunkSize < cellWindow.z1 ? (cz + 1) * chunkSize : cellWindow.z1;
+
+			// Cells read their far corners, and the central difference normals reach one voxel further either way
+			// The stencil is clipped where the window edge clamps the normals, so a chunk that moves onto or off an edge changes its stencil
+			chunk.stencil.x0 = chunk.cells.x0 - 1 > window.x0 ? chunk.cells.x0 - 1 : window.x0;
+			chunk.stencil.x1 = chunk.cells.x1 + 2 < window.x1 ? chunk.cells.x1 + 2 : window.x1;
+			chunk.stencil.z0 = chunk.cells.z0 - 1 > window.z0 ? chunk.cells.z0 - 1 : window.z0;
+			chunk.stencil.z1 = chunk.cells.z1 + 2 < window.z1 ? chunk.cells.z1 + 2 : window.z1;
+
+			std::pair<int, int> key(cz, cx);
+			std::map<std::pair<int, int>, Chunk>::iterator previous = chunks.find(key);
+			bool isReusable = previous != chunks.end() && Equals(previous->second.cells, chunk.cells) && Equals(previous->second.stencil, chunk.stencil);
+
+			for (size_t i = 0; isReusable && i < generatedRegions.size(); i++)
+			{
+
+				isReusable = !Intersects(chunk.stencil, generatedRegions[i]);
+
+			}
+
+			if (isReusable)
+			{
+
+				chunk.vertices.swap(previous->second.vertices);
+				chunksKept++;
+
+			}
+			else
+			{
+
+				ExtractChunk(chunk);
+				chunksExtracted++;
+
+			}
+
+			updatedChunks[key] = std::move(chunk);
+
+		}
+
+	}
+
+	// Chunks that scrolled out of the window are dropped here
+	chunks.swap(updatedChunks);
+
+}
+
+float ToroidalVolume::get(int worldX, int y, int worldZ) const
+{
+
+	return data[index(worldX, y, worldZ)];
+
+}
+
+void ToroidalVolume::GenerateRegion(const Region& region)
+{
+
+	for (int z = region.z0; z < region.z1; z++)
+	{
+
+		for (int y = 0; y < dimsY; y++)
+		{
+
+			for (int x = region.x0; x < region.x1; x++)
+			{
+
+				// Noise is evaluated at world coordinates, so a voxel has the same value wherever it sits in the ring
+				data[index(x, y, z)] = noise.Density(x, y, z, dimsY);
+
+			}
+
+		}
+
+	}
+
+	voxelsGenerated += (size_t)(region.x1 - region.x0) * dimsY * (region.z1 - region.z0);
+
+}
+
+void ToroidalVolume::ExtractChunk(Chunk& chunk)
+{
+
+	int stencilX = chunk.stencil.x1 - chunk.stencil.x0;
+	int stencilZ = chunk.stencil.z1 - chunk.stencil.z0;
+
+	// Unwrap the stencil into a contiguous volume for the extractor
+	chunkVolume.Allocate(stencilX, dimsY, stencilZ);
+
+	for (int z = 0; z < stencilZ; z++)
+	{
+
+		for (int y = 0; y < dimsY; y++)
+		{
+
+			for (int x = 0; x < stencilX; x++)
+			{
+
+				chunkVolume.set(x, y, z, data[index(chunk.stencil.x0 + x, y, chunk.stencil.z0 + z)]);
+
+			}
+
+		}
+
+	}
+
+	chunk.vertices.clear();
+	marchingCubes.Run(chunkVolume, chunk.cells.x0 - chunk.stencil.x0, chunk.cells.x1 - chunk.stencil.x0, 0, dimsY,
+		chunk.cells.z0 - chunk.stencil.z0, chunk.cells.z1 - chunk.stencil.z0, chunk.vertices);
+
+	// Move the vertices from the stencil's space into world space
+	float offsetX = chunk.stencil.x0 * meshScaleFactor;
+	float offsetZ = chunk.stencil.z0 * meshScaleFactor;
+
+	for (size_t i = 0; i < chunk.vertices.size(); i++)
+	{
+
+		chunk.vertices[i].position[0] += offsetX;
+		chunk.vertices[i].position[2] += offsetZ;
+
+	}
+
+}
+
+void ToroidalVolume::getVertices(std::vector<MeshVertex>& output) const
+{
+
+	output.clear();
+	output.reserve(getVertexCount());
+
+	for (std::map<std::pair<int, int>, Chunk>::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
+	{
+
+		output.insert(output.end(), it->second.vertices.begin(), it->second.vertices.end());
+
+	}
+
+}
+
+size_t ToroidalVolume::getVertexCount() const
+{
+
+	size_t vertexCount = 0;
+
+	for (std::map<std::pair<int, int>, Chunk>::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
+	{
+
+		vertexCount += it->second.vertices.size();
+
+	}
+
+	return vertexCount;
+
+}
+
+size_t ToroidalVolume::getVoxelsGenerated() const
+{
+
+	return voxelsGenerated;
+
+}
+
+int ToroidalVolume::getChunksExtracted() const
+{
+
+	return chunksExtracted;
+
+}
+
+int ToroidalVolume::getChunksKept() const
+{
+
+	return chunksKept;
+
+}
+
+bool ToroidalVolume::Intersects(const Region& a, const Region& b)
+{
+
+	return a.x0 < b.x1 && b.x0 < a.x1 && a.z0 < b.z1 && b.z0 < a.z1;
+
+}
+
+bool ToroidalVolume::Equals(const Region& a, const Region& b)
+{
+
+	return a.x0 == b.x0 && a.x1 == b.x1 && a.z0 == b.z0 && a.z1 == b.z1;
+
+}
+
+int ToroidalVolume::Wrap(int value, int size)
+{
+
+	int wrapped = value % size;
+
+	return wrapped < 0 ? wrapped + size : wrapped;
+
+}
+
+int ToroidalVolume::FloorDivide(int value, int divisor)
+{
+
+	int quotient = value / divisor;
+
+	return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+
+}
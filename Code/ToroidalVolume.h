@@ -0,0 +1,118 @@
+// Toroidal volume
+// Clipmap style density volume that scrolls over the noise field in X and Z without regenerating all of it
+// Voxels are stored with wrap-around addressing (world coordinate modulo the window size), so moving the window by a
+// whole number of voxels only generates the newly exposed slabs; the mesh is kept in column chunks of cells, and only
+// chunks whose stencil touches new voxels or a window edge are re-extracted
+// Y is not scrolled, as the height increment is relative to the volume rather than to world space
+#ifndef _TOROIDAL_VOLUME_H_
+#define _TOROIDAL_VOLUME_H_
+
+#include <map>
+#include <utility>
+#include <vector>
+#include "CPUNoise.h"
+#include "CPUMarchingCubes.h"
+
+class ToroidalVolume
+{
+
+private:
+
+	// A box of world voxel coordinates, [x0, x1) x [z0, z1) over the full height of the volume
+	struct Region
+	{
+
+		int x0;
+		int x1;
+		int z0;
+		int z1;
+
+	};
+
+	// A column of up to chunkSize x chunkSize cells, aligned to multiples of chunkSize in world space
+	struct Chunk
+	{
+
+		// The cells extracted, clipped to the window
+		Region cells;
+		// The voxels read by those cells, including the normal stencil, clipped to the window
+		Region stencil;
+		// World space vertices, so they stay valid when the window moves
+		std::vector<MeshVertex> vertices;
+
+	};
+
+public:
+
+	ToroidalVolume();
+
+	// Resize the window; everything is regenerated on the next Update
+	void Allocate(int x, int y, int z);
+	// Changing the noise or extraction values regenerates everything on the next Update
+	void UpdateNoiseValues(const NoiseParameters& parameters);
+	void UpdateExtractionValues(float isoValue, float meshScaleFactor);
+	// Width of the mesh chunks in cells along X and Z (default 8)
+	void setChunkSize(int size);
+
+	// Move the window so that its lowest voxel sits at (originX, originZ), generating and extracting only what changed
+	void Update(int originX, int originZ);
+
+	// Density at a world voxel coordinate inside the window
+	float get(int worldX, int y, int worldZ) const;
+
+	// Concatenate the chunk meshes, in chunk order
+	void getVertices(std::vector<MeshVertex>& output) const;
+	size_t getVertexCount() const;
+
+	// What the last Update had to do
+	size_t getVoxelsGenerated() const;
+	int getChunksExtracted() const;
+	int getChunksKept() const;
+
+private:
+
+	// Fill the voxels of a region with noise
+	void GenerateRegion(const Region& region);
+	// Copy the chunk's stencil out of the ring and extract its cells
+	void ExtractChunk(Chunk& chunk);
+
+	static bool Intersects(const Region& a, const Region& b);
+	static bool Equals(const Region& a, const Region& b);
+	// Modulo that is never negative, for wrapping world coordinates into the ring
+	static int Wrap(int value, int size);
+	// Division that rounds towards negative infinity, for chunk coordinates
+	static int FloorDivide(int value, int divisor);
+
+	inline size_t index(int worldX, int y, int worldZ) const
+	{
+		return ((size_t)Wrap(worldZ, dimsZ) * dimsY + y) * dimsX + Wrap(worldX, dimsX);
+	}
+
+	CPUNoise noise;
+	CPUMarchingCubes marchingCubes;
+
+	std::vector<float> data;
+	std::map<std::pair<int, int>, Chunk> chunks;
+	// Regions generated by the current Update, checked against each chunk's stencil
+	std::vector<Region> generatedRegions;
+
+	// Scratch volume holding one chunk's stencil for extraction
+	DensityVolume chunkVolume;
+
+	bool isValid;
+	int originX;
+	int originZ;
+	float meshScaleFactor;
+	int chunkSize;
+
+	int dimsX;
+	int dimsY;
+	int dimsZ;
+
+	size_t voxelsGenerated;
+	int chunksExtracted;
+	int chunksKept;
+
+};
+
+#endif // !_TOROIDAL_VOLUME_H_
@@ -1,5 +1,6 @@
 // Tri table resource
 // Creates a 2D texture to use as the triangulation table based on Paul Bourke's reference implementation
+// Also creates a constant buffer holding the packed table (getPackedTriTable) for the packed geometry shader variant
 #ifndef _TRI_TABLE_RESOURCE_H_
 #define _TRI_TABLE_RESOURCE_H_
 
@@ -17,17 +18,23 @@ public:
 	~TriTableTexture();
 
 	ID3D11ShaderResourceView* getTriTable();
+	ID3D11Buffer* getPackedTriTableBuffer();
 
 private:
 
 	// Function for creating the triangle table as a texture resource to be input into the geometry shader
 	void createTriTableResource(ID3D11Device* device);
+	// Function for creating the packed triangle table as a constant buffer, two cases to each 16-byte register
+	void createPackedTriTableBuffer(ID3D11Device* device);
 
 	ID3D11Texture2D* texture;
 
 	// Triangle table texture resource view to be passed to the shader
 	ID3D11ShaderResourceView* triTableSRV;
 
+	// Packed triangle table constant buffer
+	ID3D11Buffer* packedTriTableBuffer;
+
 };
 
 #endif // !_TRI_TABLE_RESOURCE_H_
\ No newline at end of file
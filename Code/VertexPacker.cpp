@@ -0,0 +1,133 @@
+#include "VertexPacker.h"
+#include "MaterialWeights.h"
+#include <cmath>
+
+VertexPacker::VertexPacker()
+{
+
+	origin[0] = 0.0f;
+	origin[1] = 0.0f;
+	origin[2] = 0.0f;
+	extent = 1.0f;
+
+}
+
+void VertexPacker::setBox(const float* lorigin, float lextent)
+{
+
+	origin[0] = lorigin[0];
+	origin[1] = lorigin[1];
+	origin[2] = lorigin[2];
+	extent = lextent > 0.0f ? lextent : 1.0f;
+
+}
+
+const float* VertexPacker::getOrigin() const
+{
+
+	return origin;
+
+}
+
+float VertexPacker::getExtent() const
+{
+
+	return extent;
+
+}
+
+void VertexPacker::Pack(const MeshVertex& vertex, PackedVertex& packed) const
+{
+
+	for (int a = 0; a < 3; a++)
+	{
+
+		// Clamp, so a vertex on the far face of the box (or a rounding error past it) still packs
+		float fraction = (vertex.position[a] - origin[a]) / extent;
+		fraction = fraction < 0.0f ? 0.0f : (fraction > 1.0f ? 1.0f : fraction);
+		packed.position[a] = (unsigned short)(fraction * 65535.0f + 0.5f);
+
+	}
+
+	packed.position[3] = MaterialWeights::PackShort(vertex.position[3]);
+	EncodeOctahedral(vertex.normal, packed.normal);
+
+}
+
+void VertexPacker::Unpack(const PackedVertex& packed, MeshVertex& vertex) const
+{
+
+	for (int a = 0; a < 3; a++)
+	{
+
+		vertex.position[a] = origin[a] + packed.position[a] / 65535.0f * extent;
+
+	}
+
+	vertex.position[3] = MaterialWeights::UnpackShort(packed.position[3]);
+	DecodeOctahedral(packed.normal, vertex.normal);
+
+}
+
+void VertexPacker::EncodeOctahedral(const float* normal, short* encoded)
+{
+
+	float sum = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+
+	// A zero normal (a flat density) has no direction to keep
+	if (sum == 0.0f)
+	{
+
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+
+	}
+
+	float u = normal[0] / sum;
+	float v = normal[1] / sum;
+
+	// The lower half of the octahedron folds out over the corners of the square
+	if (normal[2] < 0.0f)
+	{
+
+		float foldedU = (1.0f - fabsf(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+		float foldedV = (1.0f - fabsf(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+		u = foldedU;
+		v = foldedV;
+
+	}
+
+	encoded[0] = (short)floorf(u * 32767.0f + 0.5f);
+	encoded[1] = (short)floorf(v * 32767.0f + 0.5f);
+
+}
+
+void VertexPacker::DecodeOctahedral(const short* encoded, float* normal)
+{
+
+	// snorm16 decoding, as the input assembler does for R16G16_SNORM
+	float u = encoded[0] / 32767.0f;
+	float v = encoded[1] / 32767.0f;
+	u = u < -1.0f ? -1.0f : u;
+	v = v < -1.0f ? -1.0f : v;
+
+	float z = 1.0f - fabsf(u) - fabsf(v);
+
+	if (z < 0.0f)
+	{
+
+		float unfoldedU = (1.0f - fabsf(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+		float unfoldedV = (1.0f - fabsf(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+		u = unfoldedU;
+		v = unfoldedV;
+
+	}
+
+	float length = sqrtf(u * u + v * v + z * z);
+
+	normal[0] = u / length;
+	normal[1] = v / length;
+	normal[2] = z / length;
+
+}
@@ -0,0 +1,37 @@
+// Vertex packer
+// Converts between MeshVertex and the 12 byte PackedVertex for meshes that stay inside a box, such as a chunk
+// Positions are quantised to 1/65535 of the box's extent, and normals are octahedral encoded; light_vs.hlsl decodes
+// the same encoding when compiled with PACKED_VERTEX
+#ifndef _VERTEX_PACKER_H_
+#define _VERTEX_PACKER_H_
+
+#include "TerrainTypes.h"
+
+class VertexPacker
+{
+
+public:
+
+	VertexPacker();
+
+	// Positions are packed relative to the box [origin, origin + extent] on each axis
+	void setBox(const float* origin, float extent);
+	const float* getOrigin() const;
+	float getExtent() const;
+
+	void Pack(const MeshVertex& vertex, PackedVertex& packed) const;
+	void Unpack(const PackedVertex& packed, MeshVertex& vertex) const;
+
+	// Map a unit normal onto the octahedron, then unfold it into the [-1, 1] square as two snorm16 values
+	static void EncodeOctahedral(const float* normal, short* encoded);
+	// Inverse of EncodeOctahedral, giving a unit normal
+	static void DecodeOctahedral(const short* encoded, float* normal);
+
+private:
+
+	float origin[3];
+	float extent;
+
+};
+
+#endif // !_VERTEX_PACKER_H_
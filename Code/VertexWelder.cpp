@@ -0,0 +1,83 @@
+#include "VertexWelder.h"
+#include <cstring>
+
+const unsigned int VertexWelder::emptySlot;
+
+void VertexWelder::Weld(const MeshVertex* soup, size_t count, std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices)
+{
+
+	WeldVertices(soup, count, vertices, indices);
+
+}
+
+void VertexWelder::Weld(const PackedVertex* soup, size_t count, std::vector<PackedVertex>& vertices, std::vector<unsigned int>& indices)
+{
+
+	// Quantisation can also merge vertices that were distinct but closer than one step, which draw the same anyway
+	WeldVertices(soup, count, vertices, indices);
+
+}
+
+template <typename Vertex>
+void VertexWelder::WeldVertices(const Vertex* soup, size_t count, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+
+	vertices.clear();
+	indices.resize(count);
+
+	// Keep the table at most half full, with a power of two size so the hash can be masked
+	size_t tableSize = 16;
+
+	while (tableSize < count * 2)
+	{
+
+		tableSize *= 2;
+
+	}
+
+	slots.assign(tableSize, emptySlot);
+	size_t mask = tableSize - 1;
+
+	for (size_t i = 0; i < count; i++)
+	{
+
+		size_t slot = Hash(&soup[i], sizeof(Vertex)) & mask;
+
+		while (slots[slot] != emptySlot && memcmp(&vertices[slots[slot]], &soup[i], sizeof(Vertex)) != 0)
+		{
+
+			slot = (slot + 1) & mask;
+
+		}
+
+		if (slots[slot] == emptySlot)
+		{
+
+			slots[slot] = (unsigned int)vertices.size();
+			vertices.push_back(soup[i]);
+
+		}
+
+		indices[i] = slots[slot];
+
+	}
+
+}
+
+unsigned int VertexWelder::Hash(const void* vertex, size_t bytes)
+{
+
+	const unsigned char* data = static_cast<const unsigned char*>(vertex);
+	unsigned int hash = 2166136261u;
+
+	for (size_t i = 0; i < bytes; i++)
+	{
+
+		hash = (hash ^ data[i]) * 16777619u;
+
+	}
+
+	// Fold the high bits down, as the table only uses the low ones
+	return hash ^ (hash >> 15);
+
+}
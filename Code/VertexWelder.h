@@ -0,0 +1,37 @@
+// Vertex welder
+// Turns a triangle soup into an indexed triangle list by merging bit-identical vertices
+// Marching cubes emits the vertex on a shared edge once per cell and triangle that uses it, but always from the same
+// corner values in the same order, so the copies are exactly equal and no tolerance is needed
+#ifndef _VERTEX_WELDER_H_
+#define _VERTEX_WELDER_H_
+
+#include <cstddef>
+#include <vector>
+#include "TerrainTypes.h"
+
+class VertexWelder
+{
+
+public:
+
+	// Write each distinct vertex of the soup once, in order of first use, and one index per soup vertex
+	// The indexed triangles are the soup's triangles in the same order; the hash table is kept for the next call
+	void Weld(const MeshVertex* soup, size_t count, std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices);
+	void Weld(const PackedVertex* soup, size_t count, std::vector<PackedVertex>& vertices, std::vector<unsigned int>& indices);
+
+private:
+
+	template <typename Vertex>
+	void WeldVertices(const Vertex* soup, size_t count, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+	// FNV-1a over the vertex's bytes
+	static unsigned int Hash(const void* vertex, size_t bytes);
+
+	// Open addressing table of vertex indices, emptySlot where unused
+	std::vector<unsigned int> slots;
+
+	static const unsigned int emptySlot = 0xFFFFFFFF;
+
+};
+
+#endif // !_VERTEX_WELDER_H_
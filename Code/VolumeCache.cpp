@@ -0,0 +1,355 @@
+#include "VolumeCache.h"
+#include "PermutationTable.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+const unsigned int VolumeCache::version = 1;
+
+// 64-bit FNV-1a, folded over each input in turn
+static void HashBytes(unsigned long long& hash, const void* bytes, size_t count)
+{
+
+	const unsigned char* input = static_cast<const unsigned char*>(bytes);
+
+	for (size_t i = 0; i < count; i++)
+	{
+
+		hash ^= input[i];
+		hash *= 1099511628211ULL;
+
+	}
+
+}
+
+VolumeCache::VolumeCache()
+{
+
+	maxBytes = 0;
+	isCacheOpen = false;
+	useCounter = 0;
+
+	hitCount = 0;
+	missCount = 0;
+
+}
+
+bool VolumeCache::Open(const std::string& ldirectory, unsigned long long lmaxBytes)
+{
+
+	directory = ldirectory;
+	maxBytes = lmaxBytes;
+
+#ifdef _WIN32
+	_mkdir(directory.c_str());
+#else
+	mkdir(directory.c_str(), 0755);
+#endif
+
+	// Check the directory is usable by writing the index, which also picks up any volumes from earlier sessions
+	LoadIndex();
+	SaveIndex();
+
+	std::ifstream index((directory + "/index.txt").c_str());
+	isCacheOpen = index.is_open();
+
+	// The bound may have shrunk since the volumes were written
+	if (isCacheOpen)
+	{
+
+		Evict(0);
+
+	}
+
+	return isCacheOpen;
+
+}
+
+bool VolumeCache::isOpen() const
+{
+
+	return isCacheOpen;
+
+}
+
+unsigned long long VolumeCache::HashKey(const NoiseParameters& parameters, int x, int y, int z)
+{
+
+	unsigned long long hash = 14695981039346656037ULL;
+
+	// Fields are hashed one at a time so that struct padding never contributes
+	int isRidged = parameters.isRidged ? 1 : 0;
+	int isSimplex = parameters.isSimplex ? 1 : 0;
+	int isHashed = parameters.isHashed ? 1 : 0;
+
+	HashBytes(hash, &version, sizeof(version));
+	HashBytes(hash, &parameters.amplitude, sizeof(parameters.amplitude));
+	HashBytes(hash, &parameters.frequency, sizeof(parameters.frequency));
+	HashBytes(hash, &parameters.persistence, sizeof(parameters.persistence));
+	HashBytes(hash, &parameters.octaves, sizeof(parameters.octaves));
+	HashBytes(hash, &parameters.meshScaleFactor, sizeof(parameters.meshScaleFactor));
+	HashBytes(hash, parameters.noiseOffsets, sizeof(parameters.noiseOffsets));
+	HashBytes(hash, parameters.noiseScaleFactors, sizeof(parameters.noiseScaleFactors));
+	HashBytes(hash, &isRidged, sizeof(isRidged));
+	HashBytes(hash, &isSimplex, sizeof(isSimplex));
+	HashBytes(hash, &parameters.heightBase, sizeof(parameters.heightBase));
+	HashBytes(hash, &parameters.heightMultiplier, sizeof(parameters.heightMultiplier));
+	HashBytes(hash, &isHashed, sizeof(isHashed));
+	HashBytes(hash, &parameters.seed, sizeof(parameters.seed));
+	HashBytes(hash, &x, sizeof(x));
+	HashBytes(hash, &y, sizeof(y));
+	HashBytes(hash, &z, sizeof(z));
+	HashBytes(hash, permutationTable, sizeof(permutationTable));
+
+	return hash;
+
+}
+
+bool VolumeCache::Load(unsigned long long key, int x, int y, int z, MappedFile& file, DensityVolume& volume)
+{
+
+	size_t i = 0;
+
+	while (i < entries.size() && entries[i].key != key)
+	{
+
+		i++;
+
+	}
+
+	if (!isCacheOpen || i == entries.size())
+	{
+
+		missCount++;
+		return false;
+
+	}
+
+	// A file that has gone missing or doesn't match what was asked for is dropped from the index
+	unsigned long long valueCount = (unsigned long long)x * y * z;
+	bool isValid = file.Open(getPath(key).c_str()) && file.getSize() == headerBytes + valueCount * sizeof(float);
+
+	if (isValid)
+	{
+
+		const FileHeader* header = reinterpret_cast<const FileHeader*>(file.getData());
+		isValid = memcmp(header->magic, "MCDV", 4) == 0 && header->version == version && header->key == key &&
+			header->dims[0] == x && header->dims[1] == y && header->dims[2] == z;
+
+	}
+
+	if (!isValid)
+	{
+
+		file.Close();
+		RemoveEntry(i);
+		SaveIndex();
+		missCount++;
+		return false;
+
+	}
+
+	volume.Map(reinterpret_cast<float*>(file.getData() + headerBytes), x, y, z);
+
+	entries[i].lastUse = ++useCounter;
+	SaveIndex();
+	hitCount++;
+
+	return true;
+
+}
+
+bool VolumeCache::Store(unsigned long long key, const DensityVolume& volume)
+{
+
+	unsigned long long valueCount = (unsigned long long)volume.getDimsX() * volume.getDimsY() * volume.getDimsZ();
+	unsigned long long bytes = headerBytes + valueCount * sizeof(float);
+
+	if (!isCacheOpen || bytes > maxBytes)
+	{
+
+		return false;
+
+	}
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+
+		if (entries[i].key == key)
+		{
+
+			RemoveEntry(i);
+			break;
+
+		}
+
+	}
+
+	Evict(bytes);
+
+	// Write to a temporary name first, so a partly written volume is never picked up
+	std::string path = getPath(key);
+	std::string temporaryPath = path + ".tmp";
+	std::ofstream file(temporaryPath.c_str(), std::ofstream::binary | std::ofstream::trunc);
+
+	std::vector<char> header(headerBytes, 0);
+	FileHeader* fileHeader = reinterpret_cast<FileHeader*>(header.data());
+	memcpy(fileHeader->magic, "MCDV", 4);
+	fileHeader->version = version;
+	fileHeader->key = key;
+	fileHeader->dims[0] = volume.getDimsX();
+	fileHeader->dims[1] = volume.getDimsY();
+	fileHeader->dims[2] = volume.getDimsZ();
+
+	file.write(header.data(), header.size());
+	file.write(reinterpret_cast<const char*>(volume.getData()), valueCount * sizeof(float));
+	file.close();
+
+	if (!file.good() || rename(temporaryPath.c_str(), path.c_str()) != 0)
+	{
+
+		remove(temporaryPath.c_str());
+		return false;
+
+	}
+
+	Entry entry;
+	entry.key = key;
+	entry.bytes = bytes;
+	entry.lastUse = ++useCounter;
+	entries.push_back(entry);
+	SaveIndex();
+
+	return true;
+
+}
+
+void VolumeCache::Clear()
+{
+
+	while (!entries.empty())
+	{
+
+		RemoveEntry(entries.size() - 1);
+
+	}
+
+	SaveIndex();
+
+}
+
+void VolumeCache::Evict(unsigned long long incomingBytes)
+{
+
+	while (!entries.empty() && getCachedBytes() + incomingBytes > maxBytes)
+	{
+
+		size_t oldest = 0;
+
+		for (size_t i = 1; i < entries.size(); i++)
+		{
+
+			if (entries[i].lastUse < entries[oldest].lastUse)
+			{
+
+				oldest = i;
+
+			}
+
+		}
+
+		RemoveEntry(oldest);
+
+	}
+
+	SaveIndex();
+
+}
+
+void VolumeCache::RemoveEntry(size_t i)
+{
+
+	// On Windows a volume that is still mapped can't be deleted; it is dropped from the index and overwritten next time
+	remove(getPath(entries[i].key).c_str());
+	entries.erase(entries.begin() + i);
+
+}
+
+void VolumeCache::LoadIndex()
+{
+
+	entries.clear();
+	useCounter = 0;
+
+	std::ifstream index((directory + "/index.txt").c_str());
+	Entry entry;
+
+	while (index >> std::hex >> entry.key >> std::dec >> entry.bytes >> entry.lastUse)
+	{
+
+		entries.push_back(entry);
+		useCounter = entry.lastUse > useCounter ? entry.lastUse : useCounter;
+
+	}
+
+}
+
+void VolumeCache::SaveIndex() const
+{
+
+	std::ofstream index((directory + "/index.txt").c_str(), std::ofstream::trunc);
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+
+		index << std::hex << entries[i].key << std::dec << " " << entries[i].bytes << " " << entries[i].lastUse << std::endl;
+
+	}
+
+}
+
+std::string VolumeCache::getPath(unsigned long long key) const
+{
+
+	char name[32];
+	snprintf(name, sizeof(name), "/%016llx.vol", key);
+
+	return directory + name;
+
+}
+
+int VolumeCache::getHitCount() const
+{
+
+	return hitCount;
+
+}
+
+int VolumeCache::getMissCount() const
+{
+
+	return missCount;
+
+}
+
+unsigned long long VolumeCache::getCachedBytes() const
+{
+
+	unsigned long long bytes = 0;
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+
+		bytes += entries[i].bytes;
+
+	}
+
+	return bytes;
+
+}
@@ -0,0 +1,90 @@
+// Volume cache
+// On-disk cache of generated density volumes, keyed by a hash of everything the noise stage depends on
+// Each volume is a file with a one page header followed by the raw values, so a hit maps the file and uses the values in
+// place with no decoding. The cache keeps an index of its files and evicts the least recently used ones to stay within
+// its size bound
+#ifndef _VOLUME_CACHE_H_
+#define _VOLUME_CACHE_H_
+
+#include <string>
+#include <vector>
+#include "TerrainTypes.h"
+#include "DensityVolume.h"
+#include "MappedFile.h"
+
+class VolumeCache
+{
+
+private:
+
+	// Written at the start of each cache file, padded out to headerBytes
+	struct FileHeader
+	{
+
+		char magic[4];
+		unsigned int version;
+		unsigned long long key;
+		int dims[3];
+		unsigned int padding;
+
+	};
+
+	struct Entry
+	{
+
+		unsigned long long key;
+		unsigned long long bytes;
+		// Higher is more recent
+		unsigned long long lastUse;
+
+	};
+
+public:
+
+	VolumeCache();
+
+	// Use the directory for the cache files, creating it if needed, and keep their total size within maxBytes
+	bool Open(const std::string& directory, unsigned long long maxBytes);
+	bool isOpen() const;
+
+	// Hash of the noise parameters, the volume dimensions and the permutation table, which stands in for the noise seed
+	// Covers every field of GradientNoise::BufferType, as NoiseParameters and the dimensions hold the same values
+	static unsigned long long HashKey(const NoiseParameters& parameters, int x, int y, int z);
+
+	// Map the cached volume for key into file and point volume at it; returns false on a miss
+	bool Load(unsigned long long key, int x, int y, int z, MappedFile& file, DensityVolume& volume);
+	// Write the volume under key, evicting older volumes first if it wouldn't otherwise fit
+	bool Store(unsigned long long key, const DensityVolume& volume);
+	// Remove every cached volume
+	void Clear();
+
+	int getHitCount() const;
+	int getMissCount() const;
+	unsigned long long getCachedBytes() const;
+
+	// The values start one page into the file, so the mapped values are page aligned
+	static const size_t headerBytes = 4096;
+	static const unsigned int version;
+
+private:
+
+	void LoadIndex();
+	void SaveIndex() const;
+	// Drop least recently used volumes until incomingBytes more would fit
+	void Evict(unsigned long long incomingBytes);
+	void RemoveEntry(size_t i);
+	std::string getPath(unsigned long long key) const;
+
+	std::string directory;
+	unsigned long long maxBytes;
+	bool isCacheOpen;
+
+	std::vector<Entry> entries;
+	unsigned long long useCounter;
+
+	int hitCount;
+	int missCount;
+
+};
+
+#endif // !_VOLUME_CACHE_H_
@@ -0,0 +1,18 @@
+// Cell index functions shared by the marching cubes shaders
+// Cells are numbered X fastest, then Y, then Z, matching CellIndex.h on the CPU
+
+// Linear index of a cell in a grid of counts.x by counts.y cells in X and Y
+uint CellIndex(uint3 cell, uint2 counts)
+{
+
+	return cell.x + counts.x * (cell.y + counts.y * cell.z);
+
+}
+
+// Coordinates of the cell with the given linear index; the inverse of CellIndex
+uint3 CellCoordinates(uint index, uint2 counts)
+{
+
+	return uint3(index % counts.x, (index / counts.x) % counts.y, index / (counts.x * counts.y));
+
+}
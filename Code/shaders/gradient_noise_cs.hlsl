@@ -22,9 +22,27 @@ cbuffer noiseBuffer : register(b0)
 	// Height increment value modifiers
 	float heightBase;
 	float heightMultiplier;
+	// Hash each lattice point's gradient instead of loading it from the permutation texture, and the hash's seed
+	bool isHashed;
+	uint seed;
 
 };
 
+// The noise function selected by isSimplex and isHashed
+float Basis(float3 input)
+{
+
+	if (isHashed)
+	{
+
+		return isSimplex ? hsnoise3(input, seed) : hnoise3(input, seed);
+
+	}
+
+	return isSimplex ? snoise3(input) : noise3(input);
+
+}
+
 // Fractional Brownian motion function
 // Expanded to implement both Perlin and Simplex noise, plus ridged turbulence
 float fBm(float3 input)
@@ -36,48 +54,20 @@ float fBm(float3 input)
 	float localAmplitude = amplitude;
 	float localFrequency = frequency;
 
+	// Position in noise space before frequency scaling; these don't change between octaves
+	float3 position = (input * meshScaleFactor * noiseScaleFactors) + offsets;
+
 	// Loop for the number of octaves, running the noise function as many times as desired (8 is usually sufficient)
 	for (int k = 0; k < octaves; k++)
 	{
 
-		// Check whether we should use Simplex noise or Perlin noise
-		if (isSimplex)
-		{
-
-			noiseValue = snoise3(float3(((input.x * meshScaleFactor * noiseScaleFactors.x) + offsets.x) * localFrequency,
-				((input.y * meshScaleFactor * noiseScaleFactors.y) + offsets.y) * localFrequency,
-				((input.z * meshScaleFactor * noiseScaleFactors.z) + offsets.z) * localFrequency)
-			) * localAmplitude;
-
-			// Check if we're doing ridged turbulence implementation
-			if (isRidged)
-			{
-
-				noise2 = snoise3(float3(((input.x * meshScaleFactor * noiseScaleFactors.x) + offsets.x) * localFrequency,
-					((input.y * meshScaleFactor * noiseScaleFactors.y) + offsets.y + 150.0f) * localFrequency,
-					((input.z * meshScaleFactor * noiseScaleFactors.z) + offsets.z) * localFrequency)
-				) * localAmplitude;
+		noiseValue = Basis(position * localFrequency) * localAmplitude;
 
-			}
-
-		}
-		else
+		// Check if we're doing ridged turbulence implementation
+		if (isRidged)
 		{
 
-			noiseValue = noise3(float3(((input.x * meshScaleFactor * noiseScaleFactors.x) + offsets.x) * localFrequency,
-				((input.y * meshScaleFactor * noiseScaleFactors.y) + offsets.y) * localFrequency,
-				((input.z * meshScaleFactor * noiseScaleFactors.z) + offsets.z) * localFrequency)
-			) * localAmplitude;
-
-			if (isRidged)
-			{
-
-				noise2 = noise3(float3(((input.x * meshScaleFactor * noiseScaleFactors.x) + offsets.x) * localFrequency,
-					((input.y * meshScaleFactor * noiseScaleFactors.y) + offsets.y + 150.0f) * localFrequency,
-					((input.z * meshScaleFactor * noiseScaleFactors.z) + offsets.z) * localFrequency)
-				) * localAmplitude;
-
-			}
+			noise2 = Basis(float3(position.x, position.y + 150.0f, position.z) * localFrequency) * localAmplitude;
 
 		}
 
@@ -125,6 +115,17 @@ RWTexture3D<float> outputTexture : register(u0);
 void main(uint3 DTid : SV_DispatchThreadID)
 {
 
+	// The volume's dimensions needn't be multiples of the group size, so the last groups have threads outside it
+	uint3 dimensions;
+	outputTexture.GetDimensions(dimensions.x, dimensions.y, dimensions.z);
+
+	if (any(DTid >= dimensions))
+	{
+
+		return;
+
+	}
+
 	// Get the noise value
 	float value = fBm((float3)DTid.xyz);
 
@@ -0,0 +1,5 @@
+// Light vertex shader for packed vertices
+// light_vs.hlsl reading PackedVertex, for baked chunks written with CHUNK_VERTEX_PACKED
+
+#define PACKED_VERTEX
+#include "light_vs.hlsl"
@@ -1,6 +1,7 @@
 // Light pixel shader
 // Calculate diffuse lighting for a single directional light (also texturing)
 // Slope-based texturing adapted from Rastertek slope based texturing tutorial: http://www.rastertek.com/tertut14.html
+// The slope and height rules now run per vertex at extraction, see MaterialWeights.h and material_fx.hlsl
 
 Texture2D rockTexture  : register(t0);
 Texture2D grassTexture : register(t1);
@@ -29,89 +30,79 @@ struct InputType
 	float3 normal : NORMAL;
     float3 tex : TEXCOORD0;
 	float3 realPosition: TEXCOORD1;
+	// Sand, grass and rock weights, and the X, Y and Z projection weights, from the vertices
+	float3 layerWeights : TEXCOORD2;
+	float3 axisWeights : TEXCOORD3;
 
 };
 
+// Blend the triplanar projections of one texture, skipping those with no weight
+// Sampling inside the branches needs the gradients taken outside them
+float4 SampleTriplanar(Texture2D layerTexture, float2 uvs[3], float4 gradients[3], float3 axisWeights)
+{
+
+	float4 color = 0.0f;
+
+	[unroll]
+	for (int a = 0; a < 3; a++)
+	{
+
+		[branch]
+		if (axisWeights[a] > 0.0f)
+		{
+
+			color += layerTexture.SampleGrad(SampleType, uvs[a], gradients[a].xy, gradients[a].zw) * axisWeights[a];
+
+		}
+
+	}
+
+	return color;
+
+}
+
 float4 main(InputType input) : SV_TARGET
 {
 
 	// Final texture value
-	float4 textureColor;
-	// Samplex texture values
-	float4 grassColor;
-	float4 rockColor;
-	float4 sandColor;
-	// Intermediary texture values based on combination of height and slope
-	float4 groundColor;
-	float4 slopeColor;
+	float4 textureColor = 0.0f;
 	// Diffuse lighting values
     float3 lightDir;
     float lightIntensity;
     float4 color;
 	float textureScale = 5.0f;
 
-	// Triplana mapping blend weightd
-	// Calculate the weights based on the normal
-	float3 blendWeights = pow(abs(input.normal), 1.0f);
-	// Normalize the weights
-	blendWeights /= (blendWeights.x + blendWeights.y + blendWeights.z);
-
 	// Triplanar mapping - for each texture
 	// Source: http://www.martinpalko.com/triplanar-mapping/
 	// Sample down each axis
+	float2 uvs[3] = { input.tex.yz / textureScale, input.tex.xz / textureScale, input.tex.xy / textureScale };
+	float4 gradients[3] = { float4(ddx(uvs[0]), ddy(uvs[0])), float4(ddx(uvs[1]), ddy(uvs[1])), float4(ddx(uvs[2]), ddy(uvs[2])) };
+
+	// The slope and height blending of sand, grass and rock, and the triplanar blend weights, are worked out per vertex
+	// at extraction (MaterialWeights); a layer or projection with no weight at any of a triangle's vertices has none
+	// anywhere on it, so it isn't sampled
+	[branch]
+	if (input.layerWeights.x > 0.0f)
+	{
 
-	// Rock texture
-	float4 xaxis = rockTexture.Sample(SampleType, input.tex.yz / textureScale);
-	float4 yaxis = rockTexture.Sample(SampleType, input.tex.xz / textureScale);
-	float4 zaxis = rockTexture.Sample(SampleType, input.tex.xy / textureScale);
-
-	// Calculate the final texture from the samples using the blending weights
-	rockColor = xaxis * blendWeights.x + yaxis * blendWeights.y + zaxis * blendWeights.z;
-
-	// Grass texture
-	xaxis = grassTexture.Sample(SampleType, input.tex.yz / textureScale);
-	yaxis = grassTexture.Sample(SampleType, input.tex.xz / textureScale);
-	zaxis = grassTexture.Sample(SampleType, input.tex.xy / textureScale);
-
-	grassColor = xaxis * blendWeights.x + yaxis * blendWeights.y + zaxis * blendWeights.z;
-
-	// Sand texture
-	xaxis = sandTexture.Sample(SampleType, input.tex.yz / textureScale);
-	yaxis = sandTexture.Sample(SampleType, input.tex.xz / textureScale);
-	zaxis = sandTexture.Sample(SampleType, input.tex.xy / textureScale);
-
-	sandColor = xaxis * blendWeights.x + yaxis * blendWeights.y + zaxis * blendWeights.z;
-
-	// Get a value for the height (less than 0 will always be sand, above 1 will never be sand)
-	float height = saturate(input.realPosition.y * 0.15f);
+		textureColor += SampleTriplanar(sandTexture, uvs, gradients, input.axisWeights) * input.layerWeights.x;
 
-	// Set height to height^5 for better falloff on the sand textures
-	height = height * height * height * height * height;
+	}
 
-	// Update the ground and slope textures by linearly interpolating between relevant textures using the height values
-	groundColor = lerp(sandColor, grassColor, height);
-	slopeColor = lerp(sandColor, rockColor, height);
+	[branch]
+	if (input.layerWeights.y > 0.0f)
+	{
 
-	// Calculate the slope of this point
-	float slope = 1.0f - input.normal.y;
-	float blendAmount = 0.0f;
+		textureColor += SampleTriplanar(grassTexture, uvs, gradients, input.axisWeights) * input.layerWeights.y;
 
-	// Determine which texture to use based on height
-	if (slope < 0.3f)
-	{
-		blendAmount = slope / 0.3f;
-		textureColor = lerp(groundColor, slopeColor, blendAmount);
 	}
 
-	if ((slope < 0.7f) && (slope >= 0.3f))
+	[branch]
+	if (input.layerWeights.z > 0.0f)
 	{
-		blendAmount = (slope - 0.3f) * (1.0f / (0.7f - 0.3f));
-		textureColor = lerp(slopeColor, rockColor, blendAmount);
-	}
 
-	if (slope >= 0.7f)
-	{
-		textureColor = rockColor;
+		textureColor += SampleTriplanar(rockTexture, uvs, gradients, input.axisWeights) * input.layerWeights.z;
+
 	}
 
 	// Set a default color
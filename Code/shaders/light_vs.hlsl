@@ -1,5 +1,8 @@
 // Light vertex shader
 // Standard vertex shader; calculate necessary information per vertex for the pixel shader, then pass down the pipeline
+// Compiled with PACKED_VERTEX (light_packed_vs.hlsl) it reads PackedVertex instead, decoding it as VertexPacker does
+// Position w holds the vertex's material weights (material_fx.hlsl), which are passed on for the pixel shader to blend by
+#include "material_fx.hlsl"
 
 cbuffer MatrixBuffer : register(b0)
 {
@@ -18,6 +21,44 @@ cbuffer CameraBuffer : register(b1)
 
 };
 
+#ifdef PACKED_VERTEX
+
+cbuffer ChunkBuffer : register(b2)
+{
+
+	float3 chunkOrigin;
+	float chunkExtent;
+
+};
+
+// Positions arrive as R16G16B16A16_UNORM relative to the chunk's box, and normals as octahedral R16G16_SNORM
+struct InputType
+{
+
+	float4 position : POSITION;
+	float2 normal : NORMAL;
+
+};
+
+float3 decodeOctahedral(float2 encoded)
+{
+
+	float3 normal = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+
+	// Unfold the lower half of the octahedron from the corners of the square
+	if (normal.z < 0.0f)
+	{
+
+		normal.xy = (1.0f - abs(encoded.yx)) * (encoded >= 0.0f ? 1.0f : -1.0f);
+
+	}
+
+	return normalize(normal);
+
+}
+
+#else
+
 struct InputType
 {
 
@@ -26,6 +67,8 @@ struct InputType
 
 };
 
+#endif
+
 struct OutputType
 {
 
@@ -33,6 +76,8 @@ struct OutputType
 	float3 normal : NORMAL;
 	float3 tex : TEXCOORD0;
 	float3 realPosition : TEXCOORD1;
+	float3 layerWeights : TEXCOORD2;
+	float3 axisWeights : TEXCOORD3;
 
 };
 
@@ -41,6 +86,16 @@ OutputType main(InputType input)
 
     OutputType output;
 
+#ifdef PACKED_VERTEX
+	UnpackMaterialShort((uint)round(input.position.w * 65535.0f), output.layerWeights, output.axisWeights);
+	input.position = float4(chunkOrigin + input.position.xyz * chunkExtent, 1.0f);
+	float3 normal = decodeOctahedral(input.normal);
+#else
+	UnpackMaterial(asuint(input.position.w), output.layerWeights, output.axisWeights);
+	input.position.w = 1.0f;
+	float3 normal = input.normal;
+#endif
+
 	// realPosition is used to determine the height of the vertex in world space
 	// This allows for height based texturing
 	output.realPosition = input.position.xyz;
@@ -54,7 +109,7 @@ OutputType main(InputType input)
     output.position = mul(output.position, projectionMatrix);
 
 	 // Calculate the normal vector against the world matrix only
-    output.normal = mul(input.normal, (float3x3)worldMatrix);
+    output.normal = mul(normal, (float3x3)worldMatrix);
 
 	output.tex = input.position.xyz;
 	
@@ -0,0 +1,43 @@
+// Marching cubes classify pass
+// Finds each cell's cube configuration and how many triangles it will emit, ready for the prefix sum
+#include "marching_cubes_fx.hlsl"
+
+Texture3D<float> noiseTexture : register(t0);
+StructuredBuffer<uint> caseTriangleCounts : register(t1);
+
+RWStructuredBuffer<uint> cubeIndices : register(u0);
+// Scanned in place into each cell's first output triangle
+RWStructuredBuffer<uint> triangleCounts : register(u1);
+
+[numthreads(8, 8, 8)]
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+
+	// The cell counts needn't be multiples of the group size
+	if (any(DTid >= cellCounts))
+	{
+
+		return;
+
+	}
+
+	// Determine the cube configuration by loading the corner voxels
+	uint cubeIndex = 0;
+
+	for (int i = 0; i < 8; i++)
+	{
+
+		if (noiseTexture.Load(int4(DTid + cornerOffsets[i], 0)) < isoValue)
+		{
+
+			cubeIndex |= 1 << i;
+
+		}
+
+	}
+
+	uint cell = CellIndex(DTid);
+	cubeIndices[cell] = cubeIndex;
+	triangleCounts[cell] = caseTriangleCounts[cubeIndex];
+
+}
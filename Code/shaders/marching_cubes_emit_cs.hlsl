@@ -0,0 +1,120 @@
+// Marching cubes emit pass
+// Writes each cell's triangles at its scanned offset, so the output is ordered by cell like the CPU extractor
+#include "marching_cubes_fx.hlsl"
+#include "material_fx.hlsl"
+
+Texture3D<float> noiseTexture : register(t0);
+StructuredBuffer<uint> caseTriangleCounts : register(t1);
+Texture2D<int> triTableTexture : register(t2);
+StructuredBuffer<uint> cubeIndices : register(t3);
+StructuredBuffer<uint> triangleOffsets : register(t4);
+
+SamplerState sampleType : register(s0);
+
+// Raw vertex buffer, laid out as the stream output was: float4 position with the packed material weights in w, float3 normal
+RWByteAddressBuffer vertices : register(u0);
+
+#define VERTEX_STRIDE 28
+
+// Trilinear sample in voxel coordinates; voxel centres sit at half texel offsets
+float SampleVolume(float3 position)
+{
+
+	return noiseTexture.SampleLevel(sampleType, (position + 0.5f) / dimensions, 0);
+
+}
+
+// Calculate a normal by sampling either side of the vertex in each dimension
+float3 CalculateNormal(float3 position)
+{
+
+	float3 normal;
+	normal.x = SampleVolume(position + float3(1.0f, 0.0f, 0.0f)) - SampleVolume(position - float3(1.0f, 0.0f, 0.0f));
+	normal.y = SampleVolume(position + float3(0.0f, 1.0f, 0.0f)) - SampleVolume(position - float3(0.0f, 1.0f, 0.0f));
+	normal.z = SampleVolume(position + float3(0.0f, 0.0f, 1.0f)) - SampleVolume(position - float3(0.0f, 0.0f, 1.0f));
+
+	float length = sqrt(dot(normal, normal));
+
+	return length > 0.0f ? normal / length : normal;
+
+}
+
+[numthreads(8, 8, 8)]
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+
+	if (any(DTid >= cellCounts))
+	{
+
+		return;
+
+	}
+
+	uint cell = CellIndex(DTid);
+	uint cubeIndex = cubeIndices[cell];
+	uint triangleCount = caseTriangleCounts[cubeIndex];
+
+	if (triangleCount == 0)
+	{
+
+		return;
+
+	}
+
+	// Set the corner values by loading the corner voxels
+	float cornerValues[8];
+
+	for (int i = 0; i < 8; i++)
+	{
+
+		cornerValues[i] = noiseTexture.Load(int4(DTid + cornerOffsets[i], 0));
+
+	}
+
+	// Find the vertices where the surface intersects the cube
+	float3 vertlist[12];
+
+	for (int e = 0; e < 12; e++)
+	{
+
+		vertlist[e] = 0.0f;
+
+		if (edgeTable[cubeIndex] & (1 << e))
+		{
+
+			int2 corners = edgeCorners[e];
+			vertlist[e] = VertexInterp(float3(DTid + cornerOffsets[corners.x]), float3(DTid + cornerOffsets[corners.y]),
+				cornerValues[corners.x], cornerValues[corners.y]);
+
+		}
+
+	}
+
+	uint firstTriangle = triangleOffsets[cell];
+
+	for (uint t = 0; t < triangleCount; t++)
+	{
+
+		// Triangles beyond the buffer are dropped; the host reads the total back and regrows the buffer
+		if (firstTriangle + t >= triangleCapacity)
+		{
+
+			return;
+
+		}
+
+		for (uint v = 0; v < 3; v++)
+		{
+
+			float3 position = vertlist[triTableTexture.Load(int3(t * 3 + v, cubeIndex, 0))];
+			float3 normal = CalculateNormal(position);
+			uint address = ((firstTriangle + t) * 3 + v) * VERTEX_STRIDE;
+
+			vertices.Store4(address, asuint(float4(position * meshScaleFactor, PackMaterial(position * meshScaleFactor, normal))));
+			vertices.Store3(address + 16, asuint(normal));
+
+		}
+
+	}
+
+}
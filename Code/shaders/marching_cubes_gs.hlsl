@@ -1,6 +1,13 @@
+// Marching cubes geometry shader
+// Compiled with PACKED_TRI_TABLE (marching_cubes_packed_gs.hlsl) it reads the packed triangle table instead of the texture
+// Each vertex's position w holds its packed material weights (material_fx.hlsl) for the light shaders
+#include "material_fx.hlsl"
+
 // Textures
 Texture3D<float> noiseTexture : register(t0);
+#ifndef PACKED_TRI_TABLE
 Texture2D<int> triTableTexture : register(t1);
+#endif
 
 // Sampler set up on the CPU side
 SamplerState sampleType : register(s0);
@@ -10,12 +17,25 @@ cbuffer ParamBuffer : register(b0)
 {
 
 	float isoValue;
-	float meshSize;
 	float meshScaleFactor;
-	float padding;
+	float2 padding;
+	// Voxels in each dimension; dividing a voxel space position by it gives texture coordinates
+	float3 meshSize;
+	float meshSizePadding;
 
 };
 
+#ifdef PACKED_TRI_TABLE
+// Two cases to each register, as the low and high words of each: edge indices 4 bits each from the lowest bits up,
+// with the triangle count in the top 4 bits
+cbuffer TriTableBuffer : register(b1)
+{
+
+	uint4 packedTriTable[128];
+
+};
+#endif
+
 // Edge table from Paul Bourke's source: http://paulbourke.net/geometry/polygonise/
 static int edgeTable[256] = {
 	0x0  , 0x109, 0x203, 0x30a, 0x406, 0x50f, 0x605, 0x70c,
@@ -66,6 +86,15 @@ struct OutputType
 
 };
 
+#ifdef PACKED_TRI_TABLE
+// Edge index i of a case's packed word
+int packedTriTableValue(uint2 caseWord, int i)
+{
+
+	return (int)((i < 8 ? caseWord.x >> (4 * i) : caseWord.y >> (4 * (i - 8))) & 0xF);
+
+}
+#else
 // Triangle table texture loading
 // Source: https://github.com/Tsarpf/MarchingCubesGPU/blob/master/GPUMarchingCubes/GPUMarchingCubes/GeometryShader.hlsl
 int triTableValue(int i, int j)
@@ -81,6 +110,7 @@ int triTableValue(int i, int j)
 	return triTableTexture.Load(int3(j, i, 0));
 
 }
+#endif
 
 // Trilinear vertex interpolation, from Paul Bourke's reference implementation
 float3 VertexInterp(float isoValue, float3 p1, float3 p2, float valp1, float valp2)
@@ -248,22 +278,36 @@ void main(point InputType input[1], inout TriangleStream<OutputType> triStream)
 		vertlist[11] = VertexInterp(isoValue, cornerPositions[3], cornerPositions[7], cornerValues[3], cornerValues[7]);
 
 		// Calculate polygons from the detected vertices
+#ifdef PACKED_TRI_TABLE
+		// One load gives the triangle count and every edge, with no bounds checks or search for the terminator
+		uint4 caseWords = packedTriTable[cubeIndex >> 1];
+		uint2 caseWord = (cubeIndex & 1) ? caseWords.zw : caseWords.xy;
+		int vertexCount = (int)(caseWord.y >> 28) * 3;
+
+		for (int i = 0; i < vertexCount; i += 3)
+		{
+
+			int3 triangleEdges = int3(packedTriTableValue(caseWord, i), packedTriTableValue(caseWord, i + 1), packedTriTableValue(caseWord, i + 2));
+#else
 		for (int i = 0; triTableValue(cubeIndex, i) != -1; i += 3)
 		{
 
-			float3 vposition = vertlist[triTableValue(cubeIndex, i)];
-			output.position = float4(vposition, 1.0f);
+			int3 triangleEdges = int3(triTableValue(cubeIndex, i), triTableValue(cubeIndex, i + 1), triTableValue(cubeIndex, i + 2));
+#endif
+
+			float3 vposition = vertlist[triangleEdges.x];
 			output.normal = CalculateNormal(vposition / meshScaleFactor);
+			output.position = float4(vposition, PackMaterial(vposition, output.normal));
 			triStream.Append(output);
 
-			float3 v2position = vertlist[triTableValue(cubeIndex, i + 1)];
-			output.position = float4(v2position, 1.0f);
+			float3 v2position = vertlist[triangleEdges.y];
 			output.normal = CalculateNormal(v2position / meshScaleFactor);
+			output.position = float4(v2position, PackMaterial(v2position, output.normal));
 			triStream.Append(output);
 
-			float3 v3position = vertlist[triTableValue(cubeIndex, i + 2)];
-			output.position = float4(v3position, 1.0f);
+			float3 v3position = vertlist[triangleEdges.z];
 			output.normal = CalculateNormal(v3position / meshScaleFactor);
+			output.position = float4(v3position, PackMaterial(v3position, output.normal));
 			triStream.Append(output);
 
 			triStream.RestartStrip();
@@ -0,0 +1,5 @@
+// Marching cubes geometry shader with the packed triangle table
+// marching_cubes_gs.hlsl reading each case from a constant buffer of 64-bit words (getPackedTriTable) instead of the texture
+
+#define PACKED_TRI_TABLE
+#include "marching_cubes_gs.hlsl"
@@ -1,9 +1,22 @@
 // Marching cubes vertex shader
-// Simple geometry pass
+// Drawn with no vertex buffer, one point per voxel; each vertex derives its voxel from SV_VertexID rather than reading it
+#include "cell_index_fx.hlsl"
+
+// Shares the geometry shader's parameter buffer
+cbuffer ParamBuffer : register(b0)
+{
+
+	float isoValue;
+	float meshScaleFactor;
+	float2 padding;
+	float3 meshSize;
+	float meshSizePadding;
+
+};
 
 struct InputType
 {
-	uint4 position : POSITION;
+	uint vertexID : SV_VertexID;
 };
 
 struct OutputType
@@ -15,8 +28,9 @@ OutputType main(InputType input)
 {
 	OutputType output;
 
-	// Calculate the position of the vertex against the world, view, and projection matrices
-	output.position = float4(input.position.x, input.position.y, input.position.z, input.position.w);
+	// The voxel's lowest corner, in voxel space; the geometry shader builds the cell from it
+	uint3 voxel = CellCoordinates(input.vertexID, (uint2)meshSize.xy);
+	output.position = float4(voxel, 1.0f);
 
 	return output;
-}
\ No newline at end of file
+}
@@ -0,0 +1,97 @@
+// Material weights
+// The per-vertex texturing rules and packing of MaterialWeights.h, for the GPU extractors to write into each vertex's
+// position w and for the light shaders to read back
+
+// Sand, grass and rock weights of a vertex at mesh space height y whose unit normal has the given Y component
+float3 MaterialLayerWeights(float y, float normalY)
+{
+
+	float height = saturate(y * 0.15f);
+	height = height * height * height * height * height;
+
+	float slope = 1.0f - normalY;
+
+	if (slope < 0.3f)
+	{
+
+		float blend = slope / 0.3f;
+		return float3(1.0f - height, height * (1.0f - blend), height * blend);
+
+	}
+
+	if (slope < 0.7f)
+	{
+
+		float blend = (slope - 0.3f) * (1.0f / (0.7f - 0.3f));
+		return float3((1.0f - height) * (1.0f - blend), 0.0f, height * (1.0f - blend) + blend);
+
+	}
+
+	return float3(0.0f, 0.0f, 1.0f);
+
+}
+
+// Triplanar blend weights of the projections along X, Y and Z
+float3 TriplanarWeights(float3 normal)
+{
+
+	float3 weights = abs(normal);
+	float sum = weights.x + weights.y + weights.z;
+
+	return sum > 0.0f ? weights / sum : 1.0f / 3.0f;
+
+}
+
+// Three weights summing to 1 as integers summing to levels, by largest remainder as MaterialWeights::Quantise does
+uint3 QuantiseWeights(float3 weights, uint levels)
+{
+
+	float3 scaled = weights / (weights.x + weights.y + weights.z) * levels;
+	uint3 quantised = (uint3)floor(scaled);
+	float3 remainders = scaled - quantised;
+
+	for (uint total = quantised.x + quantised.y + quantised.z; total < levels; total++)
+	{
+
+		uint largest = remainders.x >= remainders.y ? (remainders.x >= remainders.z ? 0 : 2) : (remainders.y >= remainders.z ? 1 : 2);
+		quantised[largest]++;
+		remainders[largest] = -1.0f;
+
+	}
+
+	return quantised;
+
+}
+
+// The packed weights of a vertex, as the float stored in its position's w
+float PackMaterial(float3 position, float3 normal)
+{
+
+	uint3 layers = QuantiseWeights(MaterialLayerWeights(position.y, normal.y), 63);
+	uint3 axes = QuantiseWeights(TriplanarWeights(normal), 63);
+
+	return asfloat(0x40000000u | layers.x | (layers.y << 6) | (axes.x << 12) | (axes.y << 18));
+
+}
+
+// Weights from the 32 bit form of MeshVertex
+void UnpackMaterial(uint packed, out float3 layers, out float3 axes)
+{
+
+	uint4 values = uint4(packed, packed >> 6, packed >> 12, packed >> 18) & 0x3F;
+
+	layers = float3(values.x, values.y, 63 - values.x - values.y) / 63.0f;
+	axes = float3(values.z, values.w, 63 - values.z - values.w) / 63.0f;
+
+}
+
+// Weights from the 16 bit form of PackedVertex
+void UnpackMaterialShort(uint packed, out float3 layers, out float3 axes)
+{
+
+	uint4 values = uint4(packed, packed >> 4, packed >> 8, packed >> 12) & 0xF;
+
+	layers = float3(values.x, values.y, 15 - values.x - values.y) / 15.0f;
+	axes = float3(values.z, values.w, 15 - values.z - values.w) / 15.0f;
+
+}
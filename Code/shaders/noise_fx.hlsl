@@ -199,4 +199,79 @@ float snoise3(float3 input)
 
 }
 
+// Hash of a lattice point's coordinates and a seed, as hashLattice in CPUNoise.cpp
+// Each coordinate is scaled by its own odd constant, then xxHash32's avalanche mixes every input bit into every output bit
+uint hashLattice(int3 cell, uint seed)
+{
+
+	uint hash = seed * 0x27D4EB2Fu + 0x165667B1u + (uint)cell.x * 0x9E3779B1u + (uint)cell.y * 0x85EBCA77u + (uint)cell.z * 0xC2B2AE3Du;
+	hash ^= hash >> 15;
+	hash *= 0x85EBCA77u;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE3Du;
+	hash ^= hash >> 16;
+	return hash;
+
+}
+
+// 3D Perlin noise with each corner's gradient hashed from its coordinates instead of loaded from the permutation texture
+float hnoise3(float3 input, uint seed)
+{
+
+	int3 i0 = floor(input);
+	int3 i1 = i0 + 1;
+	float3 f0 = input - i0;
+	float3 f1 = f0 - 1.0f;
+
+	float r = fade(f0.z);
+	float t = fade(f0.y);
+	float s = fade(f0.x);
+
+	float n000 = grad3(hashLattice(int3(i0.x, i0.y, i0.z), seed), f0.x, f0.y, f0.z);
+	float n001 = grad3(hashLattice(int3(i0.x, i0.y, i1.z), seed), f0.x, f0.y, f1.z);
+	float n010 = grad3(hashLattice(int3(i0.x, i1.y, i0.z), seed), f0.x, f1.y, f0.z);
+	float n011 = grad3(hashLattice(int3(i0.x, i1.y, i1.z), seed), f0.x, f1.y, f1.z);
+	float n100 = grad3(hashLattice(int3(i1.x, i0.y, i0.z), seed), f1.x, f0.y, f0.z);
+	float n101 = grad3(hashLattice(int3(i1.x, i0.y, i1.z), seed), f1.x, f0.y, f1.z);
+	float n110 = grad3(hashLattice(int3(i1.x, i1.y, i0.z), seed), f1.x, f1.y, f0.z);
+	float n111 = grad3(hashLattice(int3(i1.x, i1.y, i1.z), seed), f1.x, f1.y, f1.z);
+
+	float n0 = lerp(lerp(n000, n001, r), lerp(n010, n011, r), t);
+	float n1 = lerp(lerp(n100, n101, r), lerp(n110, n111, r), t);
+
+	return 0.936f * (lerp(n0, n1, s));
+
+}
+
+// 3D Simplex noise with hashed gradients; corners out of range contribute nothing rather than being branched around
+float hsnoise3(float3 input, uint seed)
+{
+
+	const float2  C = float2(1.0f / 6.0f, 1.0f / 3.0f);
+
+	int3 i = floor(input + dot(input, C.yyy));
+	float3 x0 = input - i + dot(i, C.xxx);
+
+	float3 g = step(x0.yzx, x0.xyz);
+	float3 l = 1.0 - g;
+	int3 i1 = min(g.xyz, l.zxy);
+	int3 i2 = max(g.xyz, l.zxy);
+
+	float3 x1 = x0 - i1 + C.xxx;
+	float3 x2 = x0 - i2 + C.yyy;
+	float3 x3 = x0 - 0.5f;
+
+	float4 t = max(0.5f - float4(dot(x0, x0), dot(x1, x1), dot(x2, x2), dot(x3, x3)), 0.0f);
+	t *= t;
+	t *= t;
+
+	float4 n = float4(grad3(hashLattice(i, seed), x0.x, x0.y, x0.z),
+		grad3(hashLattice(i + i1, seed), x1.x, x1.y, x1.z),
+		grad3(hashLattice(i + i2, seed), x2.x, x2.y, x2.z),
+		grad3(hashLattice(i + 1, seed), x3.x, x3.y, x3.z));
+
+	return 72.0f * dot(t, n);
+
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,38 @@
+// Prefix add compute shader
+// Adds the scanned block totals from the level above back into each block, completing a multi-level scan
+cbuffer ScanBuffer : register(b0)
+{
+
+	uint elementCount;
+	uint groupsX;
+	uint2 padding;
+
+};
+
+RWStructuredBuffer<uint> data : register(u0);
+RWStructuredBuffer<uint> blockSums : register(u1);
+
+#define BLOCK_SIZE 512
+
+[numthreads(BLOCK_SIZE / 2, 1, 1)]
+void main(uint3 Gid : SV_GroupID, uint GI : SV_GroupIndex)
+{
+
+	uint block = Gid.y * groupsX + Gid.x;
+	uint first = block * BLOCK_SIZE + GI * 2;
+
+	if (first < elementCount)
+	{
+
+		data[first] += blockSums[block];
+
+	}
+
+	if (first + 1 < elementCount)
+	{
+
+		data[first + 1] += blockSums[block];
+
+	}
+
+}
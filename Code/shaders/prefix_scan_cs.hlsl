@@ -0,0 +1,105 @@
+// Prefix scan compute shader
+// Exclusive scan of 512 element blocks in place (Blelloch), writing each block's total out for the next level
+cbuffer ScanBuffer : register(b0)
+{
+
+	uint elementCount;
+	// Blocks are spread over two dispatch dimensions to stay under the 65535 group limit
+	uint groupsX;
+	uint2 padding;
+
+};
+
+RWStructuredBuffer<uint> data : register(u0);
+RWStructuredBuffer<uint> blockSums : register(u1);
+
+#define BLOCK_SIZE 512
+
+groupshared uint sharedData[BLOCK_SIZE];
+
+[numthreads(BLOCK_SIZE / 2, 1, 1)]
+void main(uint3 Gid : SV_GroupID, uint GI : SV_GroupIndex)
+{
+
+	uint block = Gid.y * groupsX + Gid.x;
+	uint first = block * BLOCK_SIZE + GI * 2;
+
+	// Pad the final block with zeroes
+	sharedData[GI * 2] = first < elementCount ? data[first] : 0;
+	sharedData[GI * 2 + 1] = first + 1 < elementCount ? data[first + 1] : 0;
+
+	// Up-sweep: build partial sums in a balanced tree
+	uint offset = 1;
+
+	[unroll]
+	for (uint d = BLOCK_SIZE / 2; d > 0; d >>= 1)
+	{
+
+		GroupMemoryBarrierWithGroupSync();
+
+		if (GI < d)
+		{
+
+			uint a = offset * (2 * GI + 1) - 1;
+			uint b = offset * (2 * GI + 2) - 1;
+			sharedData[b] += sharedData[a];
+
+		}
+
+		offset *= 2;
+
+	}
+
+	// The root holds the block total; clear it to make the scan exclusive
+	if (GI == 0)
+	{
+
+		if (block * BLOCK_SIZE < elementCount)
+		{
+
+			blockSums[block] = sharedData[BLOCK_SIZE - 1];
+
+		}
+
+		sharedData[BLOCK_SIZE - 1] = 0;
+
+	}
+
+	// Down-sweep: push the partial sums back down the tree
+	[unroll]
+	for (uint e = 1; e < BLOCK_SIZE; e *= 2)
+	{
+
+		offset >>= 1;
+		GroupMemoryBarrierWithGroupSync();
+
+		if (GI < e)
+		{
+
+			uint a = offset * (2 * GI + 1) - 1;
+			uint b = offset * (2 * GI + 2) - 1;
+			uint temp = sharedData[a];
+			sharedData[a] = sharedData[b];
+			sharedData[b] += temp;
+
+		}
+
+	}
+
+	GroupMemoryBarrierWithGroupSync();
+
+	if (first < elementCount)
+	{
+
+		data[first] = sharedData[GI * 2];
+
+	}
+
+	if (first + 1 < elementCount)
+	{
+
+		data[first + 1] = sharedData[GI * 2 + 1];
+
+	}
+
+}